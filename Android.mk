@@ -46,7 +46,7 @@ LOCAL_CFLAGS += -DVERSION=\"1.2\"
 sph_files:=$(call all-c-files-under,sha3)
 
 LOCAL_SRC_FILES=\
-  cpu-miner.c util.c \
+  cpu-miner.c miner-common.c util.c \
   api.c sysinfos.c \
   $(call all-c-files-under,algo) \
   $(filter-out sha3/md_helper.c,$(sph_files)) \
@@ -15,6 +15,10 @@
 #include <stdbool.h>
 #include <memory.h>
 #include <unistd.h>
+#include <mm_malloc.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
 #include <openssl/sha.h>
 #include "miner.h"
 #include "algo-gate-api.h"
@@ -103,13 +107,117 @@ void null_hash_alt()
   applog(LOG_WARNING,"SWERR: null_hash_alt unsafe null function");
 };
 
+void std_hash_nway( void *output, const void *input, int n )
+{
+   for ( int i = 0; i < n; i++ )
+      algo_gate.hash( (uint32_t*)output + i * 8,
+                      (const uint32_t*)input + i * 20, 80 );
+}
+
+void std_scratch_size( uint64_t *per_thread, uint64_t *shared )
+{
+   *per_thread = 0;
+   *shared = 0;
+}
+
+__thread struct scan_solutions scan_solutions;
+
+bool ( *submit_solution_hook )( int, const struct work*, uint32_t ) = NULL;
+
+bool scan_solution( int thr_id, struct work *work, uint32_t nonce )
+{
+   scan_solutions.nonce[ scan_solutions.count++ ] = nonce;
+   if ( submit_solution_hook
+        && !submit_solution_hook( thr_id, work, nonce ) )
+      return false;
+   // a target so low that the buffer fills sends no more from this scan
+   return scan_solutions.count < MAX_SCAN_SOLUTIONS;
+}
+
+bool scan_found_nonce( const struct work *work, uint32_t nonce )
+{
+   for ( int i = 0; i < scan_solutions.count; i++ )
+      if ( scan_solutions.nonce[i] == nonce )
+         return true;
+   return !scan_solutions.count
+          && *algo_gate.get_nonceptr( (uint32_t*)work->data ) == nonce;
+}
+
+// The last batch is cut at max_nonce, the nonce never wraps past it when
+// a range ends at 0xffffffff.
+int scanhash_nway( int thr_id, struct work *work, uint32_t max_nonce,
+                   uint64_t *hashes_done )
+{
+   uint32_t edata[MAX_HASH_LANES][20] __attribute__((aligned(64)));
+   uint32_t hash[MAX_HASH_LANES][8] __attribute__((aligned(64)));
+   uint32_t *pdata = work->data;
+   uint32_t *ptarget = work->target;
+   const uint32_t first_nonce = pdata[19];
+   const uint32_t Htarg = ptarget[7];
+   const int lanes = algo_gate.hash_lanes;
+   volatile uint8_t *restart = &(work_restart[thr_id].restart);
+   uint32_t n = first_nonce;
+   uint32_t hits;
+   int found = 0;
+   int k = lanes;
+   int i;
+
+   // like the other scanhash, hash at least the first nonce
+   if ( max_nonce < first_nonce )
+      max_nonce = first_nonce;
+
+   // big endian header, only the nonce differs between lanes
+   swab32_array( edata[0], pdata, 20 );
+   for ( i = 1; i < lanes; i++ )
+      memcpy( edata[i], edata[0], 76 );
+
+   for (;;)
+   {
+      // nonces left after n, the tail batch is shorter
+      const uint32_t left = max_nonce - n;
+      if ( left < (uint32_t)lanes )
+         k = left + 1;
+
+      for ( i = 0; i < k; i++ )
+         be32enc( &edata[i][19], n + i );
+      algo_gate.hash_nway( hash, edata, k );
+
+      // test word 7 of all lanes without branching, most batches end here
+      hits = 0;
+      for ( i = 0; i < k; i++ )
+         hits |= ( hash[i][7] <= Htarg ) << i;
+      for ( i = 0; hits; i++, hits >>= 1 )
+         if ( ( hits & 1 ) && fulltest( hash[i], ptarget ) )
+         {
+            found++;
+            if ( !scan_solution( thr_id, work, n + i ) )
+            {
+               pdata[19] = n + i;
+               *hashes_done = (uint64_t)( n - first_nonce ) + i + 1;
+               return found;
+            }
+         }
+      if ( left < (uint32_t)lanes || *restart )
+         break;
+      n += lanes;
+   }
+
+   // last nonce hashed, get_new_work continues after it
+   pdata[19] = n + k - 1;
+   *hashes_done = (uint64_t)( n - first_nonce ) + k;
+   return found;
+}
+
 void init_algo_gate( algo_gate_t* gate )
 {
    gate->miner_thread_init       = (void*)&return_true;
+   gate->miner_thread_free       = (void*)&do_nothing;
+   gate->unregister_algo         = (void*)&do_nothing;
    gate->scanhash                = (void*)&null_scanhash;
    gate->hash                    = (void*)&null_hash;
    gate->hash_alt                = (void*)&null_hash_alt;
    gate->hash_suw                = (void*)&null_hash_suw;
+   gate->hash_nway               = (void*)&std_hash_nway;
    gate->get_new_work            = (void*)&std_get_new_work;
    gate->get_nonceptr            = (void*)&std_get_nonceptr;
    gate->display_extra_data      = (void*)&do_nothing;
@@ -129,12 +237,17 @@ void init_algo_gate( algo_gate_t* gate )
    gate->do_this_thread          = (void*)&return_true;
    gate->longpoll_rpc_call       = (void*)&std_longpoll_rpc_call;
    gate->stratum_handle_response = (void*)&std_stratum_handle_response;
+   gate->scratch_size            = (void*)&std_scratch_size;
+   gate->lower_ways              = (void*)&return_false;
    gate->optimizations           = SSE2_OPT;
    gate->ntime_index             = STD_NTIME_INDEX;
    gate->nbits_index             = STD_NBITS_INDEX;
    gate->nonce_index             = STD_NONCE_INDEX;
    gate->work_data_size          = STD_WORK_DATA_SIZE;
    gate->work_cmp_size           = STD_WORK_CMP_SIZE;
+   gate->hot_switch              = true;
+   gate->hash_lanes              = 1;
+   gate->roll_version            = false;
 }
 
 // called by each thread that uses the gate
@@ -226,9 +339,59 @@ bool register_algo_gate( int algo, algo_gate_t *gate )
     applog(LOG_ERR, "FAIL: Required algo_gate functions undefined\n");
     return false;
   }
+  if ( gate->hash_lanes < 1 || gate->hash_lanes > MAX_HASH_LANES )
+  {
+    applog(LOG_ERR, "FAIL: algo_gate hash_lanes %d out of range\n",
+           gate->hash_lanes );
+    return false;
+  }
   return true;
 }
 
+void unregister_algo_gate( algo_gate_t *gate )
+{
+   gate->unregister_algo();
+}
+
+static __thread void   *thread_scratch = NULL;
+static __thread size_t  thread_scratch_size = 0;
+
+// -1 leaves huge pages to the kernel, 0 and 1 advise against and for them
+int scratch_hugepages = -1;
+
+uint64_t thread_scratch_total = 0;
+
+void *thread_scratch_alloc( size_t size )
+{
+   if ( size <= thread_scratch_size )
+      return thread_scratch;
+   thread_scratch_free();
+   thread_scratch = _mm_malloc( size, 64 );
+   thread_scratch_size = thread_scratch ? size : 0;
+   __sync_add_and_fetch( &thread_scratch_total, thread_scratch_size );
+#if defined(MADV_HUGEPAGE)
+   if ( thread_scratch && scratch_hugepages >= 0 )
+   {
+      // only whole pages can be advised
+      uintptr_t start = ( (uintptr_t)thread_scratch + 4095 ) & ~4095UL;
+      uintptr_t end = ( (uintptr_t)thread_scratch + size ) & ~4095UL;
+      if ( end > start )
+         madvise( (void*)start, end - start,
+                  scratch_hugepages ? MADV_HUGEPAGE : MADV_NOHUGEPAGE );
+   }
+#endif
+   return thread_scratch;
+}
+
+void thread_scratch_free()
+{
+   if ( thread_scratch )
+      _mm_free( thread_scratch );
+   __sync_sub_and_fetch( &thread_scratch_total, thread_scratch_size );
+   thread_scratch = NULL;
+   thread_scratch_size = 0;
+}
+
 // override std defaults with jr2 defaults
 bool register_json_rpc2( algo_gate_t *gate )
 {
@@ -112,9 +112,12 @@ int ( *scanhash ) ( int, struct work*, uint32_t, uint64_t* );
 void ( *hash )     ( void*, const void*, uint32_t ) ;
 void ( *hash_alt ) ( void*, const void*, uint32_t );
 void ( *hash_suw ) ( void*, const void* );
+void ( *hash_nway ) ( void*, const void*, int );
 
 //optional, safe to use default in most cases
 bool ( *miner_thread_init )      ( int );
+void ( *miner_thread_free )      ( int );
+void ( *unregister_algo )        ();
 void ( *stratum_gen_work )       ( struct stratum_ctx*, struct work* );
 void ( *get_new_work )           ( struct work*, struct work*, int, uint32_t*,
                                    bool );
@@ -136,12 +139,17 @@ void ( *resync_threads )         ( struct work* );
 bool ( *do_this_thread )         ( int );
 json_t* (*longpoll_rpc_call)     ( CURL*, int*, char* );
 bool ( *stratum_handle_response )( json_t* );
+void ( *scratch_size )           ( uint64_t*, uint64_t* );
+bool ( *lower_ways )             ();
 set_t optimizations;
 int  ntime_index;
 int  nbits_index;
 int  nonce_index;            // use with caution, see warning below
 int  work_data_size;
 int  work_cmp_size;
+bool hot_switch;             // threads can be quiesced for an algo switch
+int  hash_lanes;             // nonces per hash_nway call, see scanhash_nway
+bool roll_version;           // header version bits can be rolled, BIP320
 
 } algo_gate_t;
 
@@ -188,6 +196,43 @@ void null_hash    ();
 void null_hash_alt();
 void null_hash_suw();
 
+// Multi lane hashing for scanhash_nway. hash_nway hashes n 80 byte headers,
+// contiguous in the input, to n contiguous 32 byte hashes. An algo with
+// a lane kernel sets hash_nway and hash_lanes, up to MAX_HASH_LANES.
+// The default hashes the lanes one at a time with gate.hash.
+#define MAX_HASH_LANES 8
+void std_hash_nway( void *output, const void *input, int n );
+
+// Generic scanhash for algos with a std 80 byte header, nonce scheduling,
+// target test and restart polling are done per hash_lanes nonces. It is a
+// multi solution scan, see scan_solution.
+int scanhash_nway( int thr_id, struct work *work, uint32_t max_nonce,
+                   uint64_t *hashes_done );
+
+// Solutions of the running scan of a thread. A multi solution scanhash
+// passes each nonce that passes fulltest to scan_solution() and keeps
+// scanning to max_nonce, returning the count. The other scanhash return
+// 1 at the first nonce, left in the work, for miner_thread to submit.
+#define MAX_SCAN_SOLUTIONS 16
+struct scan_solutions
+{
+   uint32_t nonce[ MAX_SCAN_SOLUTIONS ];
+   int      count;
+   bool     failed;      // the hook couldn't submit
+};
+extern __thread struct scan_solutions scan_solutions;
+
+// Forwards a solution as it is found, false to end the scan. Set by the
+// miner, without it the solutions are only recorded.
+extern bool ( *submit_solution_hook )( int thr_id, const struct work *work,
+                                       uint32_t nonce );
+
+// Records a solution of the scan, false if the scan must end.
+bool scan_solution( int thr_id, struct work *work, uint32_t nonce );
+
+// true if the last scan of this thread found nonce, for either kind.
+bool scan_found_nonce( const struct work *work, uint32_t nonce );
+
 // optional safe targets, default listed first unless noted.
 
 void std_wait_for_diff();
@@ -243,6 +288,12 @@ bool jr2_stratum_handle_response( json_t *val );
 bool std_ready_to_mine( struct work* work, struct stratum_ctx* stratum,
                         int thr_id );
 
+// Bytes of scratch memory a miner thread needs and bytes shared by all
+// threads, for the --max-memory budget (memory.c). The default is none.
+// lower_ways hashes fewer nonces at once per thread to need less, false
+// when already at one. Default is return_false.
+void std_scratch_size( uint64_t *per_thread, uint64_t *shared );
+
 // Gate admin functions
 
 // Called from main to initialize all gate functions and algo-specific data
@@ -260,6 +311,23 @@ bool register_algo( algo_gate_t *gate );
 // functions and data.
 bool register_json_rpc2( algo_gate_t *gate );
 
+// Called with all miner threads quiesced before the gate is replaced by
+// another algo. Undoes any global setup done by the register function.
+void unregister_algo_gate( algo_gate_t *gate );
+
+// Per thread scratch memory for miner_thread_init. The buffer is kept when
+// the algo is switched and only grown when the new algo needs more.
+// Contents are undefined, 64 byte aligned.
+void *thread_scratch_alloc( size_t size );
+// Frees it, for threads that exit while the miner keeps running.
+void thread_scratch_free();
+// Huge page advice for the scratch, -1 default, 0 off, 1 on.
+extern int scratch_hugepages;
+// Bytes of scratch held by all threads.
+extern uint64_t thread_scratch_total;
+// Fits the gate of an algo switch to the memory budget, see memory.c.
+bool memory_switch( algo_gate_t *gate );
+
 // use this to call the hash function of an algo directly, ie util.c test.
 void exec_hash_function( int algo, void *output, const void *pdata );
 
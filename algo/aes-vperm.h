@@ -0,0 +1,184 @@
+// AES round primitives for cpus without AES-NI.
+//
+// Mike Hamburg's vector permute AES (http://crypto.stanford.edu/vpaes/)
+// computes the S-box with SSSE3 pshufb lookups in GF(2^4) instead of 256
+// entry tables, in constant time and with no cache footprint. Adapted from
+// the vperm ECHO of Cagdas Calik, which first carried these macros.
+//
+// The macros work in the vperm basis: TRANSFORM with _k_ipt enters it and
+// with _k_opt leaves it, xor is the same in both bases. A kernel that runs
+// many rounds on one state (echo) stays in the vperm basis between rounds
+// and converts its round keys instead. The vperm_ functions take and return
+// the normal basis and are drop in replacements of the AES-NI intrinsics.
+//
+// Kernels written with the mm_aes names get AES-NI when the compiler
+// targets it and vperm otherwise, MM_AES tells if either is available.
+
+#ifndef AES_VPERM_H__
+#define AES_VPERM_H__
+
+#include <tmmintrin.h>
+
+// as in algo/sha3/sha3_common.h, which can't be mixed with the crypto/ code
+#ifndef MYALIGN
+#define MYALIGN __attribute__((aligned(16)))
+#endif
+#ifndef M128
+#define M128(x) *((__m128i*)x)
+#endif
+
+extern const unsigned int _k_s0F[];
+extern const unsigned int _k_ipt[];
+extern const unsigned int _k_opt[];
+extern const unsigned int _k_inv[];
+extern const unsigned int _k_sb1[];
+extern const unsigned int _k_sb2[];
+extern const unsigned int _k_sbo[];
+extern const unsigned int _k_h63[];
+extern const unsigned int _k_h5b[];
+extern const unsigned int _k_aesmix1[];
+extern const unsigned int _k_aesmix2[];
+extern const unsigned int _k_aesmix3[];
+extern const unsigned int _k_aesmix4[];
+
+// input: x, table
+// output: x
+#define TRANSFORM(x, table, t1, t2)\
+	t1 = _mm_andnot_si128(M128(_k_s0F), x);\
+	t1 = _mm_srli_epi32(t1, 4);\
+	x  = _mm_and_si128(x, M128(_k_s0F));\
+	t1 = _mm_shuffle_epi8(*((__m128i*)table + 1), t1);\
+	x  = _mm_shuffle_epi8(*((__m128i*)table + 0), x);\
+	x  = _mm_xor_si128(x, t1)
+
+// input: x
+// output: t2, t3
+#define SUBSTITUTE_VPERM_CORE(x, t1, t2, t3, t4)\
+	t1 = _mm_andnot_si128(M128(_k_s0F), x);\
+	t1 = _mm_srli_epi32(t1, 4);\
+	x  = _mm_and_si128(x, M128(_k_s0F));\
+	t2 = _mm_shuffle_epi8(*((__m128i*)_k_inv + 1), x);\
+	x  = _mm_xor_si128(x, t1);\
+	t3 = _mm_shuffle_epi8(*((__m128i*)_k_inv + 0), t1);\
+	t3 = _mm_xor_si128(t3, t2);\
+	t4 = _mm_shuffle_epi8(*((__m128i*)_k_inv + 0), x);\
+	t4 = _mm_xor_si128(t4, t2);\
+	t2 = _mm_shuffle_epi8(*((__m128i*)_k_inv + 0), t3);\
+	t2 = _mm_xor_si128(t2, x);\
+	t3 = _mm_shuffle_epi8(*((__m128i*)_k_inv + 0), t4);\
+	t3 = _mm_xor_si128(t3, t1);\
+
+// input: x1, x2, table
+// output: y
+#define VPERM_LOOKUP(x1, x2, table, y, t)\
+	t = _mm_shuffle_epi8(*((__m128i*)table + 0), x1);\
+	y = _mm_shuffle_epi8(*((__m128i*)table + 1), x2);\
+	y = _mm_xor_si128(y, t)
+
+// SubBytes, normal basis
+// input: x
+// output: x
+#define SUBSTITUTE_VPERM(x, t1, t2, t3, t4)  \
+	TRANSFORM(x, _k_ipt, t1, t2);\
+	SUBSTITUTE_VPERM_CORE(x, t1, t2, t3, t4);\
+	VPERM_LOOKUP(t2, t3, _k_sbo, x, t1);\
+	x = _mm_xor_si128(x, M128(_k_h63))
+
+// ShiftRows, SubBytes and MixColumns, vperm basis
+// input: x
+// output: x
+#define AES_ROUND_VPERM_CORE(x, t1, t2, t3, t4, s1, s2, s3) \
+	SUBSTITUTE_VPERM_CORE(x, t1, t2, t3, t4);\
+	VPERM_LOOKUP(t2, t3, _k_sb1, s1, t1);\
+	VPERM_LOOKUP(t2, t3, _k_sb2, s2, t1);\
+	s3 = _mm_xor_si128(s1, s2);\
+	x = _mm_shuffle_epi8(s2, M128(_k_aesmix1));\
+	x = _mm_xor_si128(x, _mm_shuffle_epi8(s3, M128(_k_aesmix2)));\
+	x = _mm_xor_si128(x, _mm_shuffle_epi8(s1, M128(_k_aesmix3)));\
+	x = _mm_xor_si128(x, _mm_shuffle_epi8(s1, M128(_k_aesmix4)));\
+	x = _mm_xor_si128(x, M128(_k_h5b))
+
+// ShiftRows, SubBytes and MixColumns, normal basis
+// input: x
+// output: x
+#define AES_ROUND_VPERM(x, t1, t2, t3, t4, s1, s2, s3) \
+	TRANSFORM(x, _k_ipt, t1, t2);\
+	AES_ROUND_VPERM_CORE(x, t1, t2, t3, t4, s1, s2, s3);\
+	TRANSFORM(x, _k_opt, t1, t2)
+
+// _mm_aesenc_si128
+static inline __m128i vperm_aesenc( __m128i x, __m128i k )
+{
+   __m128i t1, t2, t3, t4, s1, s2, s3;
+   AES_ROUND_VPERM( x, t1, t2, t3, t4, s1, s2, s3 );
+   return _mm_xor_si128( x, k );
+}
+
+// _mm_aesenclast_si128, ShiftRows is _k_aesmix1
+static inline __m128i vperm_aesenclast( __m128i x, __m128i k )
+{
+   __m128i t1, t2, t3, t4;
+   SUBSTITUTE_VPERM( x, t1, t2, t3, t4 );
+   x = _mm_shuffle_epi8( x, M128( _k_aesmix1 ) );
+   return _mm_xor_si128( x, k );
+}
+
+// _mm_aeskeygenassist_si128: SubWord of words 1 and 3, each also rotated
+// and xored with rcon.
+static inline __m128i vperm_aeskeygenassist( __m128i x, const int rcon )
+{
+   __m128i t1, t2, t3, t4;
+   SUBSTITUTE_VPERM( x, t1, t2, t3, t4 );
+   x = _mm_shuffle_epi8( x, _mm_setr_epi8(  4,  5,  6,  7,  5,  6,  7,  4,
+                                           12, 13, 14, 15, 13, 14, 15, 12 ) );
+   return _mm_xor_si128( x, _mm_set_epi32( rcon, 0, rcon, 0 ) );
+}
+
+// The same in the vperm basis, the state and the key enter it with
+// vperm_basis_in and the state leaves it with vperm_basis_out.
+// TRANSFORM doesn't use its second temporary.
+static inline __m128i vperm_basis_in( __m128i x )
+{
+   __m128i t1;
+   TRANSFORM( x, _k_ipt, t1, t1 );
+   return x;
+}
+
+static inline __m128i vperm_basis_out( __m128i x )
+{
+   __m128i t1;
+   TRANSFORM( x, _k_opt, t1, t1 );
+   return x;
+}
+
+static inline __m128i vperm_aesenc_basis( __m128i x, __m128i k )
+{
+   __m128i t1, t2, t3, t4, s1, s2, s3;
+   AES_ROUND_VPERM_CORE( x, t1, t2, t3, t4, s1, s2, s3 );
+   return _mm_xor_si128( x, k );
+}
+
+// A kernel that only xors and permutes bytes between its rounds can run
+// in the basis with mm_aesenc_basis, the two transforms of each vperm round
+// are then paid once per value that enters or leaves the kernel. The basis
+// is the normal one with AES-NI.
+#if defined(__AES__) && !defined(NO_AES_NI)
+  #include <wmmintrin.h>
+  #define MM_AES 1
+  #define mm_aesenc             _mm_aesenc_si128
+  #define mm_aesenclast         _mm_aesenclast_si128
+  #define mm_aeskeygenassist    _mm_aeskeygenassist_si128
+  #define mm_aes_basis_in( x )  ( x )
+  #define mm_aes_basis_out( x ) ( x )
+  #define mm_aesenc_basis       _mm_aesenc_si128
+#elif defined(__SSSE3__)
+  #define MM_AES 1
+  #define mm_aesenc             vperm_aesenc
+  #define mm_aesenclast         vperm_aesenclast
+  #define mm_aeskeygenassist    vperm_aeskeygenassist
+  #define mm_aes_basis_in       vperm_basis_in
+  #define mm_aes_basis_out      vperm_basis_out
+  #define mm_aesenc_basis       vperm_aesenc_basis
+#endif
+
+#endif
@@ -79,6 +79,12 @@ int64_t argon2_get_max64 ()
   return 0x1ffLL;
 }
 
+void argon2_scratch_size( uint64_t *per_thread, uint64_t *shared )
+{
+  *per_thread = M_COSTS * ARGON2_BLOCK_SIZE;
+  *shared = 0;
+}
+
 bool register_argon2_algo( algo_gate_t* gate )
 {
   gate->optimizations = SSE2_OPT | AES_OPT | AVX_OPT | AVX2_OPT;
@@ -87,6 +93,7 @@ bool register_argon2_algo( algo_gate_t* gate )
   gate->gen_merkle_root = (void*)&SHA256_gen_merkle_root;
   gate->set_target      = (void*)&scrypt_set_target;
   gate->get_max64       = (void*)&argon2_get_max64;
+  gate->scratch_size    = (void*)&argon2_scratch_size;
   return true;
 };
 
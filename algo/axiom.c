@@ -5,6 +5,7 @@
 #include <stdint.h>
 
 #include "algo/shabal/sph_shabal.h"
+#include "algo/interleave.h"
 
 static __thread uint32_t _ALIGN(128) M[65536][8];
 
@@ -44,45 +45,115 @@ void axiomhash(void *output, const void *input)
 	memcpy(output, M[N-1], 32);
 }
 
+// Lanes are 64 bytes apart in the cache sets.
+#define AXIOM_N     65536
+#define AXIOM_LANE  ( AXIOM_N + 2 )
+
+static __thread uint32_t (*axiom_lanes)[8] = NULL;
+static __thread int axiom_ways = 1;
+
+// axiomhash of k nonces in lockstep, see algo/interleave.h. The second loop
+// reads M[j] where j depends on the block just hashed, the next j of a lane
+// is prefetched while the other lanes are hashed.
+static void axiomhash_ways( uint32_t hash[][8], uint32_t data[][20], int k )
+{
+	sph_shabal256_context ctx;
+	uint32_t (*M[IL_MAX_WAYS])[8];
+	int l;
+
+	for (l = 0; l < k; l++) {
+		M[l] = axiom_lanes + l * AXIOM_LANE;
+		sph_shabal256_init(&ctx);
+		sph_shabal256(&ctx, data[l], 80);
+		sph_shabal256_close(&ctx, M[l][0]);
+		for (int i = 1; i < AXIOM_N; i++) {
+			sph_shabal256_init(&ctx);
+			sph_shabal256(&ctx, M[l][i-1], 32);
+			sph_shabal256_close(&ctx, M[l][i]);
+		}
+	}
+
+	for (int b = 0; b < AXIOM_N; b++)
+	for (l = 0; l < k; l++)
+	{
+		const int p = b > 0 ? b - 1 : 0xFFFF;
+		const int q = M[l][p][0] % 0xFFFF;
+		const int j = (b + q) % AXIOM_N;
+		uint8_t _ALIGN(128) buf[64];
+
+		memcpy(buf, M[l][p], 32);
+		memcpy(&buf[32], M[l][j], 32);
+		sph_shabal256_init(&ctx);
+		sph_shabal256(&ctx, buf, 64);
+		sph_shabal256_close(&ctx, M[l][b]);
+		il_prefetch(M[l][(b + 1 + M[l][b][0] % 0xFFFF) % AXIOM_N]);
+	}
+
+	for (l = 0; l < k; l++)
+		memcpy(hash[l], M[l][AXIOM_N-1], 32);
+}
+
 int scanhash_axiom(int thr_id, struct work *work,
 	uint32_t max_nonce, uint64_t *hashes_done)
 {
         uint32_t *pdata = work->data;
         uint32_t *ptarget = work->target;
-	uint32_t _ALIGN(128) hash64[8];
-	uint32_t _ALIGN(128) endiandata[20];
+	uint32_t _ALIGN(128) hash64[IL_MAX_WAYS][8];
+	uint32_t _ALIGN(128) endiandata[IL_MAX_WAYS][20];
 
 	const uint32_t Htarg = ptarget[7];
 	const uint32_t first_nonce = pdata[19];
+	const int k = axiom_ways;
 
 	uint32_t n = first_nonce;
 
-        for (int k = 0; k < 19; k++)
-                be32enc(&endiandata[k], pdata[k]);
+	for (int l = 0; l < k; l++)
+		for (int i = 0; i < 19; i++)
+			be32enc(&endiandata[l][i], pdata[i]);
 
 	do {
-		be32enc(&endiandata[19], n);
-		axiomhash(hash64, endiandata);
-		if (hash64[7] < Htarg && fulltest(hash64, ptarget)) {
-			*hashes_done = n - first_nonce + 1;
-			pdata[19] = n;
+		for (int l = 0; l < k; l++)
+			be32enc(&endiandata[l][19], n + l);
+		axiomhash_ways(hash64, endiandata, k);
+		for (int l = 0; l < k; l++)
+		if (hash64[l][7] < Htarg && fulltest(hash64[l], ptarget)) {
+			*hashes_done = n + l - first_nonce + 1;
+			pdata[19] = n + l;
 			return true;
 		}
-		n++;
+		n += k;
 
 	} while (n < max_nonce && !work_restart[thr_id].restart);
 
-	*hashes_done = n - first_nonce + 1;
+	*hashes_done = n - first_nonce;
 	pdata[19] = n;
 
 	return 0;
 }
 
+bool axiom_miner_thread_init( int thr_id )
+{
+	axiom_ways = interleave_ways( AXIOM_LANE * 32 );
+	axiom_lanes = thread_scratch_alloc( (size_t)axiom_ways * AXIOM_LANE * 32 );
+	if ( axiom_lanes )
+		return true;
+	applog( LOG_ERR, "Thread %u: Axiom buffer allocation failed", thr_id );
+	return false;
+}
+
+void axiom_scratch_size( uint64_t *per_thread, uint64_t *shared )
+{
+	*per_thread = (uint64_t)interleave_ways( AXIOM_LANE * 32 ) * AXIOM_LANE * 32;
+	*shared = 0;
+}
+
 bool register_axiom_algo( algo_gate_t* gate )
 {
+    gate->miner_thread_init = (void*)&axiom_miner_thread_init;
     gate->scanhash  = (void*)&scanhash_axiom;
     gate->hash      = (void*)&axiomhash;
     gate->hash_alt  = (void*)&axiomhash;
     gate->get_max64 = (void*)&get_max64_0x40LL;
+    gate->scratch_size = (void*)&axiom_scratch_size;
     return true;
 }
@@ -17,9 +17,7 @@ extern void pentablakehash(void *output, const void *input)
 
 	sph_blake512_context     ctx_blake;
 
-	sph_blake512_init(&ctx_blake);
-	sph_blake512(&ctx_blake, input, 80);
-	sph_blake512_close(&ctx_blake, hash);
+	sph_blake512_80(hash, input);
 
         sph_blake512_init(&ctx_blake);
 	sph_blake512(&ctx_blake, hash, 64);
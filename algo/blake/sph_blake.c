@@ -1120,6 +1120,151 @@ sph_blake512_addbits_and_close(void *cc, unsigned ub, unsigned n, void *dst)
 //	sph_blake512_init(cc);
 }
 
+#if !SPH_COMPACT_BLAKE_64
+
+/*
+ * State of the single compression of an 80 byte header after round 0,
+ * less the second half of G4, the only step of round 0 that reads M9.
+ */
+static __thread struct {
+	unsigned char head[76];
+	int valid;
+	sph_u64 V[16];
+	sph_u64 M[16];
+} blake512_80_mid;
+
+static void
+blake512_80_prehash(const unsigned char *data)
+{
+	sph_u64 M0, M1, M2, M3, M4, M5, M6, M7;
+	sph_u64 M8, MA, MB, MC, MD, ME, MF;
+	sph_u64 V0, V1, V2, V3, V4, V5, V6, V7;
+	sph_u64 V8, V9, VA, VB, VC, VD, VE, VF;
+	sph_u64 *V = blake512_80_mid.V;
+	sph_u64 *M = blake512_80_mid.M;
+
+	M0 = sph_dec64be(data +   0);
+	M1 = sph_dec64be(data +   8);
+	M2 = sph_dec64be(data +  16);
+	M3 = sph_dec64be(data +  24);
+	M4 = sph_dec64be(data +  32);
+	M5 = sph_dec64be(data +  40);
+	M6 = sph_dec64be(data +  48);
+	M7 = sph_dec64be(data +  56);
+	M8 = sph_dec64be(data +  64);
+	MA = SPH_C64(0x8000000000000000);
+	MB = 0;
+	MC = 0;
+	MD = 1;
+	ME = 0;
+	MF = 80 << 3;
+	V0 = IV512[0];
+	V1 = IV512[1];
+	V2 = IV512[2];
+	V3 = IV512[3];
+	V4 = IV512[4];
+	V5 = IV512[5];
+	V6 = IV512[6];
+	V7 = IV512[7];
+	V8 = CB0;
+	V9 = CB1;
+	VA = CB2;
+	VB = CB3;
+	VC = (80 << 3) ^ CB4;
+	VD = (80 << 3) ^ CB5;
+	VE = CB6;
+	VF = CB7;
+
+	GB(M0, M1, CB0, CB1, V0, V4, V8, VC);
+	GB(M2, M3, CB2, CB3, V1, V5, V9, VD);
+	GB(M4, M5, CB4, CB5, V2, V6, VA, VE);
+	GB(M6, M7, CB6, CB7, V3, V7, VB, VF);
+	V0 = SPH_T64(V0 + V5 + (M8 ^ CB9));
+	VF = SPH_ROTR64(VF ^ V0, 32);
+	VA = SPH_T64(VA + VF);
+	V5 = SPH_ROTR64(V5 ^ VA, 25);
+	GB(MA, MB, CBA, CBB, V1, V6, VB, VC);
+	GB(MC, MD, CBC, CBD, V2, V7, V8, VD);
+	GB(ME, MF, CBE, CBF, V3, V4, V9, VE);
+
+	V[ 0] = V0; V[ 1] = V1; V[ 2] = V2; V[ 3] = V3;
+	V[ 4] = V4; V[ 5] = V5; V[ 6] = V6; V[ 7] = V7;
+	V[ 8] = V8; V[ 9] = V9; V[10] = VA; V[11] = VB;
+	V[12] = VC; V[13] = VD; V[14] = VE; V[15] = VF;
+	M[ 0] = M0; M[ 1] = M1; M[ 2] = M2; M[ 3] = M3;
+	M[ 4] = M4; M[ 5] = M5; M[ 6] = M6; M[ 7] = M7;
+	M[ 8] = M8; M[ 9] = 0;  M[10] = MA; M[11] = MB;
+	M[12] = MC; M[13] = MD; M[14] = ME; M[15] = MF;
+	memcpy(blake512_80_mid.head, data, 76);
+	blake512_80_mid.valid = 1;
+}
+
+#endif
+
+/* see sph_blake.h */
+void
+sph_blake512_80(void *dst, const void *data)
+{
+#if SPH_COMPACT_BLAKE_64
+	sph_blake512_context cc;
+
+	sph_blake512_init(&cc);
+	sph_blake512(&cc, data, 80);
+	sph_blake512_close(&cc, dst);
+#else
+	sph_u64 M0, M1, M2, M3, M4, M5, M6, M7;
+	sph_u64 M8, M9, MA, MB, MC, MD, ME, MF;
+	sph_u64 V0, V1, V2, V3, V4, V5, V6, V7;
+	sph_u64 V8, V9, VA, VB, VC, VD, VE, VF;
+	const sph_u64 *V = blake512_80_mid.V;
+	const sph_u64 *M = blake512_80_mid.M;
+	unsigned char *out = dst;
+
+	if (!blake512_80_mid.valid
+		|| memcmp(blake512_80_mid.head, data, 76) != 0)
+		blake512_80_prehash(data);
+
+	V0 = V[ 0]; V1 = V[ 1]; V2 = V[ 2]; V3 = V[ 3];
+	V4 = V[ 4]; V5 = V[ 5]; V6 = V[ 6]; V7 = V[ 7];
+	V8 = V[ 8]; V9 = V[ 9]; VA = V[10]; VB = V[11];
+	VC = V[12]; VD = V[13]; VE = V[14]; VF = V[15];
+	M0 = M[ 0]; M1 = M[ 1]; M2 = M[ 2]; M3 = M[ 3];
+	M4 = M[ 4]; M5 = M[ 5]; M6 = M[ 6]; M7 = M[ 7];
+	M8 = M[ 8]; MA = M[10]; MB = M[11];
+	MC = M[12]; MD = M[13]; ME = M[14]; MF = M[15];
+	M9 = sph_dec64be((const unsigned char *)data + 72);
+
+	/* finish round 0 */
+	V0 = SPH_T64(V0 + V5 + (M9 ^ CB8));
+	VF = SPH_ROTR64(VF ^ V0, 16);
+	VA = SPH_T64(VA + VF);
+	V5 = SPH_ROTR64(V5 ^ VA, 11);
+	ROUND_B(1);
+	ROUND_B(2);
+	ROUND_B(3);
+	ROUND_B(4);
+	ROUND_B(5);
+	ROUND_B(6);
+	ROUND_B(7);
+	ROUND_B(8);
+	ROUND_B(9);
+	ROUND_B(0);
+	ROUND_B(1);
+	ROUND_B(2);
+	ROUND_B(3);
+	ROUND_B(4);
+	ROUND_B(5);
+	sph_enc64be(out +  0, IV512[0] ^ V0 ^ V8);
+	sph_enc64be(out +  8, IV512[1] ^ V1 ^ V9);
+	sph_enc64be(out + 16, IV512[2] ^ V2 ^ VA);
+	sph_enc64be(out + 24, IV512[3] ^ V3 ^ VB);
+	sph_enc64be(out + 32, IV512[4] ^ V4 ^ VC);
+	sph_enc64be(out + 40, IV512[5] ^ V5 ^ VD);
+	sph_enc64be(out + 48, IV512[6] ^ V6 ^ VE);
+	sph_enc64be(out + 56, IV512[7] ^ V7 ^ VF);
+#endif
+}
+
 #endif
 
 #ifdef __cplusplus
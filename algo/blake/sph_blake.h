@@ -318,6 +318,17 @@ void sph_blake512_close(void *cc, void *dst);
 void sph_blake512_addbits_and_close(
 	void *cc, unsigned ub, unsigned n, void *dst);
 
+/**
+ * Compute the BLAKE-512 hash of an 80 byte block header. Everything that
+ * does not depend on the last 32 bit word (the nonce) is computed when
+ * the first 76 bytes change, and kept for the calling thread, so hashing
+ * a run of nonces only computes the nonce dependent remainder.
+ *
+ * @param dst    the destination buffer (64 bytes)
+ * @param data   the 80 byte header
+ */
+void sph_blake512_80(void *dst, const void *data);
+
 #endif
 
 #ifdef __cplusplus
@@ -958,6 +958,93 @@ sph_bmw512_addbits_and_close(void *cc, unsigned ub, unsigned n, void *dst)
 //	sph_bmw512_init(cc);
 }
 
+/*
+ * For an 80 byte header only Wb2, Wb4, Wb11, Wb12 and Wb15 of the first
+ * compression read M9, which holds the nonce. The other eleven qt[] of
+ * the first step are kept while the first 76 bytes stay the same.
+ */
+static __thread struct {
+	unsigned char head[76];
+	int valid;
+	sph_u64 mv[16];
+	sph_u64 qt[16];
+} bmw512_80_mid;
+
+#define M(x)    (mv[x])
+#define H(x)    (IV512[x])
+#define dH(x)   (h2[x])
+
+static void
+bmw512_80_prehash(const unsigned char *data)
+{
+	sph_u64 *mv = bmw512_80_mid.mv;
+	sph_u64 qt[32];
+	int i;
+
+	for (i = 0; i < 10; i ++)
+		mv[i] = sph_dec64le(data + 8 * i);
+	mv[9] &= SPH_C64(0xFFFFFFFF);
+	mv[10] = 0x80;
+	for (i = 11; i < 15; i ++)
+		mv[i] = 0;
+	mv[15] = 80 << 3;
+	MAKE_Qab;
+	memcpy(bmw512_80_mid.qt, qt, sizeof bmw512_80_mid.qt);
+	memcpy(bmw512_80_mid.head, data, 76);
+	bmw512_80_mid.valid = 1;
+}
+
+/*
+ * M(9) is the only message word that changes, and the qt[] from the
+ * first step are read from the midstate, only those that use M9 are
+ * computed. The indices are constants so this all folds at compile time.
+ */
+#undef M
+#undef Qb
+#define M(x)    ((x) == 9 ? m9 : bmw512_80_mid.mv[x])
+#define Qb(j)   ((j) < 16 && (j) != 2 && (j) != 4 && (j) != 11 && (j) != 12 \
+			&& (j) != 15 ? bmw512_80_mid.qt[j] : qt[j])
+
+#define MAKE_Q80b   do { \
+		qt[ 2] = SPH_T64(sb2(Wb2 ) + H( 3)); \
+		qt[ 4] = SPH_T64(sb4(Wb4 ) + H( 5)); \
+		qt[11] = SPH_T64(sb1(Wb11) + H(12)); \
+		qt[12] = SPH_T64(sb2(Wb12) + H(13)); \
+		qt[15] = SPH_T64(sb0(Wb15) + H( 0)); \
+		MAKE_Qbb; \
+	} while (0)
+
+/* see sph_bmw.h */
+void
+sph_bmw512_80(void *dst, const void *data)
+{
+	sph_u64 bufw[16];
+	unsigned char *buf = (unsigned char *)bufw;
+	sph_u64 m9, h2[16], h1[16];
+	unsigned char *out = dst;
+	int u;
+
+	if (!bmw512_80_mid.valid
+		|| memcmp(bmw512_80_mid.head, data, 76) != 0)
+		bmw512_80_prehash(data);
+	m9 = bmw512_80_mid.mv[9]
+		| (sph_u64)sph_dec32le((const unsigned char *)data + 76) << 32;
+
+	FOLD(sph_u64, MAKE_Q80b, SPH_T64, SPH_ROTL64, M, Qb, dH);
+
+	for (u = 0; u < 16; u ++)
+		sph_enc64le_aligned(buf + 8 * u, h2[u]);
+	compress_big(buf, final_b, h1);
+	for (u = 0; u < 8; u ++)
+		sph_enc64le(out + 8 * u, h1[u + 8]);
+}
+
+#undef Qb
+#define Qb(j)   (qt[j])
+#undef M
+#undef H
+#undef dH
+
 #endif
 
 #ifdef __cplusplus
@@ -319,6 +319,17 @@ void sph_bmw512_close(void *cc, void *dst);
 void sph_bmw512_addbits_and_close(
 	void *cc, unsigned ub, unsigned n, void *dst);
 
+/**
+ * Compute the BMW-512 hash of an 80 byte block header. The part of the
+ * first compression that does not depend on the last 32 bit word (the
+ * nonce) is computed when the first 76 bytes change, and kept for the
+ * calling thread.
+ *
+ * @param dst    the destination buffer (64 bytes)
+ * @param data   the 80 byte header
+ */
+void sph_bmw512_80(void *dst, const void *data);
+
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,86 @@
+#include "miner.h"
+#include "algo-gate-api.h"
+#include "algo/chain.h"
+
+// The fixed chain algos, see algo/chain.h. A new chain coin is one line.
+
+CHAIN_ALGO( x11, get_max64_0x3ffff, CH_BLAKE, CH_BMW, CH_GROESTL, CH_SKEIN,
+            CH_JH, CH_KECCAK, CH_LUFFA, CH_CUBEHASH, CH_SHAVITE, CH_SIMD,
+            CH_ECHO );
+
+CHAIN_ALGO( c11, get_max64_0x3ffff, CH_BLAKE, CH_BMW, CH_GROESTL, CH_JH,
+            CH_KECCAK, CH_SKEIN, CH_LUFFA, CH_CUBEHASH, CH_SHAVITE, CH_SIMD,
+            CH_ECHO );
+
+// x11gost
+CHAIN_ALGO( sib, get_max64_0x3ffff, CH_BLAKE, CH_BMW, CH_GROESTL, CH_SKEIN,
+            CH_JH, CH_KECCAK, CH_GOST, CH_LUFFA, CH_CUBEHASH, CH_SHAVITE,
+            CH_SIMD, CH_ECHO );
+
+CHAIN_ALGO( x13, get_max64_0x3ffff, CH_BLAKE, CH_BMW, CH_GROESTL, CH_SKEIN,
+            CH_JH, CH_KECCAK, CH_LUFFA, CH_CUBEHASH, CH_SHAVITE, CH_SIMD,
+            CH_ECHO, CH_HAMSI, CH_FUGUE );
+
+CHAIN_ALGO( x14, get_max64_0x3ffff, CH_BLAKE, CH_BMW, CH_GROESTL, CH_SKEIN,
+            CH_JH, CH_KECCAK, CH_LUFFA, CH_CUBEHASH, CH_SHAVITE, CH_SIMD,
+            CH_ECHO, CH_HAMSI, CH_FUGUE, CH_SHABAL );
+
+CHAIN_ALGO( x15, get_max64_0x1fffffLL, CH_BLAKE, CH_BMW, CH_GROESTL,
+            CH_SKEIN, CH_JH, CH_KECCAK, CH_LUFFA, CH_CUBEHASH, CH_SHAVITE,
+            CH_SIMD, CH_ECHO, CH_HAMSI, CH_FUGUE, CH_SHABAL, CH_WHIRLPOOL );
+
+CHAIN_ALGO( x17, get_max64_0x1fffffLL, CH_BLAKE, CH_BMW, CH_GROESTL,
+            CH_SKEIN, CH_JH, CH_KECCAK, CH_LUFFA, CH_CUBEHASH, CH_SHAVITE,
+            CH_SIMD, CH_ECHO, CH_HAMSI, CH_FUGUE, CH_SHABAL, CH_WHIRLPOOL,
+            CH_SHA512, CH_HAVAL );
+
+CHAIN_ALGO( nist5, get_max64_0x1fffffLL, CH_BLAKE, CH_GROESTL, CH_JH,
+            CH_KECCAK, CH_SKEIN );
+
+CHAIN_ALGO( qubit, get_max64_0x1fffffLL, CH_LUFFA, CH_CUBEHASH, CH_SHAVITE,
+            CH_SIMD, CH_ECHO );
+
+CHAIN_ALGO( deep, get_max64_0x1fffffLL, CH_LUFFA, CH_CUBEHASH, CH_ECHO );
+
+DECLARE_CHAIN( veltor, CH_SKEIN, CH_SHAVITE, CH_SHABAL, CH_GOST );
+
+static int scanhash_veltor( int thr_id, struct work *work,
+                            uint32_t max_nonce, uint64_t *hashes_done )
+{
+   if ( opt_benchmark )
+      work->target[7] = 0x0cff;
+   return scanhash_nway( thr_id, work, max_nonce, hashes_done );
+}
+
+bool register_veltor_algo( algo_gate_t* gate )
+{
+   veltor_chain_gate( gate );
+   gate->scanhash  = (void*)&scanhash_veltor;
+   gate->get_max64 = (void*)&get_max64_0x3ffff;
+   return true;
+}
+
+DECLARE_CHAIN( s3, CH_SHAVITE, CH_SIMD, CH_SKEIN );
+
+bool register_s3_algo( algo_gate_t* gate )
+{
+   algo_not_tested();
+   s3_chain_gate( gate );
+   return true;
+}
+
+DECLARE_CHAIN( fresh, CH_SHAVITE, CH_SIMD, CH_SHAVITE, CH_SIMD, CH_ECHO );
+
+static void fresh_set_target( struct work* work, double job_diff )
+{
+   work_set_target( work, job_diff / (256.0 * opt_diff_factor) );
+}
+
+bool register_fresh_algo( algo_gate_t* gate )
+{
+   algo_not_tested();
+   fresh_chain_gate( gate );
+   gate->set_target = (void*)&fresh_set_target;
+   gate->get_max64  = (void*)&get_max64_0x3ffff;
+   return true;
+}
@@ -0,0 +1,166 @@
+#include "cpuminer-config.h"
+#include "miner.h"
+#include "algo-gate-api.h"
+#include "algo/chain.h"
+#include "algo/hash64.h"
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "algo/blake/sph_blake.h"
+#include "algo/bmw/sph_bmw.h"
+#include "algo/groestl/sph_groestl.h"
+#include "algo/jh/sph_jh.h"
+#include "algo/keccak/sph_keccak.h"
+#include "algo/skein/sph_skein.h"
+#include "algo/luffa/sph_luffa.h"
+#include "algo/cubehash/sph_cubehash.h"
+#include "algo/shavite/sph_shavite.h"
+#include "algo/simd/sph_simd.h"
+#include "algo/echo/sph_echo.h"
+#include "algo/hamsi/sph_hamsi.h"
+#include "algo/fugue/sph_fugue.h"
+#include "algo/shabal/sph_shabal.h"
+#include "algo/whirlpool/sph_whirlpool.h"
+#include "algo/sha3/sph_sha2.h"
+#include "algo/haval/sph-haval.h"
+#include "algo/gost/sph_gost.h"
+#include "algo/luffa/sse2/luffa_for_sse2.h"
+
+// luffa512 of the 80 byte header, the first two 32 byte blocks don't
+// depend on the nonce and are hashed once per header.
+
+static __thread struct
+{
+   hashState_luffa mid;
+   unsigned char   head[64];
+   bool            valid;
+} luffa80_mid;
+
+void luffa512_80( void *out, const void *in )
+{
+   hashState_luffa ctx;
+   if ( !luffa80_mid.valid || memcmp( luffa80_mid.head, in, 64 ) )
+   {
+      init_luffa( &luffa80_mid.mid, 512 );
+      update_luffa( &luffa80_mid.mid, (const BitSequence*)in, 64 );
+      memcpy( luffa80_mid.head, in, 64 );
+      luffa80_mid.valid = true;
+   }
+   memcpy( &ctx, &luffa80_mid.mid, sizeof ctx );
+   update_and_final_luffa( &ctx, (BitSequence*)out,
+                           (const BitSequence*)in + 64, 16 );
+}
+
+#define CHAIN_REF( fn ) \
+static void ref_##fn( void *out, const void *in, size_t len ) \
+{ \
+   sph_##fn##_context ctx; \
+   sph_##fn##_init( &ctx ); \
+   sph_##fn( &ctx, in, len ); \
+   sph_##fn##_close( &ctx, out ); \
+}
+
+// and the first stage on the header for those without a precompute
+#define CHAIN_REF80( fn ) \
+CHAIN_REF( fn ) \
+void fn##_80( void *out, const void *in ) \
+{ \
+   ref_##fn( out, in, 80 ); \
+}
+
+CHAIN_REF( blake512 )
+CHAIN_REF( bmw512 )
+CHAIN_REF80( groestl512 )
+CHAIN_REF( skein512 )
+CHAIN_REF80( jh512 )
+CHAIN_REF( keccak512 )
+CHAIN_REF( luffa512 )
+CHAIN_REF80( cubehash512 )
+CHAIN_REF80( shavite512 )
+CHAIN_REF80( simd512 )
+CHAIN_REF80( echo512 )
+CHAIN_REF80( hamsi512 )
+CHAIN_REF80( fugue512 )
+CHAIN_REF80( shabal512 )
+CHAIN_REF80( whirlpool )
+CHAIN_REF80( sha512 )
+CHAIN_REF80( haval256_5 )
+CHAIN_REF80( gost512 )
+
+#define SSE_OPTS  ( SSE2_OPT | AVX_OPT | AVX2_OPT )
+
+#ifdef NO_AES_NI
+  #define AES_OPTS  SSE2_OPT
+#else
+  #define AES_OPTS  ( SSE_OPTS | AES_OPT )
+#endif
+
+// the stages with a 4 lane kernel in their CH_K_ row
+#ifdef HAVE_HASH64_4WAY
+  #define X4_OPTS   ( SSE2_OPT | AVX2_OPT )
+  #define X4_LANES  4
+#else
+  #define X4_OPTS   SSE2_OPT
+  #define X4_LANES  1
+#endif
+
+const struct chain_stage chain_stages[ CH_STAGES ] =
+{
+ [CH_BLAKE]     = { "blake",     ref_blake512,     64, SSE2_OPT, 1 },
+ [CH_BMW]       = { "bmw",       ref_bmw512,       64, SSE2_OPT, 1 },
+ [CH_GROESTL]   = { "groestl",   ref_groestl512,   64, AES_OPTS, 1 },
+ [CH_SKEIN]     = { "skein",     ref_skein512,     64, X4_OPTS, X4_LANES },
+ [CH_JH]        = { "jh",        ref_jh512,        64, SSE2_OPT, 1 },
+ [CH_KECCAK]    = { "keccak",    ref_keccak512,    64, X4_OPTS, X4_LANES },
+ [CH_LUFFA]     = { "luffa",     ref_luffa512,     64, SSE_OPTS, 1 },
+ [CH_CUBEHASH]  = { "cubehash",  ref_cubehash512,  64, SSE_OPTS, 1 },
+ [CH_SHAVITE]   = { "shavite",   ref_shavite512,   64, SSE2_OPT, 1 },
+ [CH_SIMD]      = { "simd",      ref_simd512,      64, SSE_OPTS, 1 },
+ [CH_ECHO]      = { "echo",      ref_echo512,      64, AES_OPTS, 1 },
+ [CH_HAMSI]     = { "hamsi",     ref_hamsi512,     64, SSE2_OPT, 1 },
+ [CH_FUGUE]     = { "fugue",     ref_fugue512,     64, SSE2_OPT, 1 },
+ [CH_SHABAL]    = { "shabal",    ref_shabal512,    64, SSE2_OPT, 1 },
+ [CH_WHIRLPOOL] = { "whirlpool", ref_whirlpool,    64, SSE2_OPT, 1 },
+ [CH_SHA512]    = { "sha512",    ref_sha512,       64, SSE2_OPT, 1 },
+ [CH_HAVAL]     = { "haval",     ref_haval256_5,   32, SSE2_OPT, 1 },
+ [CH_GOST]      = { "gost",      ref_gost512,      64, SSE2_OPT, 1 },
+};
+
+// The reference, one sph hash per stage from the table.
+void chain_hash_ref( const uint8_t *chain, int n, void *output,
+                     const void *input )
+{
+   unsigned char hash[64] __attribute__ ((aligned (64)));
+
+   for ( int i = 0; i < n; i++ )
+   {
+      const struct chain_stage *st = &chain_stages[ chain[i] ];
+      if ( i == 0 )
+         st->ref( hash, input, 80 );
+      else
+         st->ref( hash, hash, 64 );
+      if ( st->out_len < 64 )
+         memset( hash + st->out_len, 0, 64 - st->out_len );
+   }
+   memcpy( output, hash, 32 );
+}
+
+void chain_gate( algo_gate_t *gate, const uint8_t *chain, int n,
+                 void *hash, void *hash_nway, void *hash_ref )
+{
+   gate->optimizations = SSE2_OPT;
+   gate->hash_lanes    = 1;
+   for ( int i = 0; i < n; i++ )
+   {
+      gate->optimizations |= chain_stages[ chain[i] ].opt;
+      // the first stage runs on the headers one at a time
+      if ( i && chain_stages[ chain[i] ].lanes > gate->hash_lanes )
+         gate->hash_lanes = chain_stages[ chain[i] ].lanes;
+   }
+   gate->scanhash   = (void*)&scanhash_nway;
+   gate->hash       = hash;
+   gate->hash_nway  = hash_nway;
+   gate->hash_alt   = hash_ref;
+}
@@ -0,0 +1,290 @@
+// Declarative hash chains.
+//
+// Most of the X family is a fixed sequence of 512 bit hashes, the first
+// on the 80 byte block header and the rest on the previous 64 byte digest.
+// Such an algo is declared by its stage list only:
+//
+//   CHAIN_ALGO( x11, get_max64_0x3ffff, CH_BLAKE, CH_BMW, CH_GROESTL,
+//               CH_SKEIN, CH_JH, CH_KECCAK, CH_LUFFA, CH_CUBEHASH,
+//               CH_SHAVITE, CH_SIMD, CH_ECHO );
+//
+// which expands to:
+//
+//   x11_chain_hash       the fused hash, a straight line of calls to the
+//                        fastest kernel of each stage on one local digest.
+//                        The first stage runs on the header with its nonce
+//                        invariant precompute when it has one, the others
+//                        are the one shot functions of algo/hash64.h.
+//   x11_chain_hash_nway  the same chain on n headers, stage by stage: each
+//                        stage hashes all lanes before the next one starts,
+//                        4 at a time with its 4 lane kernel if it has one.
+//   x11_chain_hash_ref   the sph reference chain, for hash_alt.
+//   register_x11_algo    the gate on the scanhash_nway driver with the
+//                        given get_max64.
+//
+// Algos that need more gate functions use DECLARE_CHAIN and call
+// name_chain_gate from their own register function.
+//
+// Only the reference walks chain_stages[] at run time. The kernels of a
+// stage are picked with the CH_K_ row below when the macro is expanded, a
+// new primitive kernel goes into its row and every chain that uses the
+// stage gets it.
+//
+// A 32 byte stage (haval) is zero padded to 64 bytes for the next stage.
+
+#ifndef CHAIN_H__
+#define CHAIN_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "stage-profile.h"
+#include "algo/hash64.h"
+#include "algo/blake/sph_blake.h"
+#include "algo/bmw/sph_bmw.h"
+#include "algo/keccak/sph_keccak.h"
+#include "algo/skein/sph_skein.h"
+
+// include after algo-gate-api.h
+
+enum chain_stage_id
+{
+   CH_BLAKE = 0,
+   CH_BMW,
+   CH_GROESTL,
+   CH_SKEIN,
+   CH_JH,
+   CH_KECCAK,
+   CH_LUFFA,
+   CH_CUBEHASH,
+   CH_SHAVITE,
+   CH_SIMD,
+   CH_ECHO,
+   CH_HAMSI,
+   CH_FUGUE,
+   CH_SHABAL,
+   CH_WHIRLPOOL,
+   CH_SHA512,
+   CH_HAVAL,
+   CH_GOST,
+   CH_STAGES
+};
+
+// stage profiling has room for 23 stages after the header
+#define CHAIN_MAX_STAGES 23
+
+struct chain_stage
+{
+   const char *name;
+   // sph reference for any length
+   void ( *ref ) ( void*, const void*, size_t );
+   int  out_len;
+   int  opt;      // optimizations the fast kernels use
+   int  lanes;    // 4 with a 4 lane kernel in its CH_K_ row
+};
+
+extern const struct chain_stage chain_stages[ CH_STAGES ];
+
+// First stage on the 80 byte header, for the stages without a nonce
+// invariant precompute the sph hash of the header.
+void groestl512_80  ( void *out, const void *in );
+void jh512_80       ( void *out, const void *in );
+void luffa512_80    ( void *out, const void *in );
+void cubehash512_80 ( void *out, const void *in );
+void shavite512_80  ( void *out, const void *in );
+void simd512_80     ( void *out, const void *in );
+void echo512_80     ( void *out, const void *in );
+void hamsi512_80    ( void *out, const void *in );
+void fugue512_80    ( void *out, const void *in );
+void shabal512_80   ( void *out, const void *in );
+void whirlpool_80   ( void *out, const void *in );
+void sha512_80      ( void *out, const void *in );
+void haval256_5_80  ( void *out, const void *in );
+void gost512_80     ( void *out, const void *in );
+
+// The kernels of each stage: name, 64 byte one shot, 80 byte first stage,
+// digest length and the 4 lane one shot or NULL.
+#ifdef HAVE_HASH64_4WAY
+  #define CH_X4( f ) f
+#else
+  #define CH_X4( f ) NULL
+#endif
+
+#define CH_K_CH_BLAKE     "blake",     blake512_hash64,    sph_blake512_80, \
+                          64, NULL
+#define CH_K_CH_BMW       "bmw",       bmw512_hash64,      sph_bmw512_80, \
+                          64, NULL
+#define CH_K_CH_GROESTL   "groestl",   groestl512_hash64,  groestl512_80, \
+                          64, NULL
+#define CH_K_CH_SKEIN     "skein",     skein512_hash64,    sph_skein512_80, \
+                          64, CH_X4( skein512_4way_hash64 )
+#define CH_K_CH_JH        "jh",        jh512_hash64,       jh512_80, \
+                          64, NULL
+#define CH_K_CH_KECCAK    "keccak",    keccak512_hash64,   sph_keccak512_80, \
+                          64, CH_X4( keccak512_4way_hash64 )
+#define CH_K_CH_LUFFA     "luffa",     luffa512_hash64,    luffa512_80, \
+                          64, NULL
+#define CH_K_CH_CUBEHASH  "cubehash",  cubehash512_hash64, cubehash512_80, \
+                          64, NULL
+#define CH_K_CH_SHAVITE   "shavite",   shavite512_hash64,  shavite512_80, \
+                          64, NULL
+#define CH_K_CH_SIMD      "simd",      simd512_hash64,     simd512_80, \
+                          64, NULL
+#define CH_K_CH_ECHO      "echo",      echo512_hash64,     echo512_80, \
+                          64, NULL
+#define CH_K_CH_HAMSI     "hamsi",     hamsi512_hash64,    hamsi512_80, \
+                          64, NULL
+#define CH_K_CH_FUGUE     "fugue",     fugue512_hash64,    fugue512_80, \
+                          64, NULL
+#define CH_K_CH_SHABAL    "shabal",    shabal512_hash64,   shabal512_80, \
+                          64, NULL
+#define CH_K_CH_WHIRLPOOL "whirlpool", whirlpool_hash64,   whirlpool_80, \
+                          64, NULL
+#define CH_K_CH_SHA512    "sha512",    sha512_hash64,      sha512_80, \
+                          64, NULL
+#define CH_K_CH_HAVAL     "haval",     haval256_5_hash64,  haval256_5_80, \
+                          32, NULL
+#define CH_K_CH_GOST      "gost",      gost512_hash64,     gost512_80, \
+                          64, NULL
+
+// A stage on n lanes in place, 4 at a time when it has a 4 lane kernel.
+static inline void chain_lanes( void ( *h64 ) ( void*, const void* ),
+                                void ( *h4 )  ( void*, const void* ),
+                                unsigned char hash[][64], int n )
+{
+   int l = 0;
+   if ( h4 )
+      for ( ; l + 4 <= n; l += 4 )
+         h4( hash[l], hash[l] );
+   for ( ; l < n; l++ )
+      h64( hash[l], hash[l] );
+}
+
+void chain_hash_ref( const uint8_t *chain, int n, void *output,
+                     const void *input );
+void chain_gate( algo_gate_t *gate, const uint8_t *chain, int n,
+                 void *hash, void *hash_nway, void *hash_ref );
+
+// Stage expansion. CH_EACH( m, i, s1, s2, ... ) expands m( i, s1 )
+// m( i + 1, s2 ) ... for up to 22 stages after the first.
+
+#define CH_CAT_( a, b ) a##b
+#define CH_CAT( a, b )  CH_CAT_( a, b )
+
+#define CH_NARGS( ... ) CH_NARGS_( __VA_ARGS__, 22, 21, 20, 19, 18, 17, 16, \
+                   15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 )
+#define CH_NARGS_( a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, \
+                   a14, a15, a16, a17, a18, a19, a20, a21, a22, n, ... ) n
+
+#define CH_EACH( m, i, ... ) \
+   CH_CAT( CH_EACH_, CH_NARGS( __VA_ARGS__ ) )( m, i, __VA_ARGS__ )
+
+#define CH_EACH_1( m, i, s )      m( i, s )
+#define CH_EACH_2( m, i, s, ... ) m( i, s ) CH_EACH_1( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_3( m, i, s, ... ) m( i, s ) CH_EACH_2( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_4( m, i, s, ... ) m( i, s ) CH_EACH_3( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_5( m, i, s, ... ) m( i, s ) CH_EACH_4( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_6( m, i, s, ... ) m( i, s ) CH_EACH_5( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_7( m, i, s, ... ) m( i, s ) CH_EACH_6( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_8( m, i, s, ... ) m( i, s ) CH_EACH_7( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_9( m, i, s, ... ) m( i, s ) CH_EACH_8( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_10( m, i, s, ... ) m( i, s ) CH_EACH_9( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_11( m, i, s, ... ) m( i, s ) CH_EACH_10( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_12( m, i, s, ... ) m( i, s ) CH_EACH_11( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_13( m, i, s, ... ) m( i, s ) CH_EACH_12( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_14( m, i, s, ... ) m( i, s ) CH_EACH_13( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_15( m, i, s, ... ) m( i, s ) CH_EACH_14( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_16( m, i, s, ... ) m( i, s ) CH_EACH_15( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_17( m, i, s, ... ) m( i, s ) CH_EACH_16( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_18( m, i, s, ... ) m( i, s ) CH_EACH_17( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_19( m, i, s, ... ) m( i, s ) CH_EACH_18( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_20( m, i, s, ... ) m( i, s ) CH_EACH_19( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_21( m, i, s, ... ) m( i, s ) CH_EACH_20( m, i + 1, __VA_ARGS__ )
+#define CH_EACH_22( m, i, s, ... ) m( i, s ) CH_EACH_21( m, i + 1, __VA_ARGS__ )
+
+// One stage of the fused hash on the local digest "hash".
+
+#define CH_PAD( h, len ) \
+   if ( (len) < 64 ) memset( (h) + (len), 0, 64 - (len) )
+
+#define CH_FIRST( s )   CH_FIRST_( CH_K_##s )
+#define CH_FIRST_( k )  CH_FIRST__( k )
+#define CH_FIRST__( name, h64, h80, len, h4 ) \
+   h80( hash, input ); \
+   CH_PAD( hash, len ); \
+   PROF_STAGE( 1, name );
+
+#define CH_NEXT( i, s )  CH_NEXT_( i, CH_K_##s )
+#define CH_NEXT_( i, k ) CH_NEXT__( i, k )
+#define CH_NEXT__( i, name, h64, h80, len, h4 ) \
+   h64( hash, hash ); \
+   CH_PAD( hash, len ); \
+   PROF_STAGE( i, name );
+
+// One stage of the lane batch on "hash[lane]" for n lanes.
+
+#define CH_FIRST_LANES( s )   CH_FIRST_LANES_( CH_K_##s )
+#define CH_FIRST_LANES_( k )  CH_FIRST_LANES__( k )
+#define CH_FIRST_LANES__( name, h64, h80, len, h4 ) \
+   for ( int l = 0; l < n; l++ ) \
+   { \
+      h80( hash[l], (const uint8_t*)input + l * 80 ); \
+      CH_PAD( hash[l], len ); \
+   } \
+   PROF_STAGE( 1, name );
+
+#define CH_NEXT_LANES( i, s )  CH_NEXT_LANES_( i, CH_K_##s )
+#define CH_NEXT_LANES_( i, k ) CH_NEXT_LANES__( i, k )
+#define CH_NEXT_LANES__( i, name, h64, h80, len, h4 ) \
+   chain_lanes( h64, h4, hash, n ); \
+   if ( (len) < 64 ) \
+      for ( int l = 0; l < n; l++ ) \
+         memset( hash[l] + (len), 0, 64 - (len) ); \
+   PROF_STAGE( i, name );
+
+#define DECLARE_CHAIN( name, first, ... ) \
+static const uint8_t name##_chain[] = { first, __VA_ARGS__ }; \
+_Static_assert( sizeof( name##_chain ) <= CHAIN_MAX_STAGES, \
+                #name " chain too long" ); \
+static void name##_chain_hash( void *output, const void *input ) \
+{ \
+   unsigned char hash[64] __attribute__ ((aligned (64))); \
+   PROF_BEGIN; \
+   CH_FIRST( first ) \
+   CH_EACH( CH_NEXT, 2, __VA_ARGS__ ) \
+   PROF_END; \
+   memcpy( output, hash, 32 ); \
+} \
+static void name##_chain_hash_nway( void *output, const void *input, \
+                                    int n ) \
+{ \
+   unsigned char hash[MAX_HASH_LANES][64] __attribute__ ((aligned (64))); \
+   PROF_BEGIN; \
+   CH_FIRST_LANES( first ) \
+   CH_EACH( CH_NEXT_LANES, 2, __VA_ARGS__ ) \
+   PROF_END_N( n ); \
+   for ( int l = 0; l < n; l++ ) \
+      memcpy( (uint8_t*)output + l * 32, hash[l], 32 ); \
+} \
+static void name##_chain_hash_ref( void *output, const void *input ) \
+{ \
+   chain_hash_ref( name##_chain, sizeof name##_chain, output, input ); \
+} \
+static void name##_chain_gate( algo_gate_t *gate ) \
+{ \
+   chain_gate( gate, name##_chain, sizeof name##_chain, \
+               (void*)&name##_chain_hash, (void*)&name##_chain_hash_nway, \
+               (void*)&name##_chain_hash_ref ); \
+}
+
+#define CHAIN_ALGO( name, max64, ... ) \
+DECLARE_CHAIN( name, __VA_ARGS__ ) \
+bool register_##name##_algo( algo_gate_t *gate ) \
+{ \
+   name##_chain_gate( gate ); \
+   gate->get_max64 = (void*)&max64; \
+   return true; \
+}
+
+#endif
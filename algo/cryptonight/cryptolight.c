@@ -19,6 +19,7 @@
 #include "crypto/c_skein.h"
 #include "crypto/int-util.h"
 #include "crypto/hash-ops.h"
+#include "cryptonight-vperm.h"
 
 #if USE_INT128
 
@@ -173,10 +174,19 @@ static void cryptolight_hash_ctx(void* output, const void* input, int len, struc
 	hash_process(&ctx->state.hs, (const uint8_t*) input, len);
 	ctx->aes_ctx = (oaes_ctx*) oaes_alloc();
 	size_t i, j;
+#ifdef CN_VPERM
+	__m128i bkey[10];
+#endif
 	memcpy(ctx->text, ctx->state.init, INIT_SIZE_BYTE);
 
 	oaes_key_import_data(ctx->aes_ctx, ctx->state.hs.b, AES_KEY_SIZE);
+#ifdef CN_VPERM
+	cn_vperm_keys(bkey, ctx->aes_ctx->key->exp_data);
+#endif
 	for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE) {
+#ifdef CN_VPERM
+		cn_vperm_pseudo_round_8(ctx->text, bkey);
+#else
 		aesb_pseudo_round_mut(&ctx->text[AES_BLOCK_SIZE * 0], ctx->aes_ctx->key->exp_data);
 		aesb_pseudo_round_mut(&ctx->text[AES_BLOCK_SIZE * 1], ctx->aes_ctx->key->exp_data);
 		aesb_pseudo_round_mut(&ctx->text[AES_BLOCK_SIZE * 2], ctx->aes_ctx->key->exp_data);
@@ -185,6 +195,7 @@ static void cryptolight_hash_ctx(void* output, const void* input, int len, struc
 		aesb_pseudo_round_mut(&ctx->text[AES_BLOCK_SIZE * 5], ctx->aes_ctx->key->exp_data);
 		aesb_pseudo_round_mut(&ctx->text[AES_BLOCK_SIZE * 6], ctx->aes_ctx->key->exp_data);
 		aesb_pseudo_round_mut(&ctx->text[AES_BLOCK_SIZE * 7], ctx->aes_ctx->key->exp_data);
+#endif
 		memcpy(&ctx->long_state[i], ctx->text, INIT_SIZE_BYTE);
 	}
 
@@ -212,7 +223,15 @@ static void cryptolight_hash_ctx(void* output, const void* input, int len, struc
 
 	memcpy(ctx->text, ctx->state.init, INIT_SIZE_BYTE);
 	oaes_key_import_data(ctx->aes_ctx, &ctx->state.hs.b[32], AES_KEY_SIZE);
+#ifdef CN_VPERM
+	cn_vperm_keys(bkey, ctx->aes_ctx->key->exp_data);
+#endif
 	for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE) {
+#ifdef CN_VPERM
+		for (j = 0; j < INIT_SIZE_BLK; j++)
+			xor_blocks(&ctx->text[j * AES_BLOCK_SIZE], &ctx->long_state[i + j * AES_BLOCK_SIZE]);
+		cn_vperm_pseudo_round_8(ctx->text, bkey);
+#else
 		xor_blocks(&ctx->text[0 * AES_BLOCK_SIZE], &ctx->long_state[i + 0 * AES_BLOCK_SIZE]);
 		aesb_pseudo_round_mut(&ctx->text[0 * AES_BLOCK_SIZE], ctx->aes_ctx->key->exp_data);
 		xor_blocks(&ctx->text[1 * AES_BLOCK_SIZE], &ctx->long_state[i + 1 * AES_BLOCK_SIZE]);
@@ -229,6 +248,7 @@ static void cryptolight_hash_ctx(void* output, const void* input, int len, struc
 		aesb_pseudo_round_mut(&ctx->text[6 * AES_BLOCK_SIZE], ctx->aes_ctx->key->exp_data);
 		xor_blocks(&ctx->text[7 * AES_BLOCK_SIZE], &ctx->long_state[i + 7 * AES_BLOCK_SIZE]);
 		aesb_pseudo_round_mut(&ctx->text[7 * AES_BLOCK_SIZE], ctx->aes_ctx->key->exp_data);
+#endif
 	}
 	memcpy(ctx->state.init, ctx->text, INIT_SIZE_BYTE);
 	hash_permutation(&ctx->state.hs);
@@ -352,6 +372,12 @@ int scanhash_cryptolight(int thr_id, struct work *work,
 	return 0;
 }
 
+void cryptolight_scratch_size( uint64_t *per_thread, uint64_t *shared )
+{
+  *per_thread = sizeof( struct cryptonight_ctx );
+  *shared = 0;
+}
+
 bool register_cryptolight_algo( algo_gate_t* gate )
 {
   register_json_rpc2( gate );
@@ -360,6 +386,7 @@ bool register_cryptolight_algo( algo_gate_t* gate )
   gate->hash      = (void*)&cryptolight_hash;
   gate->hash_suw  = (void*)&cryptolight_hash; 
   gate->get_max64 = (void*)&get_max64_0x40LL;
+  gate->scratch_size = (void*)&cryptolight_scratch_size;
   return true;
 };
 
@@ -96,14 +96,22 @@ int scanhash_cryptonight( int thr_id, struct work *work, uint32_t max_nonce,
     return 0;
 }
 
+void cryptonight_scratch_size( uint64_t *per_thread, uint64_t *shared )
+{
+  *per_thread = MEMORY;
+  *shared = 0;
+}
+
 bool register_cryptonight_algo( algo_gate_t* gate )
 {
   register_json_rpc2( gate );
   gate->optimizations = SSE2_OPT | AES_OPT;
   gate->scanhash         = (void*)&scanhash_cryptonight;
   gate->hash             = (void*)&cryptonight_hash;
+  gate->hash_alt         = (void*)&cryptonight_hash_ctx;
   gate->hash_suw         = (void*)&cryptonight_hash_suw;  
   gate->get_max64        = (void*)&get_max64_0x40LL;
+  gate->scratch_size     = (void*)&cryptonight_scratch_size;
   return true;
 };
 
@@ -0,0 +1,65 @@
+#ifndef __CRYPTONIGHT_VPERM_H_INCLUDED
+#define __CRYPTONIGHT_VPERM_H_INCLUDED
+
+// The scratchpad fill and the final fold of cryptonight and cryptolight
+// without AES-NI. Each 128 byte step runs aesb_pseudo_round_mut, 10 AES
+// rounds and no final round, on the 8 blocks of the text. With vperm AES
+// the 8 blocks run the rounds in the vperm basis, the transforms are paid
+// once per block and step. The main loop keeps aesb_single_round, one
+// dependent round per step is faster with the T-tables.
+
+#ifdef __SSSE3__
+
+#include <stdint.h>
+#include "algo/aes-vperm.h"
+
+#define CN_VPERM 1
+
+// The first 10 round keys of the oaes expanded key, in the vperm basis.
+static inline void cn_vperm_keys( __m128i *bkey, const uint8_t *exp_data )
+{
+   for ( int j = 0; j < 10; j++ )
+      bkey[j] = vperm_basis_in(
+                      _mm_loadu_si128( (const __m128i*)exp_data + j ) );
+}
+
+// aesb_pseudo_round_mut on the 8 blocks of text, text must be 16 byte
+// aligned.
+static inline void cn_vperm_pseudo_round_8( uint8_t *text,
+                                            const __m128i *bkey )
+{
+   __m128i *t = (__m128i*)text;
+   __m128i x0 = vperm_basis_in( t[0] );
+   __m128i x1 = vperm_basis_in( t[1] );
+   __m128i x2 = vperm_basis_in( t[2] );
+   __m128i x3 = vperm_basis_in( t[3] );
+   __m128i x4 = vperm_basis_in( t[4] );
+   __m128i x5 = vperm_basis_in( t[5] );
+   __m128i x6 = vperm_basis_in( t[6] );
+   __m128i x7 = vperm_basis_in( t[7] );
+
+   for ( int j = 0; j < 10; j++ )
+   {
+      x0 = vperm_aesenc_basis( x0, bkey[j] );
+      x1 = vperm_aesenc_basis( x1, bkey[j] );
+      x2 = vperm_aesenc_basis( x2, bkey[j] );
+      x3 = vperm_aesenc_basis( x3, bkey[j] );
+      x4 = vperm_aesenc_basis( x4, bkey[j] );
+      x5 = vperm_aesenc_basis( x5, bkey[j] );
+      x6 = vperm_aesenc_basis( x6, bkey[j] );
+      x7 = vperm_aesenc_basis( x7, bkey[j] );
+   }
+
+   t[0] = vperm_basis_out( x0 );
+   t[1] = vperm_basis_out( x1 );
+   t[2] = vperm_basis_out( x2 );
+   t[3] = vperm_basis_out( x3 );
+   t[4] = vperm_basis_out( x4 );
+   t[5] = vperm_basis_out( x5 );
+   t[6] = vperm_basis_out( x6 );
+   t[7] = vperm_basis_out( x7 );
+}
+
+#endif
+
+#endif
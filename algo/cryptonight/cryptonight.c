@@ -21,6 +21,7 @@
 #include "crypto/c_skein.h"
 #include "crypto/int-util.h"
 #include "crypto/hash-ops.h"
+#include "cryptonight-vperm.h"
 //#include "cryptonight.h"
 
 #if USE_INT128
@@ -189,14 +190,23 @@ void cryptonight_hash_ctx(void* output, const void* input, int len)
     __builtin_prefetch( ctx.long_state + 448, 1, 0 );
 
 	size_t i, j;
+#ifdef CN_VPERM
+	__m128i bkey[10];
+#endif
 	memcpy(ctx.text, ctx.state.init, INIT_SIZE_BYTE);
 
 	oaes_key_import_data(ctx.aes_ctx, ctx.state.hs.b, AES_KEY_SIZE);
+#ifdef CN_VPERM
+	cn_vperm_keys(bkey, ctx.aes_ctx->key->exp_data);
+#endif
 	for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE) {
 
     __builtin_prefetch( ctx.long_state + i + 512, 1, 0 );
     __builtin_prefetch( ctx.long_state + i + 576, 1, 0 );
 
+#ifdef CN_VPERM
+		cn_vperm_pseudo_round_8(ctx.text, bkey);
+#else
 		aesb_pseudo_round_mut(&ctx.text[AES_BLOCK_SIZE * 0], ctx.aes_ctx->key->exp_data);
 		aesb_pseudo_round_mut(&ctx.text[AES_BLOCK_SIZE * 1], ctx.aes_ctx->key->exp_data);
 		aesb_pseudo_round_mut(&ctx.text[AES_BLOCK_SIZE * 2], ctx.aes_ctx->key->exp_data);
@@ -205,6 +215,7 @@ void cryptonight_hash_ctx(void* output, const void* input, int len)
 		aesb_pseudo_round_mut(&ctx.text[AES_BLOCK_SIZE * 5], ctx.aes_ctx->key->exp_data);
 		aesb_pseudo_round_mut(&ctx.text[AES_BLOCK_SIZE * 6], ctx.aes_ctx->key->exp_data);
 		aesb_pseudo_round_mut(&ctx.text[AES_BLOCK_SIZE * 7], ctx.aes_ctx->key->exp_data);
+#endif
 		memcpy(&ctx.long_state[i], ctx.text, INIT_SIZE_BYTE);
 	}
 
@@ -243,11 +254,19 @@ void cryptonight_hash_ctx(void* output, const void* input, int len)
 
 	memcpy(ctx.text, ctx.state.init, INIT_SIZE_BYTE);
 	oaes_key_import_data(ctx.aes_ctx, &ctx.state.hs.b[32], AES_KEY_SIZE);
+#ifdef CN_VPERM
+	cn_vperm_keys(bkey, ctx.aes_ctx->key->exp_data);
+#endif
 	for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE) {
 
     __builtin_prefetch( ctx.long_state + i + 512, 1, 0 );
     __builtin_prefetch( ctx.long_state + i + 576, 1, 0 );
 
+#ifdef CN_VPERM
+		for (j = 0; j < INIT_SIZE_BLK; j++)
+			xor_blocks(&ctx.text[j * AES_BLOCK_SIZE], &ctx.long_state[i + j * AES_BLOCK_SIZE]);
+		cn_vperm_pseudo_round_8(ctx.text, bkey);
+#else
 		xor_blocks(&ctx.text[0 * AES_BLOCK_SIZE], &ctx.long_state[i + 0 * AES_BLOCK_SIZE]);
 		aesb_pseudo_round_mut(&ctx.text[0 * AES_BLOCK_SIZE], ctx.aes_ctx->key->exp_data);
 		xor_blocks(&ctx.text[1 * AES_BLOCK_SIZE], &ctx.long_state[i + 1 * AES_BLOCK_SIZE]);
@@ -264,6 +283,7 @@ void cryptonight_hash_ctx(void* output, const void* input, int len)
 		aesb_pseudo_round_mut(&ctx.text[6 * AES_BLOCK_SIZE], ctx.aes_ctx->key->exp_data);
 		xor_blocks(&ctx.text[7 * AES_BLOCK_SIZE], &ctx.long_state[i + 7 * AES_BLOCK_SIZE]);
 		aesb_pseudo_round_mut(&ctx.text[7 * AES_BLOCK_SIZE], ctx.aes_ctx->key->exp_data);
+#endif
 	}
 	memcpy(ctx.state.init, ctx.text, INIT_SIZE_BYTE);
 	hash_permutation(&ctx.state.hs);
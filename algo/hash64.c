@@ -0,0 +1,468 @@
+#include "cpuminer-config.h"
+#include "miner.h"
+#include "algo/hash64.h"
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#ifdef HAVE_HASH64_4WAY
+#include <immintrin.h>
+#endif
+
+#include "algo/bmw/sph_bmw.h"
+#include "algo/shavite/sph_shavite.h"
+#include "algo/hamsi/sph_hamsi.h"
+#include "algo/fugue/sph_fugue.h"
+#include "algo/shabal/sph_shabal.h"
+#include "algo/whirlpool/sph_whirlpool.h"
+#include "algo/sha3/sph_sha2.h"
+#include "algo/haval/sph-haval.h"
+#include "algo/gost/sph_gost.h"
+
+#ifdef NO_AES_NI
+  #include "algo/groestl/sse2/grso.h"
+  #include "algo/groestl/sse2/grso-macro.c"
+#else
+  #include "algo/groestl/aes_ni/hash-groestl.h"
+#endif
+// AES-NI or vperm
+#include "algo/echo/aes_ni/hash_api.h"
+
+#include "algo/luffa/sse2/luffa_for_sse2.h"
+#include "algo/cubehash/sse2/cubehash_sse2.h"
+#include "algo/simd/sse2/nist.h"
+#include "algo/blake/sse2/blake.c"
+#include "algo/keccak/sse2/keccak.c"
+#include "algo/skein/sse2/skein.c"
+#include "algo/jh/sse2/jh_sse2_opt64.h"
+
+// The sse2 macro implementations hash in place in a local "hash" buffer,
+// 128 bytes because keccak pads past the first 64. blake, skein and the
+// sse2 groestl also buffer the input and count its bits.
+
+#define HASH64_LOCALS \
+   unsigned char hash[128] __attribute__ ((aligned (32)))
+
+#define HASH64_BUF_LOCALS \
+   unsigned char hashbuf[128] __attribute__ ((aligned (16))); \
+   size_t hashptr; \
+   sph_u64 hashctA
+
+void blake512_hash64( void *out, const void *in )
+{
+   HASH64_LOCALS;
+   HASH64_BUF_LOCALS;
+   sph_u64 hashctB;
+   memcpy( hash, in, 64 );
+   DECL_BLK;
+   BLK_I;
+   BLK_U;
+   BLK_C;
+   memcpy( out, hash, 64 );
+}
+
+// The sph compress is faster than the sse2 macro version here.
+void bmw512_hash64( void *out, const void *in )
+{
+   sph_bmw512_context ctx;
+   sph_bmw512_init( &ctx );
+   sph_bmw512( &ctx, in, 64 );
+   sph_bmw512_close( &ctx, out );
+}
+
+void groestl512_hash64( void *out, const void *in )
+{
+#ifdef NO_AES_NI
+   HASH64_LOCALS;
+   HASH64_BUF_LOCALS;
+   grsoState sts_grs;
+   memcpy( hash, in, 64 );
+   GRS_I;
+   GRS_U;
+   GRS_C;
+   memcpy( out, hash, 64 );
+#else
+   hashState_groestl ctx;
+   init_groestl( &ctx, 64 );
+   update_and_final_groestl( &ctx, (char*)out, (const char*)in, 512 );
+#endif
+}
+
+void skein512_hash64( void *out, const void *in )
+{
+   HASH64_LOCALS;
+   HASH64_BUF_LOCALS;
+   memcpy( hash, in, 64 );
+   DECL_SKN;
+   SKN_I;
+   SKN_U;
+   SKN_C;
+   memcpy( out, hash, 64 );
+}
+
+void jh512_hash64( void *out, const void *in )
+{
+   HASH64_LOCALS;
+   memcpy( hash, in, 64 );
+   DECL_JH;
+   JH_H;
+   memcpy( out, hash, 64 );
+}
+
+void keccak512_hash64( void *out, const void *in )
+{
+   HASH64_LOCALS;
+   memcpy( hash, in, 64 );
+   DECL_KEC;
+   KEC_I;
+   KEC_U;
+   KEC_C;
+   memcpy( out, hash, 64 );
+}
+
+void luffa512_hash64( void *out, const void *in )
+{
+   hashState_luffa ctx;
+   init_luffa( &ctx, 512 );
+   update_and_final_luffa( &ctx, (BitSequence*)out,
+                           (const BitSequence*)in, 64 );
+}
+
+// cubehashInit runs 10 rounds of the transform to derive the IV, start
+// from the result instead. Same as IV512 in sph_cubehash.c.
+static const uint32_t cube512_iv[32] __attribute__ ((aligned (32))) =
+{
+   0x2AEA2A61, 0x50F494D4, 0x2D538B8B, 0x4167D83E,
+   0x3FEE2313, 0xC701CF8C, 0xCC39968E, 0x50AC5695,
+   0x4D42C787, 0xA647A8B3, 0x97CF0BEF, 0x825B4537,
+   0xEEF864D2, 0xF22090C4, 0xD0E5CD33, 0xA23911AE,
+   0xFCD398D9, 0x148FE485, 0x1B017BEF, 0xB6444532,
+   0x6A536159, 0x2FF5781C, 0x91FA7934, 0x0DBADEA9,
+   0xD65C8A2B, 0xA5A70E75, 0xB1C62456, 0xBC796576,
+   0x1921C8F7, 0xE7989AF1, 0x7795D246, 0xD43E3B44
+};
+
+void cubehash512_hash64( void *out, const void *in )
+{
+   cubehashParam ctx;
+   ctx.hashbitlen = 512;
+   ctx.rounds     = 16;
+   ctx.blockbytes = 32;
+   ctx.pos        = 0;
+   memcpy( ctx.x, cube512_iv, sizeof cube512_iv );
+   cubehashUpdateDigest( &ctx, (byte*)out, (const byte*)in, 64 );
+}
+
+void shavite512_hash64( void *out, const void *in )
+{
+   sph_shavite512_context ctx;
+   sph_shavite512_init( &ctx );
+   sph_shavite512( &ctx, in, 64 );
+   sph_shavite512_close( &ctx, out );
+}
+
+void simd512_hash64( void *out, const void *in )
+{
+   hashState_sd ctx;
+   init_sd( &ctx, 512 );
+   update_final_sd( &ctx, (BitSequence*)out, (const BitSequence*)in, 512 );
+}
+
+void echo512_hash64( void *out, const void *in )
+{
+   hashState_echo ctx;
+   init_echo( &ctx, 512 );
+   update_final_echo( &ctx, (BitSequence*)out, (const BitSequence*)in, 512 );
+}
+
+void hamsi512_hash64( void *out, const void *in )
+{
+   sph_hamsi512_context ctx;
+   sph_hamsi512_init( &ctx );
+   sph_hamsi512( &ctx, in, 64 );
+   sph_hamsi512_close( &ctx, out );
+}
+
+void fugue512_hash64( void *out, const void *in )
+{
+   sph_fugue512_context ctx;
+   sph_fugue512_init( &ctx );
+   sph_fugue512( &ctx, in, 64 );
+   sph_fugue512_close( &ctx, out );
+}
+
+void shabal512_hash64( void *out, const void *in )
+{
+   sph_shabal512_context ctx;
+   sph_shabal512_init( &ctx );
+   sph_shabal512( &ctx, in, 64 );
+   sph_shabal512_close( &ctx, out );
+}
+
+void whirlpool_hash64( void *out, const void *in )
+{
+   sph_whirlpool_context ctx;
+   sph_whirlpool_init( &ctx );
+   sph_whirlpool( &ctx, in, 64 );
+   sph_whirlpool_close( &ctx, out );
+}
+
+void sha512_hash64( void *out, const void *in )
+{
+   sph_sha512_context ctx;
+   sph_sha512_init( &ctx );
+   sph_sha512( &ctx, in, 64 );
+   sph_sha512_close( &ctx, out );
+}
+
+void haval256_5_hash64( void *out, const void *in )
+{
+   sph_haval256_5_context ctx;
+   sph_haval256_5_init( &ctx );
+   sph_haval256_5( &ctx, in, 64 );
+   sph_haval256_5_close( &ctx, out );
+}
+
+void gost512_hash64( void *out, const void *in )
+{
+   sph_gost512_context ctx;
+   sph_gost512_init( &ctx );
+   sph_gost512( &ctx, in, 64 );
+   sph_gost512_close( &ctx, out );
+}
+
+#ifdef HAVE_HASH64_4WAY
+
+// Four lanes in the 64 bit elements of AVX2 vectors, word i of lane j is
+// element j of v[i]. The digests are transposed in and out, a stage costs
+// about as much as one lane of the scalar code for all four.
+
+#ifdef __AVX512VL__
+  #define rol4x64( x, c )  _mm256_rolv_epi64( x, _mm256_set1_epi64x( c ) )
+#else
+  #define rol4x64( x, c ) \
+     _mm256_or_si256( _mm256_slli_epi64( x, c ), \
+                      _mm256_srli_epi64( x, 64 - (c) ) )
+#endif
+
+static inline void load4x64( __m256i *v, const uint64_t *in )
+{
+   for ( int i = 0; i < 8; i++ )
+      v[i] = _mm256_set_epi64x( in[24 + i], in[16 + i], in[8 + i], in[i] );
+}
+
+static inline void store4x64( uint64_t *out, const __m256i *v )
+{
+   uint64_t _ALIGN(32) t[4];
+   for ( int i = 0; i < 8; i++ )
+   {
+      _mm256_store_si256( (__m256i*)t, v[i] );
+      out[i]      = t[0];
+      out[8 + i]  = t[1];
+      out[16 + i] = t[2];
+      out[24 + i] = t[3];
+   }
+}
+
+static const uint64_t keccak_rc[24] =
+{
+   0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808AULL,
+   0x8000000080008000ULL, 0x000000000000808BULL, 0x0000000080000001ULL,
+   0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008AULL,
+   0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000AULL,
+   0x000000008000808BULL, 0x800000000000008BULL, 0x8000000000008089ULL,
+   0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+   0x000000000000800AULL, 0x800000008000000AULL, 0x8000000080008081ULL,
+   0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+// One round from state a to state t, theta, rho and pi into b, chi and iota.
+#define KECCAK4_ROUND( a, t, rc ) \
+do { \
+   c0 = XOR5( a[0], a[5], a[10], a[15], a[20] ); \
+   c1 = XOR5( a[1], a[6], a[11], a[16], a[21] ); \
+   c2 = XOR5( a[2], a[7], a[12], a[17], a[22] ); \
+   c3 = XOR5( a[3], a[8], a[13], a[18], a[23] ); \
+   c4 = XOR5( a[4], a[9], a[14], a[19], a[24] ); \
+   d0 = _mm256_xor_si256( c4, rol4x64( c1, 1 ) ); \
+   d1 = _mm256_xor_si256( c0, rol4x64( c2, 1 ) ); \
+   d2 = _mm256_xor_si256( c1, rol4x64( c3, 1 ) ); \
+   d3 = _mm256_xor_si256( c2, rol4x64( c4, 1 ) ); \
+   d4 = _mm256_xor_si256( c3, rol4x64( c0, 1 ) ); \
+   b0 = _mm256_xor_si256( a[0], d0 ); \
+   b1 = rol4x64( _mm256_xor_si256( a[6], d1 ), 44 ); \
+   b2 = rol4x64( _mm256_xor_si256( a[12], d2 ), 43 ); \
+   b3 = rol4x64( _mm256_xor_si256( a[18], d3 ), 21 ); \
+   b4 = rol4x64( _mm256_xor_si256( a[24], d4 ), 14 ); \
+   t[0] = _mm256_xor_si256( b0, _mm256_andnot_si256( b1, b2 ) ); \
+   t[1] = _mm256_xor_si256( b1, _mm256_andnot_si256( b2, b3 ) ); \
+   t[2] = _mm256_xor_si256( b2, _mm256_andnot_si256( b3, b4 ) ); \
+   t[3] = _mm256_xor_si256( b3, _mm256_andnot_si256( b4, b0 ) ); \
+   t[4] = _mm256_xor_si256( b4, _mm256_andnot_si256( b0, b1 ) ); \
+   b0 = rol4x64( _mm256_xor_si256( a[3], d3 ), 28 ); \
+   b1 = rol4x64( _mm256_xor_si256( a[9], d4 ), 20 ); \
+   b2 = rol4x64( _mm256_xor_si256( a[10], d0 ), 3 ); \
+   b3 = rol4x64( _mm256_xor_si256( a[16], d1 ), 45 ); \
+   b4 = rol4x64( _mm256_xor_si256( a[22], d2 ), 61 ); \
+   t[5] = _mm256_xor_si256( b0, _mm256_andnot_si256( b1, b2 ) ); \
+   t[6] = _mm256_xor_si256( b1, _mm256_andnot_si256( b2, b3 ) ); \
+   t[7] = _mm256_xor_si256( b2, _mm256_andnot_si256( b3, b4 ) ); \
+   t[8] = _mm256_xor_si256( b3, _mm256_andnot_si256( b4, b0 ) ); \
+   t[9] = _mm256_xor_si256( b4, _mm256_andnot_si256( b0, b1 ) ); \
+   b0 = rol4x64( _mm256_xor_si256( a[1], d1 ), 1 ); \
+   b1 = rol4x64( _mm256_xor_si256( a[7], d2 ), 6 ); \
+   b2 = rol4x64( _mm256_xor_si256( a[13], d3 ), 25 ); \
+   b3 = rol4x64( _mm256_xor_si256( a[19], d4 ), 8 ); \
+   b4 = rol4x64( _mm256_xor_si256( a[20], d0 ), 18 ); \
+   t[10] = _mm256_xor_si256( b0, _mm256_andnot_si256( b1, b2 ) ); \
+   t[11] = _mm256_xor_si256( b1, _mm256_andnot_si256( b2, b3 ) ); \
+   t[12] = _mm256_xor_si256( b2, _mm256_andnot_si256( b3, b4 ) ); \
+   t[13] = _mm256_xor_si256( b3, _mm256_andnot_si256( b4, b0 ) ); \
+   t[14] = _mm256_xor_si256( b4, _mm256_andnot_si256( b0, b1 ) ); \
+   b0 = rol4x64( _mm256_xor_si256( a[4], d4 ), 27 ); \
+   b1 = rol4x64( _mm256_xor_si256( a[5], d0 ), 36 ); \
+   b2 = rol4x64( _mm256_xor_si256( a[11], d1 ), 10 ); \
+   b3 = rol4x64( _mm256_xor_si256( a[17], d2 ), 15 ); \
+   b4 = rol4x64( _mm256_xor_si256( a[23], d3 ), 56 ); \
+   t[15] = _mm256_xor_si256( b0, _mm256_andnot_si256( b1, b2 ) ); \
+   t[16] = _mm256_xor_si256( b1, _mm256_andnot_si256( b2, b3 ) ); \
+   t[17] = _mm256_xor_si256( b2, _mm256_andnot_si256( b3, b4 ) ); \
+   t[18] = _mm256_xor_si256( b3, _mm256_andnot_si256( b4, b0 ) ); \
+   t[19] = _mm256_xor_si256( b4, _mm256_andnot_si256( b0, b1 ) ); \
+   b0 = rol4x64( _mm256_xor_si256( a[2], d2 ), 62 ); \
+   b1 = rol4x64( _mm256_xor_si256( a[8], d3 ), 55 ); \
+   b2 = rol4x64( _mm256_xor_si256( a[14], d4 ), 39 ); \
+   b3 = rol4x64( _mm256_xor_si256( a[15], d0 ), 41 ); \
+   b4 = rol4x64( _mm256_xor_si256( a[21], d1 ), 2 ); \
+   t[20] = _mm256_xor_si256( b0, _mm256_andnot_si256( b1, b2 ) ); \
+   t[21] = _mm256_xor_si256( b1, _mm256_andnot_si256( b2, b3 ) ); \
+   t[22] = _mm256_xor_si256( b2, _mm256_andnot_si256( b3, b4 ) ); \
+   t[23] = _mm256_xor_si256( b3, _mm256_andnot_si256( b4, b0 ) ); \
+   t[24] = _mm256_xor_si256( b4, _mm256_andnot_si256( b0, b1 ) ); \
+   t[0] = _mm256_xor_si256( t[0], _mm256_set1_epi64x( rc ) ); \
+} while (0)
+
+#define XOR5( a, b, c, d, e ) \
+   _mm256_xor_si256( _mm256_xor_si256( _mm256_xor_si256( a, b ), \
+                                       _mm256_xor_si256( c, d ) ), e )
+
+// One block: the 64 byte message and the keccak padding of the 72 byte
+// rate, 0x01 after the message and 0x80 in the last byte.
+void keccak512_4way_hash64( void *out, const void *in )
+{
+   __m256i a[25], t[25];
+   __m256i b0, b1, b2, b3, b4, c0, c1, c2, c3, c4, d0, d1, d2, d3, d4;
+
+   load4x64( a, (const uint64_t*)in );
+   a[8] = _mm256_set1_epi64x( 0x8000000000000001ULL );
+   for ( int i = 9; i < 25; i++ )
+      a[i] = _mm256_setzero_si256();
+
+   for ( int r = 0; r < 24; r += 2 )
+   {
+      KECCAK4_ROUND( a, t, keccak_rc[r] );
+      KECCAK4_ROUND( t, a, keccak_rc[r + 1] );
+   }
+
+   store4x64( (uint64_t*)out, a );
+}
+
+static const uint64_t skein512_iv[8] =
+{
+   0x4903ADFF749C51CEULL, 0x0D95DE399746DF03ULL,
+   0x8FD1934127C79BCEULL, 0x9A255629FF352CB1ULL,
+   0x5DB62599DF6CA7B0ULL, 0xEABE394CA9D5C3F4ULL,
+   0x991112C71A75B523ULL, 0xAE18A40B660FCC33ULL
+};
+
+#define SKEIN4_MIX( p0, p1, p2, p3, p4, p5, p6, p7, r0, r1, r2, r3 ) \
+do { \
+   x[p0] = _mm256_add_epi64( x[p0], x[p1] ); \
+   x[p1] = _mm256_xor_si256( rol4x64( x[p1], r0 ), x[p0] ); \
+   x[p2] = _mm256_add_epi64( x[p2], x[p3] ); \
+   x[p3] = _mm256_xor_si256( rol4x64( x[p3], r1 ), x[p2] ); \
+   x[p4] = _mm256_add_epi64( x[p4], x[p5] ); \
+   x[p5] = _mm256_xor_si256( rol4x64( x[p5], r2 ), x[p4] ); \
+   x[p6] = _mm256_add_epi64( x[p6], x[p7] ); \
+   x[p7] = _mm256_xor_si256( rol4x64( x[p7], r3 ), x[p6] ); \
+} while (0)
+
+// subkey s of the key schedule k[9] and tweak t[3]
+#define SKEIN4_INJECT( s ) \
+do { \
+   x[0] = _mm256_add_epi64( x[0], k[ (s) % 9 ] ); \
+   x[1] = _mm256_add_epi64( x[1], k[ ( (s) + 1 ) % 9 ] ); \
+   x[2] = _mm256_add_epi64( x[2], k[ ( (s) + 2 ) % 9 ] ); \
+   x[3] = _mm256_add_epi64( x[3], k[ ( (s) + 3 ) % 9 ] ); \
+   x[4] = _mm256_add_epi64( x[4], k[ ( (s) + 4 ) % 9 ] ); \
+   x[5] = _mm256_add_epi64( x[5], _mm256_add_epi64( k[ ( (s) + 5 ) % 9 ], \
+                                  _mm256_set1_epi64x( t[ (s) % 3 ] ) ) ); \
+   x[6] = _mm256_add_epi64( x[6], _mm256_add_epi64( k[ ( (s) + 6 ) % 9 ], \
+                                  _mm256_set1_epi64x( t[ ( (s) + 1 ) % 3 ] ) ) ); \
+   x[7] = _mm256_add_epi64( x[7], _mm256_add_epi64( k[ ( (s) + 7 ) % 9 ], \
+                                  _mm256_set1_epi64x( s ) ) ); \
+} while (0)
+
+// 8 rounds and the subkeys s and s + 1 after them
+#define SKEIN4_8ROUNDS( s ) \
+do { \
+   SKEIN4_MIX( 0, 1, 2, 3, 4, 5, 6, 7, 46, 36, 19, 37 ); \
+   SKEIN4_MIX( 2, 1, 4, 7, 6, 5, 0, 3, 33, 27, 14, 42 ); \
+   SKEIN4_MIX( 4, 1, 6, 3, 0, 5, 2, 7, 17, 49, 36, 39 ); \
+   SKEIN4_MIX( 6, 1, 0, 7, 2, 5, 4, 3, 44,  9, 54, 56 ); \
+   SKEIN4_INJECT( s ); \
+   SKEIN4_MIX( 0, 1, 2, 3, 4, 5, 6, 7, 39, 30, 34, 24 ); \
+   SKEIN4_MIX( 2, 1, 4, 7, 6, 5, 0, 3, 13, 50, 10, 17 ); \
+   SKEIN4_MIX( 4, 1, 6, 3, 0, 5, 2, 7, 25, 29, 39, 43 ); \
+   SKEIN4_MIX( 6, 1, 0, 7, 2, 5, 4, 3,  8, 35, 56, 22 ); \
+   SKEIN4_INJECT( (s) + 1 ); \
+} while (0)
+
+// Threefish-512 of the message m under the chain value h and tweak t0, t1,
+// h becomes the UBI output E(h, t, m) ^ m.
+static inline void skein512_4way_ubi( __m256i *h, const __m256i *m,
+                                      uint64_t t0, uint64_t t1 )
+{
+   const uint64_t t[3] = { t0, t1, t0 ^ t1 };
+   __m256i k[9], x[8];
+
+   k[8] = _mm256_set1_epi64x( 0x1BD11BDAA9FC1A22ULL );
+   for ( int i = 0; i < 8; i++ )
+   {
+      k[i] = h[i];
+      k[8] = _mm256_xor_si256( k[8], h[i] );
+      x[i] = m[i];
+   }
+
+   SKEIN4_INJECT( 0 );
+   SKEIN4_8ROUNDS( 1 );
+   SKEIN4_8ROUNDS( 3 );
+   SKEIN4_8ROUNDS( 5 );
+   SKEIN4_8ROUNDS( 7 );
+   SKEIN4_8ROUNDS( 9 );
+   SKEIN4_8ROUNDS( 11 );
+   SKEIN4_8ROUNDS( 13 );
+   SKEIN4_8ROUNDS( 15 );
+   SKEIN4_8ROUNDS( 17 );
+
+   for ( int i = 0; i < 8; i++ )
+      h[i] = _mm256_xor_si256( x[i], m[i] );
+}
+
+// The message block (first and final, 64 bytes) then the output block of
+// a zero counter.
+void skein512_4way_hash64( void *out, const void *in )
+{
+   __m256i h[8], m[8];
+
+   for ( int i = 0; i < 8; i++ )
+      h[i] = _mm256_set1_epi64x( skein512_iv[i] );
+   load4x64( m, (const uint64_t*)in );
+   skein512_4way_ubi( h, m, 64, 0xF000000000000000ULL );
+   for ( int i = 0; i < 8; i++ )
+      m[i] = _mm256_setzero_si256();
+   skein512_4way_ubi( h, m, 8, 0xFF00000000000000ULL );
+   store4x64( (uint64_t*)out, h );
+}
+
+#endif
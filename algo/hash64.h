@@ -0,0 +1,49 @@
+// One shot hash primitives for fixed length 64 byte input.
+//
+// Chained algos hash the previous 512 bit digest through every stage, so
+// the message length and padding are known in advance. Each function here
+// starts from the constant IV of its primitive on the stack and runs the
+// fused update and close, so a chain needs no context holder, no init at
+// registration and no per hash memcpy of pre initialized contexts.
+//
+// Input and output may overlap, both must be 16 byte aligned. Output is
+// 64 bytes except haval256_5_hash64 which writes 32 bytes.
+
+#ifndef HASH64_H__
+#define HASH64_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void blake512_hash64    ( void *out, const void *in );
+void bmw512_hash64      ( void *out, const void *in );
+void groestl512_hash64  ( void *out, const void *in );
+void skein512_hash64    ( void *out, const void *in );
+void jh512_hash64       ( void *out, const void *in );
+void keccak512_hash64   ( void *out, const void *in );
+void luffa512_hash64    ( void *out, const void *in );
+void cubehash512_hash64 ( void *out, const void *in );
+void shavite512_hash64  ( void *out, const void *in );
+void simd512_hash64     ( void *out, const void *in );
+void echo512_hash64     ( void *out, const void *in );
+void hamsi512_hash64    ( void *out, const void *in );
+void fugue512_hash64    ( void *out, const void *in );
+void shabal512_hash64   ( void *out, const void *in );
+void whirlpool_hash64   ( void *out, const void *in );
+void sha512_hash64      ( void *out, const void *in );
+void haval256_5_hash64  ( void *out, const void *in );
+void gost512_hash64     ( void *out, const void *in );
+
+// Four lanes at once on AVX2, in and out are 4 contiguous 64 byte digests.
+#ifdef __AVX2__
+#define HAVE_HASH64_4WAY
+void keccak512_4way_hash64 ( void *out, const void *in );
+void skein512_4way_hash64  ( void *out, const void *in );
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
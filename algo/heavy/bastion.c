@@ -14,24 +14,17 @@
 #include "algo/skein/sph_skein.h"
 #include "algo/whirlpool/sph_whirlpool.h"
 #include "algo/shabal/sph_shabal.h"
-#include "algo/echo/sph_echo.h"
 #include "algo/hamsi/sph_hamsi.h"
 #include "algo/luffa/sse2/luffa_for_sse2.h"
 #include "algo/skein/sse2/skein.c"
 
-#ifndef NO_AES_NI
-  #include "algo/echo/aes_ni/hash_api.h"
-#endif
+#include "algo/echo/aes_ni/hash_api.h"
 
 void bastionhash(void *output, const void *input)
 {
 	unsigned char _ALIGN(128) hash[64] = { 0 };
 
-#ifdef NO_AES_NI
-        sph_echo512_context     ctx_echo;
-#else
         hashState_echo          ctx_echo;
-#endif
         hashState_luffa         ctx_luffa;
 	sph_fugue512_context ctx_fugue;
 	sph_whirlpool_context ctx_whirlpool;
@@ -75,15 +68,9 @@ void bastionhash(void *output, const void *input)
 
 	if (hash[0] & 0x8)
 	{
-#ifdef NO_AES_NI
-		sph_echo512_init(&ctx_echo);
-		sph_echo512(&ctx_echo, hash, 64);
-		sph_echo512_close(&ctx_echo, hash);
-#else
                 init_echo( &ctx_echo, 512 );
                 update_echo ( &ctx_echo, hash, 512 );
                 final_echo( &ctx_echo,  hash );
-#endif
 	} else {
                 init_luffa( &ctx_luffa, 512 );
                 update_luffa( &ctx_luffa, hash, 64 );
@@ -80,9 +80,11 @@ extern void heavyhash(unsigned char* output, const unsigned char* input, int len
 
 }
 
-int scanhash_heavy(int thr_id, uint32_t *pdata, const uint32_t *ptarget,
-                    uint32_t max_nonce, uint64_t *hashes_done)
+int scanhash_heavy( int thr_id, struct work *work, uint32_t max_nonce,
+                    uint64_t *hashes_done )
 {
+    uint32_t *pdata = work->data;
+    uint32_t *ptarget = work->target;
     uint32_t hash[8];
     uint32_t start_nonce = pdata[19];
     
@@ -108,6 +108,20 @@ int hodl_scanhash( int thr_id, struct work* work, uint32_t max_nonce,
 #endif
 }
 
+// Threads meet at hodl_barrier twice per scan, they can't be parked
+// one by one for a hot switch. The scratchbuf is kept for the next
+// registration.
+void hodl_unregister()
+{
+  pthread_barrier_destroy( &hodl_barrier );
+}
+
+void hodl_scratch_size( uint64_t *per_thread, uint64_t *shared )
+{
+  *per_thread = 0;
+  *shared = 1 << 30;
+}
+
 bool register_hodl_algo( algo_gate_t* gate )
 {
   pthread_barrier_init( &hodl_barrier, NULL, opt_n_threads );
@@ -119,8 +133,12 @@ bool register_hodl_algo( algo_gate_t* gate )
   gate->build_extraheader     = (void*)&hodl_build_extraheader;
   gate->resync_threads        = (void*)&hodl_resync_threads;
   gate->do_this_thread        = (void*)&hodl_do_this_thread;
+  gate->unregister_algo       = (void*)&hodl_unregister;
+  gate->scratch_size          = (void*)&hodl_scratch_size;
   gate->work_cmp_size         = 76;
-  hodl_scratchbuf = (unsigned char*)malloc( 1 << 30 );
+  gate->hot_switch            = false;
+  if ( !hodl_scratchbuf )
+     hodl_scratchbuf = (unsigned char*)malloc( 1 << 30 );
   return ( hodl_scratchbuf != NULL );
 }
 
@@ -7,6 +7,7 @@
 #include "hodl-gate.h"
 #include "hodl-wolf.h"
 #include "miner.h"
+#include "algo/interleave.h"
 
 #ifndef NO_AES_NI               
 
@@ -87,11 +88,17 @@ int scanhash_hodl_wolf( int threadNumber, struct work* work, uint32_t max_nonce,
             __m128i ExpKey[AES_PARALLEL_N][16];
             __m128i ivs[AES_PARALLEL_N];
 
-            // use last 4 bytes of first cache as next location
+            // use last 4 bytes of first cache as next location, the
+            // slices of all the lanes are fetched before the first key
+            // expansion waits for its last line
             for(int n=0; n<AES_PARALLEL_N; ++n) {
                 uint32_t nextLocation = Cache[n].dwords[(GARBAGE_SLICE_SIZE >> 2) - 1] & (COMPARE_SIZE - 1); //% COMPARE_SIZE;
                 next[n] = Garbage[nextLocation].dqwords;
+                il_prefetch( next[n] + 254 );
+                il_prefetch( next[n] );
+            }
 
+            for(int n=0; n<AES_PARALLEL_N; ++n) {
                 __m128i last[2];
                 last[0] = _mm_xor_si128(Cache[n].dqwords[254], next[n][254]);
                 last[1] = _mm_xor_si128(Cache[n].dqwords[255], next[n][255]);
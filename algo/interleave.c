@@ -0,0 +1,100 @@
+#include "algo/interleave.h"
+
+#include <stdio.h>
+
+int opt_interleave = 0;
+
+// Size of the cache of a level divided by the cpus that share it, 0 if
+// unknown.
+static size_t cache_share( int level )
+{
+#ifdef __linux__
+   char path[96], buf[256];
+   size_t share = 0;
+
+   for ( int i = 0; i < 8; i++ )
+   {
+      FILE *fd;
+      int lvl = 0, cpus = 0;
+      long kb = 0;
+      char *p;
+
+      snprintf( path, sizeof path,
+                "/sys/devices/system/cpu/cpu0/cache/index%d/level", i );
+      if ( !( fd = fopen( path, "r" ) ) )
+         break;
+      if ( fscanf( fd, "%d", &lvl ) != 1 )
+         lvl = 0;
+      fclose( fd );
+      if ( lvl != level )
+         continue;
+
+      snprintf( path, sizeof path,
+                "/sys/devices/system/cpu/cpu0/cache/index%d/size", i );
+      if ( ( fd = fopen( path, "r" ) ) )
+      {
+         if ( fscanf( fd, "%ldK", &kb ) != 1 )
+            kb = 0;
+         fclose( fd );
+      }
+
+      // "0-3,8-11"
+      snprintf( path, sizeof path,
+                "/sys/devices/system/cpu/cpu0/cache/index%d/shared_cpu_list", i );
+      if ( ( fd = fopen( path, "r" ) ) )
+      {
+         if ( fgets( buf, sizeof buf, fd ) )
+            for ( p = buf; *p; )
+            {
+               int a, b, n;
+               if ( sscanf( p, "%d-%d%n", &a, &b, &n ) == 2 )
+                  cpus += b - a + 1;
+               else if ( sscanf( p, "%d%n", &a, &n ) == 1 )
+                  cpus++;
+               else
+                  break;
+               p += n;
+               if ( *p == ',' )
+                  p++;
+            }
+         fclose( fd );
+      }
+      if ( kb > 0 )
+         share = (size_t)kb * 1024 / ( cpus > 0 ? cpus : 1 );
+   }
+   return share;
+#else
+   return 0;
+#endif
+}
+
+// More lanes lost to the cache misses they add in the --bench-memory
+// sweeps of axiom and pluck, try them with --interleave.
+#define IL_AUTO_WAYS 2
+
+int interleave_ways( size_t lane_bytes )
+{
+   static size_t l2 = (size_t)-1, l3 = (size_t)-1;
+   size_t share;
+   int k;
+
+   if ( opt_interleave > 0 )
+      return opt_interleave < IL_MAX_WAYS ? opt_interleave : IL_MAX_WAYS;
+
+   if ( l2 == (size_t)-1 )
+   {
+      l3 = cache_share( 3 );
+      l2 = cache_share( 2 );
+   }
+   if ( l2 && lane_bytes <= l2 )
+      share = l2;
+   else if ( l3 && lane_bytes <= l3 )
+      share = l3;
+   else
+      // DRAM bound or unknown, only the latency is left to hide
+      return IL_AUTO_WAYS;
+
+   // don't push the lanes out of the cache level that holds one
+   k = share / lane_bytes;
+   return k < 1 ? 1 : k > IL_AUTO_WAYS ? IL_AUTO_WAYS : k;
+}
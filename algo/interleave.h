@@ -0,0 +1,32 @@
+// Interleaved hashing of independent nonces.
+//
+// The memory hard loops of axiom and pluck make a data dependent load at
+// every step, the address is only known when the previous step is done so
+// one hash can't have more than one of these loads in flight. A thread
+// hashes K nonces in lockstep instead: each step is done for every lane in
+// turn and the address a lane needs next is prefetched as soon as it is
+// known, its load then overlaps the compute of the other K-1 lanes.
+//
+// More lanes need K times the scratchpad, K is chosen per cpu so the lanes
+// stay in the cache level that holds one lane, or set with --interleave.
+// --bench-memory measures the rate for K = 1 to 8.
+
+#ifndef INTERLEAVE_H__
+#define INTERLEAVE_H__
+
+#include <stddef.h>
+
+#define IL_MAX_WAYS 8
+
+// --interleave, 0 chooses per cpu
+extern int opt_interleave;
+
+// lanes for a hash with lane_bytes of scratchpad per nonce
+int interleave_ways( size_t lane_bytes );
+
+static inline void il_prefetch( const void *p )
+{
+   __builtin_prefetch( p, 0, 3 );
+}
+
+#endif
@@ -1818,6 +1818,35 @@ sph_keccak512_addbits_and_close(void *cc, unsigned ub, unsigned n, void *dst)
 	keccak_close64(cc, ub, n, dst);
 }
 
+/*
+ * The first 76 bytes fill the first 72 byte block, which is processed
+ * as soon as more data follows, so a context that absorbed them is the
+ * midstate for any nonce.
+ */
+static __thread struct {
+	unsigned char head[76];
+	int valid;
+	sph_keccak512_context cc;
+} keccak512_80_mid;
+
+/* see sph_keccak.h */
+void
+sph_keccak512_80(void *dst, const void *data)
+{
+	sph_keccak512_context cc;
+
+	if (!keccak512_80_mid.valid
+		|| memcmp(keccak512_80_mid.head, data, 76) != 0) {
+		sph_keccak512_init(&keccak512_80_mid.cc);
+		sph_keccak512(&keccak512_80_mid.cc, data, 76);
+		memcpy(keccak512_80_mid.head, data, 76);
+		keccak512_80_mid.valid = 1;
+	}
+	memcpy(&cc, &keccak512_80_mid.cc, sizeof cc);
+	sph_keccak512(&cc, (const unsigned char *)data + 76, 4);
+	sph_keccak512_close(&cc, dst);
+}
+
 
 #ifdef __cplusplus
 }
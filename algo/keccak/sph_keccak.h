@@ -286,6 +286,16 @@ void sph_keccak512_close(void *cc, void *dst);
 void sph_keccak512_addbits_and_close(
 	void *cc, unsigned ub, unsigned n, void *dst);
 
+/**
+ * Compute the Keccak-512 hash of an 80 byte block header. The Keccak-512
+ * state after the nonce invariant first block is computed when the first
+ * 76 bytes change, and kept for the calling thread.
+ *
+ * @param dst    the destination buffer (64 bytes)
+ * @param data   the 80 byte header
+ */
+void sph_keccak512_80(void *dst, const void *data);
+
 #ifdef __cplusplus
 }
 #endif
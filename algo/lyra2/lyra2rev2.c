@@ -131,7 +131,7 @@ bool lyra2rev2_thread_init()
    const int64_t ROW_LEN_BYTES = ROW_LEN_INT64 * 8;
 
    int i = (int64_t)ROW_LEN_BYTES * 4; // nRows;
-   l2v2_wholeMatrix = _mm_malloc( i, 64 );
+   l2v2_wholeMatrix = thread_scratch_alloc( i );
 
    if ( l2v2_wholeMatrix == NULL )
      return false;
@@ -94,7 +94,7 @@ bool zcoin_thread_init()
    const int64_t ROW_LEN_BYTES = ROW_LEN_INT64 * 8;
 
    int i = (int64_t)ROW_LEN_BYTES * 8; // nRows;
-   zcoin_wholeMatrix = _mm_malloc( i, 64 );
+   zcoin_wholeMatrix = thread_scratch_alloc( i );
 
    if ( zcoin_wholeMatrix == NULL )
      return false;
@@ -69,7 +69,7 @@ bool zoin_thread_init()
    const int64_t ROW_LEN_BYTES = ROW_LEN_INT64 * 8;
 
    int i = (int64_t)ROW_LEN_BYTES * 330; // nRows;
-   zoin_wholeMatrix = _mm_malloc( i, 64 );
+   zoin_wholeMatrix = thread_scratch_alloc( i );
 
    if ( zoin_wholeMatrix == NULL )
      return false;
@@ -84,6 +84,12 @@ bool zoin_thread_init()
    return true;
 }
 
+void zoin_scratch_size( uint64_t *per_thread, uint64_t *shared )
+{
+   *per_thread = (uint64_t)BLOCK_LEN_INT64 * 256 * 8 * 330;
+   *shared = 0;
+}
+
 bool register_lyra2z330_algo( algo_gate_t* gate )
 {
   gate->optimizations = SSE2_OPT | AES_OPT | AVX_OPT | AVX2_OPT;
@@ -93,6 +99,7 @@ bool register_lyra2z330_algo( algo_gate_t* gate )
   gate->hash_alt   = (void*)&zoin_hash;
   gate->get_max64  = (void*)&get_max64_0xffffLL;
   gate->set_target = (void*)&zoin_set_target;
+  gate->scratch_size = (void*)&zoin_scratch_size;
 //  gate->prevent_dupes = (void*)&zoin_get_work_height;
   return true;
 };
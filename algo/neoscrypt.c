@@ -1081,6 +1081,13 @@ void neoscrypt_wait_for_diff( struct stratum_ctx *stratum )
    }
 }
 
+// the stack of neoscrypt() for its default profile, N 128 and r 2
+void neoscrypt_scratch_size( uint64_t *per_thread, uint64_t *shared )
+{
+  *per_thread = ( 128 + 3 ) * 2 * 2 * SCRYPT_BLOCK_SIZE + STACK_ALIGN;
+  *shared = 0;
+}
+
 bool register_neoscrypt_algo( algo_gate_t* gate )
 {
   gate->scanhash              = (void*)&scanhash_neoscrypt;
@@ -1092,6 +1099,7 @@ bool register_neoscrypt_algo( algo_gate_t* gate )
   gate->build_stratum_request = (void*)&std_be_build_stratum_request;
   gate->set_work_data_endian  = (void*)&swab_work_data;
   gate->work_data_size        = 80;
+  gate->scratch_size          = (void*)&neoscrypt_scratch_size;
   return true;
 };
 
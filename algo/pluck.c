@@ -27,6 +27,7 @@
 #include "cpuminer-config.h"
 #include "miner.h"
 #include "algo-gate-api.h"
+#include "algo/interleave.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -64,6 +65,7 @@
 #endif
 
 static __thread char *scratchbuf;
+static __thread int pluck_ways = 1;
 
 #ifdef OPT_COMPATIBLE
 static void _VECTOR xor_salsa8(__m128i B[4], const __m128i Bx[4], int i)
@@ -445,39 +447,100 @@ void pluck_hash(uint32_t *hash, const uint32_t *data, uchar *hashbuffer, const i
 	memcpy(hash, hashbuffer, 32);
 }
 
+// pluck_hash of k nonces in lockstep, see algo/interleave.h. The joint
+// words of a step are gathered from random places below i, their addresses
+// are known after the first salsa so they are prefetched for all the lanes
+// before the first lane gathers.
+void pluck_hash_ways(uint32_t hash[][8], uint32_t data[][20],
+	uchar *buf, int k, const int N)
+{
+	const int size = N * 1024;
+	uint32_t _ALIGN(64) randseed[16];
+	uint32_t _ALIGN(64) randbuffer[IL_MAX_WAYS][16];
+	uint32_t _ALIGN(64) joint[16];
+	uchar *hb[IL_MAX_WAYS];
+	int l;
+
+	for (l = 0; l < k; l++) {
+		hb[l] = buf + l * (size + 64);
+		sha256_hash(hb[l], (void*)data[l], BLOCK_HEADER_SIZE);
+		memset(&hb[l][32], 0, 32);
+	}
+
+	for (int i = 64; i < size - 32; i += 32)
+	{
+		int randmax = i - 4;
+
+		for (l = 0; l < k; l++) {
+			memcpy(randseed, &hb[l][i - 64], 64);
+			if (i > 128) memcpy(randbuffer[l], &hb[l][i - 128], 64);
+			xor_salsa8((void*)randbuffer[l], (void*)randseed, i);
+			for (int j = 0; j < 8; j++)
+				il_prefetch(&hb[l][randbuffer[l][j] % (randmax - 32)]);
+		}
+
+		for (l = 0; l < k; l++) {
+			uchar *h = hb[l];
+
+			memcpy(joint, &h[i - 32], 32);
+			for (int j = 32; j < 64; j += 4)
+			{
+				uint32_t rand = randbuffer[l][(j - 32) >> 2] % (randmax - 32);
+				joint[j >> 2] = *((uint32_t *)&h[rand]);
+			}
+			sha256_hash512((uint32_t*) &h[i], joint);
+
+			memcpy(randseed, &h[i - 32], 64);
+			if (i > 128) memcpy(randbuffer[l], &h[i - 128], 64);
+			xor_salsa8((void*)randbuffer[l], (void*)randseed, i);
+			for (int j = 0; j < 32; j += 2)
+			{
+				uint32_t rand = randbuffer[l][j >> 1] % randmax;
+				*((uint32_t *)(h + rand)) = *((uint32_t *)(h + j + randmax));
+			}
+		}
+	}
+
+	for (l = 0; l < k; l++)
+		memcpy(hash[l], hb[l], 32);
+}
+
 int scanhash_pluck(int thr_id, struct work *work, uint32_t max_nonce,
         uint64_t *hashes_done  )
 {
         uint32_t *pdata = work->data;
         uint32_t *ptarget = work->target;
-	uint32_t _ALIGN(64) endiandata[20];
-	uint32_t _ALIGN(64) hash[8];
+	uint32_t _ALIGN(64) endiandata[IL_MAX_WAYS][20];
+	uint32_t _ALIGN(64) hash[IL_MAX_WAYS][8];
 	const uint32_t first_nonce = pdata[19];
+	const int k = pluck_ways;
 	volatile uint8_t *restart = &(work_restart[thr_id].restart);
 	uint32_t n = first_nonce;
 
 	if (opt_benchmark)
 		((uint32_t*)ptarget)[7] = 0x0ffff;
 
-        for (int i=0; i < 19; i++) 
-                be32enc(&endiandata[i], pdata[i]);
+	for (int l = 0; l < k; l++)
+		for (int i = 0; i < 19; i++)
+			be32enc(&endiandata[l][i], pdata[i]);
 
 	const uint32_t Htarg = ptarget[7];
 	do {
-		//be32enc(&endiandata[19], n);
-		endiandata[19] = n;
-		pluck_hash(hash, endiandata, scratchbuf, opt_pluck_n);
+		for (int l = 0; l < k; l++)
+			endiandata[l][19] = n + l;
+		pluck_hash_ways(hash, endiandata, scratchbuf, k, opt_pluck_n);
 
-		if (hash[7] <= Htarg && fulltest(hash, ptarget))
+		for (int l = 0; l < k; l++)
+		if (hash[l][7] <= Htarg && fulltest(hash[l], ptarget))
 		{
-			*hashes_done = n - first_nonce + 1;
-			pdata[19] = htobe32(endiandata[19]);
+			*hashes_done = n + l - first_nonce + 1;
+			pdata[19] = htobe32(endiandata[l][19]);
 			return 1;
 		}
-		n++;
+		n += k;
 	} while (n < max_nonce && !(*restart));
 
-	*hashes_done = n - first_nonce + 1;
+	*hashes_done = n - first_nonce;
 	pdata[19] = n;
 	return 0;
 }
@@ -489,13 +552,21 @@ int64_t pluck_get_max64 ()
 
 bool pluck_miner_thread_init( int thr_id )
 { 
-  scratchbuf = malloc( 128 * 1024 ); 
+  pluck_ways = interleave_ways( opt_pluck_n * 1024 );
+  scratchbuf = thread_scratch_alloc( pluck_ways * ( opt_pluck_n * 1024 + 64 ) );
   if ( scratchbuf )
     return true;
   applog( LOG_ERR, "Thread %u: Pluck buffer allocation failed", thr_id );
   return false;
 }
 
+void pluck_scratch_size( uint64_t *per_thread, uint64_t *shared )
+{
+  *per_thread = (uint64_t)interleave_ways( opt_pluck_n * 1024 )
+                          * ( opt_pluck_n * 1024 + 64 );
+  *shared = 0;
+}
+
 bool register_pluck_algo( algo_gate_t* gate )
 {
   algo_not_tested();
@@ -504,6 +575,7 @@ bool register_pluck_algo( algo_gate_t* gate )
   gate->hash             = (void*)&pluck_hash;
   gate->set_target       = (void*)&scrypt_set_target;
   gate->get_max64        = (void*)&pluck_get_max64;
+  gate->scratch_size     = (void*)&pluck_scratch_size;
   return true;
 };
 
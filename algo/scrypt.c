@@ -507,9 +507,29 @@ static inline void scrypt_core(uint32_t *X, uint32_t *V, int N)
 #define scrypt_best_throughput() 1
 #endif
 
+/* 0 for the best, or the scrypt_core ways to use, 1, 3 or 6 */
+int scrypt_ways = 0;
+static bool scrypt_ways_lowered = false;
+
+int scrypt_max_ways()
+{
+	return scrypt_best_throughput();
+}
+
+/* the 4 way sha256 runs the scrypt_core lanes 4 times over the same V */
+static int scrypt_core_ways()
+{
+	return scrypt_ways ? scrypt_ways : scrypt_best_throughput();
+}
+
+size_t scrypt_buffer_size(int N)
+{
+	return (size_t)N * scrypt_core_ways() * 128 + 63;
+}
+
 unsigned char *scrypt_buffer_alloc(int N)
 {
-	return (uchar*) malloc((size_t)N * SCRYPT_MAX_WAYS * 128 + 63);
+	return (uchar*) thread_scratch_alloc(scrypt_buffer_size(N));
 }
 
 static void scrypt_1024_1_1_256(const uint32_t *input, uint32_t *output,
@@ -705,7 +725,7 @@ extern int scanhash_scrypt( int thr_id, struct work *work, uint32_t max_nonce,
 	uint32_t midstate[8];
 	uint32_t n = pdata[19] - 1;
 	const uint32_t Htarg = ptarget[7];
-	int throughput = scrypt_best_throughput();
+	int throughput = scrypt_core_ways();
 	int i;
 	
 #ifdef HAVE_SHA256_4WAY
@@ -776,14 +796,39 @@ bool scrypt_miner_thread_init( int thr_id )
  return false; 
 }
 
+void scrypt_scratch_size( uint64_t *per_thread, uint64_t *shared )
+{
+  *per_thread = scrypt_buffer_size( scratchbuf_size );
+  *shared = 0;
+}
+
+// 6, 3 then 1 scrypt_core lanes for the --max-memory budget
+bool scrypt_lower_ways()
+{
+  int ways = scrypt_core_ways();
+  if ( ways <= 1 )
+     return false;
+  scrypt_ways = ways > 3 ? 3 : 1;
+  scrypt_ways_lowered = true;
+  return true;
+}
+
 bool register_scrypt_algo( algo_gate_t* gate )
 {
+  // lowered for the N of the previous registration
+  if ( scrypt_ways_lowered )
+  {
+     scrypt_ways = 0;
+     scrypt_ways_lowered = false;
+  }
   gate->miner_thread_init =(void*)&scrypt_miner_thread_init;
   gate->scanhash         = (void*)&scanhash_scrypt;
   gate->hash             = (void*)&scrypt_1024_1_1_256_24way;
   gate->hash_alt         = (void*)&scrypt_1024_1_1_256_24way;
   gate->set_target       = (void*)&scrypt_set_target;
   gate->get_max64        = (void*)&scrypt_get_max64;
+  gate->scratch_size     = (void*)&scrypt_scratch_size;
+  gate->lower_ways       = (void*)&scrypt_lower_ways;
 
   if ( !opt_scrypt_n )
      scratchbuf_size = 1024;
@@ -47,6 +47,9 @@
 
 uint64_t sj_N;
 
+/* V then Y and X of the thread, N grows it on the next miner_thread_init */
+static __thread uint8_t *sj_V;
+
 typedef struct scrypt_aligned_alloc_t {
 	uint8_t *mem, *ptr;
 } scrypt_aligned_alloc;
@@ -140,12 +143,10 @@ unsigned char GetNfactor(unsigned int nTimestamp, unsigned int ntime) {
 int scanhash_scryptjane( int thr_id, struct work *work, uint32_t max_nonce,
                          uint64_t *hashes_done)
 {
-	scrypt_aligned_alloc YX, V;
 	uint8_t *X, *Y;
 //        uint32_t N, chunk_bytes;
 	uint32_t chunk_bytes;
 	const uint32_t r = SCRYPT_R;
-	const uint32_t p = SCRYPT_P;
 
 	uint32_t *pdata = work->data;
 	uint32_t *ptarget = work->target;
@@ -172,13 +173,7 @@ int scanhash_scryptjane( int thr_id, struct work *work, uint32_t max_nonce,
 //	N = (1 << ( opt_scrypt_n + 1));
 
 	chunk_bytes = SCRYPT_BLOCK_BYTES * r * 2;
-	if (!scrypt_alloc( sj_N * chunk_bytes, &V ) ) return 1;
-	if (!scrypt_alloc((p + 1) * chunk_bytes, &YX)) {
-		scrypt_free(&V);
-		return 1;
-	}
-
-	Y = YX.ptr;
+	Y = sj_V + sj_N * chunk_bytes;
 	X = Y + chunk_bytes;
 
 	do {
@@ -188,13 +183,11 @@ int scanhash_scryptjane( int thr_id, struct work *work, uint32_t max_nonce,
 
 		scrypt_N_1_1((unsigned char *)endiandata, 80,
 			(unsigned char *)endiandata, 80,
-			sj_N, (unsigned char *)hash, 32, X, Y, V.ptr);
+			sj_N, (unsigned char *)hash, 32, X, Y, sj_V);
 
 		if (hash[7] <= Htarg && fulltest(hash, ptarget)) {
 			pdata[19] = nonce;
 			*hashes_done = pdata[19] - first_nonce;
-			scrypt_free(&V);
-			scrypt_free(&YX);
 			return 1;
 		}
 		nonce++;
@@ -203,9 +196,6 @@ int scanhash_scryptjane( int thr_id, struct work *work, uint32_t max_nonce,
 
 	pdata[19] = nonce;
 	*hashes_done = pdata[19] - first_nonce + 1;
-
-	scrypt_free(&V);
-	scrypt_free(&YX);
 	return 0;
 }
 
@@ -237,8 +227,32 @@ void scryptjanehash(void *output, const void *input )
 	scrypt_free(&YX);
 }
 
+static size_t sj_scratch_bytes()
+{
+    const uint32_t chunk_bytes = SCRYPT_BLOCK_BYTES * SCRYPT_R * 2;
+    return ( sj_N + SCRYPT_P + 1 ) * chunk_bytes;
+}
+
+bool scryptjane_thread_init( int thr_id )
+{
+    sj_V = thread_scratch_alloc( sj_scratch_bytes() );
+    if ( sj_V )
+       return true;
+    applog( LOG_ERR, "Thread %u: scryptjane buffer allocation failed, "
+                     "N %llu", thr_id, (unsigned long long)sj_N );
+    return false;
+}
+
+void scryptjane_scratch_size( uint64_t *per_thread, uint64_t *shared )
+{
+    *per_thread = sj_scratch_bytes();
+    *shared = 0;
+}
+
 bool register_scryptjane_algo( algo_gate_t* gate )
 {
+    gate->miner_thread_init = (void*)&scryptjane_thread_init;
+    gate->scratch_size      = (void*)&scryptjane_scratch_size;
     gate->scanhash   = (void*)&scanhash_scryptjane;
     gate->hash       = (void*)&scryptjanehash;
     gate->hash_alt   = (void*)&scryptjanehash;
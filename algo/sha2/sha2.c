@@ -474,20 +474,28 @@ static inline int scanhash_sha256d_4way(int thr_id, struct work *work,
         uint32_t *pdata = work->data;
         uint32_t *ptarget = work->target;
 
-	uint32_t _ALIGN(128) data[4 * 64];
+	static __thread uint32_t _ALIGN(128) data[4 * 64];
+	static __thread uint32_t block2[4];
 	uint32_t _ALIGN(32) hash[4 * 8];
 	uint32_t _ALIGN(32) midstate[4 * 8];
 	uint32_t _ALIGN(32) prehash[4 * 8];
 	uint32_t n = pdata[19] - 1;
 	const uint32_t first_nonce = pdata[19];
 	const uint32_t Htarg = ptarget[7];
+	int found = 0;
 	int i, j;
 	
-	memcpy(data, pdata + 16, 64);
-	sha256d_preextend(data);
-	for (i = 31; i >= 0; i--)
-		for (j = 0; j < 4; j++)
-			data[i * 4 + j] = data[i];
+	/* the second block doesn't change with the version, its schedule is
+	   kept across the version rolls of a job */
+	if (!block2[3] || memcmp(block2, pdata + 16, 12)) {
+		memcpy(data, pdata + 16, 64);
+		sha256d_preextend(data);
+		for (i = 31; i >= 0; i--)
+			for (j = 0; j < 4; j++)
+				data[i * 4 + j] = data[i];
+		memcpy(block2, pdata + 16, 12);
+		block2[3] = 1;
+	}
 	
 	sha256_init(midstate);
 	sha256_transform(midstate, pdata, 0);
@@ -511,8 +519,11 @@ static inline int scanhash_sha256d_4way(int thr_id, struct work *work,
 				pdata[19] = data[4 * 3 + i];
 				sha256d_80_swap(hash, pdata);
 				if (fulltest(hash, ptarget)) {
-					*hashes_done = n - first_nonce + 1;
-					return 1;
+					found++;
+					if (!scan_solution(thr_id, work, pdata[19])) {
+						*hashes_done = pdata[19] - first_nonce + 1;
+						return found;
+					}
 				}
 			}
 		}
@@ -520,7 +531,7 @@ static inline int scanhash_sha256d_4way(int thr_id, struct work *work,
 	
 	*hashes_done = n - first_nonce + 1;
 	pdata[19] = n;
-	return 0;
+	return found;
 }
 
 #endif /* HAVE_SHA256_4WAY */
@@ -536,20 +547,28 @@ static inline int scanhash_sha256d_8way(int thr_id, struct work *work,
         uint32_t *pdata = work->data;
         uint32_t *ptarget = work->target;
 
-	uint32_t _ALIGN(128) data[8 * 64];
+	static __thread uint32_t _ALIGN(128) data[8 * 64];
+	static __thread uint32_t block2[4];
 	uint32_t _ALIGN(32)  hash[8 * 8];
 	uint32_t _ALIGN(32)  midstate[8 * 8];
 	uint32_t _ALIGN(32)  prehash[8 * 8];
 	uint32_t n = pdata[19] - 1;
 	const uint32_t first_nonce = pdata[19];
 	const uint32_t Htarg = ptarget[7];
+	int found = 0;
 	int i, j;
 	
-	memcpy(data, pdata + 16, 64);
-	sha256d_preextend(data);
-	for (i = 31; i >= 0; i--)
-		for (j = 0; j < 8; j++)
-			data[i * 8 + j] = data[i];
+	/* the second block doesn't change with the version, its schedule is
+	   kept across the version rolls of a job */
+	if (!block2[3] || memcmp(block2, pdata + 16, 12)) {
+		memcpy(data, pdata + 16, 64);
+		sha256d_preextend(data);
+		for (i = 31; i >= 0; i--)
+			for (j = 0; j < 8; j++)
+				data[i * 8 + j] = data[i];
+		memcpy(block2, pdata + 16, 12);
+		block2[3] = 1;
+	}
 	
 	sha256_init(midstate);
 	sha256_transform(midstate, pdata, 0);
@@ -573,8 +592,11 @@ static inline int scanhash_sha256d_8way(int thr_id, struct work *work,
 				pdata[19] = data[8 * 3 + i];
 				sha256d_80_swap(hash, pdata);
 				if (fulltest(hash, ptarget)) {
-					*hashes_done = n - first_nonce + 1;
-					return 1;
+					found++;
+					if (!scan_solution(thr_id, work, pdata[19])) {
+						*hashes_done = pdata[19] - first_nonce + 1;
+						return found;
+					}
 				}
 			}
 		}
@@ -582,7 +604,7 @@ static inline int scanhash_sha256d_8way(int thr_id, struct work *work,
 	
 	*hashes_done = n - first_nonce + 1;
 	pdata[19] = n;
-	return 0;
+	return found;
 }
 
 #endif /* HAVE_SHA256_8WAY */
@@ -592,13 +614,15 @@ int scanhash_sha256d(int thr_id, struct work *work,
 {
         uint32_t *pdata = work->data;
         uint32_t *ptarget = work->target;
-	uint32_t _ALIGN(128) data[64];
+	static __thread uint32_t _ALIGN(128) data[64];
+	static __thread uint32_t block2[4];
 	uint32_t _ALIGN(32) hash[8];
 	uint32_t _ALIGN(32) midstate[8];
 	uint32_t _ALIGN(32) prehash[8];
 	uint32_t n = pdata[19] - 1;
 	const uint32_t first_nonce = pdata[19];
 	const uint32_t Htarg = ptarget[7];
+	int found = 0;
 	
 #ifdef HAVE_SHA256_8WAY
 	if (sha256_use_8way())
@@ -611,8 +635,13 @@ int scanhash_sha256d(int thr_id, struct work *work,
 			max_nonce, hashes_done);
 #endif
 	
-	memcpy(data, pdata + 16, 64);
-	sha256d_preextend(data);
+	/* kept across the version rolls of a job, as in the n-way scans */
+	if (!block2[3] || memcmp(block2, pdata + 16, 12)) {
+		memcpy(data, pdata + 16, 64);
+		sha256d_preextend(data);
+		memcpy(block2, pdata + 16, 12);
+		block2[3] = 1;
+	}
 	
 	sha256_init(midstate);
 	sha256_transform(midstate, pdata, 0);
@@ -626,15 +655,18 @@ int scanhash_sha256d(int thr_id, struct work *work,
 			pdata[19] = data[3];
 			sha256d_80_swap(hash, pdata);
 			if (fulltest(hash, ptarget)) {
-				*hashes_done = n - first_nonce + 1;
-				return 1;
+				found++;
+				if (!scan_solution(thr_id, work, n)) {
+					*hashes_done = n - first_nonce + 1;
+					return found;
+				}
 			}
 		}
 	} while (likely(n < max_nonce && !work_restart[thr_id].restart));
 	
 	*hashes_done = n - first_nonce + 1;
 	pdata[19] = n;
-	return 0;
+	return found;
 }
 
 bool register_sha256d_algo( algo_gate_t* gate )
@@ -642,6 +674,7 @@ bool register_sha256d_algo( algo_gate_t* gate )
     gate->scanhash = (void*)&scanhash_sha256d;
     gate->hash_alt = (void*)&sha256d;
     gate->hash     = (void*)&sha256d;
+    gate->roll_version = true;
     return true;
 };
 
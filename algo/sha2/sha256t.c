@@ -6,123 +6,112 @@
 #include <string.h>
 #include <stdio.h>
 
-#include "sph-sha2.h"
+// The lanes run on the 4 or 8 way SHA-256 transforms of sha2.c where the
+// cpu has them. Lane j of a state or block word i is at i * ways + j.
 
-//#define DEBUG_ALGO
+static __thread uint32_t sha256t_lane_mid[8];
+static int sha256t_max_ways = 1;   // sha256_use_*way runs cpuid
 
-
-static  sph_sha256_context sha256t_ctx __attribute__ ((aligned (64)));
-static __thread sph_sha256_context sha256t_mid  __attribute__ ((aligned (64)));
-
-void sha256t_midstate( const void* input )
+static void sha256t_pad( uint32_t *block, int len, uint32_t bits, int ways )
 {
-    memcpy( &sha256t_mid, &sha256t_ctx, sizeof sha256t_mid );
-    sph_sha256( &sha256t_mid, input, 64 );
+   for ( int j = 0; j < ways; j++ )
+   {
+      block[ len * ways + j ] = 0x80000000;
+      for ( int i = len + 1; i < 15; i++ )
+         block[ i * ways + j ] = 0;
+      block[ 15 * ways + j ] = bits;
+   }
 }
 
-void sha256t_hash(void* output, const void* input,  uint32_t len)
+// up to ways headers, the extra lanes hash the first one
+static void sha256t_ways( uint32_t *output, const uint32_t *input, int n,
+     int ways, void (*transform)( uint32_t*, const uint32_t*, int ) )
 {
-        sph_sha256_context ctx_sha256 __attribute__ ((aligned (64)));
-	uint32_t _ALIGN(64) hashA[16];
-
-        const int midlen = 64;            // bytes
-        const int tail   = 80 - midlen;   // 16
-
-        memcpy( &ctx_sha256, &sha256t_mid, sizeof sha256t_mid );
-        sph_sha256( &ctx_sha256, input + midlen, tail );
-
-//        sph_sha256_init(&ctx_sha256);
-//	sph_sha256 (&ctx_sha256, input, 80);
-	sph_sha256_close( &ctx_sha256, hashA );
-
-//        sph_sha256_init(&ctx_sha256);
-        memcpy( &ctx_sha256, &sha256t_ctx, sizeof sha256t_ctx );
-	sph_sha256( &ctx_sha256, hashA, 32 );
-	sph_sha256_close( &ctx_sha256, hashA );
-
-//        sph_sha256_init(&ctx_sha256);
-        memcpy( &ctx_sha256, &sha256t_ctx, sizeof sha256t_ctx );
-	sph_sha256( &ctx_sha256, hashA, 32 );
-	sph_sha256_close( &ctx_sha256, hashA );
-
-	memcpy( output, hashA, 32 );
+   uint32_t _ALIGN(64) state[ 8 * 8 ];
+   uint32_t _ALIGN(64) block[ 16 * 8 ];
+   uint32_t h0[8];
+
+   for ( int i = 0; i < 8; i++ )
+   for ( int j = 0; j < ways; j++ )
+      state[ i * ways + j ] = sha256t_lane_mid[i];
+   for ( int j = 0; j < ways; j++ )
+   {
+      const uint32_t *in = input + ( j < n ? j : 0 ) * 20;
+      for ( int i = 0; i < 4; i++ )
+         block[ i * ways + j ] = swab32( in[ 16 + i ] );
+   }
+   sha256t_pad( block, 4, 80 * 8, ways );
+   transform( state, block, 0 );
+
+   sha256_init( h0 );
+   for ( int r = 0; r < 2; r++ )
+   {
+      memcpy( block, state, 8 * ways * sizeof(uint32_t) );
+      sha256t_pad( block, 8, 32 * 8, ways );
+      for ( int i = 0; i < 8; i++ )
+      for ( int j = 0; j < ways; j++ )
+         state[ i * ways + j ] = h0[i];
+      transform( state, block, 0 );
+   }
+
+   for ( int j = 0; j < n; j++ )
+   for ( int i = 0; i < 8; i++ )
+      output[ j * 8 + i ] = swab32( state[ i * ways + j ] );
 }
 
-int scanhash_sha256t(int thr_id, struct work *work,
-				uint32_t max_nonce, uint64_t *hashes_done)
+// The lanes share the midstate of the first 64 bytes, it is only
+// recomputed when they change.
+void sha256t_hash_nway( void *output, const void *input, int n )
 {
-        uint32_t *pdata = work->data;
-        uint32_t *ptarget = work->target;
-	uint32_t len = 80;
-
-	uint32_t n = pdata[19] - 1;
-	const uint32_t first_nonce = pdata[19];
-	const uint32_t Htarg = ptarget[7];
-#ifdef _MSC_VER
-	uint32_t __declspec(align(32)) hash64[8];
-#else
-	uint32_t hash64[8] __attribute__((aligned(32)));
+   static __thread uint32_t mid_data[16];
+   static __thread bool mid_valid = false;
+   void (*transform)( uint32_t*, const uint32_t*, int ) = sha256_transform;
+   int ways = 1;
+
+   if ( !mid_valid || memcmp( mid_data, input, 64 ) )
+   {
+      memcpy( mid_data, input, 64 );
+      sha256_init( sha256t_lane_mid );
+      sha256_transform( sha256t_lane_mid, (const uint32_t*)input, 1 );
+      mid_valid = true;
+   }
+#ifdef HAVE_SHA256_4WAY
+   if ( n > 1 && sha256t_max_ways >= 4 )
+   {
+      ways = 4;
+      transform = sha256_transform_4way;
+   }
 #endif
-	uint32_t endiandata[32];
-
-	uint64_t htmax[] = {
-		0,
-		0xF,
-		0xFF,
-		0xFFF,
-		0xFFFF,
-		0x10000000
-	};
-	uint32_t masks[] = {
-		0xFFFFFFFF,
-		0xFFFFFFF0,
-		0xFFFFFF00,
-		0xFFFFF000,
-		0xFFFF0000,
-		0
-	};
-
-	// we need bigendian data...
-        for (int k = 0; k < 19; k++)
-                be32enc(&endiandata[k], pdata[k]);
+#ifdef HAVE_SHA256_8WAY
+   if ( n > 4 && sha256t_max_ways >= 8 )
+   {
+      ways = 8;
+      transform = sha256_transform_8way;
+   }
+#endif
+   for ( int i = 0; i < n; i += ways )
+      sha256t_ways( (uint32_t*)output + i * 8,
+                    (const uint32_t*)input + i * 20,
+                    n - i < ways ? n - i : ways, ways, transform );
+}
 
-        sha256t_midstate( endiandata );
+void sha256t_hash( void *output, const void *input, uint32_t len )
+{
+   sha256t_hash_nway( output, input, 1 );
+}
 
-#ifdef DEBUG_ALGO
-	if (Htarg != 0)
-		printf("[%d] Htarg=%X\n", thr_id, Htarg);
+// lanes of the widest transform the cpu has
+static int sha256t_lanes()
+{
+#ifdef HAVE_SHA256_8WAY
+   if ( sha256_use_8way() )
+      return 8;
 #endif
-	for (int m=0; m < 6; m++) {
-		if (Htarg <= htmax[m]) {
-			uint32_t mask = masks[m];
-			do {
-				pdata[19] = ++n;
-				be32enc(&endiandata[19], n);
-				sha256t_hash(hash64, endiandata, len);
-#ifndef DEBUG_ALGO
-				if ((!(hash64[7] & mask)) && fulltest(hash64, ptarget)) {
-					*hashes_done = n - first_nonce + 1;
-					return true;
-				}
-#else
-				if (!(n % 0x1000) && !thr_id) printf(".");
-				if (!(hash64[7] & mask)) {
-					printf("[%d]",thr_id);
-					if (fulltest(hash64, ptarget)) {
-						*hashes_done = n - first_nonce + 1;
-						return true;
-					}
-				}
+#ifdef HAVE_SHA256_4WAY
+   if ( sha256_use_4way() )
+      return 4;
 #endif
-			} while (n < max_nonce && !work_restart[thr_id].restart);
-			// see blake.c if else to understand the loop on htmax => mask
-			break;
-		}
-	}
-
-	*hashes_done = n - first_nonce + 1;
-	pdata[19] = n;
-	return 0;
+   return 1;
 }
 
 void sha256t_set_target( struct work* work, double job_diff )
@@ -133,8 +122,10 @@ void sha256t_set_target( struct work* work, double job_diff )
 
 bool register_sha256t_algo( algo_gate_t* gate )
 {
-    sph_sha256_init( &sha256t_ctx );
-    gate->scanhash   = (void*)&scanhash_sha256t;
+    gate->scanhash   = (void*)&scanhash_nway;
+    gate->hash_nway  = (void*)&sha256t_hash_nway;
+    sha256t_max_ways = sha256t_lanes();
+    gate->hash_lanes = sha256t_max_ways;
     gate->hash       = (void*)&sha256t_hash;
     gate->hash_alt   = (void*)&sha256t_hash;
     gate->set_target = (void*)&sha256t_set_target;
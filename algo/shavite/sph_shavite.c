@@ -35,6 +35,10 @@
 
 #include "sph_shavite.h"
 
+#if defined(__AES__) || defined(__SSSE3__)
+#include "algo/aes-vperm.h"
+#endif
+
 #ifdef __cplusplus
 extern "C"{
 #endif
@@ -720,7 +724,102 @@ c256(sph_shavite_small_context *sc, const void *msg)
 
 #endif
 
-#if SPH_SMALL_FOOTPRINT_SHAVITE
+#ifdef MM_AES
+
+/*
+ * The 512-bit compression on 128-bit words, the AES rounds of the message
+ * expansion and of the Feistel rounds are AES-NI or vperm (see
+ * algo/aes-vperm.h). Same steps as the small footprint version below, the
+ * word rotations of the message expansion are shuffles. Between the rounds
+ * there are only xors and byte moves, so the message, the counter and the
+ * chaining value enter the AES basis once and the result leaves it once.
+ */
+static void
+c512(sph_shavite_big_context *sc, const void *msg)
+{
+	__m128i rk[112];
+	__m128i p0, p1, p2, p3, x;
+	const __m128i zero = _mm_setzero_si128();
+	int u, r, s;
+
+	for (u = 0; u < 8; u ++)
+		rk[u] = mm_aes_basis_in(
+			_mm_loadu_si128((const __m128i *)msg + u));
+	for (;;) {
+		for (s = 0; s < 4; s ++) {
+			x = mm_aesenc_basis(_mm_shuffle_epi32(rk[u - 8], 0x39), zero);
+			rk[u] = _mm_xor_si128(x, rk[u - 1]);
+			if (u == 8)
+				rk[u] = _mm_xor_si128(rk[u],
+					mm_aes_basis_in(_mm_set_epi32(
+					~sc->count3, sc->count2, sc->count1, sc->count0)));
+			else if (u == 110)
+				rk[u] = _mm_xor_si128(rk[u],
+					mm_aes_basis_in(_mm_set_epi32(
+					~sc->count2, sc->count3, sc->count0, sc->count1)));
+			u ++;
+
+			x = mm_aesenc_basis(_mm_shuffle_epi32(rk[u - 8], 0x39), zero);
+			rk[u] = _mm_xor_si128(x, rk[u - 1]);
+			if (u == 41)
+				rk[u] = _mm_xor_si128(rk[u],
+					mm_aes_basis_in(_mm_set_epi32(
+					~sc->count0, sc->count1, sc->count2, sc->count3)));
+			else if (u == 79)
+				rk[u] = _mm_xor_si128(rk[u],
+					mm_aes_basis_in(_mm_set_epi32(
+					~sc->count1, sc->count0, sc->count3, sc->count2)));
+			u ++;
+		}
+		if (u == 112)
+			break;
+		for (s = 0; s < 8; s ++) {
+			rk[u] = _mm_xor_si128(rk[u - 8],
+				_mm_alignr_epi8(rk[u - 1], rk[u - 2], 4));
+			u ++;
+		}
+	}
+
+	p0 = mm_aes_basis_in(_mm_loadu_si128((const __m128i *)sc->h + 0));
+	p1 = mm_aes_basis_in(_mm_loadu_si128((const __m128i *)sc->h + 1));
+	p2 = mm_aes_basis_in(_mm_loadu_si128((const __m128i *)sc->h + 2));
+	p3 = mm_aes_basis_in(_mm_loadu_si128((const __m128i *)sc->h + 3));
+	u = 0;
+	for (r = 0; r < 14; r ++) {
+#define C512_ELT(l, r)   do { \
+		x = _mm_xor_si128(r, rk[u ++]); \
+		x = mm_aesenc_basis(x, rk[u ++]); \
+		x = mm_aesenc_basis(x, rk[u ++]); \
+		x = mm_aesenc_basis(x, rk[u ++]); \
+		x = mm_aesenc_basis(x, zero); \
+		l = _mm_xor_si128(l, x); \
+	} while (0)
+
+		C512_ELT(p0, p1);
+		C512_ELT(p2, p3);
+		x = p3;
+		p3 = p2;
+		p2 = p1;
+		p1 = p0;
+		p0 = x;
+
+#undef C512_ELT
+	}
+	_mm_storeu_si128((__m128i *)sc->h + 0,
+		_mm_xor_si128(_mm_loadu_si128((__m128i *)sc->h + 0),
+		mm_aes_basis_out(p0)));
+	_mm_storeu_si128((__m128i *)sc->h + 1,
+		_mm_xor_si128(_mm_loadu_si128((__m128i *)sc->h + 1),
+		mm_aes_basis_out(p1)));
+	_mm_storeu_si128((__m128i *)sc->h + 2,
+		_mm_xor_si128(_mm_loadu_si128((__m128i *)sc->h + 2),
+		mm_aes_basis_out(p2)));
+	_mm_storeu_si128((__m128i *)sc->h + 3,
+		_mm_xor_si128(_mm_loadu_si128((__m128i *)sc->h + 3),
+		mm_aes_basis_out(p3)));
+}
+
+#elif SPH_SMALL_FOOTPRINT_SHAVITE
 
 /*
  * This function assumes that "msg" is aligned for 32-bit access.
@@ -9,7 +9,6 @@
 #include "sph_skein.h"
 
 typedef struct {
-        sph_skein512_context skein;
         SHA256_CTX           sha256;
 } skein_ctx_holder;
 
@@ -17,7 +16,6 @@ skein_ctx_holder skein_ctx;
 
 void init_skein_ctx()
 {
-        sph_skein512_init(&skein_ctx.skein);
         SHA256_Init(&skein_ctx.sha256);
 }
 
@@ -27,8 +25,7 @@ void skeinhash(void *state, const void *input)
      memcpy( &ctx, &skein_ctx, sizeof(skein_ctx) );
      uint32_t hash[16];
 	
-     sph_skein512(&ctx.skein, input, 80);
-     sph_skein512_close(&ctx.skein, hash);
+     sph_skein512_80( hash, input );
 
      SHA256_Update(&ctx.sha256, hash, 64);
      SHA256_Final((unsigned char*) hash, &ctx.sha256);
@@ -23,9 +23,7 @@ void skein2hash(void *output, const void *input)
 
 	uint32_t hash[16];
 
-	sph_skein512_init(&ctx_skein);
-	sph_skein512(&ctx_skein, input, 80);
-	sph_skein512_close(&ctx_skein, hash);
+	sph_skein512_80(hash, input);
 
 	sph_skein512_init(&ctx_skein);
 	sph_skein512(&ctx_skein, hash, 64);
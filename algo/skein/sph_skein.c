@@ -1246,6 +1246,35 @@ sph_skein512_addbits_and_close(void *cc, unsigned ub, unsigned n, void *dst)
 //	sph_skein512_init(cc);
 }
 
+/*
+ * The first 76 bytes fill the first 64 byte block, which is processed
+ * as soon as more data follows, so a context that absorbed them is the
+ * midstate for any nonce.
+ */
+static __thread struct {
+	unsigned char head[76];
+	int valid;
+	sph_skein512_context cc;
+} skein512_80_mid;
+
+/* see sph_skein.h */
+void
+sph_skein512_80(void *dst, const void *data)
+{
+	sph_skein512_context cc;
+
+	if (!skein512_80_mid.valid
+		|| memcmp(skein512_80_mid.head, data, 76) != 0) {
+		sph_skein512_init(&skein512_80_mid.cc);
+		sph_skein512(&skein512_80_mid.cc, data, 76);
+		memcpy(skein512_80_mid.head, data, 76);
+		skein512_80_mid.valid = 1;
+	}
+	memcpy(&cc, &skein512_80_mid.cc, sizeof cc);
+	sph_skein512(&cc, (const unsigned char *)data + 76, 4);
+	sph_skein512_close(&cc, dst);
+}
+
 #endif
 
 
@@ -289,6 +289,16 @@ void sph_skein512_close(void *cc, void *dst);
 void sph_skein512_addbits_and_close(
 	void *cc, unsigned ub, unsigned n, void *dst);
 
+/**
+ * Compute the Skein-512 hash of an 80 byte block header. The Skein-512
+ * state after the nonce invariant first block is computed when the first
+ * 76 bytes change, and kept for the calling thread.
+ *
+ * @param dst    the destination buffer (64 bytes)
+ * @param data   the 80 byte header
+ */
+void sph_skein512_80(void *dst, const void *data);
+
 #endif
 
 #ifdef __cplusplus
@@ -1,5 +1,6 @@
 #include <miner.h>
 #include "algo-gate-api.h"
+#include "stage-profile.h"
 
 #include <stdlib.h>
 #include <stdint.h>
@@ -118,14 +119,21 @@ void init_tt_ctx()
 #endif
 };
 
+#ifdef STAGE_PROFILE
+static const char* const tt_stage_names[HASH_FUNC_COUNT] =
+ { "blake", "bmw", "groestl", "skein", "jh", "keccak", "luffa", "cubehash" };
+#endif
+
 void timetravel_hash(void *output, const void *input)
 {
+   PROF_BEGIN;
    uint32_t _ALIGN(64) hash[128]; // 16 bytes * HASH_FUNC_COUNT
    uint32_t *hashA, *hashB;
    uint32_t dataLen = 64;
    uint32_t *work_data = (uint32_t *)input;
    tt_ctx_holder ctx;
    memcpy( &ctx, &tt_ctx, sizeof(tt_ctx) );
+   PROF_STAGE( 0, "ctx copy" );
    int i;
    const int midlen = 64;            // bytes
    const int tail   = 80 - midlen;   // 16
@@ -267,8 +275,11 @@ void timetravel_hash(void *output, const void *input)
      default:
 	break;
     }
+    // stages are counted by function, not by position in the chain
+    PROF_STAGE( 1 + permutation[i], tt_stage_names[ permutation[i] ] );
   }
 
+   PROF_END;
 	memcpy(output, &hash[16 * (HASH_FUNC_COUNT - 1)], 32);
 }
 
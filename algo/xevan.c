@@ -1,5 +1,6 @@
 #include <miner.h>
 #include "algo-gate-api.h"
+#include "stage-profile.h"
 
 #include <stdlib.h>
 #include <stdint.h>
@@ -24,11 +25,10 @@
 
 #ifdef NO_AES_NI
   #include "algo/groestl/sph_groestl.h"
-  #include "algo/echo/sph_echo.h"
 #else
   #include "algo/groestl/aes_ni/hash-groestl.h"
-  #include "algo/echo/aes_ni/hash_api.h"
 #endif
+#include "algo/echo/aes_ni/hash_api.h"
 
 typedef struct {
         sph_blake512_context    blake;
@@ -46,11 +46,10 @@ typedef struct {
         sph_whirlpool_context   whirlpool;
         sph_sha512_context      sha512;
         sph_haval256_5_context  haval;
+        hashState_echo          echo;
 #ifdef NO_AES_NI
         sph_groestl512_context  groestl;
-        sph_echo512_context     echo;
 #else
-        hashState_echo          echo;
         hashState_groestl       groestl;
 #endif
 } xevan_ctx_holder;
@@ -75,12 +74,11 @@ void init_xevan_ctx()
         sph_whirlpool_init( &xevan_ctx.whirlpool );
         sph_sha512_init(&xevan_ctx.sha512);
         sph_haval256_5_init(&xevan_ctx.haval);
+        init_echo( &xevan_ctx.echo, 512 );
 #ifdef NO_AES_NI
         sph_groestl512_init( &xevan_ctx.groestl );
-        sph_echo512_init( &xevan_ctx.echo );
 #else
         init_groestl( &xevan_ctx.groestl, 64 );
-        init_echo( &xevan_ctx.echo, 512 );
 #endif
 };
 
@@ -94,6 +92,7 @@ void xevan_hash(void *output, const void *input)
 {
         uint32_t _ALIGN(64) hash[32]; // 128 bytes required
 	const int dataLen = 128;
+        PROF_BEGIN;
         xevan_ctx_holder ctx;
         memcpy( &ctx, &xevan_ctx, sizeof(xevan_ctx) );
 
@@ -101,135 +100,164 @@ void xevan_hash(void *output, const void *input)
         const int tail   = 80 - midlen;   // 16
 
         memcpy( &ctx.blake, &xevan_blake_mid, sizeof xevan_blake_mid );
+        PROF_STAGE( 0, "ctx copy" );
         sph_blake512( &ctx.blake, input + midlen, tail );
 
 //	sph_blake512(&ctx.blake, input, 80);
 	sph_blake512_close(&ctx.blake, hash);
+	PROF_STAGE( 1, "blake" );
 
 	memset(&hash[16], 0, 64);
 
 	sph_bmw512(&ctx.bmw, hash, dataLen);
 	sph_bmw512_close(&ctx.bmw, hash);
+	PROF_STAGE( 2, "bmw" );
 
 #ifdef NO_AES_NI
 	sph_groestl512(&ctx.groestl, hash, dataLen);
 	sph_groestl512_close(&ctx.groestl, hash);
+	PROF_STAGE( 3, "groestl" );
 #else
         update_and_final_groestl( &ctx.groestl, (char*)hash, 
                                   (const char*)hash, dataLen*8 );
+        PROF_STAGE( 3, "groestl" );
 #endif
 
 	sph_skein512(&ctx.skein, hash, dataLen);
 	sph_skein512_close(&ctx.skein, hash);
+	PROF_STAGE( 4, "skein" );
 
 	sph_jh512(&ctx.jh, hash, dataLen);
 	sph_jh512_close(&ctx.jh, hash);
+	PROF_STAGE( 5, "jh" );
 
 	sph_keccak512(&ctx.keccak, hash, dataLen);
 	sph_keccak512_close(&ctx.keccak, hash);
+	PROF_STAGE( 6, "keccak" );
 
         update_and_final_luffa( &ctx.luffa, (BitSequence*)hash,
                                 (const BitSequence*)hash, dataLen );
+        PROF_STAGE( 7, "luffa" );
 
         cubehashUpdateDigest( &ctx.cubehash, (byte*)hash,
                               (const byte*) hash, dataLen );
+        PROF_STAGE( 8, "cubehash" );
 
 	sph_shavite512(&ctx.shavite, hash, dataLen);
 	sph_shavite512_close(&ctx.shavite, hash);
+	PROF_STAGE( 9, "shavite" );
 
         update_final_sd( &ctx.simd, (BitSequence *)hash,
                          (const BitSequence *)hash, dataLen*8 );
+        PROF_STAGE( 10, "simd" );
 
-#ifdef NO_AES_NI
-	sph_echo512(&ctx.echo, hash, dataLen);
-	sph_echo512_close(&ctx.echo, hash);
-#else
         update_final_echo( &ctx.echo, (BitSequence *) hash, 
                            (const BitSequence *) hash, dataLen*8 );
-#endif
+        PROF_STAGE( 11, "echo" );
 
 	sph_hamsi512(&ctx.hamsi, hash, dataLen);
 	sph_hamsi512_close(&ctx.hamsi, hash);
+	PROF_STAGE( 12, "hamsi" );
 
 	sph_fugue512(&ctx.fugue, hash, dataLen);
 	sph_fugue512_close(&ctx.fugue, hash);
+	PROF_STAGE( 13, "fugue" );
 
 	sph_shabal512(&ctx.shabal, hash, dataLen);
 	sph_shabal512_close(&ctx.shabal, hash);
+	PROF_STAGE( 14, "shabal" );
 
 	sph_whirlpool(&ctx.whirlpool, hash, dataLen);
 	sph_whirlpool_close(&ctx.whirlpool, hash);
+	PROF_STAGE( 15, "whirlpool" );
 
 	sph_sha512(&ctx.sha512,(const void*) hash, dataLen);
 	sph_sha512_close(&ctx.sha512,(void*) hash);
+	PROF_STAGE( 16, "sha512" );
 
 	sph_haval256_5(&ctx.haval,(const void*) hash, dataLen);
 	sph_haval256_5_close(&ctx.haval, hash);
+	PROF_STAGE( 17, "haval" );
 
 	memset(&hash[8], 0, dataLen - 32);
 
         memcpy( &ctx, &xevan_ctx, sizeof(xevan_ctx) );
+        PROF_STAGE( 0, "ctx copy" );
 
 	sph_blake512(&ctx.blake, hash, dataLen);
 	sph_blake512_close(&ctx.blake, hash);
+	PROF_STAGE( 1, "blake" );
 
 	sph_bmw512(&ctx.bmw, hash, dataLen);
 	sph_bmw512_close(&ctx.bmw, hash);
+	PROF_STAGE( 2, "bmw" );
 
 #ifdef NO_AES_NI
         sph_groestl512(&ctx.groestl, hash, dataLen);
         sph_groestl512_close(&ctx.groestl, hash);
+        PROF_STAGE( 3, "groestl" );
 #else
         update_and_final_groestl( &ctx.groestl, (char*)hash,
                                   (const BitSequence*)hash, dataLen*8 );
+        PROF_STAGE( 3, "groestl" );
 #endif
 
 	sph_skein512(&ctx.skein, hash, dataLen);
 	sph_skein512_close(&ctx.skein, hash);
+	PROF_STAGE( 4, "skein" );
 
 	sph_jh512(&ctx.jh, hash, dataLen);
 	sph_jh512_close(&ctx.jh, hash);
+	PROF_STAGE( 5, "jh" );
 
 	sph_keccak512(&ctx.keccak, hash, dataLen);
 	sph_keccak512_close(&ctx.keccak, hash);
+	PROF_STAGE( 6, "keccak" );
         update_and_final_luffa( &ctx.luffa, (BitSequence*)hash,
                                 (const BitSequence*)hash, dataLen );
+        PROF_STAGE( 7, "luffa" );
 
         cubehashUpdateDigest( &ctx.cubehash, (byte*)hash,
                               (const byte*) hash, dataLen );
+        PROF_STAGE( 8, "cubehash" );
 
 	sph_shavite512(&ctx.shavite, hash, dataLen);
 	sph_shavite512_close(&ctx.shavite, hash);
+	PROF_STAGE( 9, "shavite" );
 
         update_final_sd( &ctx.simd, (BitSequence *)hash,
                          (const BitSequence *)hash, dataLen*8 );
+        PROF_STAGE( 10, "simd" );
 
-#ifdef NO_AES_NI
-        sph_echo512(&ctx.echo, hash, dataLen);
-        sph_echo512_close(&ctx.echo, hash);
-#else
         update_final_echo( &ctx.echo, (BitSequence *) hash,
                            (const BitSequence *) hash, dataLen*8 );
-#endif
+        PROF_STAGE( 11, "echo" );
 
 	sph_hamsi512(&ctx.hamsi, hash, dataLen);
 	sph_hamsi512_close(&ctx.hamsi, hash);
+	PROF_STAGE( 12, "hamsi" );
 
 	sph_fugue512(&ctx.fugue, hash, dataLen);
 	sph_fugue512_close(&ctx.fugue, hash);
+	PROF_STAGE( 13, "fugue" );
 
 	sph_shabal512(&ctx.shabal, hash, dataLen);
 	sph_shabal512_close(&ctx.shabal, hash);
+	PROF_STAGE( 14, "shabal" );
 
 	sph_whirlpool(&ctx.whirlpool, hash, dataLen);
 	sph_whirlpool_close(&ctx.whirlpool, hash);
+	PROF_STAGE( 15, "whirlpool" );
 
 	sph_sha512(&ctx.sha512,(const void*) hash, dataLen);
 	sph_sha512_close(&ctx.sha512,(void*) hash);
+	PROF_STAGE( 16, "sha512" );
 
 	sph_haval256_5(&ctx.haval,(const void*) hash, dataLen);
 	sph_haval256_5_close(&ctx.haval, hash);
+	PROF_STAGE( 17, "haval" );
 
+	PROF_END;
 	memcpy(output, hash, 32);
 }
 
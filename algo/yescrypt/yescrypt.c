@@ -49,6 +49,13 @@ int64_t yescrypt_get_max64 ()
   return 0x1ffLL;
 }
 
+// V of yescrypt_hash, N 2048 and r 8
+void yescrypt_scratch_size( uint64_t *per_thread, uint64_t *shared )
+{
+   *per_thread = 2048 * 8 * 128;
+   *shared = 0;
+}
+
 bool register_yescrypt_algo ( algo_gate_t* gate )
 {
    gate->scanhash   = (void*)&scanhash_yescrypt;
@@ -56,6 +63,7 @@ bool register_yescrypt_algo ( algo_gate_t* gate )
    gate->hash_alt   = (void*)&yescrypthash;
    gate->set_target = (void*)&scrypt_set_target;
    gate->get_max64  = (void*)&yescrypt_get_max64;
+   gate->scratch_size = (void*)&yescrypt_scratch_size;
    return true;
 }
 
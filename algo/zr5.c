@@ -106,8 +106,7 @@ static const int arrOrder[][4] =
     zr5_ctx_holder ctx;
     memcpy( &ctx, &zr5_ctx, sizeof(zr5_ctx) );
 
-    sph_keccak512 (&ctx.keccak, input, 80);
-    sph_keccak512_close(&ctx.keccak, hash);
+    sph_keccak512_80( hash, input );
   
     unsigned int nOrder = *(unsigned int *)(&hash) % 24;
     unsigned int i = 0;
@@ -0,0 +1,623 @@
+/**
+ * cpuminer-bench, hash primitive microbenchmark
+ *
+ * Times each hash primitive of the tree alone on 32, 64, 80 and 128 byte
+ * messages: the sph reference code, the sse2 and aes_ni implementations
+ * used by the algos and the multi-way sha256 and scrypt kernels. The
+ * benchmark thread is pinned to one cpu, every measurement is warmed up
+ * and repeated, and results are printed as one line per primitive and
+ * length so runs can be diffed against each other.
+ *
+ * Build with "make cpuminer-bench", it is not part of the default target.
+ *
+ * Cycles are read with rdtsc, they are reference cycles and not core
+ * cycles when the clock is scaled. Fix the frequency for stable numbers.
+ */
+
+#include <cpuminer-config.h>
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "miner.h"
+
+#ifdef __linux
+#include <sched.h>
+#endif
+
+#include "algo/blake/sph_blake.h"
+#include "algo/bmw/sph_bmw.h"
+#include "algo/groestl/sph_groestl.h"
+#include "algo/skein/sph_skein.h"
+#include "algo/jh/sph_jh.h"
+#include "algo/keccak/sph_keccak.h"
+#include "algo/luffa/sph_luffa.h"
+#include "algo/cubehash/sph_cubehash.h"
+#include "algo/shavite/sph_shavite.h"
+#include "algo/simd/sph_simd.h"
+#include "algo/echo/sph_echo.h"
+#include "algo/hamsi/sph_hamsi.h"
+#include "algo/fugue/sph_fugue.h"
+#include "algo/shabal/sph_shabal.h"
+#include "algo/whirlpool/sph_whirlpool.h"
+#include "algo/sha3/sph_sha2.h"
+#include "algo/haval/sph-haval.h"
+#include "algo/gost/sph_gost.h"
+#include "algo/ripemd/sph_ripemd.h"
+#include "algo/tiger/sph_tiger.h"
+#include "algo/hash64.h"
+
+#include "algo/luffa/sse2/luffa_for_sse2.h"
+#include "algo/cubehash/sse2/cubehash_sse2.h"
+#include "algo/simd/sse2/nist.h"
+#ifndef NO_AES_NI
+#include "algo/groestl/aes_ni/hash-groestl.h"
+#include "algo/echo/aes_ni/hash_api.h"
+#endif
+
+#if defined(USE_ASM) && defined(__x86_64__)
+#define HAVE_SCRYPT_3WAY 1
+int scrypt_best_throughput();
+void scrypt_core(uint32_t *X, uint32_t *V, int N);
+void scrypt_core_3way(uint32_t *X, uint32_t *V, int N);
+#if defined(USE_AVX2)
+#define HAVE_SCRYPT_6WAY 1
+void scrypt_core_6way(uint32_t *X, uint32_t *V, int N);
+#endif
+#elif defined(USE_ASM)
+void scrypt_core(uint32_t *X, uint32_t *V, int N);
+#endif
+
+#define SCRYPT_N      1024
+#define MAX_OUT       64
+#define MAX_LANES     8
+
+static const int bench_lens[] = { 32, 64, 80, 128 };
+#define NUM_LENS (int)(sizeof(bench_lens) / sizeof(bench_lens[0]))
+
+struct bench_prim {
+	const char *name;
+	const char *impl;
+	int lanes;           /* messages hashed per call */
+	int fixed_len;       /* 0 for any length */
+	int out_len;
+	size_t ctx_size;
+	const char *ref;     /* impl whose output this one must match */
+	void (*run)(void *ctx, void *out, const void *in, size_t len);
+	bool (*avail)();
+};
+
+/* sph reference implementations, one complete hash per call */
+
+#define SPH_BENCH(fn) \
+static void bench_sph_##fn(void *cc, void *out, const void *in, size_t len) \
+{ \
+	sph_##fn##_init(cc); \
+	sph_##fn(cc, in, len); \
+	sph_##fn##_close(cc, out); \
+}
+
+SPH_BENCH(blake256)
+SPH_BENCH(blake512)
+SPH_BENCH(bmw256)
+SPH_BENCH(bmw512)
+SPH_BENCH(groestl256)
+SPH_BENCH(groestl512)
+SPH_BENCH(skein256)
+SPH_BENCH(skein512)
+SPH_BENCH(jh512)
+SPH_BENCH(keccak256)
+SPH_BENCH(keccak512)
+SPH_BENCH(luffa512)
+SPH_BENCH(cubehash256)
+SPH_BENCH(cubehash512)
+SPH_BENCH(shavite512)
+SPH_BENCH(simd512)
+SPH_BENCH(echo512)
+SPH_BENCH(hamsi512)
+SPH_BENCH(fugue512)
+SPH_BENCH(shabal256)
+SPH_BENCH(shabal512)
+SPH_BENCH(whirlpool)
+SPH_BENCH(sha256)
+SPH_BENCH(sha512)
+SPH_BENCH(haval256_5)
+SPH_BENCH(gost512)
+SPH_BENCH(ripemd160)
+SPH_BENCH(tiger)
+
+/*
+ * 80 byte headers with the nonce invariant part precomputed, as the first
+ * stage of a chain sees them, the precompute is done once per header.
+ */
+
+#define HDR80_BENCH(fn) \
+static void bench_80_##fn(void *cc, void *out, const void *in, size_t len) \
+{ \
+	sph_##fn##_80(out, in); \
+}
+
+HDR80_BENCH(blake512)
+HDR80_BENCH(bmw512)
+HDR80_BENCH(skein512)
+HDR80_BENCH(keccak512)
+
+/* one shot 64 byte chain stages, see algo/hash64.h */
+
+#define HASH64_BENCH(fn) \
+static void bench_64_##fn(void *cc, void *out, const void *in, size_t len) \
+{ \
+	fn##_hash64(out, in); \
+}
+
+HASH64_BENCH(blake512)
+HASH64_BENCH(bmw512)
+HASH64_BENCH(groestl512)
+HASH64_BENCH(skein512)
+HASH64_BENCH(jh512)
+HASH64_BENCH(keccak512)
+HASH64_BENCH(luffa512)
+HASH64_BENCH(cubehash512)
+HASH64_BENCH(shavite512)
+HASH64_BENCH(simd512)
+HASH64_BENCH(echo512)
+HASH64_BENCH(hamsi512)
+HASH64_BENCH(fugue512)
+HASH64_BENCH(shabal512)
+HASH64_BENCH(whirlpool)
+HASH64_BENCH(sha512)
+HASH64_BENCH(haval256_5)
+HASH64_BENCH(gost512)
+
+/* the sse2 and aes_ni implementations, as called by the algos */
+
+static void bench_luffa_sse2(void *cc, void *out, const void *in, size_t len)
+{
+	init_luffa((hashState_luffa*) cc, 512);
+	update_and_final_luffa((hashState_luffa*) cc, (BitSequence*) out,
+		(const BitSequence*) in, len);
+}
+
+static void bench_cubehash_sse2(void *cc, void *out, const void *in, size_t len)
+{
+	cubehashInit((cubehashParam*) cc, 512, 16, 32);
+	cubehashUpdateDigest((cubehashParam*) cc, (byte*) out, (const byte*) in,
+		len);
+}
+
+static void bench_simd_sse2(void *cc, void *out, const void *in, size_t len)
+{
+	init_sd((hashState_sd*) cc, 512);
+	update_final_sd((hashState_sd*) cc, (BitSequence*) out,
+		(const BitSequence*) in, len * 8);
+}
+
+#ifndef NO_AES_NI
+static void bench_groestl_aes(void *cc, void *out, const void *in, size_t len)
+{
+	init_groestl((hashState_groestl*) cc, 64);
+	update_and_final_groestl((hashState_groestl*) cc, (char*) out,
+		(const char*) in, len * 8);
+}
+
+static void bench_echo_aes(void *cc, void *out, const void *in, size_t len)
+{
+	init_echo((hashState_echo*) cc, 512);
+	update_final_echo((hashState_echo*) cc, (BitSequence*) out,
+		(const BitSequence*) in, len * 8);
+}
+#endif
+
+/* sha256d, reference and multi-way. The lanes all hash the same message. */
+
+static void bench_sha256d_sph(void *cc, void *out, const void *in, size_t len)
+{
+	sph_sha256_init(cc);
+	sph_sha256(cc, in, len);
+	sph_sha256_close(cc, out);
+	sph_sha256_init(cc);
+	sph_sha256(cc, out, 32);
+	sph_sha256_close(cc, out);
+}
+
+#ifdef HAVE_SHA256_4WAY
+static void sha256d_nway(int lanes, void (*init)(uint32_t*),
+	void (*transform)(uint32_t*, const uint32_t*, int),
+	void *out, const void *in, size_t len)
+{
+	uint32_t _ALIGN(32) state[8 * MAX_LANES];
+	uint32_t _ALIGN(32) blk[16 * MAX_LANES];
+	unsigned char msg[192];
+	uint32_t *w = (uint32_t*) msg;
+	int blocks = (int) (len + 9 + 63) / 64;
+	uint64_t bits = (uint64_t) len * 8;
+
+	/* pad the message, big endian length in the last 8 bytes */
+	memcpy(msg, in, len);
+	memset(msg + len, 0, blocks * 64 - len);
+	msg[len] = 0x80;
+	for (int i = 0; i < 8; i++)
+		msg[blocks * 64 - 1 - i] = (unsigned char) (bits >> (8 * i));
+
+	init(state);
+	for (int b = 0; b < blocks; b++) {
+		for (int i = 0; i < 16; i++)
+			for (int l = 0; l < lanes; l++)
+				blk[i * lanes + l] = w[b * 16 + i];
+		transform(state, blk, 1);
+	}
+
+	/* second hash of the 32 byte digest, already in host order */
+	memcpy(blk, state, 32 * lanes);
+	init(state);
+	for (int l = 0; l < lanes; l++) {
+		blk[8 * lanes + l] = 0x80000000;
+		for (int i = 9; i < 15; i++)
+			blk[i * lanes + l] = 0;
+		blk[15 * lanes + l] = 256;
+	}
+	transform(state, blk, 0);
+
+	for (int i = 0; i < 8; i++)
+		be32enc((uint32_t*) out + i, state[i * lanes]);
+}
+
+static void bench_sha256d_4way(void *cc, void *out, const void *in, size_t len)
+{
+	sha256d_nway(4, sha256_init_4way, sha256_transform_4way, out, in, len);
+}
+
+static bool avail_4way() { return sha256_use_4way() != 0; }
+#endif
+
+#ifdef HAVE_SHA256_8WAY
+static void bench_sha256d_8way(void *cc, void *out, const void *in, size_t len)
+{
+	sha256d_nway(8, sha256_init_8way, sha256_transform_8way, out, in, len);
+}
+
+static bool avail_8way() { return sha256_use_8way() != 0; }
+#endif
+
+/* scrypt(1024,1,1) core on one 128 byte block per lane, ctx is V */
+
+#ifdef USE_ASM
+static void scrypt_lanes(int lanes, void (*core)(uint32_t*, uint32_t*, int),
+	void *cc, void *out, const void *in)
+{
+	uint32_t _ALIGN(64) X[32 * 6];
+	uint32_t *V = (uint32_t*) (((uintptr_t) cc + 63) & ~(uintptr_t) 63);
+
+	for (int l = 0; l < lanes; l++)
+		memcpy(X + 32 * l, in, 128);
+	core(X, V, SCRYPT_N);
+	memcpy(out, X, MAX_OUT);
+}
+
+static void bench_scrypt_1way(void *cc, void *out, const void *in, size_t len)
+{
+	scrypt_lanes(1, scrypt_core, cc, out, in);
+}
+#endif
+
+#ifdef HAVE_SCRYPT_3WAY
+static void bench_scrypt_3way(void *cc, void *out, const void *in, size_t len)
+{
+	scrypt_lanes(3, scrypt_core_3way, cc, out, in);
+}
+#endif
+
+#ifdef HAVE_SCRYPT_6WAY
+static void bench_scrypt_6way(void *cc, void *out, const void *in, size_t len)
+{
+	scrypt_lanes(6, scrypt_core_6way, cc, out, in);
+}
+
+static bool avail_scrypt_6way() { return scrypt_best_throughput() >= 24; }
+#endif
+
+#define SPH(n, fn, out) \
+	{ n, "sph", 1, 0, out, sizeof(sph_##fn##_context), NULL, bench_sph_##fn, NULL }
+
+#define HASH64(n, fn, out) \
+	{ n, "hash64", 1, 64, out, 64, "sph", bench_64_##fn, NULL }
+
+static const struct bench_prim prims[] =
+{
+	SPH("blake256",   blake256,   32),
+	SPH("blake512",   blake512,   64),
+	HASH64("blake512",    blake512,    64),
+	SPH("bmw256",     bmw256,     32),
+	{ "blake512", "hdr80", 1, 80, 64, 64, "sph", bench_80_blake512, NULL },
+	SPH("bmw512",     bmw512,     64),
+	HASH64("bmw512",      bmw512,      64),
+	{ "bmw512", "hdr80", 1, 80, 64, 64, "sph", bench_80_bmw512, NULL },
+	SPH("groestl256", groestl256, 32),
+	SPH("groestl512", groestl512, 64),
+	HASH64("groestl512",  groestl512,  64),
+#ifndef NO_AES_NI
+	{ "groestl512", "aes_ni", 1, 0, 64, sizeof(hashState_groestl), "sph",
+	  bench_groestl_aes, NULL },
+#endif
+	SPH("skein256",   skein256,   32),
+	SPH("skein512",   skein512,   64),
+	HASH64("skein512",    skein512,    64),
+	{ "skein512", "hdr80", 1, 80, 64, 64, "sph", bench_80_skein512, NULL },
+	SPH("jh512",      jh512,      64),
+	HASH64("jh512",       jh512,       64),
+	SPH("keccak256",  keccak256,  32),
+	SPH("keccak512",  keccak512,  64),
+	HASH64("keccak512",   keccak512,   64),
+	{ "keccak512", "hdr80", 1, 80, 64, 64, "sph", bench_80_keccak512, NULL },
+	SPH("luffa512",   luffa512,   64),
+	HASH64("luffa512",    luffa512,    64),
+	{ "luffa512", "sse2", 1, 0, 64, sizeof(hashState_luffa), "sph",
+	  bench_luffa_sse2, NULL },
+	SPH("cubehash256", cubehash256, 32),
+	SPH("cubehash512", cubehash512, 64),
+	HASH64("cubehash512", cubehash512, 64),
+	{ "cubehash512", "sse2", 1, 0, 64, sizeof(cubehashParam), "sph",
+	  bench_cubehash_sse2, NULL },
+	SPH("shavite512", shavite512, 64),
+	HASH64("shavite512",  shavite512,  64),
+	SPH("simd512",    simd512,    64),
+	HASH64("simd512",     simd512,     64),
+	{ "simd512", "sse2", 1, 0, 64, sizeof(hashState_sd), "sph",
+	  bench_simd_sse2, NULL },
+	SPH("echo512",    echo512,    64),
+	HASH64("echo512",     echo512,     64),
+#ifndef NO_AES_NI
+	{ "echo512", "aes_ni", 1, 0, 64, sizeof(hashState_echo), "sph",
+	  bench_echo_aes, NULL },
+#endif
+	SPH("hamsi512",   hamsi512,   64),
+	HASH64("hamsi512",    hamsi512,    64),
+	SPH("fugue512",   fugue512,   64),
+	HASH64("fugue512",    fugue512,    64),
+	SPH("shabal256",  shabal256,  32),
+	SPH("shabal512",  shabal512,  64),
+	HASH64("shabal512",   shabal512,   64),
+	SPH("whirlpool",  whirlpool,  64),
+	HASH64("whirlpool",   whirlpool,   64),
+	SPH("sha256",     sha256,     32),
+	SPH("sha512",     sha512,     64),
+	HASH64("sha512",      sha512,      64),
+	SPH("haval256_5", haval256_5, 32),
+	HASH64("haval256_5",  haval256_5,  32),
+	SPH("gost512",    gost512,    64),
+	HASH64("gost512",     gost512,     64),
+	SPH("ripemd160",  ripemd160,  20),
+	SPH("tiger",      tiger,      24),
+	{ "sha256d", "sph", 1, 0, 32, sizeof(sph_sha256_context), NULL,
+	  bench_sha256d_sph, NULL },
+#ifdef HAVE_SHA256_4WAY
+	{ "sha256d", "4way", 4, 0, 32, 64, "sph",
+	  bench_sha256d_4way, avail_4way },
+#endif
+#ifdef HAVE_SHA256_8WAY
+	{ "sha256d", "8way", 8, 0, 32, 64, "sph",
+	  bench_sha256d_8way, avail_8way },
+#endif
+#ifdef USE_ASM
+	{ "scrypt_core", "asm", 1, 128, 64, 128 * SCRYPT_N + 63, NULL,
+	  bench_scrypt_1way, NULL },
+#endif
+#ifdef HAVE_SCRYPT_3WAY
+	{ "scrypt_core", "3way", 3, 128, 64, 3 * 128 * SCRYPT_N + 63, "asm",
+	  bench_scrypt_3way, NULL },
+#endif
+#ifdef HAVE_SCRYPT_6WAY
+	{ "scrypt_core", "6way", 6, 128, 64, 6 * 128 * SCRYPT_N + 63, "asm",
+	  bench_scrypt_6way, avail_scrypt_6way },
+#endif
+};
+#define NUM_PRIMS (int)(sizeof(prims) / sizeof(prims[0]))
+
+static int opt_cpu = 0;
+static int opt_repeats = 9;
+static int opt_run_ms = 50;
+static int opt_warmup_ms = 100;
+static bool opt_csv = false;
+
+static inline uint64_t bench_ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	uint32_t lo, hi;
+	__asm__ __volatile__ ("lfence\n\trdtsc" : "=a"(lo), "=d"(hi) :: "memory");
+	return ((uint64_t) hi << 32) | lo;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static double bench_now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double*) a, y = *(const double*) b;
+	return x < y ? -1 : x > y;
+}
+
+/*
+ * Warm up for opt_warmup_ms and size the run so it lasts about opt_run_ms,
+ * then time opt_repeats runs. Results are ticks per call.
+ */
+static void bench_one(const struct bench_prim *p, void *ctx, const void *in,
+	int len, double *res)
+{
+	unsigned char _ALIGN(64) out[MAX_OUT];
+	double t0 = bench_now(), t;
+	long calls = 0, iters;
+
+	do {
+		p->run(ctx, out, in, len);
+		calls++;
+	} while ((t = bench_now() - t0) < opt_warmup_ms * 1e-3);
+
+	iters = (long) (calls * (opt_run_ms * 1e-3) / t);
+	if (iters < 1)
+		iters = 1;
+
+	for (int r = 0; r < opt_repeats; r++) {
+		uint64_t c0 = bench_ticks();
+		for (long i = 0; i < iters; i++)
+			p->run(ctx, out, in, len);
+		res[r] = (double) (bench_ticks() - c0) / iters;
+	}
+}
+
+/* "ok" if the output matches the reference impl, "-" if there is none */
+static const char *bench_check(const struct bench_prim *p, void *ctx,
+	const void *in, int len)
+{
+	unsigned char _ALIGN(64) out[MAX_OUT], ref[MAX_OUT];
+	int n = p->out_len;
+
+	if (!p->ref)
+		return "-";
+	for (int k = 0; k < NUM_PRIMS; k++) {
+		const struct bench_prim *q = &prims[k];
+		if (strcmp(q->name, p->name) || strcmp(q->impl, p->ref))
+			continue;
+		void *qctx = _mm_malloc(q->ctx_size, 64);
+		memset(out, 0, sizeof(out));
+		memset(ref, 0, sizeof(ref));
+		q->run(qctx, ref, in, len);
+		p->run(ctx, out, in, len);
+		_mm_free(qctx);
+		return memcmp(out, ref, n) ? "DIFFERS" : "ok";
+	}
+	return "-";
+}
+
+static void bench_pin(int cpu)
+{
+#ifdef __linux
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	if (sched_setaffinity(0, sizeof(set), &set))
+		fprintf(stderr, "could not pin to cpu %d\n", cpu);
+#endif
+}
+
+static bool bench_match(const struct bench_prim *p, int argc, char **argv)
+{
+	char full[64];
+	if (!argc)
+		return true;
+	snprintf(full, sizeof(full), "%s/%s", p->name, p->impl);
+	for (int i = 0; i < argc; i++)
+		if (strstr(full, argv[i]))
+			return true;
+	return false;
+}
+
+static void show_usage(const char *prog)
+{
+	printf("Usage: %s [OPTIONS] [FILTER...]\n"
+		"Times the hash primitives on %d, %d, %d and %d byte messages.\n"
+		"FILTER selects primitives by substring of name/impl, ie sha256d/4way.\n"
+		"\n"
+		"  -c N   cpu to pin the benchmark to (default %d)\n"
+		"  -r N   timed runs per primitive and length (default %d)\n"
+		"  -t N   length of a timed run in ms (default %d)\n"
+		"  -w N   warmup in ms (default %d)\n"
+		"  -C     comma separated output\n"
+		"  -h     this help\n"
+		"\n"
+		"Columns: primitive, impl, lanes, bytes, cycles per hash (median),\n"
+		"cycles per byte, min and max of the runs, output check against the\n"
+		"reference impl. Multi-way results are per lane.\n",
+		prog, bench_lens[0], bench_lens[1], bench_lens[2], bench_lens[3],
+		opt_cpu, opt_repeats, opt_run_ms, opt_warmup_ms);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *fmt_head, *fmt_row;
+	double res[64];
+	unsigned char _ALIGN(64) in[128];
+	int c;
+
+	while ((c = getopt(argc, argv, "c:r:t:w:Ch")) != -1) {
+		switch (c) {
+		case 'c': opt_cpu = atoi(optarg); break;
+		case 'r': opt_repeats = atoi(optarg); break;
+		case 't': opt_run_ms = atoi(optarg); break;
+		case 'w': opt_warmup_ms = atoi(optarg); break;
+		case 'C': opt_csv = true; break;
+		default:
+			show_usage(argv[0]);
+			return c == 'h' ? 0 : 1;
+		}
+	}
+	if (opt_repeats < 1 || opt_repeats > 64 || opt_run_ms < 1) {
+		show_usage(argv[0]);
+		return 1;
+	}
+
+	if (opt_csv) {
+		fmt_head = "primitive,impl,lanes,bytes,cycles_per_hash,"
+			"cycles_per_byte,min,max,check\n";
+		fmt_row = "%s,%s,%d,%d,%.1f,%.2f,%.1f,%.1f,%s\n";
+	} else {
+		fmt_head = "# %-12s %-7s %5s %5s %12s %10s %12s %12s  %s\n";
+		fmt_row = "%-14s %-7s %5d %5d %12.1f %10.2f %12.1f %12.1f  %s\n";
+	}
+
+	bench_pin(opt_cpu);
+
+	/* fixed pseudo random message so runs are comparable */
+	for (int i = 0; i < (int) sizeof(in); i++)
+		in[i] = (unsigned char) (i * 131 + 17);
+
+	printf(fmt_head, "primitive", "impl", "lanes", "bytes", "cycles/hash",
+		"cycles/B", "min", "max", "check");
+
+	for (int k = 0; k < NUM_PRIMS; k++) {
+		const struct bench_prim *p = &prims[k];
+		void *ctx;
+
+		if (!bench_match(p, argc - optind, argv + optind))
+			continue;
+		if (p->avail && !p->avail())
+			continue;
+		ctx = _mm_malloc(p->ctx_size, 64);
+		if (!ctx) {
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+
+		for (int l = 0; l < NUM_LENS; l++) {
+			int len = bench_lens[l];
+			const char *check;
+			double med;
+
+			if (p->fixed_len && len != p->fixed_len)
+				continue;
+			check = bench_check(p, ctx, in, len);
+			bench_one(p, ctx, in, len, res);
+			qsort(res, opt_repeats, sizeof(double), cmp_double);
+			for (int r = 0; r < opt_repeats; r++)
+				res[r] /= p->lanes;
+			med = res[opt_repeats / 2];
+			printf(fmt_row, p->name, p->impl, p->lanes, len, med, med / len,
+				res[0], res[opt_repeats - 1], check);
+			fflush(stdout);
+		}
+		_mm_free(ctx);
+	}
+	return 0;
+}
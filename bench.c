@@ -0,0 +1,711 @@
+/**
+ * Rigorous benchmark, --bench-reps and friends
+ *
+ * Every thread hashes the same fixed work, a fixed number of hashes per
+ * repetition after a warmup. The threads start each repetition together
+ * and the rate of a repetition is all the hashes over the time of the
+ * slowest thread. Mean, stddev, min and max are reported over the
+ * repetitions, for -t threads or for every count from 1 to -t with
+ * --bench-sweep, so a scaling cliff (memory bandwidth, shared caches, SMT)
+ * shows as a drop in efficiency. --bench-json writes the results with the
+ * cpu, kernel and huge page details needed to compare runs later.
+ *
+ * --bench-memory is for the memory hard algos, whose rate is set by the
+ * caches, TLB reach and DRAM bandwidth more than by the cores. It repeats
+ * the thread sweep for each thread placement (spread over cores and
+ * packages first, or compact on SMT siblings and one package first), with
+ * huge pages advised on and off, for scrypt with each scrypt_core
+ * width and for axiom and pluck with 1 to 8 interleaved nonces. Bytes per hash come from a model of each algo's scratchpad, the
+ * bandwidth is that times the rate. The thread count where adding a thread
+ * gains less than half a thread is reported as the scaling limit.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#include "miner.h"
+#include "algo-gate-api.h"
+#include "algo/interleave.h"
+
+#if defined(USE_ASM) && defined(__x86_64__)
+int scrypt_best_throughput();
+#endif
+extern int scrypt_ways;
+int scrypt_max_ways();
+extern uint64_t sj_N;
+
+#define BENCH_REPS       5
+#define BENCH_REP_TIME   2.0    /* seconds per repetition when calibrating */
+#define BENCH_WARMUP     10     /* percent of the hashes */
+#define BENCH_NTIME      0x58000000
+#define BENCH_BEST       0.97   /* of the best rate, for the thread count */
+#define BENCH_KNEE       0.5    /* of one thread's rate, for a thread to pay */
+
+bool opt_bench = false;
+int opt_bench_reps = BENCH_REPS;
+uint64_t opt_bench_hashes = 0;
+int64_t opt_bench_warmup = -1;
+bool opt_bench_sweep = false;
+char *opt_bench_json = NULL;
+bool opt_bench_memory = false;
+
+struct bench_thr {
+	int id;
+	int threads;
+	struct work work;
+	uint32_t first_nonce;
+	uint32_t last_nonce;
+	double *times;       /* per repetition */
+	bool ok;
+};
+
+static pthread_barrier_t bench_barrier;
+static int *bench_order = NULL;       /* cpu of each thread, or miner placement */
+static double bench_traffic = 0.;     /* bytes per hash, 0 if unknown */
+static long bench_huge_kb = -1;       /* AnonHugePages at the end of a run */
+
+static double bench_now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* the benchmark work of get_work() with a fixed ntime */
+static void bench_work(struct bench_thr *bt)
+{
+	uint32_t *data = bt->work.data;
+	uint32_t range = 0xffffffffU / bt->threads;
+
+	memset(&bt->work, 0, sizeof(bt->work));
+	for (int n = 0; n < 74; n++)
+		((char*) data)[n] = n;
+	data[17] = swab32(BENCH_NTIME);
+	memset(data + 19, 0x00, 52);
+	data[20] = 0x80000000;
+	data[31] = 0x00000280;
+
+	bt->first_nonce = range * bt->id;
+	bt->last_nonce = bt->first_nonce + range - 0x20;
+	*algo_gate.get_nonceptr(data) = bt->first_nonce;
+}
+
+/* scan count hashes, found nonces are skipped, the range wraps */
+static void bench_scan(struct bench_thr *bt, uint64_t count)
+{
+	uint32_t *np = algo_gate.get_nonceptr(bt->work.data);
+
+	while (count) {
+		uint64_t done = 0;
+		uint32_t max_nonce;
+
+		if (*np >= bt->last_nonce)
+			*np = bt->first_nonce;
+		max_nonce = bt->last_nonce - *np > count
+			? *np + (uint32_t) count : bt->last_nonce;
+		work_restart[bt->id].restart = 0;
+		algo_gate.scanhash(bt->id, &bt->work, max_nonce, &done);
+		if (done == 0)
+			done = 1;
+		count = done < count ? count - done : 0;
+		(*np)++;
+	}
+}
+
+/* huge pages backing the process, -1 if unknown */
+static long bench_anon_huge_kb()
+{
+	long kb = -1;
+#ifdef __linux__
+	char line[128];
+	FILE *fd = fopen("/proc/self/smaps_rollup", "r");
+
+	if (!fd)
+		return -1;
+	while (fgets(line, sizeof(line), fd))
+		if (sscanf(line, "AnonHugePages: %ld", &kb) == 1)
+			break;
+	fclose(fd);
+#endif
+	return kb;
+}
+
+/*
+ * Scratchpad size and bytes read and written per hash, counted from the
+ * reference algorithms. Caches absorb part of it, so the bandwidth is what
+ * the memory hierarchy delivers, not only DRAM.
+ */
+static bool bench_memory_model(int algo, double *footprint, double *traffic)
+{
+	double f, t;
+	int rows = 0, cols = 0, tcost = 0;
+
+	switch (algo) {
+	case ALGO_SCRYPT:         /* N * 128 V, written then read */
+		f = 128. * (opt_scrypt_n ? opt_scrypt_n : 1024);
+		t = 2. * f;
+		break;
+	case ALGO_SCRYPTJANE:
+		f = 128. * sj_N;
+		t = 2. * f;
+		break;
+	case ALGO_NEOSCRYPT:      /* N 128, r 2, salsa and chacha smix */
+		f = 128. * 2 * 128;
+		t = 4. * f;
+		break;
+	case ALGO_CRYPTONIGHT:    /* init, 2^19 loops of 4 x 16 bytes, final */
+		f = 1 << 21;
+		t = 2. * f + (1 << 19) * 64.;
+		break;
+	case ALGO_CRYPTOLIGHT:
+		f = 1 << 20;
+		t = 2. * f + (1 << 18) * 64.;
+		break;
+	case ALGO_YESCRYPT:       /* N 2048, r 8, smix1 then N/3 of smix2 */
+		f = 2048. * 128 * 8;
+		t = f * 8. / 3.;
+		break;
+	case ALGO_ARGON2:         /* 16 1k blocks, 2 passes of 2 reads 1 write */
+		f = 16. * 1024;
+		t = f * 7.;
+		break;
+	case ALGO_AXIOM:          /* 64k 32 byte hashes, then 2 reads 1 write */
+		f = 65536. * 32;
+		t = f * 4.;
+		break;
+	case ALGO_PLUCK:
+		f = 128. * 1024;
+		t = 2. * f;
+		break;
+	case ALGO_LYRA2RE:   rows = 8;   cols = 8;   tcost = 1; break;
+	case ALGO_LYRA2REV2: rows = 4;   cols = 4;   tcost = 1; break;
+	case ALGO_LYRA2Z:    rows = 8;   cols = 8;   tcost = 8; break;
+	case ALGO_LYRA2Z330: rows = 330; cols = 256; tcost = 2; break;
+	default:
+		return false;
+	}
+	if (rows) {
+		/* 96 byte blocks, setup and each wandering pass read and write 2 rows */
+		f = 96. * rows * cols;
+		t = f * (4. + 4. * tcost);
+	}
+	*footprint = f;
+	*traffic = t;
+	return true;
+}
+
+static void *bench_thread(void *userdata)
+{
+	struct bench_thr *bt = (struct bench_thr *) userdata;
+	uint64_t warmup = opt_bench_warmup >= 0 ? (uint64_t) opt_bench_warmup
+		: opt_bench_hashes * BENCH_WARMUP / 100;
+
+	/* same placement as the miner threads, or the one under test */
+	if (bench_order)
+		affine_to_cpu_mask(bt->id, 1UL << bench_order[bt->id % num_cpus]);
+	else if (num_cpus > 1) {
+		if (opt_affinity == -1 && bt->threads > 1)
+			affine_to_cpu_mask(bt->id, 1UL << (bt->id % num_cpus));
+		else if (opt_affinity != -1L)
+			affine_to_cpu_mask(bt->id, (unsigned long) opt_affinity);
+	}
+	bt->ok = algo_gate.miner_thread_init(bt->id);
+	bench_work(bt);
+
+	pthread_barrier_wait(&bench_barrier);
+	if (bt->ok)
+		bench_scan(bt, warmup);
+	for (int r = 0; r < opt_bench_reps; r++) {
+		double t0;
+		pthread_barrier_wait(&bench_barrier);
+		t0 = bench_now();
+		if (bt->ok)
+			bench_scan(bt, opt_bench_hashes);
+		bt->times[r] = bench_now() - t0;
+	}
+	if (bt->id == 0)
+		bench_huge_kb = bench_anon_huge_kb();
+	pthread_barrier_wait(&bench_barrier);
+	if (bt->ok)
+		algo_gate.miner_thread_free(bt->id);
+	thread_scratch_free();
+	return NULL;
+}
+
+/* hashes per thread for about BENCH_REP_TIME per repetition */
+static uint64_t bench_calibrate()
+{
+	struct bench_thr bt;
+	uint64_t count = 16;
+	double t = 0.;
+
+	memset(&bt, 0, sizeof(bt));
+	bt.threads = 1;
+	if (!algo_gate.miner_thread_init(0))
+		return 0;
+	bench_work(&bt);
+	while (count < (1ULL << 40)) {
+		double t0 = bench_now();
+		bench_scan(&bt, count);
+		t = bench_now() - t0;
+		if (t >= 0.25)
+			break;
+		count *= 2;
+	}
+	algo_gate.miner_thread_free(0);
+	thread_scratch_free();
+	return (uint64_t) (count * BENCH_REP_TIME / t) + 1;
+}
+
+static json_t *bench_run(int threads, double *mean1)
+{
+	struct bench_thr *bt = (struct bench_thr*) calloc(threads, sizeof(*bt));
+	double *rates = (double*) calloc(opt_bench_reps, sizeof(double));
+	double sum = 0., sq = 0., rmin = 0., rmax = 0., mean, sd, eff;
+	json_t *res, *jrates, *jthr;
+	char s_mean[32], s_sd[32], s_min[32], s_max[32], s_bw[32] = "";
+	bool ok = true;
+	int i, r;
+
+	if (!bt || !rates)
+		return NULL;
+	pthread_barrier_init(&bench_barrier, NULL, threads);
+	for (i = 0; i < threads; i++) {
+		bt[i].id = i;
+		bt[i].threads = threads;
+		bt[i].times = (double*) calloc(opt_bench_reps, sizeof(double));
+		if (!bt[i].times
+		    || pthread_create(&thr_info[i].pth, NULL, bench_thread, &bt[i])) {
+			applog(LOG_ERR, "bench thread %d create failed", i);
+			exit(1);
+		}
+	}
+	for (i = 0; i < threads; i++) {
+		pthread_join(thr_info[i].pth, NULL);
+		ok = ok && bt[i].ok;
+	}
+	pthread_barrier_destroy(&bench_barrier);
+	if (!ok) {
+		applog(LOG_ERR, "FAIL: thread init failed");
+		return NULL;
+	}
+
+	for (r = 0; r < opt_bench_reps; r++) {
+		double t = 0.;
+		for (i = 0; i < threads; i++)
+			if (bt[i].times[r] > t)
+				t = bt[i].times[r];
+		rates[r] = (double) opt_bench_hashes * threads / t;
+		sum += rates[r];
+		sq += rates[r] * rates[r];
+		if (r == 0 || rates[r] < rmin)
+			rmin = rates[r];
+		if (r == 0 || rates[r] > rmax)
+			rmax = rates[r];
+	}
+	mean = sum / opt_bench_reps;
+	sd = opt_bench_reps > 1
+		? sqrt(fmax(0., (sq - sum * mean) / (opt_bench_reps - 1))) : 0.;
+	/* scaling efficiency against one thread, when it was measured */
+	if (threads == 1)
+		*mean1 = mean;
+	eff = *mean1 > 0. ? mean / (*mean1 * threads) : 0.;
+
+	format_hashrate(mean, s_mean);
+	format_hashrate(sd, s_sd);
+	format_hashrate(rmin, s_min);
+	format_hashrate(rmax, s_max);
+	if (bench_traffic > 0.)
+		sprintf(s_bw, ", %.2f GB/s", mean * bench_traffic * 1e-9);
+	if (eff > 0.)
+		applog(LOG_NOTICE, "Benchmark: %2d threads %s +- %s (min %s, max %s)"
+			" %3.0f%%%s", threads, s_mean, s_sd, s_min, s_max, eff * 100.,
+			s_bw);
+	else
+		applog(LOG_NOTICE, "Benchmark: %2d threads %s +- %s (min %s, max %s)%s",
+			threads, s_mean, s_sd, s_min, s_max, s_bw);
+
+	jrates = json_array();
+	for (r = 0; r < opt_bench_reps; r++)
+		json_array_append_new(jrates, json_real(rates[r]));
+	jthr = json_array();
+	for (i = 0; i < threads; i++) {
+		double t = 0.;
+		for (r = 0; r < opt_bench_reps; r++)
+			t += bt[i].times[r];
+		json_array_append_new(jthr,
+			json_real((double) opt_bench_hashes * opt_bench_reps / t));
+		free(bt[i].times);
+	}
+	res = json_pack("{s:i, s:f, s:f, s:f, s:f}", "threads", threads,
+		"mean", mean, "stddev", sd, "min", rmin, "max", rmax);
+	if (eff > 0.)
+		json_object_set_new(res, "efficiency", json_real(eff));
+	if (bench_traffic > 0.)
+		json_object_set_new(res, "bandwidth", json_real(mean * bench_traffic));
+	if (bench_huge_kb >= 0)
+		json_object_set_new(res, "anon_huge_kb", json_integer(bench_huge_kb));
+	json_object_set_new(res, "rates", jrates);
+	json_object_set_new(res, "thread_rates", jthr);
+	free(rates);
+	free(bt);
+	return res;
+}
+
+static json_t *bench_features(bool sse2, bool aes, bool avx, bool avx2)
+{
+	json_t *a = json_array();
+	if (sse2) json_array_append_new(a, json_string("SSE2"));
+	if (aes)  json_array_append_new(a, json_string("AES"));
+	if (avx)  json_array_append_new(a, json_string("AVX"));
+	if (avx2) json_array_append_new(a, json_string("AVX2"));
+	return a;
+}
+
+static json_t *bench_kernels()
+{
+	set_t opt = algo_gate.optimizations;
+	json_t *k = json_object();
+	bool sw_sse2 = false, sw_aes = false, sw_avx = false, sw_avx2 = false;
+
+#ifdef __SSE2__
+	sw_sse2 = true;
+#endif
+#ifdef __AES__
+	sw_aes = true;
+#endif
+#ifdef __AVX__
+	sw_avx = true;
+#endif
+#ifdef __AVX2__
+	sw_avx2 = true;
+#endif
+	json_object_set_new(k, "cpu", bench_features(has_sse2(), has_aes_ni(),
+		has_avx1(), has_avx2()));
+	json_object_set_new(k, "sw", bench_features(sw_sse2, sw_aes, sw_avx,
+		sw_avx2));
+	json_object_set_new(k, "algo", bench_features(true,
+		set_incl(AES_OPT, opt), set_incl(AVX_OPT, opt),
+		set_incl(AVX2_OPT, opt)));
+#ifdef HAVE_SHA256_8WAY
+	if (sha256_use_8way())
+		json_object_set_new(k, "sha256", json_string("8way"));
+	else
+#endif
+#ifdef HAVE_SHA256_4WAY
+	if (sha256_use_4way())
+		json_object_set_new(k, "sha256", json_string("4way"));
+	else
+#endif
+		json_object_set_new(k, "sha256", json_string("1way"));
+#if defined(USE_ASM) && defined(__x86_64__)
+	json_object_set_new(k, "scrypt_ways", json_integer(scrypt_best_throughput()));
+#endif
+	return k;
+}
+
+/* transparent huge page mode and the hugetlbfs pool */
+static json_t *bench_hugepages()
+{
+	json_t *h = json_object();
+#ifdef __linux__
+	char line[256];
+	FILE *fd = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+
+	if (fd) {
+		if (fgets(line, sizeof(line), fd)) {
+			char *b = strchr(line, '['), *e = b ? strchr(b, ']') : NULL;
+			if (b && e) {
+				*e = '\0';
+				json_object_set_new(h, "thp", json_string(b + 1));
+			}
+		}
+		fclose(fd);
+	}
+	fd = fopen("/proc/meminfo", "r");
+	if (fd) {
+		long v;
+		while (fgets(line, sizeof(line), fd)) {
+			if (sscanf(line, "HugePages_Total: %ld", &v) == 1)
+				json_object_set_new(h, "total", json_integer(v));
+			else if (sscanf(line, "HugePages_Free: %ld", &v) == 1)
+				json_object_set_new(h, "free", json_integer(v));
+			else if (sscanf(line, "Hugepagesize: %ld", &v) == 1)
+				json_object_set_new(h, "size_kb", json_integer(v));
+		}
+		fclose(fd);
+	}
+#endif
+	return h;
+}
+
+/*
+ * cpus in the order threads are placed: spread takes one cpu of each core,
+ * packages in turn, before any SMT sibling, compact takes the siblings of
+ * a core and the cores of a package first. Returns false if both are the
+ * same on this host.
+ */
+static bool bench_placement(bool compact, int *order)
+{
+	long *key = (long*) calloc(num_cpus, sizeof(long));
+	bool differ = false;
+	int c, k;
+
+	if (!key)
+		return false;
+	for (c = 0; c < num_cpus; c++) {
+		int pkg = cpu_package(c), core = cpu_core(c);
+		int smt = 0, rank = 0;
+
+		/* siblings before c on the same core, cores before it in the package */
+		for (k = 0; k < c; k++) {
+			if (cpu_package(k) != pkg)
+				continue;
+			if (cpu_core(k) == core)
+				smt++;
+			else {
+				int j;
+				for (j = 0; j < k; j++)
+					if (cpu_package(j) == pkg && cpu_core(j) == cpu_core(k))
+						break;
+				if (j == k)
+					rank++;
+			}
+		}
+		if (smt || pkg)
+			differ = true;
+		key[c] = compact ? ((long) pkg << 32) | (rank << 12) | smt
+		                 : ((long) smt << 32) | (rank << 12) | pkg;
+		order[c] = c;
+	}
+	/* insertion sort, a few hundred cpus at most */
+	for (c = 1; c < num_cpus; c++)
+		for (k = c; k > 0 && key[order[k - 1]] > key[order[k]]; k--) {
+			int t = order[k];
+			order[k] = order[k - 1];
+			order[k - 1] = t;
+		}
+	free(key);
+	return differ;
+}
+
+/* thread counts first to -t, the means go to rates[n] */
+static json_t *bench_sweep(int first, double *rates)
+{
+	json_t *results = json_array();
+	double mean1 = 0.;
+
+	for (int n = first; n <= opt_n_threads; n++) {
+		json_t *res = bench_run(n, &mean1);
+		if (!res) {
+			json_decref(results);
+			return NULL;
+		}
+		if (rates)
+			rates[n] = json_real_value(json_object_get(res, "mean"));
+		json_array_append_new(results, res);
+	}
+	return results;
+}
+
+static void bench_set_hugepages(int on)
+{
+	scratch_hugepages = on;
+#if defined(__linux__) && defined(PR_SET_THP_DISABLE)
+	prctl(PR_SET_THP_DISABLE, on == 0 ? 1 : 0, 0, 0, 0);
+#endif
+}
+
+/* one sweep per placement, huge pages and scrypt or interleave width */
+static json_t *bench_memory(json_t *root)
+{
+	static const char *const place_names[] = { "spread", "compact" };
+	int *order = (int*) calloc(num_cpus, sizeof(int));
+	double *rates = (double*) calloc(opt_n_threads + 1, sizeof(double));
+	json_t *configs = json_array(), *best = NULL;
+	double best_rate = 0.;
+	int places = 1, hps = 1, ways[5] = { 0 }, nways = 1;
+	int *set_ways = &scrypt_ways;
+	const char *ways_key = "scrypt_ways";
+
+	if (!order || !rates)
+		return NULL;
+	/* --cpu-affinity fixes the placement */
+	if (opt_affinity == -1L && bench_placement(true, order))
+		places = 2;
+#ifdef __linux__
+	hps = 2;
+#endif
+	if (opt_algo == ALGO_SCRYPT) {
+		int max = scrypt_max_ways();
+		nways = 0;
+		for (int w = 1; w <= max; w = w == 1 ? 3 : w * 2)
+			ways[nways++] = w;
+	}
+	else if (opt_algo == ALGO_AXIOM || opt_algo == ALGO_PLUCK) {
+		set_ways = &opt_interleave;
+		ways_key = "interleave";
+		nways = 0;
+		for (int w = 1; w <= IL_MAX_WAYS; w *= 2)
+			ways[nways++] = w;
+	}
+
+	for (int p = 0; p < places; p++)
+	for (int h = 0; h < hps; h++)
+	for (int w = 0; w < nways; w++) {
+		const char *place = opt_affinity != -1L ? "affinity" : place_names[p];
+		int hp = hps > 1 ? !h : -1, limit = opt_n_threads, nbest = 1;
+		char s_rate[32], s_ways[16] = "";
+		json_t *results, *cfg;
+
+		if (opt_affinity == -1L) {
+			bench_placement(p == 1, order);
+			bench_order = order;
+		}
+		bench_set_hugepages(hp);
+		*set_ways = ways[w];
+		if (ways[w])
+			sprintf(s_ways, ", %d way", ways[w]);
+		applog(LOG_INFO, "Placement %s, huge pages %s%s", place,
+			hp < 0 ? "default" : hp ? "on" : "off", s_ways);
+
+		results = bench_sweep(1, rates);
+		if (!results) {
+			json_decref(configs);
+			configs = NULL;
+			break;
+		}
+		/* first thread that brings less than BENCH_KNEE of one thread */
+		for (int n = 2; n <= opt_n_threads; n++)
+			if (rates[n] - rates[n - 1] < BENCH_KNEE * rates[1]) {
+				limit = n - 1;
+				break;
+			}
+		for (int n = 1; n <= opt_n_threads; n++)
+			if (rates[n] > rates[nbest])
+				nbest = n;
+		for (int n = 1; n <= opt_n_threads; n++)
+			if (rates[n] >= BENCH_BEST * rates[nbest]) {
+				nbest = n;
+				break;
+			}
+		format_hashrate(rates[nbest], s_rate);
+		applog(LOG_NOTICE, "%s %s%s: scales to %d threads, best %d threads %s",
+			algo_names[opt_algo], place, s_ways, limit, nbest, s_rate);
+
+		cfg = json_pack("{s:s, s:i, s:i, s:i, s:f, s:o}", "placement", place,
+			"hugepages", hp, "scaling_limit", limit, "best_threads", nbest,
+			"best_rate", rates[nbest], "results", results);
+		if (ways[w])
+			json_object_set_new(cfg, ways_key, json_integer(ways[w]));
+		json_array_append_new(configs, cfg);
+		if (rates[nbest] > best_rate) {
+			best_rate = rates[nbest];
+			best = cfg;
+		}
+	}
+	if (configs && best) {
+		json_t *rec = json_deep_copy(best);
+		int hp = (int) json_integer_value(json_object_get(rec, "hugepages"));
+		int w = (int) json_integer_value(json_object_get(rec, ways_key));
+		char s_ways[16] = "";
+
+		json_object_del(rec, "results");
+		json_object_set_new(root, "recommended", rec);
+		if (w)
+			sprintf(s_ways, ", %d way", w);
+		applog(LOG_NOTICE, "Recommended: -t %d, %s placement, huge pages %s%s",
+			(int) json_integer_value(json_object_get(rec, "best_threads")),
+			json_string_value(json_object_get(rec, "placement")),
+			hp < 0 ? "default" : hp ? "on" : "off", s_ways);
+	}
+
+	bench_order = NULL;
+	bench_set_hugepages(-1);
+	*set_ways = 0;
+	free(order);
+	free(rates);
+	return configs;
+}
+
+/* runs the benchmark of opt_algo, returns non zero on error */
+int cpu_bench()
+{
+	char brand[0x40] = { 0 };
+	char affinity[32];
+	double footprint;
+	json_t *root, *results;
+
+	if (opt_algo == ALGO_HODL) {
+		applog(LOG_ERR, "hodl threads work together, it can't be benchmarked"
+			" this way");
+		return 1;
+	}
+	if (opt_bench_reps < 1)
+		opt_bench_reps = 1;
+	if (!opt_bench_hashes) {
+		opt_bench_hashes = bench_calibrate();
+		if (!opt_bench_hashes) {
+			applog(LOG_ERR, "FAIL: thread init failed");
+			return 1;
+		}
+	}
+	if (opt_affinity != -1L)
+		sprintf(affinity, "0x%llx", (unsigned long long) opt_affinity);
+	else
+		strcpy(affinity, "per thread");
+
+	applog(LOG_INFO, "Benchmark %s: %llu hashes per thread, %d repetitions",
+		algo_names[opt_algo], (unsigned long long) opt_bench_hashes,
+		opt_bench_reps);
+
+	cpu_brand_string(brand);
+	root = json_pack("{s:s, s:s, s:s, s:i, s:o, s:o, s:s, s:I, s:I, s:i}",
+		"version", PACKAGE_VERSION, "algo", algo_names[opt_algo],
+		"cpu", brand, "cpus", num_cpus, "kernels", bench_kernels(),
+		"hugepages", bench_hugepages(), "affinity", affinity,
+		"hashes", (json_int_t) opt_bench_hashes,
+		"warmup", (json_int_t) (opt_bench_warmup >= 0 ? opt_bench_warmup
+			: (int64_t) (opt_bench_hashes * BENCH_WARMUP / 100)),
+		"reps", opt_bench_reps);
+	if (bench_memory_model(opt_algo, &footprint, &bench_traffic)) {
+		applog(LOG_INFO, "Scratchpad %.0f kB, %.0f kB read and written per hash",
+			footprint / 1024., bench_traffic / 1024.);
+		json_object_set_new(root, "scratchpad", json_real(footprint));
+		json_object_set_new(root, "bytes_per_hash", json_real(bench_traffic));
+	}
+
+	if (opt_bench_memory)
+		results = bench_memory(root);
+	else
+		results = bench_sweep(opt_bench_sweep ? 1 : opt_n_threads, NULL);
+	if (!results) {
+		json_decref(root);
+		return 1;
+	}
+	json_object_set_new(root, opt_bench_memory ? "configs" : "results",
+		results);
+
+	if (opt_bench_json) {
+		FILE *fd = strcmp(opt_bench_json, "-") ? fopen(opt_bench_json, "w")
+			: stdout;
+		if (!fd) {
+			applog(LOG_ERR, "cannot write %s", opt_bench_json);
+			json_decref(root);
+			return 1;
+		}
+		json_dumpf(root, fd, JSON_INDENT(2) | JSON_PRESERVE_ORDER);
+		fputc('\n', fd);
+		if (fd != stdout)
+			fclose(fd);
+	}
+	json_decref(root);
+	return 0;
+}
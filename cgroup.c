@@ -0,0 +1,260 @@
+/**
+ * Container limits
+ *
+ * sysconf gives the cpus of the host, a container's cgroup may narrow
+ * them to a cpuset, cap them with a cpu quota and cap the memory. The
+ * default thread count follows the cpuset and the quota, more threads
+ * than the quota only get throttled at the end of each CFS period, and
+ * the threads are bound inside the cpuset. The memory limit is a budget
+ * of the scratchpads, see memory.c.
+ *
+ * cgroup v2 and v1 are found through /proc/self/cgroup and /sys/fs/cgroup,
+ * CPUMINER_CGROUP_ROOT prefixes both to run on a fake tree.
+ */
+
+#define _GNU_SOURCE  /* sched_getaffinity */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux
+#include <sched.h>
+#endif
+
+#include "miner.h"
+
+#define CG_ROOT_ENV     "CPUMINER_CGROUP_ROOT"
+#define CG_MEM_MAX      (1ULL << 62)   /* v1 writes ~2^63 for no limit */
+
+unsigned long cgroup_cpus = 0;      /* allowed cpus, 0 for all */
+double        cgroup_cpu_quota = 0; /* in cpus, 0 for none */
+uint64_t      cgroup_mem_limit = 0; /* bytes, 0 for none */
+
+#ifdef __linux
+
+static const char *cg_root = "";
+
+static bool cg_read(const char *dir, const char *file, char *buf, int sz)
+{
+	char path[512];
+	FILE *fd;
+	bool ok;
+
+	/* a truncated path could name another file */
+	if (snprintf(path, sizeof(path), "%s/%s", dir, file) >= (int) sizeof(path)
+	    || !(fd = fopen(path, "r")))
+		return false;
+	ok = fgets(buf, sz, fd) != NULL;
+	fclose(fd);
+	return ok;
+}
+
+/* "0-3,8-11" */
+static unsigned long cg_cpu_list(const char *s)
+{
+	unsigned long mask = 0;
+	int a, b, n;
+
+	while (*s && *s != '\n') {
+		if (sscanf(s, "%d-%d%n", &a, &b, &n) != 2) {
+			if (sscanf(s, "%d%n", &a, &n) != 1)
+				break;
+			b = a;
+		}
+		for (; a <= b && a < (int) (8 * sizeof(long)); a++)
+			mask |= 1UL << a;
+		s += n;
+		if (*s == ',')
+			s++;
+	}
+	return mask;
+}
+
+/*
+ * Directory of a controller for the cgroup path of this process. Inside a
+ * cgroup namespace the path is / and the mount is the container's own
+ * cgroup, without one the path may not exist under the mount.
+ */
+static void cg_dir(char *dir, int sz, const char *mount, const char *path)
+{
+	char probe[512];
+
+	snprintf(dir, sz, "%s%s", mount, strcmp(path, "/") ? path : "");
+	snprintf(probe, sizeof(probe), "%s/.", dir);
+	if (access(probe, F_OK))
+		snprintf(dir, sz, "%s", mount);
+}
+
+/* the smallest limit from the cgroup up to the mount, limits nest */
+static void cg_walk(char *dir, const char *mount, bool v2)
+{
+	size_t mlen = strlen(mount);
+	char buf[128];
+
+	for (;;) {
+		double quota = 0;
+		uint64_t mem = 0;
+
+		if (v2) {
+			long q, p;
+			if (cg_read(dir, "cpu.max", buf, sizeof(buf))
+			    && sscanf(buf, "%ld %ld", &q, &p) == 2 && q > 0 && p > 0)
+				quota = (double) q / p;
+			if (cg_read(dir, "memory.max", buf, sizeof(buf)))
+				mem = strtoull(buf, NULL, 10);
+		}
+		else {
+			long q = -1, p = 0;
+			if (cg_read(dir, "cpu.cfs_quota_us", buf, sizeof(buf)))
+				q = atol(buf);
+			if (cg_read(dir, "cpu.cfs_period_us", buf, sizeof(buf)))
+				p = atol(buf);
+			if (q > 0 && p > 0)
+				quota = (double) q / p;
+			if (cg_read(dir, "memory.limit_in_bytes", buf, sizeof(buf)))
+				mem = strtoull(buf, NULL, 10);
+		}
+		if (quota > 0 && (!cgroup_cpu_quota || quota < cgroup_cpu_quota))
+			cgroup_cpu_quota = quota;
+		if (mem && mem < CG_MEM_MAX
+		    && (!cgroup_mem_limit || mem < cgroup_mem_limit))
+			cgroup_mem_limit = mem;
+
+		if (strlen(dir) <= mlen)
+			break;
+		*strrchr(dir, '/') = '\0';
+	}
+}
+
+static void cg_discover()
+{
+	char line[512], mount[320], dir[512], buf[256];
+	bool v1_cpu = false, v1_cpuset = false, v1_mem = false;
+	char v2_path[256] = "";
+	unsigned long cpus = 0;
+	FILE *fd;
+
+	snprintf(line, sizeof(line), "%s/proc/self/cgroup", cg_root);
+	if (!(fd = fopen(line, "r")))
+		return;
+	/* "4:cpu,cpuacct:/docker/id" for v1, "0::/path" for v2 */
+	while (fgets(line, sizeof(line), fd)) {
+		char *ctrl = strchr(line, ':'), *path;
+		bool is_cpu, is_cpuset, is_mem;
+
+		if (!ctrl || !(path = strchr(++ctrl, ':')))
+			continue;
+		*path++ = '\0';
+		path[strcspn(path, "\n")] = '\0';
+		if (!*ctrl) {
+			snprintf(v2_path, sizeof(v2_path), "%s", path);
+			continue;
+		}
+		snprintf(buf, sizeof(buf), ",%s,", ctrl);
+		is_cpu = strstr(buf, ",cpu,") != NULL;
+		is_cpuset = strstr(buf, ",cpuset,") != NULL;
+		is_mem = strstr(buf, ",memory,") != NULL;
+		if (!is_cpu && !is_cpuset && !is_mem)
+			continue;
+		snprintf(mount, sizeof(mount), "%s/sys/fs/cgroup/%s", cg_root, ctrl);
+		cg_dir(dir, sizeof(dir), mount, path);
+		if (is_cpuset) {
+			if (cg_read(dir, "cpuset.effective_cpus", buf, sizeof(buf))
+			    || cg_read(dir, "cpuset.cpus", buf, sizeof(buf)))
+				cpus = cg_cpu_list(buf);
+			v1_cpuset = true;
+		}
+		if (is_cpu || is_mem) {
+			cg_walk(dir, mount, false);
+			v1_cpu |= is_cpu;
+			v1_mem |= is_mem;
+		}
+	}
+	fclose(fd);
+
+	/* unified hierarchy, or the controllers v1 didn't take on a hybrid */
+	snprintf(mount, sizeof(mount), "%s/sys/fs/cgroup", cg_root);
+	if (*v2_path && !(v1_cpu && v1_cpuset && v1_mem)
+	    && cg_read(mount, "cgroup.controllers", buf, sizeof(buf))) {
+		cg_dir(dir, sizeof(dir), mount, v2_path);
+		if (!v1_cpuset
+		    && cg_read(dir, "cpuset.cpus.effective", buf, sizeof(buf)))
+			cpus = cg_cpu_list(buf);
+		if (!v1_cpu || !v1_mem)
+			cg_walk(dir, mount, true);
+	}
+	cgroup_cpus = cpus;
+}
+
+#endif /* __linux */
+
+/*
+ * Reads the limits and keeps the affinity inside the allowed cpus, before
+ * --split and the thread count use them.
+ */
+bool cgroup_init()
+{
+#ifdef __linux
+	unsigned long all = num_cpus >= (int) (8 * sizeof(long)) ? ~0UL
+		: (1UL << num_cpus) - 1;
+	unsigned long allowed;
+	cpu_set_t set;
+
+	if (getenv(CG_ROOT_ENV))
+		cg_root = getenv(CG_ROOT_ENV);
+	cg_discover();
+
+	/* a taskset or the kernel's view of the cpuset */
+	allowed = cgroup_cpus ? cgroup_cpus & all : all;
+	if (!*cg_root && !sched_getaffinity(0, sizeof(set), &set)) {
+		unsigned long aff = 0;
+		for (int c = 0; c < num_cpus && c < (int) (8 * sizeof(long)); c++)
+			if (CPU_ISSET(c, &set))
+				aff |= 1UL << c;
+		if (aff && (allowed & aff))
+			allowed &= aff;
+	}
+	cgroup_cpus = allowed != all ? allowed : 0;
+
+	if (cgroup_cpus || cgroup_cpu_quota || cgroup_mem_limit) {
+		char quota[32] = "none", mem[32] = "none";
+		if (cgroup_cpu_quota)
+			sprintf(quota, "%.2f cpus", cgroup_cpu_quota);
+		if (cgroup_mem_limit)
+			sprintf(mem, "%llu MiB",
+				(unsigned long long) (cgroup_mem_limit >> 20));
+		applog(LOG_INFO, "cgroup: cpus 0x%lx, quota %s, memory %s",
+			allowed, quota, mem);
+	}
+	if (!cgroup_cpus)
+		return true;
+
+	if (opt_affinity == -1L)
+		opt_affinity = (int64_t) cgroup_cpus;
+	else {
+		unsigned long mask = (unsigned long) opt_affinity & cgroup_cpus;
+		if (!mask) {
+			applog(LOG_ERR, "--cpu-affinity: no cpu of the mask is "
+				"allowed, cgroup cpus 0x%lx", cgroup_cpus);
+			return false;
+		}
+		if (mask != (unsigned long) opt_affinity)
+			applog(LOG_WARNING, "--cpu-affinity: cpus 0x%lx not allowed "
+				"by the cgroup, using 0x%lx",
+				(unsigned long) opt_affinity & ~cgroup_cpus, mask);
+		opt_affinity = (int64_t) mask;
+	}
+#endif
+	return true;
+}
+
+/* one per allowed cpu, no more than the quota */
+int cgroup_threads()
+{
+	int n = cgroup_cpus ? __builtin_popcountl((unsigned long) opt_affinity)
+		: num_cpus;
+
+	if (cgroup_cpu_quota > 0. && n > (int) cgroup_cpu_quota)
+		n = cgroup_cpu_quota >= 1. ? (int) cgroup_cpu_quota : 1;
+	return n;
+}
@@ -60,6 +60,8 @@
 
 #include "miner.h"
 #include "algo-gate-api.h"
+#include "stage-profile.h"
+#include "algo/interleave.h"
 
 #ifdef WIN32
 #include "compat/winansi.h"
@@ -72,94 +74,10 @@
 
 #define LP_SCANTIME		60
 
-algo_gate_t algo_gate;
-
-bool opt_debug = false;
-bool opt_debug_diff = false;
-bool opt_protocol = false;
-bool opt_benchmark = false;
-bool opt_redirect = true;
-bool opt_showdiff = true;
-bool opt_extranonce = true;
-bool want_longpoll = true;
-bool have_longpoll = false;
-bool have_gbt = true;
-bool allow_getwork = true;
-bool want_stratum = true;
-bool have_stratum = false;
-bool allow_mininginfo = true;
-bool use_syslog = false;
-bool use_colors = true;
-static bool opt_background = false;
-bool opt_quiet = false;
-bool opt_randomize = false;
-static int opt_retries = -1;
-static int opt_fail_pause = 10;
-static int opt_time_limit = 0;
-int opt_timeout = 300;
-static int opt_scantime = 5;
-static const bool opt_time = true;
-enum algos opt_algo = ALGO_NULL;
-int opt_scrypt_n = 0;
-int opt_pluck_n = 128;
-int opt_n_threads = 0;
-int64_t opt_affinity = -1L;
-int opt_priority = 0;
-int num_cpus;
-char *rpc_url = NULL;;
-char *rpc_userpass = NULL;
-char *rpc_user, *rpc_pass;
-char *short_url = NULL;
-static unsigned char pk_script[25] = { 0 };
-static size_t pk_script_size = 0;
-static char coinbase_sig[101] = { 0 };
-char *opt_cert;
-char *opt_proxy;
-long opt_proxy_type;
-struct thr_info *thr_info;
 int work_thr_id;
-int longpoll_thr_id = -1;
-int stratum_thr_id = -1;
-int api_thr_id = -1;
-bool stratum_need_reset = false;
-struct work_restart *work_restart = NULL;
-struct stratum_ctx stratum;
-bool jsonrpc_2 = false;
-char rpc2_id[64] = "";
-char *rpc2_blob = NULL;
-size_t rpc2_bloblen = 0;
-uint32_t rpc2_target = 0;
-char *rpc2_job_id = NULL;
-double opt_diff_factor = 1.0;
-uint32_t zr5_pok = 0;
-bool opt_stratum_stats = false;
-
-uint32_t accepted_count = 0L;
-uint32_t rejected_count = 0L;
-double *thr_hashrates;
-double *thr_hashcount;
-double global_hashcount = 0;
-double global_hashrate = 0;
-double stratum_diff = 0.;
-double net_diff = 0.;
-double net_hashrate = 0.;
 uint64_t net_blocks = 0;
 // conditional mining
-  bool conditional_state[MAX_CPUS] = { 0 };
-  double opt_max_temp = 0.0;
-  double opt_max_diff = 0.0;
-  double opt_max_rate = 0.0;
-
-  uint32_t opt_work_size = 0;
-  char *opt_api_allow = NULL;
-  int opt_api_remote = 0;
-  int opt_api_listen = 4048; 
-
-  pthread_mutex_t rpc2_job_lock;
-  pthread_mutex_t rpc2_login_lock;
-  pthread_mutex_t applog_lock;
-  pthread_mutex_t stats_lock;
-
+bool conditional_state[MAX_CPUS] = { 0 };
 
 static char const short_options[] =
 #ifdef HAVE_SYSLOG_H
@@ -167,145 +85,18 @@ static char const short_options[] =
 #endif
 	"a:b:Bc:CDf:hm:n:p:Px:qr:R:s:t:T:o:u:O:V";
 
-static struct work g_work = {{ 0 }};
-//static struct work tmp_work;
-time_t g_work_time = 0;
 static        pthread_mutex_t g_work_lock;
+// Held for writing while a hot algo switch replaces the gate, the stratum
+// and workio threads hold it for reading while they use algo_gate. Each
+// switch starts a new generation, submissions queued before it are
+// dropped.
+static pthread_rwlock_t algo_gate_lock = PTHREAD_RWLOCK_INITIALIZER;
+static volatile int     algo_gate_gen = 0;
+
 static bool   submit_old = false;
-static char*  lp_id;
 
 static void   workio_cmd_free(struct workio_cmd *wc);
 
-#ifdef __linux /* Linux specific policy and affinity management */
-#include <sched.h>
-
-static inline void drop_policy(void)
-{
-	struct sched_param param;
-	param.sched_priority = 0;
-#ifdef SCHED_IDLE
-	if (unlikely(sched_setscheduler(0, SCHED_IDLE, &param) == -1))
-#endif
-#ifdef SCHED_BATCH
-		sched_setscheduler(0, SCHED_BATCH, &param);
-#endif
-}
-
-#ifdef __BIONIC__
-#define pthread_setaffinity_np(tid,sz,s) {} /* only do process affinity */
-#endif
-
-static void affine_to_cpu_mask(int id, unsigned long mask) {
-	cpu_set_t set;
-	CPU_ZERO(&set);
-	for (uint8_t i = 0; i < num_cpus; i++) {
-		// cpu mask
-		if (mask & (1UL<<i)) { CPU_SET(i, &set); }
-	}
-	if (id == -1) {
-		// process affinity
-		sched_setaffinity(0, sizeof(&set), &set);
-	} else {
-		// thread only
-		pthread_setaffinity_np(thr_info[id].pth, sizeof(&set), &set);
-	}
-}
-
-#elif defined(WIN32) /* Windows */
-static inline void drop_policy(void) { }
-static void affine_to_cpu_mask(int id, unsigned long mask) {
-	if (id == -1)
-		SetProcessAffinityMask(GetCurrentProcess(), mask);
-	else
-		SetThreadAffinityMask(GetCurrentThread(), mask);
-}
-#else
-static inline void drop_policy(void) { }
-static void affine_to_cpu_mask(int id, unsigned long mask) { }
-#endif
-
-// not very useful, just index the arrray directly.
-// but declaring this fuinction in miner.h eliminates
-// an annoying compiler warning for not using a static.
-const char* algo_name( enum algos a ) {return algo_names[a];}
-
-void get_currentalgo(char* buf, int sz)
-{
-	snprintf(buf, sz, "%s", algo_names[opt_algo]);
-}
-
-void proper_exit(int reason)
-{
-#ifdef WIN32
-	if (opt_background) {
-		HWND hcon = GetConsoleWindow();
-		if (hcon) {
-			// unhide parent command line windows
-			ShowWindow(hcon, SW_SHOWMINNOACTIVE);
-		}
-	}
-#endif
-	exit(reason);
-}
-
-uint32_t* get_stratum_job_ntime()
-{
-   return (uint32_t*)stratum.job.ntime;
-}
-
-void work_free(struct work *w)
-{
-	if (w->txs) free(w->txs);
-	if (w->workid) free(w->workid);
-	if (w->job_id) free(w->job_id);
-	if (w->xnonce2) free(w->xnonce2);
-}
-
-void work_copy(struct work *dest, const struct work *src)
-{
-	memcpy(dest, src, sizeof(struct work));
-	if (src->txs)
-		dest->txs = strdup(src->txs);
-	if (src->workid)
-		dest->workid = strdup(src->workid);
-	if (src->job_id)
-		dest->job_id = strdup(src->job_id);
-	if (src->xnonce2) {
-		dest->xnonce2 = (uchar*) malloc(src->xnonce2_len);
-		memcpy(dest->xnonce2, src->xnonce2, src->xnonce2_len);
-	}
-}
-
-bool jr2_work_decode( const json_t *val, struct work *work)
-{
-        return rpc2_job_decode(val, work);
-}
-
-bool std_work_decode( const json_t *val, struct work *work)
-{
-    int i;
-    int data_size   = algo_gate.work_data_size;
-    int target_size = sizeof(work->target);
-    int adata_sz    = ARRAY_SIZE(work->data);
-    int atarget_sz  = ARRAY_SIZE(work->target);
-
-    if (unlikely( !jobj_binary(val, "data", work->data, data_size) ))
-    {
-       applog(LOG_ERR, "JSON invalid data");
-       return false;
-    }
-    if (unlikely( !jobj_binary(val, "target", work->target, target_size) ))
-    {
-       applog(LOG_ERR, "JSON invalid target");
-       return false;
-    }
-    for ( i = 0; i < adata_sz; i++ )
-          work->data[i] = le32dec( work->data + i );
-    for ( i = 0; i < atarget_sz; i++ )
-          work->target[i] = le32dec( work->target + i );
-    return true;
-}
-
 static bool work_decode(const json_t *val, struct work *work)
 {
     if ( !algo_gate.work_decode( val, work ) )
@@ -390,6 +181,96 @@ static bool get_mininginfo(CURL *curl, struct work *work)
 
 #define BLOCK_VERSION_CURRENT 3
 
+/*
+ * The submitblock request of the current template, built when it is
+ * decoded with the header left as a hole of zeros. A found block only
+ * patches the 160 hex chars of its header in, see solo_submit().
+ */
+struct gbt_block {
+	int refs;
+	uint32_t key[16];	/* data[1..16], prevhash and merkle root */
+	size_t hdr_pos;
+	char *req;
+};
+
+static struct gbt_block *gbt_block = NULL;
+static pthread_mutex_t gbt_block_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void gbt_block_put(struct gbt_block *b)
+{
+	bool last;
+
+	if (!b)
+		return;
+	pthread_mutex_lock(&gbt_block_lock);
+	last = --b->refs == 0;
+	pthread_mutex_unlock(&gbt_block_lock);
+	if (last) {
+		free(b->req);
+		free(b);
+	}
+}
+
+/* the prepared block of the template work was hashed on, or NULL */
+static struct gbt_block *gbt_block_get(const struct work *work)
+{
+	struct gbt_block *b;
+
+	pthread_mutex_lock(&gbt_block_lock);
+	b = gbt_block;
+	if (b && !memcmp(b->key, &work->data[1], sizeof(b->key)))
+		b->refs++;
+	else
+		b = NULL;
+	pthread_mutex_unlock(&gbt_block_lock);
+	return b;
+}
+
+static void gbt_block_prepare(const struct work *work)
+{
+	static const char head[] = "{\"method\": \"submitblock\", \"params\": [\"";
+	struct gbt_block *b, *old;
+	char *params = NULL;
+	size_t txs_len = strlen(work->txs);
+	size_t n;
+
+	if (work->workid) {
+		json_t *val = json_object();
+		json_object_set_new(val, "workid", json_string(work->workid));
+		params = json_dumps(val, 0);
+		json_decref(val);
+	}
+	b = (struct gbt_block*) calloc(1, sizeof(*b));
+	if (b)
+		b->req = (char*) malloc(sizeof(head) + 2 * 80 + txs_len
+			+ (params ? strlen(params) : 0) + 32);
+	if (!b || !b->req) {
+		free(b);
+		free(params);
+		return;
+	}
+	b->refs = 1;
+	memcpy(b->key, &work->data[1], sizeof(b->key));
+	n = sizeof(head) - 1;
+	memcpy(b->req, head, n);
+	b->hdr_pos = n;
+	memset(b->req + n, '0', 2 * 80);
+	n += 2 * 80;
+	memcpy(b->req + n, work->txs, txs_len);
+	n += txs_len;
+	if (params)
+		sprintf(b->req + n, "\", %s], \"id\":4}\r\n", params);
+	else
+		sprintf(b->req + n, "\"], \"id\":4}\r\n");
+	free(params);
+
+	pthread_mutex_lock(&gbt_block_lock);
+	old = gbt_block;
+	gbt_block = b;
+	pthread_mutex_unlock(&gbt_block_lock);
+	gbt_block_put(old);
+}
+
 static bool gbt_work_decode(const json_t *val, struct work *work)
 {
 	int i, n;
@@ -658,6 +539,7 @@ static bool gbt_work_decode(const json_t *val, struct work *work)
 	   work->workid = strdup(json_string_value(tmp));
 	}
 
+	gbt_block_prepare(work);
 	rc = true;
 out:
 	/* Long polling */
@@ -681,262 +563,34 @@ out:
 	return rc;
 }
 
-void scale_hash_for_display ( double* hashrate, char* units )
-{
-     if ( *hashrate < 1e4 )
-       // 0 H/s to 9999 H/s
-       *units = 0;
-     else if ( *hashrate < 1e7 )
-     {
-       // 10 kH/s to 9999 kH/s
-       *units = 'k';
-       *hashrate /= 1e3;
-     }
-     else if ( *hashrate < 1e10 )
-     {
-       // 10 Mh/s to 9999 Mh/s
-       *units = 'M';
-       *hashrate /= 1e6;
-     }
-     else if ( *hashrate < 1e13 )
-     {
-       // 10 iGh/s to 9999 Gh/s
-       *units = 'G';
-       *hashrate /= 1e9;
-     }
-     else
-     {
-       // 10 Th/s and higher
-       *units = 'T';
-       *hashrate /= 1e12;
-     }
-}
-
-static int share_result( int result, struct work *work, const char *reason )
+static void submitblock_result( json_t *val, struct work *work )
 {
-   char hc[16];
-   char hr[16];
-   const char *sres;
-   double hashcount = 0.;
-   double hashrate = 0.;
-   char hc_units[4] = {0};
-   char hr_units[4] = {0};
-   uint32_t total_submits;
-   float rate;
-   char rate_s[8] = {0};
-   int i;
-
-   pthread_mutex_lock(&stats_lock);
-   for (i = 0; i < opt_n_threads; i++)
+   json_t *res = json_object_get(val, "result");
+   if (json_is_object(res))
    {
-       hashcount += thr_hashcount[i];
-       hashrate += thr_hashrates[i];
-   }
-   result ? accepted_count++ : rejected_count++;
-   pthread_mutex_unlock(&stats_lock);
-   global_hashcount = hashcount;
-   global_hashrate = hashrate;
-   total_submits = accepted_count + rejected_count;
-
-   rate = ( result ? ( 100. * accepted_count / total_submits )  
-                   : ( 100. * rejected_count / total_submits ) );
-
-   if (use_colors)
-        sres = (result ? CL_GRN "Accepted" CL_WHT : CL_RED "Rejected" CL_WHT );
-   else
-        sres = (result ? "Accepted" : "Rejected" );
-
-   // Contrary to rounding convention 100% means zero rejects, exactly 100%. 
-   // Rates > 99% and < 100% (rejects>0) display 99.9%.
-   if ( result )
-   {
-      rate = 100. * accepted_count / total_submits;
-      if ( rate == 100.0 )
-         sprintf( rate_s, "%.0f", rate );
-      else
-          sprintf( rate_s, "%.1f", ( rate < 99.9 ) ? rate : 99.9 );
-   }
-   else
-   {
-      rate = 100. * rejected_count / total_submits;
-      if ( rate < 0.1 )
-         sprintf( rate_s, "%.1f", 0.10 );
-      else
-         sprintf( rate_s, "%.1f", rate );
-   }
-
-   scale_hash_for_display ( &hashcount, hc_units );
-   scale_hash_for_display ( &hashrate, hr_units );
-   if ( hc_units[0] )
-   {
-      sprintf(hc, "%.2f", hashcount );
-      if ( hashrate < 10 )
-         // very low hashrate, add digits
-         sprintf(hr, "%.4f", hashrate );
-      else
-         sprintf(hr, "%.2f", hashrate );
-   }
-   else
-   {
-      // no fractions of a hash
-      sprintf(hc, "%.0f", hashcount );
-      sprintf(hr, "%.2f", hashrate );
-   }
-
-#if ((defined(_WIN64) || defined(__WINDOWS__)))
-   applog( LOG_NOTICE, "%s %lu/%lu (%s%%), %s %sH, %s %sH/s",
-                       sres, ( result ? accepted_count : rejected_count ),
-                       total_submits, rate_s, hc, hc_units, hr, hr_units );
-#else
-   applog( LOG_NOTICE, "%s %lu/%lu (%s%%), %s %sH, %s %sH/s, %dC",
-                       sres, ( result ? accepted_count : rejected_count ),
-                       total_submits, rate_s, hc, hc_units, hr, hr_units,
-                       (uint32_t)cpu_temp(0) );
-#endif
-
-   if (reason)
-   {
-	applog(LOG_WARNING, "reject reason: %s", reason);
-	if (strncmp(reason, "low difficulty share", 20) == 0)
-        {
-           opt_diff_factor = (opt_diff_factor * 2.0) / 3.0;
-	   applog(LOG_WARNING, "factor reduced to : %0.2f", opt_diff_factor);
-           return 0;
-        }
-   }
-	return 1;
-}
-
-void std_le_build_stratum_request( char *req, struct work *work )
-{
-   unsigned char *xnonce2str;
-   uint32_t ntime,       nonce;
-   char     ntimestr[9], noncestr[9];
-   le32enc( &ntime, work->data[ algo_gate.ntime_index ] );
-   le32enc( &nonce, work->data[ algo_gate.nonce_index ] );
-   bin2hex( ntimestr, (char*)(&ntime), sizeof(uint32_t) );
-   bin2hex( noncestr, (char*)(&nonce), sizeof(uint32_t) );
-   xnonce2str = abin2hex(work->xnonce2, work->xnonce2_len);
-   snprintf( req, JSON_BUF_LEN,
-        "{\"method\": \"mining.submit\", \"params\": [\"%s\", \"%s\", \"%s\", \"%s\", \"%s\"], \"id\":4}",
-         rpc_user, work->job_id, xnonce2str, ntimestr, noncestr );
-   free( xnonce2str );
-}
-
-// le is default
-void std_be_build_stratum_request( char *req, struct work *work )
-{
-   unsigned char *xnonce2str;
-   uint32_t ntime,       nonce;
-   char     ntimestr[9], noncestr[9];
-   be32enc( &ntime, work->data[ algo_gate.ntime_index ] );
-   be32enc( &nonce, work->data[ algo_gate.nonce_index ] );
-   bin2hex( ntimestr, (char*)(&ntime), sizeof(uint32_t) );
-   bin2hex( noncestr, (char*)(&nonce), sizeof(uint32_t) );
-   xnonce2str = abin2hex(work->xnonce2, work->xnonce2_len);
-   snprintf( req, JSON_BUF_LEN,
-        "{\"method\": \"mining.submit\", \"params\": [\"%s\", \"%s\", \"%s\", \"%s\", \"%s\"], \"id\":4}",
-         rpc_user, work->job_id, xnonce2str, ntimestr, noncestr );
-   free( xnonce2str );
-}
-
-void jr2_build_stratum_request( char *req, struct work *work )
-{
-   uchar hash[32];
-   char noncestr[9];
-   bin2hex( noncestr, (char*) algo_gate.get_nonceptr( work->data ),
-                      sizeof(uint32_t) );
-   algo_gate.hash_suw( hash, work->data );
-   char *hashhex = abin2hex(hash, 32);
-   snprintf( req, JSON_BUF_LEN,
-        "{\"method\": \"submit\", \"params\": {\"id\": \"%s\", \"job_id\": \"%s\", \"nonce\": \"%s\", \"result\": \"%s\"}, \"id\":4}",
-          rpc2_id, work->job_id, noncestr, hashhex );
-   free( hashhex );
-}
-
-bool std_submit_getwork_result( CURL *curl, struct work *work )
-{
-   char req[JSON_BUF_LEN];
-   json_t *val, *res, *reason;
-   char* gw_str;
-   int data_size = algo_gate.work_data_size;
-
-   for ( int i = 0; i < data_size / sizeof(uint32_t); i++ )
-     le32enc( &work->data[i], work->data[i] );
-   gw_str = abin2hex( (uchar*)work->data, data_size );
-   if ( unlikely(!gw_str) )
-   {
-      applog(LOG_ERR, "submit_upstream_work OOM");
-      return false;
-   }
-   // build JSON-RPC request 
-   snprintf( req, JSON_BUF_LEN,
-     "{\"method\": \"getwork\", \"params\": [\"%s\"], \"id\":4}\r\n", gw_str );
-   free( gw_str );
-   // issue JSON-RPC request 
-   val = json_rpc_call( curl, rpc_url, rpc_userpass, req, NULL, 0 );
-   if ( unlikely(!val) )
-   {
-       applog(LOG_ERR, "submit_upstream_work json_rpc_call failed");
-       return false;
-   }
-   res = json_object_get(val, "result");
-   reason = json_object_get(val, "reject-reason");
-   share_result( json_is_true(res), work,
-                 reason ? json_string_value(reason) : NULL);
-   json_decref(val);
-   return true;
-}
-
-bool jr2_submit_getwork_result( CURL *curl, struct work *work )
-{
-   json_t *val, *res;
-   char req[JSON_BUF_LEN];
-   char noncestr[9];
-   uchar hash[32];
-   char *hashhex;
-   bin2hex( noncestr, (char*) algo_gate.get_nonceptr( work->data ),
-                      sizeof(uint32_t) );
-   algo_gate.hash_suw( hash, work->data );
-   hashhex = abin2hex( &hash[0], 32 );
-   snprintf( req, JSON_BUF_LEN, "{\"method\": \"submit\", \"params\": "
-       "{\"id\": \"%s\", \"job_id\": \"%s\", \"nonce\": \"%s\", \"result\": \"%s\"},"
-       "\"id\":4}\r\n",
-       rpc2_id, work->job_id, noncestr, hashhex );
-   free( hashhex );
-   // issue JSON-RPC request 
-   val = json_rpc2_call( curl, rpc_url, rpc_userpass, req, NULL, 0 );
-   if (unlikely( !val ))
-   {
-      applog(LOG_ERR, "submit_upstream_work json_rpc_call failed");
-      return false;
+      char *res_str;
+      bool sumres = false;
+      void *iter = json_object_iter(res);
+      while (iter)
+      {
+         if (json_is_null(json_object_iter_value(iter)))
+         {
+            sumres = true;
+            break;
+         }
+         iter = json_object_iter_next(res, iter);
+      }
+      res_str = json_dumps(res, 0);
+      share_result(sumres, work, res_str);
+      free(res_str);
    }
-   res = json_object_get( val, "result" );
-   json_t *status = json_object_get( res, "status" );
-   bool valid = !strcmp( status ? json_string_value( status ) : "", "OK" );
-   if (valid)
-       share_result( valid, work, NULL );
    else
-   {
-       json_t *err = json_object_get( res, "error" );
-       const char *sreason = json_string_value( json_object_get(
-                                                      err, "message" ) );
-       share_result( valid, work, sreason );
-       if ( !strcasecmp( "Invalid job id", sreason ) )
-       {
-            work_free( work );
-            work_copy( work, &g_work );
-            g_work_time = 0;
-            restart_threads();
-       }
-   }
-   json_decref(val);
-   return true;
+      share_result(json_is_null(res), work, json_string_value(res));
 }
 
 static bool submit_upstream_work( CURL *curl, struct work *work )
 {
-   json_t *val, *res;
+   json_t *val;
    char req[JSON_BUF_LEN];
    int i;
 
@@ -1004,27 +658,7 @@ static bool submit_upstream_work( CURL *curl, struct work *work )
           applog(LOG_ERR, "submit_upstream_work json_rpc_call failed");
           return false;
        }
-       res = json_object_get(val, "result");
-       if (json_is_object(res))
-       {
-          char *res_str;
-	  bool sumres = false;
-	  void *iter = json_object_iter(res);
-	  while (iter)
-          {
- 	     if (json_is_null(json_object_iter_value(iter)))
-             {
-        	sumres = true;
- 	        break;
-             }
-             iter = json_object_iter_next(res, iter);
-	  }
-	  res_str = json_dumps(res, 0);
-	  share_result(sumres, work, res_str);
-	  free(res_str);
-       }
-       else
-          share_result(json_is_null(res), work, json_string_value(res));
+       submitblock_result(val, work);
        json_decref(val);
        return true;     
    }
@@ -1032,18 +666,6 @@ static bool submit_upstream_work( CURL *curl, struct work *work )
        return algo_gate.submit_getwork_result( curl, work );
 }
 
-static const char *getwork_req =
-	"{\"method\": \"getwork\", \"params\": [], \"id\":0}\r\n";
-
-#define GBT_CAPABILITIES "[\"coinbasetxn\", \"coinbasevalue\", \"longpoll\", \"workid\"]"
-
-static const char *gbt_req =
-	"{\"method\": \"getblocktemplate\", \"params\": [{\"capabilities\": "
-	GBT_CAPABILITIES "}], \"id\":0}\r\n";
-static const char *gbt_lp_req =
-	"{\"method\": \"getblocktemplate\", \"params\": [{\"capabilities\": "
-	GBT_CAPABILITIES ", \"longpollid\": \"%s\"}], \"id\":0}\r\n";
-
 static bool get_upstream_work(CURL *curl, struct work *work)
 {
 	json_t *val;
@@ -1173,6 +795,12 @@ static bool workio_submit_work(struct workio_cmd *wc, CURL *curl)
 {
    int failures = 0;
 
+   // a share of the previous algo
+   if ( wc->gate_gen != algo_gate_gen )
+   {
+      applog( LOG_WARNING, "Dropped a share found before the algo switch" );
+      return true;
+   }
    /* submit solution to bitcoin via JSON-RPC */
    while (!submit_upstream_work(curl, wc->u.work))
    {
@@ -1189,68 +817,6 @@ static bool workio_submit_work(struct workio_cmd *wc, CURL *curl)
    return true;
 }
 
-bool rpc2_login(CURL *curl)
-{
-	json_t *val;
-	bool rc = false;
-	struct timeval tv_start, tv_end, diff;
-	char s[JSON_BUF_LEN];
-
-	if (!jsonrpc_2)
-		return false;
-	snprintf(s, JSON_BUF_LEN, "{\"method\": \"login\", \"params\": {"
-		"\"login\": \"%s\", \"pass\": \"%s\", \"agent\": \"%s\"}, \"id\": 1}",
-		rpc_user, rpc_pass, USER_AGENT);
-	gettimeofday(&tv_start, NULL);
-	val = json_rpc_call(curl, rpc_url, rpc_userpass, s, NULL, 0);
-	gettimeofday(&tv_end, NULL);
-	if (!val)
-		goto end;
-	rc = rpc2_login_decode(val);
-	json_t *result = json_object_get(val, "result");
-	if (!result)
-		goto end;
-	json_t *job = json_object_get(result, "job");
-	if (!rpc2_job_decode(job, &g_work))
-		goto end;
-	if (opt_debug && rc)
-        {
-		timeval_subtract(&diff, &tv_end, &tv_start);
-		applog(LOG_DEBUG, "DEBUG: authenticated in %d ms",
-				diff.tv_sec * 1000 + diff.tv_usec / 1000);
-	}
-	json_decref(val);
-end:
-	return rc;
-}
-
-bool rpc2_workio_login(CURL *curl)
-{
-   int failures = 0;
-   if (opt_benchmark)
-	return true;
-   /* submit solution to bitcoin via JSON-RPC */
-   pthread_mutex_lock(&rpc2_login_lock);
-   while (!rpc2_login(curl))
-   {
-      if (unlikely((opt_retries >= 0) && (++failures > opt_retries)))
-      {
-	applog(LOG_ERR, "...terminating workio thread");
-	pthread_mutex_unlock(&rpc2_login_lock);
-	return false;
-      }
-
-      /* pause, then restart work-request loop */
-      if (!opt_benchmark)
-          applog(LOG_ERR, "...retry after %d seconds", opt_fail_pause);
-      sleep(opt_fail_pause);
-      pthread_mutex_unlock(&rpc2_login_lock);
-      pthread_mutex_lock(&rpc2_login_lock);
-   }
-   pthread_mutex_unlock(&rpc2_login_lock);
-   return true;
-}
-
 static void *workio_thread(void *userdata)
 {
 	struct thr_info *mythr = (struct thr_info *) userdata;
@@ -1278,6 +844,7 @@ static void *workio_thread(void *userdata)
 		}
 
 		/* process workio_cmd */
+		pthread_rwlock_rdlock(&algo_gate_lock);
 		switch (wc->cmd)
                 {
 		case WC_GET_WORK:
@@ -1291,6 +858,7 @@ static void *workio_thread(void *userdata)
 			ok = false;
 			break;
 		}
+		pthread_rwlock_unlock(&algo_gate_lock);
 		workio_cmd_free(wc);
 	}
 	tq_freeze(mythr->q);
@@ -1354,6 +922,7 @@ static bool submit_work(struct thr_info *thr, const struct work *work_in)
 		goto err_out;
 	wc->cmd = WC_SUBMIT_WORK;
 	wc->thr = thr;
+	wc->gate_gen = algo_gate_gen;
 	work_copy(wc->u.work, work_in);
 
 	/* send solution to workio thread */
@@ -1365,36 +934,152 @@ err_out:
 	return false;
 }
 
-bool rpc2_stratum_job( struct stratum_ctx *sctx, json_t *params )
+/*
+ * Solo blocks don't wait behind getwork and longpoll calls in the workio
+ * queue: the miner thread hands the block to the solo thread, which sends
+ * the prepared request of its template on a connection of its own. The
+ * connection is kept open with a cheap call while idle, so a block never
+ * pays for the connect.
+ */
+#define SOLO_KEEPALIVE 20	/* s, below the 30 s idle timeout of bitcoind */
+
+struct solo_cmd {
+	struct gbt_block *block;
+	struct work work;	/* header only, no txs */
+};
+
+static int solo_thr_id = -1;
+
+static bool solo_send(CURL *curl, struct solo_cmd *sc)
 {
-	bool ret = false;
-	pthread_mutex_lock(&sctx->work_lock);
-	ret = rpc2_job_decode(params, &sctx->work);
-	if (ret)
-        {
-           if (sctx->job.job_id)
-		free(sctx->job.job_id);
-	   sctx->job.job_id = strdup(sctx->work.job_id);
- 	}
+	struct gbt_block *b = sc->block;
+	uint32_t hdr[20];
+	char hdr_hex[2 * 80 + 1];
+	struct timeval tv_start, tv_end, diff;
+	json_t *val;
+	int i;
 
-	pthread_mutex_unlock(&sctx->work_lock);
-	return ret;
+	for (i = 0; i < 20; i++)
+		be32enc(hdr + i, sc->work.data[i]);
+	bin2hex(hdr_hex, (unsigned char *) hdr, 80);
+	memcpy(b->req + b->hdr_pos, hdr_hex, 2 * 80);
+
+	gettimeofday(&tv_start, NULL);
+	val = json_rpc_call(curl, rpc_url, rpc_userpass, b->req, NULL, 0);
+	gettimeofday(&tv_end, NULL);
+	if (unlikely(!val)) {
+		applog(LOG_ERR, "submitblock failed");
+		return false;
+	}
+	timeval_subtract(&diff, &tv_end, &tv_start);
+	applog(LOG_BLUE, "Block %d submitted, reply in %.2f ms", sc->work.height,
+		(1000.0 * diff.tv_sec) + (0.001 * diff.tv_usec));
+	submitblock_result(val, &sc->work);
+	json_decref(val);
+	return true;
 }
 
-static bool wanna_mine(int thr_id)
+static void *solo_thread(void *userdata)
 {
-	bool state = true;
+	struct thr_info *mythr = (struct thr_info *) userdata;
+	static const char *ping_req =
+		"{\"method\": \"getblockcount\", \"params\": [], \"id\":0}\r\n";
+	time_t last = time(NULL);
+	CURL *curl;
 
-	if (opt_max_temp > 0.0)
-        {
-		float temp = cpu_temp(0);
-		if (temp > opt_max_temp)
-                {
-			if (!thr_id && !conditional_state[thr_id] && !opt_quiet)
-				applog(LOG_INFO, "temperature too high (%.0fC), waiting...", temp);
-			state = false;
+	curl = curl_easy_init();
+	if (unlikely(!curl)) {
+		applog(LOG_ERR, "CURL initialization failed");
+		return NULL;
+	}
+	while (1) {
+		struct timespec abstime = { last + SOLO_KEEPALIVE, 0 };
+		struct solo_cmd *sc;
+		int failures = 0;
+
+		sc = (struct solo_cmd *) tq_pop(mythr->q, &abstime);
+		if (!sc) {
+			json_t *val;
+			if (time(NULL) < last + SOLO_KEEPALIVE)
+				continue;
+			/* only while mining a template */
+			if (gbt_block && !have_stratum) {
+				val = json_rpc_call(curl, rpc_url, rpc_userpass,
+					ping_req, NULL, 0);
+				if (val)
+					json_decref(val);
+			}
+			time(&last);
+			continue;
+		}
+		/* retry until the template changes */
+		while (!solo_send(curl, sc) && sc->block == gbt_block) {
+			if (unlikely((opt_retries >= 0) && (++failures > opt_retries)))
+				break;
+			applog(LOG_ERR, "...retry after %d seconds", opt_fail_pause);
+			sleep(opt_fail_pause);
 		}
+		time(&last);
+		gbt_block_put(sc->block);
+		free(sc);
 	}
+	curl_easy_cleanup(curl);
+	return NULL;
+}
+
+/* false if the block must go through submit_work() */
+static bool solo_submit(const struct work *work)
+{
+	struct solo_cmd *sc;
+
+	if (solo_thr_id < 0 || have_stratum || !work->txs)
+		return false;
+	sc = (struct solo_cmd *) malloc(sizeof(*sc));
+	if (!sc)
+		return false;
+	sc->block = gbt_block_get(work);
+	if (!sc->block) {
+		/* stale or a template without one */
+		free(sc);
+		return false;
+	}
+	memcpy(&sc->work, work, sizeof(*work));
+	sc->work.txs = NULL;
+	sc->work.workid = NULL;
+	if (!tq_push(thr_info[solo_thr_id].q, sc)) {
+		gbt_block_put(sc->block);
+		free(sc);
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Submission hook of the multi solution scans, a copy of the work with the
+ * nonce goes out while the thread keeps scanning its range. Getwork and
+ * solo work without longpoll end at the first solution, it needs new work.
+ */
+static bool submit_solution(int thr_id, const struct work *work,
+	uint32_t nonce)
+{
+	struct work sol;
+
+	if (opt_benchmark)
+		return true;
+	memcpy(&sol, work, sizeof(sol));
+	*algo_gate.get_nonceptr(sol.data) = nonce;
+	if (!solo_submit(&sol) && !submit_work(&thr_info[thr_id], &sol)) {
+		scan_solutions.failed = true;
+		return false;
+	}
+	return have_stratum || have_longpoll;
+}
+
+static bool wanna_mine(int thr_id)
+{
+	bool state = true;
+
+	// temperature is handled by the governor, see thermal.c
 	if (opt_max_diff > 0.0 && net_diff > opt_max_diff)
         {
 		if (!thr_id && !conditional_state[thr_id] && !opt_quiet)
@@ -1411,146 +1096,112 @@ static bool wanna_mine(int thr_id)
 		}
 		state = false;
 	}
-	if (thr_id < MAX_CPUS)
-		conditional_state[thr_id] = (uint8_t) !state;
-	return state;
-}
-
-void std_wait_for_diff()
-{
-   while ( time(NULL) >= g_work_time + 120 )
-     sleep(1);
-}
-
-// Common target functions, default usually listed first.
-
-// pick your favorite or define your own
-int64_t get_max64_0x1fffffLL() { return 0x1fffffLL; } // default
-int64_t get_max64_0x40LL()     { return 0x40LL;     }
-int64_t get_max64_0x3ffff()    { return 0x3ffff;    }
-int64_t get_max64_0x3fffffLL() { return 0x3fffffLL; }
-int64_t get_max64_0x1ffff()    { return 0x1ffff;    }
-int64_t get_max64_0xffffLL()   { return 0xffffLL;   };
-
-// default
-void sha256d_gen_merkle_root( char* merkle_root, struct stratum_ctx* sctx )
-{
-  sha256d(merkle_root, sctx->job.coinbase, (int) sctx->job.coinbase_size);
-  for ( int i = 0; i < sctx->job.merkle_count; i++ )
-  {
-     memcpy( merkle_root + 32, sctx->job.merkle[i], 32 );
-     sha256d( merkle_root, merkle_root, 64 );
-  }
-}
-void SHA256_gen_merkle_root( char* merkle_root, struct stratum_ctx* sctx )
-{
-  SHA256( sctx->job.coinbase, (int)sctx->job.coinbase_size, merkle_root );
-  for ( int i = 0; i < sctx->job.merkle_count; i++ )
-  {
-     memcpy( merkle_root + 32, sctx->job.merkle[i], 32 );
-     sha256d( merkle_root, merkle_root, 64 );
-  }
+	if (thr_id < MAX_CPUS)
+		conditional_state[thr_id] = (uint8_t) !state;
+	return state;
 }
 
-void std_set_target( struct work* work, double job_diff )
-{
-   work_set_target( work, job_diff / opt_diff_factor );
-}
-// most scrypt based algos
-void scrypt_set_target( struct work* work, double job_diff )
-{
-   work_set_target( work, job_diff / (65536.0 * opt_diff_factor) );
-}
+static pthread_cond_t  algo_switch_cond = PTHREAD_COND_INITIALIZER;
+static int             algo_switch_parked = 0;
+static int             algo_switch_resumed = 0;
+static int             algo_switch_gen = 0;
 
-// set_work_data_endian target, default is do_nothing
-void swab_work_data( struct work *work )
+static void algo_switch_exec()
 {
-   int nonce_index = algo_gate.nonce_index;
-   for ( int i = 0; i < nonce_index; i++ )
-      work->data[i] = swab32( work->data[i] );
-}
+   algo_gate_t gate;
+   int old_algo = opt_algo;
+   int old_scrypt_n = opt_scrypt_n;
+   bool old_rpc2 = jsonrpc_2;
+   bool old_extranonce = opt_extranonce;
 
-double std_calc_network_diff( struct work* work )
-{
-   // sample for diff 43.281 : 1c05ea29
-   // todo: endian reversed on longpoll could be zr5 specific...
-   int nbits_index = algo_gate.nbits_index;
-   uint32_t nbits = have_longpoll ? work->data[ nbits_index]
-                                  : swab32( work->data[ nbits_index ] );
-   uint32_t bits  = ( nbits & 0xffffff );
-   int16_t  shift = ( swab32(nbits) & 0xff ); // 0x1c = 28
-   int m;
-   double d = (double)0x0000ffff / (double)bits;
-   for ( m = shift; m < 29; m++ )
-       d *= 256.0;
-   for ( m = 29; m < shift; m++ )
-       d /= 256.0;
-   if ( opt_debug_diff )
-      applog(LOG_DEBUG, "net diff: %f -> shift %u, bits %08x", d, shift, bits);
-   return d;
-}
+   unregister_algo_gate( &algo_gate );
+   opt_algo = algo_switch_to;
+   opt_scrypt_n = algo_switch_scrypt_n;
+   jsonrpc_2 = false;
+   if ( !register_algo_gate( opt_algo, &gate ) || jsonrpc_2 != old_rpc2
+        || !memory_switch( &gate ) )
+   {
+      applog( LOG_ERR, "Algo switch to %s failed%s", algo_names[opt_algo],
+              jsonrpc_2 != old_rpc2 ? ", stratum protocol differs" : "" );
+      unregister_algo_gate( &gate );
+      opt_algo = old_algo;
+      opt_scrypt_n = old_scrypt_n;
+      jsonrpc_2 = old_rpc2;
+      opt_extranonce = old_extranonce;
+      register_algo_gate( opt_algo, &gate );
+      memory_switch( &gate );
+   }
+   algo_gate = gate;
+   algo_gate_gen++;
 
-uint32_t* std_get_nonceptr( uint32_t *work_data )
-{
-   return work_data + algo_gate.nonce_index;
-}
+   prof_reset();
 
-uint32_t* jr2_get_nonceptr( uint32_t *work_data )
-{
-   // nonce is misaligned, use byte offset
-   return (uint32_t*) ( ((uint8_t*) work_data) + algo_gate.nonce_index );
-}
+   // rates of the old algo would give absurd scan ranges
+   pthread_mutex_lock( &stats_lock );
+   for ( int i = 0; i < opt_n_threads; i++ )
+      thr_hashrates[i] = thr_hashcount[i] = 0.;
+   global_hashrate = 0.;
+   pthread_mutex_unlock( &stats_lock );
 
-void std_get_new_work( struct work* work, struct work* g_work, int thr_id,
-                     uint32_t *end_nonce_ptr, bool clean_job )
-{
-   uint32_t *nonceptr = algo_gate.get_nonceptr( work->data );
-   
-   if ( memcmp( work->data, g_work->data, algo_gate.work_cmp_size )
-      && ( clean_job || ( *nonceptr >= *end_nonce_ptr )
-         || ( work->job_id != g_work->job_id ) ) )
+   // rebuild the current job for the new algo
+   pthread_mutex_lock( &g_work_lock );
+   if ( have_stratum && stratum.job.job_id )
    {
-     work_free( work );
-     work_copy( work, g_work );
-     *nonceptr = 0xffffffffU / opt_n_threads * thr_id;
-     if ( opt_randomize )
-       *nonceptr += ( (rand() *4 ) & UINT32_MAX ) / opt_n_threads;
-     *end_nonce_ptr = ( 0xffffffffU / opt_n_threads ) * (thr_id+1) - 0x20; 
+      algo_gate.stratum_gen_work( &stratum, &g_work );
+      time( &g_work_time );
    }
    else
-       ++(*nonceptr);
+      g_work_time = 0;
+   pthread_mutex_unlock( &g_work_lock );
 }
 
-void jr2_get_new_work( struct work* work, struct work* g_work, int thr_id,
-                     uint32_t *end_nonce_ptr )
+static bool algo_switch_park( int thr_id )
 {
-   uint32_t *nonceptr = algo_gate.get_nonceptr( work->data );
+   int gen;
+
+   algo_gate.miner_thread_free( thr_id );
+   // the scratch kept for the next algo would count against its budget
+   if ( memory_budget() )
+      thread_scratch_free();
 
-   // byte data[ 0..38, 43..75 ], skip over misaligned nonce [39..42]
-   if ( memcmp( work->data, g_work->data, algo_gate.nonce_index )
-     || memcmp( ((uint8_t*) work->data)   + JR2_WORK_CMP_INDEX_2,
-                ((uint8_t*) g_work->data) + JR2_WORK_CMP_INDEX_2,
-                                                    JR2_WORK_CMP_SIZE_2 ) )
+   pthread_mutex_lock( &algo_switch_lock );
+   gen = algo_switch_gen;
+   if ( ++algo_switch_parked == opt_n_threads )
    {
-      work_free( work );
-      work_copy( work, g_work );
-      *nonceptr = ( 0xffffffU / opt_n_threads ) * thr_id
-                   + ( *nonceptr & 0xff000000U );
-      *end_nonce_ptr = ( 0xffffffU / opt_n_threads ) * (thr_id+1)
-                        + ( *nonceptr & 0xff000000U ) - 0x20;
+      // the gate lock comes first, the stratum thread requests switches
+      // while holding it. The other threads stay parked meanwhile.
+      pthread_mutex_unlock( &algo_switch_lock );
+      pthread_rwlock_wrlock( &algo_gate_lock );
+      pthread_mutex_lock( &algo_switch_lock );
+      algo_switch_exec();
+      pthread_rwlock_unlock( &algo_gate_lock );
+      algo_switch_to = ALGO_NULL;
+      algo_switch_parked = 0;
+      algo_switch_resumed = 0;
+      algo_switch_gen++;
+      pthread_cond_broadcast( &algo_switch_cond );
    }
-   else
-       ++(*nonceptr);
-}
+   else while ( gen == algo_switch_gen )
+      pthread_cond_wait( &algo_switch_cond, &algo_switch_lock );
+   pthread_mutex_unlock( &algo_switch_lock );
 
-bool std_ready_to_mine( struct work* work, struct stratum_ctx* stratum,
-                           int thr_id )
-{
-   if ( have_stratum && !work->data[0] && !opt_benchmark )
-   {
-      sleep(1);
+   if ( thr_id < memory_threads && !algo_gate.miner_thread_init( thr_id ) )
       return false;
+
+   pthread_mutex_lock( &algo_switch_lock );
+   if ( ++algo_switch_resumed == opt_n_threads )
+   {
+      struct timeval now, diff;
+      double ms;
+      gettimeofday( &now, NULL );
+      timeval_subtract( &diff, &now, &algo_switch_start );
+      ms = diff.tv_sec * 1e3 + diff.tv_usec * 1e-3;
+      applog( ms < 1000. ? LOG_BLUE : LOG_WARNING,
+              "Switched to %s in %.0f ms", algo_names[opt_algo], ms );
+      api_push_event( API_EVENT_JOB, "EVENT=algo;ALGO=%s;MS=%.0f|",
+                      algo_names[opt_algo], ms );
    }
+   pthread_mutex_unlock( &algo_switch_lock );
    return true;
 }
 
@@ -1614,12 +1265,13 @@ static void *miner_thread( void *userdata )
    // CPU thread affinity
    if (num_cpus > 1)
    {
-      if (opt_affinity == -1 && opt_n_threads > 1) 
+      if ( thread_pinned() )
       {
+         int cpu = thread_cpu( thr_id );
          if (opt_debug)
            applog( LOG_DEBUG, "Binding thread %d to cpu %d (mask %x)",
-                   thr_id, thr_id % num_cpus, ( 1 << (thr_id % num_cpus) ) );
-         affine_to_cpu_mask(thr_id, 1UL << (thr_id % num_cpus));
+                   thr_id, cpu, ( 1 << cpu ) );
+         affine_to_cpu_mask(thr_id, 1UL << cpu);
       }
       else if (opt_affinity != -1L)
       {
@@ -1636,12 +1288,36 @@ static void *miner_thread( void *userdata )
       exit (1);
    }
 
+   perf_thread_init( thr_id );
+
    while (1)
    {
        uint64_t hashes_done;
        struct timeval tv_start, tv_end, diff;
+       struct perf_stats pstats;
        int64_t max64;
        int nonce_found = 0;
+
+       if ( unlikely( algo_switch_to != ALGO_NULL ) )
+       {
+          if ( !algo_switch_park( thr_id ) )
+          {
+             applog( LOG_ERR, "FAIL: thread %u failed to initialize %s",
+                     thr_id, algo_names[opt_algo] );
+             exit(1);
+          }
+          // old work has the layout and target of the old algo
+          work_free( &work );
+          memset( &work, 0, sizeof(work) );
+          if ( !opt_benchmark )
+             end_nonce = 0;
+       }
+       // over the memory budget of this algo until the next switch
+       if ( unlikely( thr_id >= memory_threads ) )
+       {
+          usleep( 100000 );
+          continue;
+       }
        if ( algo_gate.do_this_thread( thr_id ) )
        {
           if (have_stratum)
@@ -1674,6 +1350,9 @@ static void *miner_thread( void *userdata )
 		pthread_mutex_unlock(&g_work_lock);
 		continue;
              }
+             // a new template always replaces the thread's work
+             algo_gate.get_new_work( &work, &g_work, thr_id, &end_nonce,
+                                     true );
              pthread_mutex_unlock( &g_work_lock );
           }
        } // do_this_thread
@@ -1720,6 +1399,7 @@ static void *miner_thread( void *userdata )
                 char rate[32];
                 format_hashrate(global_hashrate, rate);
                 applog(LOG_NOTICE, "Benchmark: %s", rate);
+                prof_report();
                 fprintf(stderr, "%llu\n", (unsigned long long)global_hashrate);
              }
              else
@@ -1729,9 +1409,16 @@ static void *miner_thread( void *userdata )
           }
           if (remain < max64) max64 = remain;
        }
-       // max64
+       // max64, from the rate per cpu second so a scan that was preempted
+       // or stolen from doesn't shrink the next one
        uint32_t work_nonce = *(algo_gate.get_nonceptr( work.data ) );
-       max64 *= thr_hashrates[thr_id];
+       double rate = cputime_rate( thr_id );
+       if ( rate <= 0. )
+          rate = thr_hashrates[thr_id];
+       max64 *= rate;
+       // keep scans short while throttled so the duty cycle stays smooth
+       if ( governor_duty( thr_id ) < 1.0 && max64 > (int64_t)( rate * 0.25 ) )
+          max64 = (int64_t)( rate * 0.25 );
        if ( max64 <= 0)
           max64 = (int64_t)algo_gate.get_max64();
        if ( work_nonce + max64 > end_nonce )
@@ -1743,7 +1430,11 @@ static void *miner_thread( void *userdata )
           firstwork_time = time(NULL);
        work_restart[thr_id].restart = 0;
        hashes_done = 0;
+       scan_solutions.count = 0;
+       scan_solutions.failed = false;
        gettimeofday((struct timeval *) &tv_start, NULL);
+       perf_thread_start( thr_id );
+       cputime_start( thr_id );
 
        // Scanhash
        nonce_found = (int) algo_gate.scanhash( thr_id, &work, max_nonce,
@@ -1751,6 +1442,8 @@ static void *miner_thread( void *userdata )
 
        // record scanhash elapsed time
        gettimeofday(&tv_end, NULL);
+       cputime_sample( thr_id, hashes_done );
+       perf_thread_sample( thr_id, hashes_done );
        timeval_subtract(&diff, &tv_end, &tv_start);
        if (diff.tv_usec || diff.tv_sec)
        {
@@ -1760,10 +1453,18 @@ static void *miner_thread( void *userdata )
 		hashes_done / (diff.tv_sec + diff.tv_usec * 1e-6);
 	  pthread_mutex_unlock(&stats_lock);
        }
-       // if nonce found, submit work 
+       if ( unlikely( scan_solutions.failed ) )
+          break;
+       // if nonce found, submit work, a multi solution scan already did
        if ( nonce_found && !opt_benchmark )
        {
-          if ( !submit_work(mythr, &work) )
+          if ( scan_solutions.count )
+          {
+             if ( opt_debug && scan_solutions.count > 1 )
+                applog( LOG_DEBUG, "CPU #%d: %d solutions in one scan",
+                        thr_id, scan_solutions.count );
+          }
+          else if ( !solo_submit(&work) && !submit_work(mythr, &work) )
                 break;
           // prevent stale work in solo
           // we can't submit twice a block!
@@ -1775,11 +1476,24 @@ static void *miner_thread( void *userdata )
              pthread_mutex_unlock(&g_work_lock);
           }
        }
+       // thermal duty cycle, count the pause in the thread's hashrate
+       if ( diff.tv_usec || diff.tv_sec )
+       {
+          double busy = diff.tv_sec + diff.tv_usec * 1e-6;
+          double off = governor_throttle( thr_id, busy );
+          if ( off > 0. )
+          {
+             pthread_mutex_lock( &stats_lock );
+             thr_hashrates[thr_id] *= busy / ( busy + off );
+             pthread_mutex_unlock( &stats_lock );
+          }
+       }
        // display hashrate
        if (!opt_quiet)
        {
           char hc[16];
           char hr[16];
+          char ct[64];
           char hc_units[2] = {0,0};
           char hr_units[2] = {0,0};
           double hashcount = thr_hashcount[thr_id];
@@ -1793,8 +1507,15 @@ static void *miner_thread( void *userdata )
              else // no fractions of a hash
                 sprintf( hc, "%.0f", hashcount );
              sprintf( hr, "%.2f", hashrate );
-             applog( LOG_INFO, "CPU #%d: %s %sH, %s %sH/s",
-                               thr_id, hc, hc_units, hr, hr_units );
+             cputime_format( thr_id, ct, sizeof ct );
+             applog( LOG_INFO, "CPU #%d: %s %sH, %s %sH/s%s",
+                               thr_id, hc, hc_units, hr, hr_units, ct );
+          }
+          if ( opt_perf_counters && perf_get_stats( thr_id, false, &pstats ) )
+          {
+             char ps[160];
+             perf_format( &pstats, ps, sizeof ps );
+             applog( LOG_INFO, "CPU #%d: %s", thr_id, ps );
           }
        }
        // Display benchmark total
@@ -1830,6 +1551,22 @@ static void *miner_thread( void *userdata )
                          hc, hc_units, hr, hr_units, (uint32_t)cpu_temp(0) );
 #endif
           }
+          if ( opt_perf_counters && perf_get_total( &pstats ) )
+          {
+             char ps[160];
+             perf_format( &pstats, ps, sizeof ps );
+             applog( LOG_NOTICE, "Total: %s", ps );
+          }
+#ifdef STAGE_PROFILE
+          static time_t last_profile = 0;
+          if ( !last_profile )
+             last_profile = time(NULL);
+          else if ( time(NULL) - last_profile >= 30 )
+          {
+             last_profile = time(NULL);
+             prof_report();
+          }
+#endif
        }
    }  // miner_thread loop
 
@@ -1838,48 +1575,6 @@ out:
 	return NULL;
 }
 
-void restart_threads(void)
-{
-	for ( int i = 0; i < opt_n_threads; i++)
-		work_restart[i].restart = 1;
-}
-
-json_t *std_longpoll_rpc_call( CURL *curl, int *err, char* lp_url )
-{
-   json_t *val;
-   char *req = NULL;
-   if (have_gbt)
-   {
-       req = (char*) malloc( strlen(gbt_lp_req) + strlen(lp_id) + 1 );
-       sprintf( req, gbt_lp_req, lp_id );
-   }
-   val = json_rpc_call( curl, rpc_url, rpc_userpass, getwork_req, err,
-                        JSON_RPC_LONGPOLL );
-   val = json_rpc_call( curl, lp_url, rpc_userpass, req ? req : getwork_req,
-                        err, JSON_RPC_LONGPOLL);
-   free(req);
-   return val;
-}
-
-json_t *jr2_longpoll_rpc_call( CURL *curl, int *err )
-{
-   json_t *val;
-   char req[128];
-
-   pthread_mutex_lock( &rpc2_login_lock );
-   if ( !strlen(rpc2_id) )
-   {
-     pthread_mutex_unlock( &rpc2_login_lock );
-     sleep(1);
-     return NULL;
-   }
-   snprintf( req, 128, "{\"method\": \"getjob\", \"params\": {\"id\": \"%s\"}, \"id\":1}\r\n", rpc2_id );
-   pthread_mutex_unlock( &rpc2_login_lock );
-   val = json_rpc2_call( curl, rpc_url, rpc_userpass, req, err,
-                         JSON_RPC_LONGPOLL );
-   return val;
-}
-
 static void *longpoll_thread(void *userdata)
 {
    struct thr_info *mythr = (struct thr_info*) userdata;
@@ -1937,7 +1632,7 @@ start:
       if (likely( val ))
       {
  	 bool rc;
-	 char *start_job_id;
+	 char start_job_id[WORK_JOB_ID_MAX];
 	 double start_diff = 0.0;
 	 json_t *res, *soval;
 	 res = json_object_get(val, "result");
@@ -1947,14 +1642,14 @@ start:
 	   submit_old = soval ? json_is_true(soval) : false;
 	 }
 	 pthread_mutex_lock(&g_work_lock);
-	 start_job_id = g_work.job_id ? strdup(g_work.job_id) : NULL;
+	 strcpy(start_job_id, g_work.job_id);
 	 if (have_gbt)
 	   rc = gbt_work_decode(res, &g_work);
 	 else
 	   rc = work_decode(res, &g_work);
 	 if (rc)
          {
-           bool newblock = g_work.job_id && strcmp(start_job_id, g_work.job_id);
+           bool newblock = *g_work.job_id && strcmp(start_job_id, g_work.job_id);
 	   newblock |= (start_diff != net_diff); // the best is the height but... longpoll...
            if (newblock)
            {
@@ -1973,9 +1668,12 @@ start:
 	     }
 	     time(&g_work_time);
 	     restart_threads();
+             api_push_event( API_EVENT_JOB,
+                     "EVENT=job;JOB=%s;HEIGHT=%d;DIFF=%g;CLEAN=1|",
+                     g_work.job_id, g_work.height,
+                     net_diff );
 	   }
          }
-         free(start_job_id);
          pthread_mutex_unlock(&g_work_lock);
          json_decref(val);
       }
@@ -2011,43 +1709,6 @@ out:
 	return NULL;
 }
 
-bool std_stratum_handle_response( json_t *val )
-{
-    bool valid = false;
-    json_t *err_val, *res_val, *id_val;
-    res_val = json_object_get( val, "result" );
-    err_val = json_object_get( val, "error" );
-    id_val  = json_object_get( val, "id" );
-
-    if ( !res_val || json_integer_value(id_val) < 4 )
-         return false;
-    valid = json_is_true( res_val );
-    share_result( valid, NULL, err_val ?
-                  json_string_value( json_array_get(err_val, 1) ) : NULL );
-    return true;
-}
-
-bool jr2_stratum_handle_response( json_t *val )
-{
-    bool valid = false;
-    json_t *err_val, *res_val;
-    res_val = json_object_get( val, "result" );
-    err_val = json_object_get( val, "error" );
-
-    if ( !res_val && !err_val )
-        return false;
-    json_t *status = json_object_get( res_val, "status" );
-    if ( status ) 
-    {
-        const char *s = json_string_value( status );
-        valid = !strcmp( s, "OK" ) && json_is_null( err_val );
-    }
-    else
-        valid = json_is_null( err_val );
-    share_result( valid, NULL, err_val ? json_string_value(err_val) : NULL );
-    return true;
-}
-
 static bool stratum_handle_response( char *buf )
 {
 	json_t *val, *id_val;
@@ -2064,7 +1725,12 @@ static bool stratum_handle_response( char *buf )
 	id_val = json_object_get( val, "id" );
 	if ( !id_val || json_is_null(id_val) )
 		goto out;
-        if ( !algo_gate.stratum_handle_response( val ) )
+        if ( json_integer_value( id_val ) == DIFFCTL_RPC_ID )
+                diffctl_response( val );
+        // mining.configure answered after its timeout
+        else if ( json_integer_value( id_val ) == STRATUM_CONFIGURE_ID )
+                ;
+        else if ( !algo_gate.stratum_handle_response( val ) )
                 goto out;
 	ret = true;
 out:
@@ -2073,80 +1739,10 @@ out:
 	return ret;
 }
 
-void std_build_extraheader( struct work* g_work, struct stratum_ctx* sctx )
-{
-   uchar merkle_root[64] = { 0 };
-   size_t t;
-   int i;
-
-   algo_gate.gen_merkle_root( merkle_root, sctx );
-   // Increment extranonce2
-   for ( t = 0; t < sctx->xnonce2_size && !( ++sctx->job.xnonce2[t] ); t++ );
-   // Assemble block header
-   memset( g_work->data, 0, sizeof(g_work->data) );
-   g_work->data[0] = le32dec( sctx->job.version );
-   for ( i = 0; i < 8; i++ )
-      g_work->data[1 + i] = le32dec( (uint32_t *) sctx->job.prevhash + i );
-   for ( i = 0; i < 8; i++ )
-      g_work->data[9 + i] = be32dec( (uint32_t *) merkle_root + i );
-
-   g_work->data[ algo_gate.ntime_index ] = le32dec(sctx->job.ntime);
-   g_work->data[ algo_gate.nbits_index ] = le32dec(sctx->job.nbits);
-   g_work->data[20] = 0x80000000;
-   g_work->data[31] = 0x00000280;
-}
-
-void std_stratum_gen_work( struct stratum_ctx *sctx, struct work *g_work )
-{
-   pthread_mutex_lock( &sctx->work_lock );
-   free( g_work->job_id );
-   g_work->job_id = strdup( sctx->job.job_id );
-   g_work->xnonce2_len = sctx->xnonce2_size;
-   g_work->xnonce2 = (uchar*) realloc( g_work->xnonce2, sctx->xnonce2_size );
-   memcpy( g_work->xnonce2, sctx->job.xnonce2, sctx->xnonce2_size );
-
-   algo_gate.build_extraheader( g_work, sctx );
-
-   net_diff = algo_gate.calc_network_diff( g_work );
-   algo_gate.set_work_data_endian( g_work );
-   pthread_mutex_unlock( &sctx->work_lock );
-
-   if ( opt_debug )
-   {
-     unsigned char *xnonce2str = abin2hex( g_work->xnonce2,
-                                           g_work->xnonce2_len );
-     applog( LOG_DEBUG, "DEBUG: job_id='%s' extranonce2=%s ntime=%08x",
-                    g_work->job_id, xnonce2str, swab32( g_work->data[17] ) );
-       free( xnonce2str );
-   }
-
-   algo_gate.set_target( g_work, sctx->job.diff );
-
-   if ( stratum_diff != sctx->job.diff )
-   {
-     char sdiff[32] = { 0 };
-     // store for api stats
-     stratum_diff = sctx->job.diff;
-     if ( opt_showdiff && g_work->targetdiff != stratum_diff )
-     {
-        snprintf( sdiff, 32, " (%.5f)", g_work->targetdiff );
-        applog( LOG_WARNING, "Stratum difficulty set to %g%s", stratum_diff,
-                        sdiff );
-     }
-   }
-}
-
-void jr2_stratum_gen_work( struct stratum_ctx *sctx, struct work *g_work )
-{
-   pthread_mutex_lock( &sctx->work_lock );
-   work_free( g_work );
-   work_copy( g_work, &sctx->work );
-   pthread_mutex_unlock( &sctx->work_lock );
-}
-
 static void *stratum_thread(void *userdata )
 {
     struct thr_info *mythr = (struct thr_info *) userdata;
+    bool connected;
     char *s;
 
     stratum.url = (char*) tq_pop(mythr->q, NULL);
@@ -2178,11 +1774,16 @@ static void *stratum_thread(void *userdata )
            g_work_time = 0;
            pthread_mutex_unlock( &g_work_lock );
            restart_threads();
-           if ( !stratum_connect( &stratum, stratum.url )
-                || !stratum_subscribe( &stratum )
-                || !stratum_authorize( &stratum, rpc_user, rpc_pass ) )
-           {
+           pthread_rwlock_rdlock( &algo_gate_lock );
+           connected = stratum_connect( &stratum, stratum.url )
+                && stratum_configure( &stratum )
+                && stratum_subscribe( &stratum )
+                && stratum_authorize( &stratum, rpc_user, rpc_pass );
+           if ( !connected )
               stratum_disconnect( &stratum );
+           pthread_rwlock_unlock( &algo_gate_lock );
+           if ( !connected )
+           {
               if (opt_retries >= 0 && ++failures > opt_retries)
               {
                  applog(LOG_ERR, "...terminating workio thread");
@@ -2199,15 +1800,23 @@ static void *stratum_thread(void *userdata )
               work_free(&g_work);
 	      work_copy(&g_work, &stratum.work);
            }
+           if ( stratum.curl )
+              diffctl_connect();
         }
 
         if ( stratum.job.job_id &&
              ( !g_work_time || strcmp( stratum.job.job_id, g_work.job_id ) ) )
         {
+           pthread_rwlock_rdlock( &algo_gate_lock );
            pthread_mutex_lock(&g_work_lock);
            algo_gate.stratum_gen_work( &stratum, &g_work );
            time(&g_work_time);
            pthread_mutex_unlock(&g_work_lock);
+           pthread_rwlock_unlock( &algo_gate_lock );
+           api_push_event( API_EVENT_JOB,
+                      "EVENT=job;JOB=%s;HEIGHT=%d;DIFF=%g;CLEAN=%d|",
+                      stratum.job.job_id, stratum.bloc_height,
+                      stratum.job.diff, stratum.job.clean ? 1 : 0 );
 //           restart_threads();
 
            if (stratum.job.clean || jsonrpc_2)
@@ -2235,6 +1844,15 @@ static void *stratum_thread(void *userdata )
            }
         }  // stratum.job.job_id
 
+        if ( opt_share_rate > 0. && g_work_time )
+        {
+           uint32_t target[8];
+           pthread_mutex_lock( &g_work_lock );
+           memcpy( target, g_work.target, sizeof(target) );
+           pthread_mutex_unlock( &g_work_lock );
+           diffctl_update( &stratum, target );
+        }
+
        if ( !stratum_socket_full( &stratum, opt_timeout ) )
        {
           applog(LOG_ERR, "Stratum connection timeout");
@@ -2248,468 +1866,16 @@ static void *stratum_thread(void *userdata )
 	  applog(LOG_ERR, "Stratum connection interrupted");
 	  continue;
        }
+       pthread_rwlock_rdlock( &algo_gate_lock );
        if (!stratum_handle_method(&stratum, s))
           stratum_handle_response(s);
+       pthread_rwlock_unlock( &algo_gate_lock );
        free(s);
    }  // loop
 out:
 	return NULL;
 }
 
-void show_version_and_exit(void)
-{
-        printf("\n built on " __DATE__
-#ifdef _MSC_VER
-         " with VC++ 2013\n");
-#elif defined(__GNUC__)
-         " with GCC");
-        printf(" %d.%d.%d\n", __GNUC__, __GNUC_MINOR__, __GNUC_PATCHLEVEL__);
-#endif
-
-        printf(" features:"
-#if defined(USE_ASM) && defined(__i386__)
-                " i386"
-#endif
-#if defined(USE_ASM) && defined(__x86_64__)
-                " x86_64"
-#endif
-#if defined(USE_ASM) && (defined(__i386__) || defined(__x86_64__))
-                " SSE2"
-#endif
-#if defined(__x86_64__) && defined(USE_AVX)
-                " AVX"
-#endif
-#if defined(__x86_64__) && defined(USE_AVX2)
-                " AVX2"
-#endif
-#if defined(__x86_64__) && defined(USE_XOP)
-                " XOP"
-#endif
-#if defined(USE_ASM) && defined(__arm__) && defined(__APCS_32__)
-                " ARM"
-#if defined(__ARM_ARCH_5E__) || defined(__ARM_ARCH_5TE__) || \
-        defined(__ARM_ARCH_5TEJ__) || defined(__ARM_ARCH_6__) || \
-        defined(__ARM_ARCH_6J__) || defined(__ARM_ARCH_6K__) || \
-        defined(__ARM_ARCH_6M__) || defined(__ARM_ARCH_6T2__) || \
-        defined(__ARM_ARCH_6Z__) || defined(__ARM_ARCH_6ZK__) || \
-        defined(__ARM_ARCH_7__) || \
-        defined(__ARM_ARCH_7A__) || defined(__ARM_ARCH_7R__) || \
-        defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
-                " ARMv5E"
-#endif
-#if defined(__ARM_NEON__)
-                " NEON"
-#endif
-#endif
-                "\n\n");
-
-        /* dependencies versions */
-        printf("%s\n", curl_version());
-#ifdef JANSSON_VERSION
-        printf("jansson/%s ", JANSSON_VERSION);
-#endif
-#ifdef PTW32_VERSION
-        printf("pthreads/%d.%d.%d.%d ", PTW32_VERSION);
-#endif
-        printf("\n");
-        exit(0);
-}
-
-
-void show_usage_and_exit(int status)
-{
-	if (status)
-		fprintf(stderr, "Try `" PACKAGE_NAME " --help' for more information.\n");
-	else
-		printf(usage);
-	exit(status);
-}
-
-void strhide(char *s)
-{
-	if (*s) *s++ = 'x';
-	while (*s) *s++ = '\0';
-}
-
-void parse_arg(int key, char *arg )
-{
-	char *p;
-	int v, i;
-	uint64_t ul;
-	double d;
-
-	switch(key)
-        {
-	   case 'a':
-              get_algo_alias( &arg );
-              for (i = 1; i < ALGO_COUNT; i++)
-              {
-	          v = (int) strlen(algo_names[i]);
-		  if (v && !strncasecmp(arg, algo_names[i], v))
-                  {
-			if (arg[v] == '\0')
-                        {
-				opt_algo = (enum algos) i;
-				break;
-			}
-			if (arg[v] == ':')
-                        {
-				char *ep;
-				v = strtol(arg+v+1, &ep, 10);
-                                if (*ep || v < 2)
-					continue;
-				opt_algo = (enum algos) i;
-				opt_scrypt_n = v;
-				break;
-			}
-		  }
-	      }
-              if (i == ALGO_COUNT)
-              {
-                 applog(LOG_ERR,"Unknown algo: %s",arg);
-                 show_usage_and_exit(1);
-              }
-           break;
-
-	case 'b':
-		p = strstr(arg, ":");
-		if (p) {
-			/* ip:port */
-			if (p - arg > 0) {
-				free(opt_api_allow);
-				opt_api_allow = strdup(arg);
-				opt_api_allow[p - arg] = '\0';
-			}
-			opt_api_listen = atoi(p + 1);
-		}
-		else if (arg && strstr(arg, ".")) {
-			/* ip only */
-			free(opt_api_allow);
-			opt_api_allow = strdup(arg);
-		}
-		else if (arg) {
-			/* port or 0 to disable */
-			opt_api_listen = atoi(arg);
-		}
-		break;
-	case 1030: /* --api-remote */
-		opt_api_remote = 1;
-		break;
-	case 'B':
-		opt_background = true;
-		use_colors = false;
-		break;
-	case 'c': {
-		json_error_t err;
-		json_t *config;
-                
-		if (arg && strstr(arg, "://"))
-			config = json_load_url(arg, &err);
-                else
-			config = JSON_LOADF(arg, &err);
-		if (!json_is_object(config))
-                {
-			if (err.line < 0)
-				fprintf(stderr, "%s\n", err.text);
-			else
-				fprintf(stderr, "%s:%d: %s\n",
-					arg, err.line, err.text);
-		}
-                else
-                {
-			parse_config(config, arg);
-			json_decref(config);
-		}
-		break;
-	}
-	case 'q':
-		opt_quiet = true;
-		break;
-	case 'D':
-		opt_debug = true;
-		break;
-	case 'p':
-		free(rpc_pass);
-		rpc_pass = strdup(arg);
-		strhide(arg);
-		break;
-	case 'P':
-		opt_protocol = true;
-		break;
-	case 'r':
-		v = atoi(arg);
-		if (v < -1 || v > 9999) /* sanity check */
-			show_usage_and_exit(1);
-		opt_retries = v;
-		break;
-	case 'R':
-		v = atoi(arg);
-		if (v < 1 || v > 9999) /* sanity check */
-			show_usage_and_exit(1);
-		opt_fail_pause = v;
-		break;
-	case 's':
-		v = atoi(arg);
-		if (v < 1 || v > 9999) /* sanity check */
-			show_usage_and_exit(1);
-		opt_scantime = v;
-		break;
-	case 'T':
-		v = atoi(arg);
-		if (v < 1 || v > 99999) /* sanity check */
-			show_usage_and_exit(1);
-		opt_timeout = v;
-		break;
-	case 't':
-		v = atoi(arg);
-		if (v < 0 || v > 9999) /* sanity check */
-			show_usage_and_exit(1);
-		opt_n_threads = v;
-		break;
-	case 'u':
-		free(rpc_user);
-		rpc_user = strdup(arg);
-		break;
-	case 'o': {			/* --url */
-		char *ap, *hp;
-		ap = strstr(arg, "://");
-		ap = ap ? ap + 3 : arg;
-		hp = strrchr(arg, '@');
-		if (hp) {
-			*hp = '\0';
-			p = strchr(ap, ':');
-			if (p) {
-				free(rpc_userpass);
-				rpc_userpass = strdup(ap);
-				free(rpc_user);
-				rpc_user = (char*) calloc(p - ap + 1, 1);
-				strncpy(rpc_user, ap, p - ap);
-				free(rpc_pass);
-				rpc_pass = strdup(++p);
-				if (*p) *p++ = 'x';
-				v = (int) strlen(hp + 1) + 1;
-				memmove(p + 1, hp + 1, v);
-				memset(p + v, 0, hp - p);
-				hp = p;
-			} else {
-				free(rpc_user);
-				rpc_user = strdup(ap);
-			}
-			*hp++ = '@';
-		} else
-			hp = ap;
-		if (ap != arg) {
-			if (strncasecmp(arg, "http://", 7) &&
-			    strncasecmp(arg, "https://", 8) &&
-			    strncasecmp(arg, "stratum+tcp://", 14)) {
-				fprintf(stderr, "unknown protocol -- '%s'\n", arg);
-				show_usage_and_exit(1);
-			}
-			free(rpc_url);
-			rpc_url = strdup(arg);
-			strcpy(rpc_url + (ap - arg), hp);
-			short_url = &rpc_url[ap - arg];
-		} else {
-			if (*hp == '\0' || *hp == '/') {
-				fprintf(stderr, "invalid URL -- '%s'\n",
-					arg);
-				show_usage_and_exit(1);
-			}
-			free(rpc_url);
-			rpc_url = (char*) malloc( strlen(hp) + 15 );
-			sprintf( rpc_url, "stratum+tcp://%s", hp );
-			short_url = &rpc_url[ sizeof("stratum+tcp://") - 1 ];
-		}
-		have_stratum = !opt_benchmark && !strncasecmp(rpc_url, "stratum", 7);
-		break;
-	}
-	case 'O':			/* --userpass */
-		p = strchr(arg, ':');
-		if (!p) {
-			fprintf(stderr, "invalid username:password pair -- '%s'\n", arg);
-			show_usage_and_exit(1);
-		}
-		free(rpc_userpass);
-		rpc_userpass = strdup(arg);
-		free(rpc_user);
-		rpc_user = (char*) calloc(p - arg + 1, 1);
-		strncpy(rpc_user, arg, p - arg);
-		free(rpc_pass);
-		rpc_pass = strdup(++p);
-		strhide(p);
-		break;
-	case 'x':			/* --proxy */
-		if (!strncasecmp(arg, "socks4://", 9))
-			opt_proxy_type = CURLPROXY_SOCKS4;
-		else if (!strncasecmp(arg, "socks5://", 9))
-			opt_proxy_type = CURLPROXY_SOCKS5;
-#if LIBCURL_VERSION_NUM >= 0x071200
-		else if (!strncasecmp(arg, "socks4a://", 10))
-			opt_proxy_type = CURLPROXY_SOCKS4A;
-		else if (!strncasecmp(arg, "socks5h://", 10))
-			opt_proxy_type = CURLPROXY_SOCKS5_HOSTNAME;
-#endif
-		else
-			opt_proxy_type = CURLPROXY_HTTP;
-		free(opt_proxy);
-		opt_proxy = strdup(arg);
-		break;
-	case 1001:
-		free(opt_cert);
-		opt_cert = strdup(arg);
-		break;
-	case 1002:
-		use_colors = false;
-		break;
-	case 1003:
-		want_longpoll = false;
-		break;
-	case 1005:
-		opt_benchmark = true;
-		want_longpoll = false;
-		want_stratum = false;
-		have_stratum = false;
-		break;
-	case 1006:
-//		print_hash_tests();
-		exit(0);
-	case 1007:
-		want_stratum = false;
-		opt_extranonce = false;
-		break;
-	case 1008:
-		opt_time_limit = atoi(arg);
-		break;
-	case 1009:
-		opt_redirect = false;
-		break;
-	case 1010:
-		allow_getwork = false;
-		break;
-	case 1011:
-		have_gbt = false;
-		break;
-	case 1012:
-		opt_extranonce = false;
-		break;
-	case 1013:
-		opt_showdiff = false;
-		break;
-	case 1016:			/* --coinbase-addr */
-		pk_script_size = address_to_script(pk_script, sizeof(pk_script), arg);
-		if (!pk_script_size) {
-			fprintf(stderr, "invalid address -- '%s'\n", arg);
-			show_usage_and_exit(1);
-		}
-		break;
-	case 1015:			/* --coinbase-sig */
-		if (strlen(arg) + 1 > sizeof(coinbase_sig)) {
-			fprintf(stderr, "coinbase signature too long\n");
-			show_usage_and_exit(1);
-		}
-		strcpy(coinbase_sig, arg);
-		break;
-	case 'f':
-		d = atof(arg);
-		if (d == 0.)	/* --diff-factor */
-			show_usage_and_exit(1);
-		opt_diff_factor = d;
-		break;
-	case 'm':
-		d = atof(arg);
-		if (d == 0.)	/* --diff-multiplier */
-			show_usage_and_exit(1);
-		opt_diff_factor = 1.0/d;
-		break;
-	case 'S':
-		use_syslog = true;
-		use_colors = false;
-		break;
-	case 1020:
-		p = strstr(arg, "0x");
-		if (p)
-			ul = strtoul(p, NULL, 16);
-		else
-			ul = atol(arg);
-		if (ul > (1UL<<num_cpus)-1)
-			ul = -1;
-		opt_affinity = ul;
-		break;
-	case 1021:
-		v = atoi(arg);
-		if (v < 0 || v > 5)	/* sanity check */
-			show_usage_and_exit(1);
-		opt_priority = v;
-		break;
-	case 1060: // max-temp
-		d = atof(arg);
-		opt_max_temp = d;
-		break;
-	case 1061: // max-diff
-		d = atof(arg);
-		opt_max_diff = d;
-		break;
-	case 1062: // max-rate
-		d = atof(arg);
-		p = strstr(arg, "K");
-		if (p) d *= 1e3;
-		p = strstr(arg, "M");
-		if (p) d *= 1e6;
-		p = strstr(arg, "G");
-		if (p) d *= 1e9;
-		opt_max_rate = d;
-		break;
-	case 1024:
-		opt_randomize = true;
-		break;
-	case 'V':
-		show_version_and_exit();
-	case 'h':
-		show_usage_and_exit(0);
-	default:
-		show_usage_and_exit(1);
-	}
-}
-
-void parse_config(json_t *config, char *ref)
-{
-	int i;
-	json_t *val;
-
-	for (i = 0; i < ARRAY_SIZE(options); i++) {
-		if (!options[i].name)
-			break;
-
-		val = json_object_get(config, options[i].name);
-		if (!val)
-			continue;
-		if (options[i].has_arg && json_is_string(val)) {
-			char *s = strdup(json_string_value(val));
-			if (!s)
-				break;
-			parse_arg(options[i].val, s);
-			free(s);
-		}
-		else if (options[i].has_arg && json_is_integer(val)) {
-			char buf[16];
-			sprintf(buf, "%d", (int)json_integer_value(val));
-			parse_arg(options[i].val, buf);
-		}
-		else if (options[i].has_arg && json_is_real(val)) {
-			char buf[16];
-			sprintf(buf, "%f", json_real_value(val));
-			parse_arg(options[i].val, buf);
-		}
-		else if (!options[i].has_arg) {
-			if (json_is_true(val))
-				parse_arg(options[i].val, "");
-		}
-		else
-			applog(LOG_ERR, "JSON option %s invalid",
-			options[i].name);
-	}
-}
-
 static void parse_cmdline(int argc, char *argv[])
 {
    int key;
@@ -2898,6 +2064,7 @@ int main(int argc, char *argv[])
 	struct thr_info *thr;
 	long flags;
 	int i, err;
+	bool threads_given;
 
 	pthread_mutex_init(&applog_lock, NULL);
 
@@ -2925,8 +2092,18 @@ int main(int argc, char *argv[])
 
 	parse_cmdline(argc, argv);
 
+        if ( opt_cputest )
+           exit( cpu_selftest( opt_algo ) ? 1 : 0 );
+
+        if ( !cgroup_init() )
+           exit(1);
+        threads_given = opt_n_threads != 0;
+
+        if ( !split_init() )
+           exit(1);
+
         if (!opt_n_threads)
-                opt_n_threads = num_cpus;
+                opt_n_threads = cgroup_threads();
 
 /*
         // All options must be set before starting the gate
@@ -2943,6 +2120,8 @@ int main(int argc, char *argv[])
             fprintf(stderr, "%s: no algo supplied\n", argv[0]);
             show_usage_and_exit(1);
         }
+        if ( opt_verify )
+           exit( cpu_verify() ? 1 : 0 );
 	if ( !opt_benchmark )
         {
             if ( !short_url )
@@ -2988,6 +2167,9 @@ int main(int argc, char *argv[])
         if ( !check_cpu_capability() )
            exit(1);
 
+        if ( !memory_init( threads_given ) )
+           exit(1);
+
 	pthread_mutex_init(&stats_lock, NULL);
 	pthread_mutex_init(&g_work_lock, NULL);
 	pthread_mutex_init(&rpc2_job_lock, NULL);
@@ -3054,6 +2236,9 @@ int main(int argc, char *argv[])
 		SetPriorityClass(GetCurrentProcess(), prio);
 	}
 #endif
+	if ( !split_start() )
+		return 1;
+
 	if (opt_affinity != -1)
         {
 		if (!opt_quiet)
@@ -3061,7 +2246,6 @@ int main(int argc, char *argv[])
 		affine_to_cpu_mask(-1, (unsigned long)opt_affinity);
 	}
 
-
 //#ifdef HAVE_SYSLOG_H
 //	if (use_syslog)
 //		openlog("cpuminer", LOG_PID, LOG_USER);
@@ -3070,7 +2254,7 @@ int main(int argc, char *argv[])
 	work_restart = (struct work_restart*) calloc(opt_n_threads, sizeof(*work_restart));
 	if (!work_restart)
 		return 1;
-	thr_info = (struct thr_info*) calloc(opt_n_threads + 4, sizeof(*thr));
+	thr_info = (struct thr_info*) calloc(opt_n_threads + 6, sizeof(*thr));
 	if (!thr_info)
 		return 1;
 	thr_hashrates = (double *) calloc(opt_n_threads, sizeof(double));
@@ -3079,6 +2263,15 @@ int main(int argc, char *argv[])
         thr_hashcount = (double *) calloc(opt_n_threads, sizeof(double));
         if (!thr_hashcount)
                 return 1;
+        if ( !perf_init( opt_n_threads ) )
+                return 1;
+        if ( !cputime_init( opt_n_threads ) )
+                return 1;
+        if ( !governor_init() )
+                return 1;
+
+        if ( opt_bench )
+           exit( cpu_bench() ? 1 : 0 );
 
 	/* init workio thread info */
 	work_thr_id = opt_n_threads;
@@ -3099,6 +2292,22 @@ int main(int argc, char *argv[])
 		return 1;
 	}
 
+	if (!have_stratum && !opt_benchmark && !jsonrpc_2)
+        {
+		/* solo block submit thread */
+		solo_thr_id = opt_n_threads + 5;
+		thr = &thr_info[solo_thr_id];
+		thr->id = solo_thr_id;
+		thr->q = tq_new();
+		if (!thr->q)
+			return 1;
+		err = thread_create(thr, solo_thread);
+		if (err) {
+			applog(LOG_ERR, "solo submit thread create failed");
+			return 1;
+		}
+	}
+
 	/* ESET-NOD32 Detects these 2 thread_create... */
 	if (want_longpoll && !have_stratum)
         {
@@ -3152,7 +2361,23 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	if (opt_max_temp > 0. || opt_max_power > 0.)
+        {
+		/* thermal governor thread */
+		thr = &thr_info[opt_n_threads + 4];
+		thr->id = opt_n_threads + 4;
+		thr->q = tq_new();
+		if (!thr->q)
+			return 1;
+		err = thread_create(thr, governor_thread);
+		if (err) {
+			applog(LOG_ERR, "governor thread create failed");
+			return 1;
+		}
+	}
+
 	/* start mining threads */
+	submit_solution_hook = submit_solution;
 	for (i = 0; i < opt_n_threads; i++)
         {
 		thr = &thr_info[i];
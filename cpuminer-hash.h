@@ -0,0 +1,85 @@
+/*
+ * Hash library of the cpuminer algos, libcpuminer-hash.a
+ *
+ * Hashes block headers with the same kernels as the miner, for a pool
+ * that checks the shares it gets. Build it with "make libcpuminer-hash.a"
+ * and link with the libraries of cpuminer:
+ *
+ *   -lcpuminer-hash -lcurl -ljansson -lssl -lcrypto -lgmp -lpthread -lstdc++ -lm
+ *
+ * with compat/jansson in the library path when the bundled jansson is used.
+ *
+ * A context is opened once per algo and hashes one header or batches of
+ * them on a pool of threads. The algos keep their state in globals, so
+ * only one context can be open in a process at a time: cmh_init returns
+ * NULL while another is open, for the same algo too, until it is passed
+ * to cmh_free. A pool that checks shares of two algos runs a process for
+ * each.
+ *
+ * Headers are the bytes that go on the wire, cmh_header_len() of them
+ * each. Hashes and targets are 32 bytes in memory order, the last 4 bytes
+ * are the most significant word as in a share target.
+ *
+ * scrypt, yescrypt, pluck and drop have no single hash function, they are
+ * only verified against a target by a scan of the one nonce.
+ */
+
+#ifndef CPUMINER_HASH_H__
+#define CPUMINER_HASH_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CMH_API_VERSION 2
+
+typedef struct cmh_ctx cmh_ctx;
+
+/*
+ * Opens an algo by name or alias, "scrypt:N" and "scryptjane:NF" too.
+ * threads 0 is one per cpu. NULL if the algo is unknown, fails to start
+ * or another context is open.
+ */
+cmh_ctx *cmh_init( const char *algo, int threads );
+void     cmh_free( cmh_ctx *ctx );
+
+/* bytes of a header of the algo */
+int cmh_header_len( const cmh_ctx *ctx );
+
+/* 0 if the algo can only be verified */
+int cmh_can_hash( const cmh_ctx *ctx );
+
+/*
+ * 0 for a header the algo can't hash safely, such as an x11evo header
+ * with an ntime before the coin's start. Such a header hashes to all ones
+ * and passes no target, cmh_hash returns -1 for it.
+ */
+int cmh_header_ok( const cmh_ctx *ctx, const void *header );
+
+/*
+ * Hashes n headers, n * cmh_header_len() bytes, to n 32 byte hashes.
+ * cmh_hash runs on the caller, batches on the pool. 0 on success, -1 if
+ * the algo can't hash.
+ */
+int cmh_hash( cmh_ctx *ctx, void *hash, const void *header );
+int cmh_hash_batch( cmh_ctx *ctx, void *hashes, const void *headers,
+                    size_t n );
+
+/*
+ * pass[i] is 1 if the hash of header i is at or below targets[i], 32
+ * bytes each, 0 if not. With target_stride 0 all headers share the one
+ * target. hashes may be NULL, and is left as is by the verify only algos.
+ * 0 on success.
+ */
+int cmh_verify_batch( cmh_ctx *ctx, uint8_t *pass, void *hashes,
+                      const void *headers, const void *targets,
+                      size_t target_stride, size_t n );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,253 @@
+/**
+ * Cpu time of the miner threads
+ *
+ * The hashrate is the hashes of a scan over its wall time. On a VM or a
+ * shared host the thread doesn't run for part of that time: the hypervisor
+ * gives the cpu to another guest (steal time) or the scheduler gives it to
+ * another process (involuntary context switches). Each scan is also timed
+ * on the thread's cpu clock, the steal of its cpu is read from /proc/stat
+ * and the switches from getrusage. A thread that gets little of the cpu
+ * with a high steal has a noisy neighbour, one with little steal loses it
+ * on the host itself, one that gets all of it and is still slow has a
+ * problem of its own.
+ *
+ * Scans are sized from the hashes per cpu second times the share of the
+ * cpu the thread gets on average, one preempted scan doesn't shrink the
+ * next ones.
+ */
+
+#define _GNU_SOURCE  /* RUSAGE_THREAD */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux
+#include <sys/resource.h>
+#endif
+
+#include "miner.h"
+
+#define CT_SMOOTH      0.3     /* weight of a new scan */
+#define CT_MIN_CPU     0.001   /* s, shorter scans are too coarse to use */
+#define CT_LOG_SHARE   0.95    /* the log line shows the cpu time below */
+
+struct ct_thread {
+	/* at the start of the scan */
+	double wall0, cpu0, steal0;
+	long nivcsw0;
+	/* last scan */
+	double wall, cpu, steal;
+	long nivcsw;
+	/* totals */
+	double t_wall, t_cpu, t_steal;
+	long t_nivcsw;
+	uint64_t t_hashes;
+	/* smoothed */
+	double cpu_rate;   /* hashes per cpu second */
+	double share;      /* cpu time over wall time */
+};
+
+static struct ct_thread *ct_thr = NULL;
+static int ct_n_threads = 0;
+
+static double ct_clock(clockid_t id)
+{
+	struct timespec ts;
+
+	if (clock_gettime(id, &ts))
+		return 0.;
+	return (double) ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* cpu time of the calling thread, the wall time where there is no clock */
+static double ct_thread_clock()
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+	return ct_clock(CLOCK_THREAD_CPUTIME_ID);
+#else
+	return ct_clock(CLOCK_MONOTONIC);
+#endif
+}
+
+static long ct_nivcsw()
+{
+#if defined(__linux) && defined(RUSAGE_THREAD)
+	struct rusage ru;
+
+	if (!getrusage(RUSAGE_THREAD, &ru))
+		return ru.ru_nivcsw;
+#endif
+	return 0;
+}
+
+/*
+ * Seconds of steal of a cpu, or the average of all cpus for -1. The 8th
+ * value of a "cpuN" line of /proc/stat, in USER_HZ ticks.
+ */
+static double ct_steal(int cpu)
+{
+	double steal = 0.;
+#ifdef __linux
+	char line[512], name[16];
+	unsigned long long v[8];
+	FILE *fd;
+
+	if (cpu >= 0)
+		snprintf(name, sizeof(name), "cpu%d ", cpu);
+	else
+		snprintf(name, sizeof(name), "cpu ");
+	if (!(fd = fopen("/proc/stat", "r")))
+		return 0.;
+	while (fgets(line, sizeof(line), fd)) {
+		if (strncmp(line, "cpu", 3))
+			break;
+		if (strncmp(line, name, strlen(name)))
+			continue;
+		if (sscanf(line + strlen(name), "%llu %llu %llu %llu %llu %llu "
+		    "%llu %llu", v, v + 1, v + 2, v + 3, v + 4, v + 5, v + 6, v + 7)
+		    == 8)
+			steal = (double) v[7] / sysconf(_SC_CLK_TCK);
+		break;
+	}
+	fclose(fd);
+	if (cpu < 0 && num_cpus > 1)
+		steal /= num_cpus;
+#endif
+	return steal;
+}
+
+/* the cpu a miner thread is bound to, -1 if it can run on several */
+static int ct_cpu(int thr_id)
+{
+	return num_cpus > 1 && thread_pinned() ? thread_cpu(thr_id) : -1;
+}
+
+bool cputime_init(int n_threads)
+{
+	ct_thr = (struct ct_thread*) calloc(n_threads, sizeof(*ct_thr));
+	if (!ct_thr)
+		return false;
+	ct_n_threads = n_threads;
+	return true;
+}
+
+/* just before scanhash */
+void cputime_start(int thr_id)
+{
+	struct ct_thread *ct;
+
+	if (thr_id >= ct_n_threads)
+		return;
+	ct = &ct_thr[thr_id];
+	ct->steal0 = ct_steal(ct_cpu(thr_id));
+	ct->nivcsw0 = ct_nivcsw();
+	ct->cpu0 = ct_thread_clock();
+	ct->wall0 = ct_clock(CLOCK_MONOTONIC);
+}
+
+/* after a scanhash of hashes_done */
+void cputime_sample(int thr_id, uint64_t hashes_done)
+{
+	struct ct_thread *ct;
+	double wall, cpu, share;
+
+	if (thr_id >= ct_n_threads)
+		return;
+	ct = &ct_thr[thr_id];
+	wall = ct_clock(CLOCK_MONOTONIC) - ct->wall0;
+	cpu = ct_thread_clock() - ct->cpu0;
+	if (cpu > wall)
+		cpu = wall;
+	ct->wall = wall;
+	ct->cpu = cpu;
+	ct->steal = ct_steal(ct_cpu(thr_id)) - ct->steal0;
+	if (ct->steal > wall - cpu)
+		ct->steal = wall - cpu;
+	if (ct->steal < 0.)
+		ct->steal = 0.;
+	ct->nivcsw = ct_nivcsw() - ct->nivcsw0;
+
+	ct->t_wall += wall;
+	ct->t_cpu += cpu;
+	ct->t_steal += ct->steal;
+	ct->t_nivcsw += ct->nivcsw;
+	ct->t_hashes += hashes_done;
+
+	if (cpu < CT_MIN_CPU || !hashes_done)
+		return;
+	share = cpu / wall;
+	if (ct->cpu_rate > 0.) {
+		ct->cpu_rate += CT_SMOOTH * (hashes_done / cpu - ct->cpu_rate);
+		ct->share += CT_SMOOTH * (share - ct->share);
+	}
+	else {
+		ct->cpu_rate = hashes_done / cpu;
+		ct->share = share;
+	}
+}
+
+/* hashes per wall second to size the next scan, 0 before the first */
+double cputime_rate(int thr_id)
+{
+	if (thr_id >= ct_n_threads)
+		return 0.;
+	return ct_thr[thr_id].cpu_rate * ct_thr[thr_id].share;
+}
+
+/* ", cpu 82%, steal 15%, 40 preempted" for the log, empty at a full cpu */
+void cputime_format(int thr_id, char *out, size_t sz)
+{
+	struct ct_thread *ct;
+
+	*out = '\0';
+	if (thr_id >= ct_n_threads)
+		return;
+	ct = &ct_thr[thr_id];
+	if (ct->wall <= 0. || ct->cpu >= ct->wall * CT_LOG_SHARE)
+		return;
+	snprintf(out, sz, ", cpu %.0f%%, steal %.0f%%, %ld preempted",
+		100. * ct->cpu / ct->wall, 100. * ct->steal / ct->wall,
+		ct->nivcsw);
+}
+
+static int ct_format(char *buf, size_t sz, double wall, double cpu,
+	double steal, long nivcsw, uint64_t hashes)
+{
+	return snprintf(buf, sz, "WALL=%.3f;CPUTIME=%.3f;EFF=%.4f;STEAL=%.4f;"
+		"NIVCSW=%ld;HS=%.2f;CPUHS=%.2f|", wall, cpu,
+		wall > 0. ? cpu / wall : 0., wall > 0. ? steal / wall : 0., nivcsw,
+		wall > 0. ? hashes / wall : 0., cpu > 0. ? hashes / cpu : 0.);
+}
+
+/* api "cputime" command, one record per thread and the total */
+int cputime_format_api(char *buf, size_t sz)
+{
+	double wall = 0., cpu = 0., steal = 0.;
+	uint64_t hashes = 0;
+	long nivcsw = 0;
+	size_t len = 0;
+
+	*buf = '\0';
+	for (int i = 0; i < ct_n_threads && len < sz; i++) {
+		struct ct_thread *ct = &ct_thr[i];
+		len += snprintf(buf + len, sz - len, "CPU=%d;", i);
+		if (len < sz)
+			len += ct_format(buf + len, sz - len, ct->t_wall, ct->t_cpu,
+				ct->t_steal, ct->t_nivcsw, ct->t_hashes);
+		wall += ct->t_wall;
+		cpu += ct->t_cpu;
+		steal += ct->t_steal;
+		nivcsw += ct->t_nivcsw;
+		hashes += ct->t_hashes;
+	}
+	/* rates of the whole miner, not of an average thread */
+	if (len < sz && ct_n_threads) {
+		len += snprintf(buf + len, sz - len, "CPU=total;");
+		if (len < sz)
+			len += ct_format(buf + len, sz - len, wall / ct_n_threads,
+				cpu / ct_n_threads, steal / ct_n_threads, nivcsw,
+				hashes);
+	}
+	return (int) len;
+}
@@ -0,0 +1,146 @@
+/**
+ * Share difficulty suggestion, --share-rate
+ *
+ * At the pool's default difficulty a fast algo on a big machine sends a
+ * flood of shares and a slow one so few that the accepted rate says
+ * nothing. With --share-rate=N the difficulty for N shares a minute at the
+ * measured hashrate is sent with mining.suggest_difficulty, and sent again
+ * when it moves by more than DC_HYSTERESIS. The hashes per share come from
+ * the target of the current work, so the algo's difficulty scale and
+ * --diff-factor are taken into account.
+ *
+ * A pool that answers with an error, or that doesn't move its difficulty
+ * towards the suggestion within DC_GRACE seconds, is left at its own
+ * difficulty until the next connection.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "miner.h"
+
+#define DC_HYSTERESIS  1.5    /* factor between suggestions */
+#define DC_INTERVAL    120    /* seconds between suggestions */
+#define DC_GRACE       90     /* seconds for the pool to follow */
+#define DC_WARMUP      30     /* seconds of hashrate before the first */
+#define DC_SMOOTH      0.3    /* weight of a new hashrate sample */
+
+double opt_share_rate = 0.;   /* shares per minute, 0 for off */
+
+static double dc_hashrate = 0.;
+static double dc_sent = 0.;        /* last suggestion, 0 for none */
+static double dc_pool_diff = 0.;   /* pool difficulty when it was sent */
+static time_t dc_sent_time = 0;
+static time_t dc_start = 0;
+static bool   dc_ignored = false;
+
+/* hashes to find a hash at or below the target */
+static double dc_hashes_per_share(const uint32_t *target)
+{
+	double t = 0.;
+
+	for (int i = 7; i >= 0; i--)
+		t = t * 4294967296.0 + target[i];
+	return t > 0. ? pow(2., 256.) / (t + 1.) : 0.;
+}
+
+/* 3 significant digits, pools show the difficulty as it was sent */
+static double dc_round(double diff)
+{
+	double unit = pow(10., floor(log10(diff)) - 2.);
+	return round(diff / unit) * unit;
+}
+
+static bool dc_suggest(struct stratum_ctx *sctx, double diff)
+{
+	char s[128];
+
+	snprintf(s, sizeof(s), "{\"id\": %d, \"method\": "
+		"\"mining.suggest_difficulty\", \"params\": [%g]}",
+		DIFFCTL_RPC_ID, diff);
+	return stratum_send_line(sctx, s);
+}
+
+/* a new stratum session, suggest again once the hashrate is known */
+void diffctl_connect()
+{
+	dc_sent = 0.;
+	dc_ignored = false;
+	if (!dc_start)
+		dc_start = time(NULL);
+}
+
+/*
+ * Called by the stratum thread with the target of the current work, for
+ * the pool difficulty sctx->job.diff.
+ */
+void diffctl_update(struct stratum_ctx *sctx, const uint32_t *target)
+{
+	double hashrate = 0., pool_diff, hps, diff;
+	time_t now = time(NULL);
+	char rate[32];
+
+	if (opt_share_rate <= 0. || dc_ignored || jsonrpc_2)
+		return;
+
+	pthread_mutex_lock(&stats_lock);
+	for (int i = 0; i < opt_n_threads; i++)
+		hashrate += thr_hashrates[i];
+	pthread_mutex_unlock(&stats_lock);
+	if (hashrate <= 0.)
+		return;
+	dc_hashrate = dc_hashrate > 0. ? dc_hashrate
+		+ DC_SMOOTH * (hashrate - dc_hashrate) : hashrate;
+
+	pool_diff = sctx->job.diff;
+	hps = dc_hashes_per_share(target);
+	if (pool_diff <= 0. || hps <= 0. || now - dc_start < DC_WARMUP)
+		return;
+
+	/* a pool that never followed */
+	if (dc_sent > 0. && now - dc_sent_time > DC_GRACE
+	    && pool_diff == dc_pool_diff
+	    && fabs(log(pool_diff / dc_sent)) > log(DC_HYSTERESIS)) {
+		applog(LOG_WARNING, "Pool keeps difficulty %g, not following the "
+			"suggested %g", pool_diff, dc_sent);
+		dc_ignored = true;
+		return;
+	}
+
+	diff = dc_round(pool_diff * dc_hashrate * 60. / opt_share_rate / hps);
+	if (dc_sent > 0. && (now - dc_sent_time < DC_INTERVAL
+	    || fabs(log(diff / dc_sent)) < log(DC_HYSTERESIS)))
+		return;
+	if (!dc_suggest(sctx, diff))
+		return;
+
+	format_hashrate(dc_hashrate, rate);
+	applog(LOG_INFO, "Suggesting difficulty %g for %g shares/min at %s",
+		diff, opt_share_rate, rate);
+	dc_sent = diff;
+	dc_pool_diff = pool_diff;
+	dc_sent_time = now;
+}
+
+/* the answer to mining.suggest_difficulty */
+void diffctl_response(json_t *val)
+{
+	json_t *res_val = json_object_get(val, "result");
+	json_t *err_val = json_object_get(val, "error");
+
+	if ((err_val && !json_is_null(err_val)) || json_is_false(res_val)) {
+		applog(LOG_WARNING, "Pool doesn't take mining.suggest_difficulty, "
+			"using its difficulty");
+		dc_ignored = true;
+	}
+}
+
+int diffctl_format_api(char *buf, size_t sz)
+{
+	return snprintf(buf, sz, "RATE=%g;HASHRATE=%.2f;SUGGESTED=%g;"
+		"IGNORED=%d|", opt_share_rate, dc_hashrate, dc_sent,
+		dc_ignored ? 1 : 0);
+}
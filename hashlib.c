@@ -0,0 +1,448 @@
+/**
+ * Hash library, see cpuminer-hash.h
+ *
+ * The algos are the miner's own through the gate, registered as with -a.
+ * A header is hashed the way scanhash hashes it: gate.hash on the wire
+ * bytes, after a one nonce scan for the algos whose hash reads a midstate
+ * that scanhash prepares. Algos with a lane kernel hash consecutive headers
+ * of a batch together when only their nonces differ, the others one by one.
+ * The algos with no plain hash verify by scanning the one nonce.
+ *
+ * A batch is cut in one slice per thread, the caller hashes the first. The
+ * pool threads are threads of the algo, with their own miner_thread_init
+ * and scratch, the caller's scratch is freed by cmh_free. No algo reads
+ * thr_id other than for work_restart, the scans all run as thread 0.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "miner.h"
+#include "algo-gate-api.h"
+#include "cpuminer-hash.h"
+
+#define HL_MAX_THREADS  256
+#define HL_MAX_LEN      180   /* decred */
+#define HL_MIN_SLICE    16    /* headers per thread worth a wake up */
+#define HL_MAX_PREFIX   128   /* decred's midstate */
+#define HL_X11EVO_START 1462060800   /* INITIAL_DATE of x11evo.c */
+
+#define HL_RAW          1     /* hash input is work data as is */
+#define HL_PRIME        2     /* gate.hash reads a midstate of scanhash */
+#define HL_SCAN         4     /* no plain hash, verify by scan */
+
+/*
+ * algos that differ from an 80 byte big endian header, as in selftest.c.
+ * prefix is the bytes of the header a primed midstate covers.
+ */
+static const struct {
+	int algo;
+	int len;
+	int flags;
+	int prefix;
+} hl_algos[] =
+{
+	{ ALGO_BLAKE,       80,  HL_PRIME,          64 },
+	{ ALGO_BLAKECOIN,   80,  HL_PRIME,          64 },
+	{ ALGO_CRYPTOLIGHT, 76,  HL_RAW,            0 },
+	{ ALGO_CRYPTONIGHT, 76,  HL_RAW,            0 },
+	{ ALGO_DECRED,      180, HL_RAW | HL_PRIME, 128 },
+	{ ALGO_DROP,        80,  HL_SCAN,           0 },
+	{ ALGO_HEAVY,       80,  HL_RAW,            0 },
+	{ ALGO_LBRY,        112, 0,                 0 },
+	{ ALGO_LYRA2RE,     80,  HL_PRIME,          64 },
+	{ ALGO_LYRA2REV2,   80,  HL_PRIME,          64 },
+	{ ALGO_LYRA2Z,      80,  HL_PRIME,          64 },
+	{ ALGO_NEOSCRYPT,   80,  HL_RAW,            0 },
+	{ ALGO_PLUCK,       80,  HL_SCAN,           0 },
+	{ ALGO_SCRYPT,      80,  HL_SCAN,           0 },
+	{ ALGO_TIMETRAVEL,  80,  HL_PRIME,          64 },
+	{ ALGO_VANILLA,     80,  HL_PRIME,          64 },
+	{ ALGO_WHIRLPOOL,   80,  HL_PRIME,          64 },
+	{ ALGO_XEVAN,       80,  HL_PRIME,          64 },
+	{ ALGO_YESCRYPT,    80,  HL_SCAN,           0 },
+};
+
+struct cmh_ctx {
+	int algo;
+	int len;
+	int flags;
+	int prefix;
+	int lanes;
+	int threads;
+	int serial;
+	pthread_t *pool;
+	int started;
+
+	pthread_mutex_t batch_lock;   /* one batch at a time */
+	pthread_mutex_t lock;
+	pthread_cond_t start;
+	pthread_cond_t done;
+	int gen;
+	int busy;
+	bool quit;
+	bool error;
+
+	/* the batch */
+	const uchar *headers;
+	uchar *hashes;
+	uint8_t *pass;
+	const uchar *targets;
+	size_t stride;
+	size_t n;
+};
+
+static pthread_mutex_t hl_open_lock = PTHREAD_MUTEX_INITIALIZER;
+static cmh_ctx *hl_open = NULL;
+static int hl_serial = 0;
+static struct work_restart hl_restart[1];
+
+/* context whose miner_thread_init ran on this thread, and its primed prefix */
+static __thread int hl_thread_serial = 0;
+static __thread bool hl_primed = false;
+static __thread uchar hl_prefix[HL_MAX_PREFIX];
+
+static void hl_work_data(const cmh_ctx *ctx, uint32_t *data,
+	const uchar *header)
+{
+	uint32_t in[HL_MAX_LEN / 4];
+
+	memset(data, 0, sizeof(((struct work*) 0)->data));
+	memcpy(in, header, ctx->len);
+	for (int i = 0; i < ctx->len / 4; i++)
+		data[i] = ctx->flags & HL_RAW ? in[i] : swab32(in[i]);
+	if (ctx->len == 80) {
+		data[20] = 0x80000000;
+		data[31] = 0x00000280;
+	}
+}
+
+/* scan the one nonce of a header, true if it is at or below the target */
+static bool hl_scan(const cmh_ctx *ctx, const uchar *header,
+	const uint32_t *target)
+{
+	struct work work;
+	uint64_t hashes = 0;
+	uint32_t nonce, *np;
+
+	memset(&work, 0, sizeof(work));
+	hl_work_data(ctx, work.data, header);
+	memcpy(work.target, target, sizeof(work.target));
+	np = algo_gate.get_nonceptr(work.data);
+	nonce = *np;
+	scan_solutions.count = 0;
+	if (algo_gate.scanhash(0, &work, nonce + 1, &hashes) <= 0)
+		return false;
+	return scan_found_nonce(&work, nonce);
+}
+
+static void hl_hash_one(const cmh_ctx *ctx, uint32_t *hash,
+	const uchar *header)
+{
+	uint32_t _ALIGN(64) in[48];
+	uint32_t _ALIGN(64) out[16];
+
+	if ((ctx->flags & HL_PRIME)
+	    && (!hl_primed || memcmp(hl_prefix, header, ctx->prefix))) {
+		static const uint32_t zero[8];
+		hl_scan(ctx, header, zero);
+		memcpy(hl_prefix, header, ctx->prefix);
+		hl_primed = true;
+	}
+	memset(in, 0, sizeof(in));
+	memcpy(in, header, ctx->len);
+	algo_gate.hash(out, in, ctx->len);
+	memcpy(hash, out, 32);
+}
+
+static bool hl_thread_init(cmh_ctx *ctx, int slot)
+{
+	if (hl_thread_serial == ctx->serial)
+		return true;
+	if (!algo_gate.miner_thread_init(slot))
+		return false;
+	hl_thread_serial = ctx->serial;
+	hl_primed = false;
+	return true;
+}
+
+/*
+ * Headers an algo would crash or spin on. x11evo's hash order counts the
+ * days from its start as an int, an ntime before it or more than 2^31 s
+ * after it gives a negative count that walks its permutations for ever.
+ */
+static bool hl_header_ok(const cmh_ctx *ctx, const uchar *header)
+{
+	if (ctx->algo == ALGO_X11EVO)
+		return (int32_t) (le32dec(header + 68) - HL_X11EVO_START) >= 0;
+	return true;
+}
+
+/* the hash of a header that can't be hashed, no target passes */
+static void hl_reject(cmh_ctx *ctx, size_t i)
+{
+	if (ctx->hashes)
+		memset(ctx->hashes + i * 32, 0xff, 32);
+	if (ctx->pass)
+		ctx->pass[i] = 0;
+}
+
+static void hl_range(cmh_ctx *ctx, size_t first, size_t end)
+{
+	const size_t len = ctx->len;
+
+	for (size_t i = first; i < end; ) {
+		uint32_t _ALIGN(64) hash[MAX_HASH_LANES][8];
+		uint32_t _ALIGN(64) edata[MAX_HASH_LANES][20];
+		uint32_t target[8];
+		const uchar *h = ctx->headers + i * len;
+		int k = 1;
+
+		if (!hl_header_ok(ctx, h)) {
+			hl_reject(ctx, i++);
+			continue;
+		}
+		if (ctx->flags & HL_SCAN) {
+			memcpy(target, ctx->targets + i * ctx->stride, 32);
+			ctx->pass[i] = hl_scan(ctx, h, target);
+			i++;
+			continue;
+		}
+		if (ctx->lanes > 1) {
+			while (k < ctx->lanes && i + k < end
+			       && !memcmp(h, h + k * len, 76))
+				k++;
+			for (int j = 0; j < k; j++)
+				memcpy(edata[j], h + j * len, 80);
+			algo_gate.hash_nway(hash, edata, k);
+		}
+		else
+			hl_hash_one(ctx, hash[0], h);
+
+		for (int j = 0; j < k; j++) {
+			if (ctx->hashes)
+				memcpy(ctx->hashes + (i + j) * 32, hash[j], 32);
+			if (ctx->pass) {
+				memcpy(target, ctx->targets + (i + j) * ctx->stride, 32);
+				ctx->pass[i + j] = fulltest(hash[j], target);
+			}
+		}
+		i += k;
+	}
+}
+
+static void hl_slice(cmh_ctx *ctx, int slot, int slices)
+{
+	if (!hl_thread_init(ctx, slot)) {
+		ctx->error = true;
+		return;
+	}
+	hl_range(ctx, ctx->n * slot / slices, ctx->n * (slot + 1) / slices);
+}
+
+static void *hl_thread(void *arg)
+{
+	cmh_ctx *ctx = (cmh_ctx*) arg;
+	int slot = __sync_add_and_fetch(&ctx->started, 1);
+	int gen = 0;
+
+	pthread_mutex_lock(&ctx->lock);
+	for (;;) {
+		while (ctx->gen == gen && !ctx->quit)
+			pthread_cond_wait(&ctx->start, &ctx->lock);
+		if (ctx->quit)
+			break;
+		gen = ctx->gen;
+		pthread_mutex_unlock(&ctx->lock);
+		hl_slice(ctx, slot, ctx->threads);
+		pthread_mutex_lock(&ctx->lock);
+		if (--ctx->busy == 0)
+			pthread_cond_signal(&ctx->done);
+	}
+	pthread_mutex_unlock(&ctx->lock);
+	if (hl_thread_serial == ctx->serial)
+		algo_gate.miner_thread_free(slot);
+	thread_scratch_free();
+	return NULL;
+}
+
+static int hl_batch(cmh_ctx *ctx, uint8_t *pass, void *hashes,
+	const void *headers, const void *targets, size_t stride, size_t n)
+{
+	int rc;
+
+	pthread_mutex_lock(&ctx->batch_lock);
+	ctx->headers = (const uchar*) headers;
+	ctx->hashes = (uchar*) hashes;
+	ctx->pass = pass;
+	ctx->targets = (const uchar*) targets;
+	ctx->stride = stride;
+	ctx->n = n;
+	ctx->error = false;
+
+	if (ctx->threads > 1 && n >= (size_t) ctx->threads * HL_MIN_SLICE) {
+		pthread_mutex_lock(&ctx->lock);
+		ctx->busy = ctx->threads - 1;
+		ctx->gen++;
+		pthread_cond_broadcast(&ctx->start);
+		pthread_mutex_unlock(&ctx->lock);
+
+		hl_slice(ctx, 0, ctx->threads);
+
+		pthread_mutex_lock(&ctx->lock);
+		while (ctx->busy)
+			pthread_cond_wait(&ctx->done, &ctx->lock);
+		pthread_mutex_unlock(&ctx->lock);
+	}
+	else
+		hl_slice(ctx, 0, 1);
+
+	rc = ctx->error ? -1 : 0;
+	pthread_mutex_unlock(&ctx->batch_lock);
+	return rc;
+}
+
+cmh_ctx *cmh_init(const char *name, int threads)
+{
+	char arg[64];
+	int algo, scrypt_n = 0;
+	cmh_ctx *ctx;
+
+	snprintf(arg, sizeof(arg), "%s", name);
+	algo = algo_from_name(arg, &scrypt_n);
+	/* hodl's threads share one scratchpad filled per work */
+	if (algo == ALGO_NULL || algo == ALGO_HODL)
+		return NULL;
+
+	pthread_mutex_lock(&hl_open_lock);
+	if (hl_open || !(ctx = (cmh_ctx*) calloc(1, sizeof(*ctx)))) {
+		pthread_mutex_unlock(&hl_open_lock);
+		return NULL;
+	}
+	if (!work_restart)
+		work_restart = hl_restart;
+	opt_algo = (enum algos) algo;
+	opt_scrypt_n = scrypt_n;
+	if (!register_algo_gate(algo, &algo_gate)) {
+		free(ctx);
+		pthread_mutex_unlock(&hl_open_lock);
+		return NULL;
+	}
+
+	ctx->algo = algo;
+	ctx->len = 80;
+	for (int i = 0; i < (int) ARRAY_SIZE(hl_algos); i++)
+		if (hl_algos[i].algo == algo) {
+			ctx->len = hl_algos[i].len;
+			ctx->flags = hl_algos[i].flags;
+			ctx->prefix = hl_algos[i].prefix;
+		}
+	if (algo_gate.hash == (void*) &null_hash)
+		ctx->flags |= HL_SCAN;
+	ctx->lanes = algo_gate.hash_nway != std_hash_nway && ctx->len == 80
+		? algo_gate.hash_lanes : 1;
+
+	if (threads <= 0)
+		threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+	ctx->threads = threads < 1 ? 1 : threads > HL_MAX_THREADS
+		? HL_MAX_THREADS : threads;
+	if (!opt_n_threads)
+		opt_n_threads = ctx->threads;
+	ctx->serial = ++hl_serial;
+
+	pthread_mutex_init(&ctx->batch_lock, NULL);
+	pthread_mutex_init(&ctx->lock, NULL);
+	pthread_cond_init(&ctx->start, NULL);
+	pthread_cond_init(&ctx->done, NULL);
+	ctx->pool = (pthread_t*) calloc(ctx->threads, sizeof(pthread_t));
+	for (int i = 1; ctx->pool && i < ctx->threads; i++)
+		if (pthread_create(&ctx->pool[i], NULL, hl_thread, ctx)) {
+			/* run with the threads that started */
+			ctx->threads = i;
+			break;
+		}
+
+	hl_open = ctx;
+	pthread_mutex_unlock(&hl_open_lock);
+	return ctx;
+}
+
+void cmh_free(cmh_ctx *ctx)
+{
+	if (!ctx)
+		return;
+	pthread_mutex_lock(&ctx->lock);
+	ctx->quit = true;
+	pthread_cond_broadcast(&ctx->start);
+	pthread_mutex_unlock(&ctx->lock);
+	for (int i = 1; ctx->pool && i < ctx->threads; i++)
+		pthread_join(ctx->pool[i], NULL);
+	if (hl_thread_serial == ctx->serial) {
+		algo_gate.miner_thread_free(0);
+		thread_scratch_free();
+		hl_thread_serial = 0;
+	}
+
+	pthread_mutex_lock(&hl_open_lock);
+	unregister_algo_gate(&algo_gate);
+	hl_open = NULL;
+	pthread_mutex_unlock(&hl_open_lock);
+
+	pthread_mutex_destroy(&ctx->batch_lock);
+	pthread_mutex_destroy(&ctx->lock);
+	pthread_cond_destroy(&ctx->start);
+	pthread_cond_destroy(&ctx->done);
+	free(ctx->pool);
+	free(ctx);
+}
+
+int cmh_header_len(const cmh_ctx *ctx)
+{
+	return ctx->len;
+}
+
+int cmh_can_hash(const cmh_ctx *ctx)
+{
+	return !(ctx->flags & HL_SCAN);
+}
+
+int cmh_header_ok(const cmh_ctx *ctx, const void *header)
+{
+	return hl_header_ok(ctx, (const uchar*) header);
+}
+
+int cmh_hash(cmh_ctx *ctx, void *hash, const void *header)
+{
+	int rc = 0;
+
+	if (ctx->flags & HL_SCAN)
+		return -1;
+	if (!hl_header_ok(ctx, (const uchar*) header)) {
+		memset(hash, 0xff, 32);
+		return -1;
+	}
+	pthread_mutex_lock(&ctx->batch_lock);
+	if (hl_thread_init(ctx, 0))
+		hl_hash_one(ctx, (uint32_t*) hash, (const uchar*) header);
+	else
+		rc = -1;
+	pthread_mutex_unlock(&ctx->batch_lock);
+	return rc;
+}
+
+int cmh_hash_batch(cmh_ctx *ctx, void *hashes, const void *headers, size_t n)
+{
+	if (ctx->flags & HL_SCAN)
+		return -1;
+	return hl_batch(ctx, NULL, hashes, headers, NULL, 0, n);
+}
+
+int cmh_verify_batch(cmh_ctx *ctx, uint8_t *pass, void *hashes,
+	const void *headers, const void *targets, size_t target_stride,
+	size_t n)
+{
+	return hl_batch(ctx, pass, hashes, headers, targets, target_stride, n);
+}
@@ -0,0 +1,158 @@
+/**
+ * Memory budget
+ *
+ * The scratchpad of a thread goes from a few KiB to hundreds of MiB across
+ * the algos, scrypt's and scryptjane's grow with N and hodl shares a GiB
+ * between all threads. Each algo declares its needs with the gate's
+ * scratch_size, the budget is --max-memory or the cgroup memory limit,
+ * the smaller, less what the miner needs without scratchpads.
+ *
+ * An algo over the budget first hashes fewer nonces at once per thread
+ * (the gate's lower_ways), then runs fewer threads. At start the thread
+ * count is lowered, after an algo switch the threads over the budget idle
+ * until an algo that fits them, their scratch is freed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "miner.h"
+#include "algo-gate-api.h"
+
+#define MEM_RESERVE  (64ULL << 20)  /* the miner without scratchpads */
+#define MiB(x)       ((double) (x) / (1 << 20))
+
+uint64_t opt_max_memory = 0;  /* bytes, 0 for none */
+int      memory_threads = 0;  /* threads in the budget, the others idle */
+
+static uint64_t mem_per_thread = 0;
+static uint64_t mem_shared = 0;
+
+/* bytes for the scratchpads, 0 for no limit */
+uint64_t memory_budget()
+{
+	uint64_t limit = opt_max_memory;
+
+	if (cgroup_mem_limit && (!limit || cgroup_mem_limit < limit))
+		limit = cgroup_mem_limit;
+	if (!limit)
+		return 0;
+	return limit > MEM_RESERVE ? limit - MEM_RESERVE : 1;
+}
+
+/* threads of the gate's algo in the budget, with fewer ways if it helps */
+static int mem_fit(algo_gate_t *gate, uint64_t budget, int threads)
+{
+	for (;;) {
+		uint64_t n;
+
+		gate->scratch_size(&mem_per_thread, &mem_shared);
+		if (!budget)
+			return threads;
+		if (mem_shared + mem_per_thread > budget)
+			n = 0;
+		else if (!mem_per_thread)
+			n = threads;
+		else
+			n = (budget - mem_shared) / mem_per_thread;
+		if (n >= (uint64_t) threads)
+			return threads;
+		if (!gate->lower_ways())
+			return (int) n;
+	}
+}
+
+/*
+ * Fewer threads when the default count doesn't fit the budget, an explicit
+ * -t that doesn't fit is an error. Called once the gate is registered.
+ */
+bool memory_init(bool threads_given)
+{
+	uint64_t budget = memory_budget();
+	int n = mem_fit(&algo_gate, budget, opt_n_threads);
+
+	memory_threads = opt_n_threads;
+	if (!budget)
+		return true;
+	if (n < 1) {
+		applog(LOG_ERR, "%s needs %.0f MiB, the memory budget is %.0f MiB",
+			algo_names[opt_algo],
+			MiB(mem_shared + mem_per_thread + MEM_RESERVE),
+			MiB(budget + MEM_RESERVE));
+		return false;
+	}
+	if (n < opt_n_threads) {
+		if (threads_given) {
+			applog(LOG_ERR, "%d %s threads need %.0f MiB, the memory "
+				"budget of %.0f MiB holds %d", opt_n_threads,
+				algo_names[opt_algo], MiB(mem_shared + MEM_RESERVE
+					+ opt_n_threads * mem_per_thread),
+				MiB(budget + MEM_RESERVE), n);
+			return false;
+		}
+		applog(LOG_WARNING, "%d threads for the memory budget of %.0f MiB",
+			n, MiB(budget + MEM_RESERVE));
+		opt_n_threads = memory_threads = n;
+	}
+	if (opt_debug)
+		applog(LOG_DEBUG, "Memory: %.2f MiB per thread, %.0f MiB shared, "
+			"budget %.0f MiB", MiB(mem_per_thread), MiB(mem_shared),
+			MiB(budget + MEM_RESERVE));
+	return true;
+}
+
+/*
+ * Fits the gate of an algo switch, called with the miner threads parked.
+ * False if not even one thread fits.
+ */
+bool memory_switch(algo_gate_t *gate)
+{
+	uint64_t budget = memory_budget();
+	int n = mem_fit(gate, budget, opt_n_threads);
+
+	if (n < 1) {
+		applog(LOG_ERR, "%s needs %.0f MiB, the memory budget is %.0f MiB",
+			algo_names[opt_algo],
+			MiB(mem_shared + mem_per_thread + MEM_RESERVE),
+			MiB(budget + MEM_RESERVE));
+		return false;
+	}
+	if (n < opt_n_threads)
+		applog(LOG_WARNING, "%d of %d threads for the memory budget of "
+			"%.0f MiB, the others idle", n, opt_n_threads,
+			MiB(budget + MEM_RESERVE));
+	memory_threads = n;
+	return true;
+}
+
+/* resident set of the process, 0 if unknown */
+static uint64_t mem_resident()
+{
+	uint64_t rss = 0;
+#ifdef __linux
+	unsigned long size, pages;
+	FILE *fd = fopen("/proc/self/statm", "r");
+
+	if (!fd)
+		return 0;
+	if (fscanf(fd, "%lu %lu", &size, &pages) == 2)
+		rss = (uint64_t) pages * sysconf(_SC_PAGESIZE);
+	fclose(fd);
+#endif
+	return rss;
+}
+
+/* sizes in MiB, BUDGET 0 for none */
+int memory_format_api(char *buf, size_t sz)
+{
+	uint64_t budget = memory_budget();
+
+	return snprintf(buf, sz, "BUDGET=%.1f;MAXMEM=%.1f;CGROUP=%.1f;"
+		"PERTHREAD=%.3f;SHARED=%.1f;THREADS=%d;ACTIVE=%d;SCRATCH=%.1f;"
+		"RSS=%.1f|", budget ? MiB(budget + MEM_RESERVE) : 0.,
+		MiB(opt_max_memory), MiB(cgroup_mem_limit), MiB(mem_per_thread),
+		MiB(mem_shared), opt_n_threads, memory_threads,
+		MiB(thread_scratch_total), MiB(mem_resident()));
+}
@@ -0,0 +1,1591 @@
+/*
+ * Copyright 2010 Jeff Garzik
+ * Copyright 2012-2014 pooler
+ * Copyright 2014 Lucas Jones
+ * Copyright 2014 Tanguy Pruvot
+ * Copyright 2016 Jay D Dee
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.  See COPYING for more details.
+ */
+
+/*
+ * The miner's globals, the default gate functions, the getwork and stratum
+ * work handling and the option parsing. They are shared by cpuminer and
+ * libcpuminer-hash.a, the threads and main are in cpu-miner.c.
+ */
+
+#include <cpuminer-config.h>
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <time.h>
+#include <signal.h>
+#include <memory.h>
+
+#include <curl/curl.h>
+#include <jansson.h>
+#include <openssl/sha.h>
+
+
+#ifdef _MSC_VER
+#include <windows.h>
+#include <stdint.h>
+#else
+#include <errno.h>
+#if HAVE_SYS_SYSCTL_H
+#include <sys/types.h>
+#if HAVE_SYS_PARAM_H
+#include <sys/param.h>
+#endif
+#include <sys/sysctl.h>
+#endif
+#endif
+
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
+
+#include "miner.h"
+#include "algo-gate-api.h"
+#include "stage-profile.h"
+#include "algo/interleave.h"
+
+#ifdef WIN32
+#include "compat/winansi.h"
+//BOOL WINAPI ConsoleHandler(DWORD);
+#endif
+#ifdef _MSC_VER
+#include <Mmsystem.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+
+algo_gate_t algo_gate;
+
+bool opt_debug = false;
+bool opt_debug_diff = false;
+bool opt_protocol = false;
+bool opt_benchmark = false;
+bool opt_cputest = false;
+bool opt_redirect = true;
+bool opt_showdiff = true;
+bool opt_extranonce = true;
+bool opt_version_rolling = true;
+bool want_longpoll = true;
+bool have_longpoll = false;
+bool have_gbt = true;
+bool allow_getwork = true;
+bool want_stratum = true;
+bool have_stratum = false;
+bool allow_mininginfo = true;
+bool use_syslog = false;
+bool use_colors = true;
+bool opt_background = false;
+bool opt_quiet = false;
+bool opt_randomize = false;
+int opt_retries = -1;
+int opt_fail_pause = 10;
+int opt_time_limit = 0;
+int opt_timeout = 300;
+int opt_scantime = 5;
+static const bool opt_time = true;
+enum algos opt_algo = ALGO_NULL;
+int opt_scrypt_n = 0;
+int opt_pluck_n = 128;
+int opt_n_threads = 0;
+int64_t opt_affinity = -1L;
+int opt_priority = 0;
+int num_cpus;
+char *rpc_url = NULL;;
+char *rpc_userpass = NULL;
+char *rpc_user, *rpc_pass;
+char *short_url = NULL;
+unsigned char pk_script[25] = { 0 };
+size_t pk_script_size = 0;
+char coinbase_sig[101] = { 0 };
+char *opt_cert;
+char *opt_proxy;
+long opt_proxy_type;
+struct thr_info *thr_info;
+int longpoll_thr_id = -1;
+int stratum_thr_id = -1;
+int api_thr_id = -1;
+bool stratum_need_reset = false;
+struct work_restart *work_restart = NULL;
+struct stratum_ctx stratum;
+bool jsonrpc_2 = false;
+char rpc2_id[64] = "";
+char *rpc2_blob = NULL;
+size_t rpc2_bloblen = 0;
+uint32_t rpc2_target = 0;
+char *rpc2_job_id = NULL;
+double opt_diff_factor = 1.0;
+uint32_t zr5_pok = 0;
+bool opt_stratum_stats = false;
+
+uint32_t accepted_count = 0L;
+uint32_t rejected_count = 0L;
+double *thr_hashrates;
+double *thr_hashcount;
+double global_hashcount = 0;
+double global_hashrate = 0;
+double stratum_diff = 0.;
+double net_diff = 0.;
+double net_hashrate = 0.;
+// conditional mining
+  double opt_max_temp = 0.0;
+  double opt_max_diff = 0.0;
+  double opt_max_rate = 0.0;
+
+  uint32_t opt_work_size = 0;
+  char *opt_api_allow = NULL;
+  int opt_api_remote = 0;
+  int opt_api_listen = 4048; 
+  int opt_api_push_ms = 1000;
+
+  pthread_mutex_t rpc2_job_lock;
+  pthread_mutex_t rpc2_login_lock;
+  pthread_mutex_t applog_lock;
+  pthread_mutex_t stats_lock;
+
+
+
+struct work g_work = {{ 0 }};
+//static struct work tmp_work;
+time_t g_work_time = 0;
+
+char*  lp_id;
+
+
+#ifdef __linux /* Linux specific policy and affinity management */
+#include <sched.h>
+
+void drop_policy(void)
+{
+	struct sched_param param;
+	param.sched_priority = 0;
+#ifdef SCHED_IDLE
+	if (unlikely(sched_setscheduler(0, SCHED_IDLE, &param) == -1))
+#endif
+#ifdef SCHED_BATCH
+		sched_setscheduler(0, SCHED_BATCH, &param);
+#endif
+}
+
+#ifdef __BIONIC__
+#define pthread_setaffinity_np(tid,sz,s) {} /* only do process affinity */
+#endif
+
+void affine_to_cpu_mask(int id, unsigned long mask) {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (uint8_t i = 0; i < num_cpus; i++) {
+		// cpu mask
+		if (mask & (1UL<<i)) { CPU_SET(i, &set); }
+	}
+	if (id == -1) {
+		// process affinity
+		sched_setaffinity(0, sizeof(&set), &set);
+	} else {
+		// thread only
+		pthread_setaffinity_np(thr_info[id].pth, sizeof(&set), &set);
+	}
+}
+
+#elif defined(WIN32) /* Windows */
+void drop_policy(void) { }
+void affine_to_cpu_mask(int id, unsigned long mask) {
+	if (id == -1)
+		SetProcessAffinityMask(GetCurrentProcess(), mask);
+	else
+		SetThreadAffinityMask(GetCurrentThread(), mask);
+}
+#else
+void drop_policy(void) { }
+void affine_to_cpu_mask(int id, unsigned long mask) { }
+#endif
+
+// Miner threads are bound one per cpu by default and in the groups of
+// --split. With --cpu-affinity alone each thread can run on any cpu of
+// the mask.
+bool thread_pinned()
+{
+   return opt_n_threads > 1 && ( opt_affinity == -1L || split_pinned() );
+}
+
+// cpu of a miner thread, one per cpu of the --cpu-affinity mask in turn
+int thread_cpu( int thr_id )
+{
+   unsigned long mask = (unsigned long)opt_affinity;
+   int n, c;
+
+   if ( opt_affinity == -1L || !mask )
+      return thr_id % num_cpus;
+   n = thr_id % __builtin_popcountl( mask );
+   for ( c = 0; n || !( mask & ( 1UL << c ) ); c++ )
+      if ( mask & ( 1UL << c ) )
+         n--;
+   return c;
+}
+
+// not very useful, just index the arrray directly.
+// but declaring this fuinction in miner.h eliminates
+// an annoying compiler warning for not using a static.
+const char* algo_name( enum algos a ) {return algo_names[a];}
+
+void get_currentalgo(char* buf, int sz)
+{
+	snprintf(buf, sz, "%s", algo_names[opt_algo]);
+}
+
+void proper_exit(int reason)
+{
+#ifdef WIN32
+	if (opt_background) {
+		HWND hcon = GetConsoleWindow();
+		if (hcon) {
+			// unhide parent command line windows
+			ShowWindow(hcon, SW_SHOWMINNOACTIVE);
+		}
+	}
+#endif
+	exit(reason);
+}
+
+uint32_t* get_stratum_job_ntime()
+{
+   return (uint32_t*)stratum.job.ntime;
+}
+
+void work_free(struct work *w)
+{
+	if (w->txs) free(w->txs);
+	if (w->workid) free(w->workid);
+}
+
+void work_copy(struct work *dest, const struct work *src)
+{
+	memcpy(dest, src, sizeof(struct work));
+	if (src->txs)
+		dest->txs = strdup(src->txs);
+	if (src->workid)
+		dest->workid = strdup(src->workid);
+}
+
+bool jr2_work_decode( const json_t *val, struct work *work)
+{
+        return rpc2_job_decode(val, work);
+}
+
+bool std_work_decode( const json_t *val, struct work *work)
+{
+    int i;
+    int data_size   = algo_gate.work_data_size;
+    int target_size = sizeof(work->target);
+    int adata_sz    = ARRAY_SIZE(work->data);
+    int atarget_sz  = ARRAY_SIZE(work->target);
+
+    if (unlikely( !jobj_binary(val, "data", work->data, data_size) ))
+    {
+       applog(LOG_ERR, "JSON invalid data");
+       return false;
+    }
+    if (unlikely( !jobj_binary(val, "target", work->target, target_size) ))
+    {
+       applog(LOG_ERR, "JSON invalid target");
+       return false;
+    }
+    for ( i = 0; i < adata_sz; i++ )
+          work->data[i] = le32dec( work->data + i );
+    for ( i = 0; i < atarget_sz; i++ )
+          work->target[i] = le32dec( work->target + i );
+    return true;
+}
+
+
+void scale_hash_for_display ( double* hashrate, char* units )
+{
+     if ( *hashrate < 1e4 )
+       // 0 H/s to 9999 H/s
+       *units = 0;
+     else if ( *hashrate < 1e7 )
+     {
+       // 10 kH/s to 9999 kH/s
+       *units = 'k';
+       *hashrate /= 1e3;
+     }
+     else if ( *hashrate < 1e10 )
+     {
+       // 10 Mh/s to 9999 Mh/s
+       *units = 'M';
+       *hashrate /= 1e6;
+     }
+     else if ( *hashrate < 1e13 )
+     {
+       // 10 iGh/s to 9999 Gh/s
+       *units = 'G';
+       *hashrate /= 1e9;
+     }
+     else
+     {
+       // 10 Th/s and higher
+       *units = 'T';
+       *hashrate /= 1e12;
+     }
+}
+
+int share_result( int result, struct work *work, const char *reason )
+{
+   char hc[16];
+   char hr[16];
+   const char *sres;
+   double hashcount = 0.;
+   double hashrate = 0.;
+   char hc_units[4] = {0};
+   char hr_units[4] = {0};
+   uint32_t total_submits;
+   float rate;
+   char rate_s[8] = {0};
+   int i;
+
+   pthread_mutex_lock(&stats_lock);
+   for (i = 0; i < opt_n_threads; i++)
+   {
+       hashcount += thr_hashcount[i];
+       hashrate += thr_hashrates[i];
+   }
+   result ? accepted_count++ : rejected_count++;
+   pthread_mutex_unlock(&stats_lock);
+   global_hashcount = hashcount;
+   global_hashrate = hashrate;
+   total_submits = accepted_count + rejected_count;
+
+   rate = ( result ? ( 100. * accepted_count / total_submits )  
+                   : ( 100. * rejected_count / total_submits ) );
+
+   if (use_colors)
+        sres = (result ? CL_GRN "Accepted" CL_WHT : CL_RED "Rejected" CL_WHT );
+   else
+        sres = (result ? "Accepted" : "Rejected" );
+
+   // Contrary to rounding convention 100% means zero rejects, exactly 100%. 
+   // Rates > 99% and < 100% (rejects>0) display 99.9%.
+   if ( result )
+   {
+      rate = 100. * accepted_count / total_submits;
+      if ( rate == 100.0 )
+         sprintf( rate_s, "%.0f", rate );
+      else
+          sprintf( rate_s, "%.1f", ( rate < 99.9 ) ? rate : 99.9 );
+   }
+   else
+   {
+      rate = 100. * rejected_count / total_submits;
+      if ( rate < 0.1 )
+         sprintf( rate_s, "%.1f", 0.10 );
+      else
+         sprintf( rate_s, "%.1f", rate );
+   }
+
+   scale_hash_for_display ( &hashcount, hc_units );
+   scale_hash_for_display ( &hashrate, hr_units );
+   if ( hc_units[0] )
+   {
+      sprintf(hc, "%.2f", hashcount );
+      if ( hashrate < 10 )
+         // very low hashrate, add digits
+         sprintf(hr, "%.4f", hashrate );
+      else
+         sprintf(hr, "%.2f", hashrate );
+   }
+   else
+   {
+      // no fractions of a hash
+      sprintf(hc, "%.0f", hashcount );
+      sprintf(hr, "%.2f", hashrate );
+   }
+
+#if ((defined(_WIN64) || defined(__WINDOWS__)))
+   applog( LOG_NOTICE, "%s %lu/%lu (%s%%), %s %sH, %s %sH/s",
+                       sres, ( result ? accepted_count : rejected_count ),
+                       total_submits, rate_s, hc, hc_units, hr, hr_units );
+#else
+   applog( LOG_NOTICE, "%s %lu/%lu (%s%%), %s %sH, %s %sH/s, %dC",
+                       sres, ( result ? accepted_count : rejected_count ),
+                       total_submits, rate_s, hc, hc_units, hr, hr_units,
+                       (uint32_t)cpu_temp(0) );
+#endif
+
+   api_push_event( API_EVENT_SHARE,
+                   "EVENT=share;RESULT=%s;ACC=%u;REJ=%u;DIFF=%g;REASON=%s|",
+                   result ? "accepted" : "rejected", accepted_count,
+                   rejected_count, stratum_diff, reason ? reason : "" );
+
+   if (reason)
+   {
+	applog(LOG_WARNING, "reject reason: %s", reason);
+	if (strncmp(reason, "low difficulty share", 20) == 0)
+        {
+           opt_diff_factor = (opt_diff_factor * 2.0) / 3.0;
+	   applog(LOG_WARNING, "factor reduced to : %0.2f", opt_diff_factor);
+           return 0;
+        }
+   }
+	return 1;
+}
+
+void std_le_build_stratum_request( char *req, struct work *work )
+{
+   unsigned char *xnonce2str;
+   uint32_t ntime,       nonce;
+   char     ntimestr[9], noncestr[9];
+   le32enc( &ntime, work->data[ algo_gate.ntime_index ] );
+   le32enc( &nonce, work->data[ algo_gate.nonce_index ] );
+   bin2hex( ntimestr, (char*)(&ntime), sizeof(uint32_t) );
+   bin2hex( noncestr, (char*)(&nonce), sizeof(uint32_t) );
+   xnonce2str = abin2hex(work->xnonce2, work->xnonce2_len);
+   if ( work->version_mask )
+      // BIP320, the rolled version bits
+      snprintf( req, JSON_BUF_LEN,
+        "{\"method\": \"mining.submit\", \"params\": [\"%s\", \"%s\", \"%s\", \"%s\", \"%s\", \"%08x\"], \"id\":4}",
+         rpc_user, work->job_id, xnonce2str, ntimestr, noncestr,
+         swab32( work->data[0] ) & work->version_mask );
+   else
+      snprintf( req, JSON_BUF_LEN,
+        "{\"method\": \"mining.submit\", \"params\": [\"%s\", \"%s\", \"%s\", \"%s\", \"%s\"], \"id\":4}",
+         rpc_user, work->job_id, xnonce2str, ntimestr, noncestr );
+   free( xnonce2str );
+}
+
+// le is default
+void std_be_build_stratum_request( char *req, struct work *work )
+{
+   unsigned char *xnonce2str;
+   uint32_t ntime,       nonce;
+   char     ntimestr[9], noncestr[9];
+   be32enc( &ntime, work->data[ algo_gate.ntime_index ] );
+   be32enc( &nonce, work->data[ algo_gate.nonce_index ] );
+   bin2hex( ntimestr, (char*)(&ntime), sizeof(uint32_t) );
+   bin2hex( noncestr, (char*)(&nonce), sizeof(uint32_t) );
+   xnonce2str = abin2hex(work->xnonce2, work->xnonce2_len);
+   if ( work->version_mask )
+      // BIP320, the rolled version bits
+      snprintf( req, JSON_BUF_LEN,
+        "{\"method\": \"mining.submit\", \"params\": [\"%s\", \"%s\", \"%s\", \"%s\", \"%s\", \"%08x\"], \"id\":4}",
+         rpc_user, work->job_id, xnonce2str, ntimestr, noncestr,
+         swab32( work->data[0] ) & work->version_mask );
+   else
+      snprintf( req, JSON_BUF_LEN,
+        "{\"method\": \"mining.submit\", \"params\": [\"%s\", \"%s\", \"%s\", \"%s\", \"%s\"], \"id\":4}",
+         rpc_user, work->job_id, xnonce2str, ntimestr, noncestr );
+   free( xnonce2str );
+}
+
+void jr2_build_stratum_request( char *req, struct work *work )
+{
+   uchar hash[32];
+   char noncestr[9];
+   bin2hex( noncestr, (char*) algo_gate.get_nonceptr( work->data ),
+                      sizeof(uint32_t) );
+   algo_gate.hash_suw( hash, work->data );
+   char *hashhex = abin2hex(hash, 32);
+   snprintf( req, JSON_BUF_LEN,
+        "{\"method\": \"submit\", \"params\": {\"id\": \"%s\", \"job_id\": \"%s\", \"nonce\": \"%s\", \"result\": \"%s\"}, \"id\":4}",
+          rpc2_id, work->job_id, noncestr, hashhex );
+   free( hashhex );
+}
+
+bool std_submit_getwork_result( CURL *curl, struct work *work )
+{
+   char req[JSON_BUF_LEN];
+   json_t *val, *res, *reason;
+   char* gw_str;
+   int data_size = algo_gate.work_data_size;
+
+   for ( int i = 0; i < data_size / sizeof(uint32_t); i++ )
+     le32enc( &work->data[i], work->data[i] );
+   gw_str = abin2hex( (uchar*)work->data, data_size );
+   if ( unlikely(!gw_str) )
+   {
+      applog(LOG_ERR, "submit_upstream_work OOM");
+      return false;
+   }
+   // build JSON-RPC request 
+   snprintf( req, JSON_BUF_LEN,
+     "{\"method\": \"getwork\", \"params\": [\"%s\"], \"id\":4}\r\n", gw_str );
+   free( gw_str );
+   // issue JSON-RPC request 
+   val = json_rpc_call( curl, rpc_url, rpc_userpass, req, NULL, 0 );
+   if ( unlikely(!val) )
+   {
+       applog(LOG_ERR, "submit_upstream_work json_rpc_call failed");
+       return false;
+   }
+   res = json_object_get(val, "result");
+   reason = json_object_get(val, "reject-reason");
+   share_result( json_is_true(res), work,
+                 reason ? json_string_value(reason) : NULL);
+   json_decref(val);
+   return true;
+}
+
+bool jr2_submit_getwork_result( CURL *curl, struct work *work )
+{
+   json_t *val, *res;
+   char req[JSON_BUF_LEN];
+   char noncestr[9];
+   uchar hash[32];
+   char *hashhex;
+   bin2hex( noncestr, (char*) algo_gate.get_nonceptr( work->data ),
+                      sizeof(uint32_t) );
+   algo_gate.hash_suw( hash, work->data );
+   hashhex = abin2hex( &hash[0], 32 );
+   snprintf( req, JSON_BUF_LEN, "{\"method\": \"submit\", \"params\": "
+       "{\"id\": \"%s\", \"job_id\": \"%s\", \"nonce\": \"%s\", \"result\": \"%s\"},"
+       "\"id\":4}\r\n",
+       rpc2_id, work->job_id, noncestr, hashhex );
+   free( hashhex );
+   // issue JSON-RPC request 
+   val = json_rpc2_call( curl, rpc_url, rpc_userpass, req, NULL, 0 );
+   if (unlikely( !val ))
+   {
+      applog(LOG_ERR, "submit_upstream_work json_rpc_call failed");
+      return false;
+   }
+   res = json_object_get( val, "result" );
+   json_t *status = json_object_get( res, "status" );
+   bool valid = !strcmp( status ? json_string_value( status ) : "", "OK" );
+   if (valid)
+       share_result( valid, work, NULL );
+   else
+   {
+       json_t *err = json_object_get( res, "error" );
+       const char *sreason = json_string_value( json_object_get(
+                                                      err, "message" ) );
+       share_result( valid, work, sreason );
+       if ( !strcasecmp( "Invalid job id", sreason ) )
+       {
+            work_free( work );
+            work_copy( work, &g_work );
+            g_work_time = 0;
+            restart_threads();
+       }
+   }
+   json_decref(val);
+   return true;
+}
+
+
+const char *getwork_req =
+	"{\"method\": \"getwork\", \"params\": [], \"id\":0}\r\n";
+
+#define GBT_CAPABILITIES "[\"coinbasetxn\", \"coinbasevalue\", \"longpoll\", \"workid\"]"
+
+const char *gbt_req =
+	"{\"method\": \"getblocktemplate\", \"params\": [{\"capabilities\": "
+	GBT_CAPABILITIES "}], \"id\":0}\r\n";
+
+const char *gbt_lp_req =
+	"{\"method\": \"getblocktemplate\", \"params\": [{\"capabilities\": "
+	GBT_CAPABILITIES ", \"longpollid\": \"%s\"}], \"id\":0}\r\n";
+
+
+bool rpc2_login(CURL *curl)
+{
+	json_t *val;
+	bool rc = false;
+	struct timeval tv_start, tv_end, diff;
+	char s[JSON_BUF_LEN];
+
+	if (!jsonrpc_2)
+		return false;
+	snprintf(s, JSON_BUF_LEN, "{\"method\": \"login\", \"params\": {"
+		"\"login\": \"%s\", \"pass\": \"%s\", \"agent\": \"%s\"}, \"id\": 1}",
+		rpc_user, rpc_pass, USER_AGENT);
+	gettimeofday(&tv_start, NULL);
+	val = json_rpc_call(curl, rpc_url, rpc_userpass, s, NULL, 0);
+	gettimeofday(&tv_end, NULL);
+	if (!val)
+		goto end;
+	rc = rpc2_login_decode(val);
+	json_t *result = json_object_get(val, "result");
+	if (!result)
+		goto end;
+	json_t *job = json_object_get(result, "job");
+	if (!rpc2_job_decode(job, &g_work))
+		goto end;
+	if (opt_debug && rc)
+        {
+		timeval_subtract(&diff, &tv_end, &tv_start);
+		applog(LOG_DEBUG, "DEBUG: authenticated in %d ms",
+				diff.tv_sec * 1000 + diff.tv_usec / 1000);
+	}
+	json_decref(val);
+end:
+	return rc;
+}
+
+bool rpc2_workio_login(CURL *curl)
+{
+   int failures = 0;
+   if (opt_benchmark)
+	return true;
+   /* submit solution to bitcoin via JSON-RPC */
+   pthread_mutex_lock(&rpc2_login_lock);
+   while (!rpc2_login(curl))
+   {
+      if (unlikely((opt_retries >= 0) && (++failures > opt_retries)))
+      {
+	applog(LOG_ERR, "...terminating workio thread");
+	pthread_mutex_unlock(&rpc2_login_lock);
+	return false;
+      }
+
+      /* pause, then restart work-request loop */
+      if (!opt_benchmark)
+          applog(LOG_ERR, "...retry after %d seconds", opt_fail_pause);
+      sleep(opt_fail_pause);
+      pthread_mutex_unlock(&rpc2_login_lock);
+      pthread_mutex_lock(&rpc2_login_lock);
+   }
+   pthread_mutex_unlock(&rpc2_login_lock);
+   return true;
+}
+
+
+bool rpc2_stratum_job( struct stratum_ctx *sctx, json_t *params )
+{
+	bool ret = false;
+	pthread_mutex_lock(&sctx->work_lock);
+	ret = rpc2_job_decode(params, &sctx->work);
+	if (ret)
+        {
+           if (sctx->job.job_id)
+		free(sctx->job.job_id);
+	   sctx->job.job_id = strdup(sctx->work.job_id);
+ 	}
+
+	pthread_mutex_unlock(&sctx->work_lock);
+	return ret;
+}
+
+
+void std_wait_for_diff()
+{
+   while ( time(NULL) >= g_work_time + 120 )
+     sleep(1);
+}
+
+// Common target functions, default usually listed first.
+
+// pick your favorite or define your own
+int64_t get_max64_0x1fffffLL() { return 0x1fffffLL; } // default
+int64_t get_max64_0x40LL()     { return 0x40LL;     }
+int64_t get_max64_0x3ffff()    { return 0x3ffff;    }
+int64_t get_max64_0x3fffffLL() { return 0x3fffffLL; }
+int64_t get_max64_0x1ffff()    { return 0x1ffff;    }
+int64_t get_max64_0xffffLL()   { return 0xffffLL;   };
+
+// default
+void sha256d_gen_merkle_root( char* merkle_root, struct stratum_ctx* sctx )
+{
+  sha256d(merkle_root, sctx->job.coinbase, (int) sctx->job.coinbase_size);
+  for ( int i = 0; i < sctx->job.merkle_count; i++ )
+  {
+     memcpy( merkle_root + 32, sctx->job.merkle[i], 32 );
+     sha256d( merkle_root, merkle_root, 64 );
+  }
+}
+void SHA256_gen_merkle_root( char* merkle_root, struct stratum_ctx* sctx )
+{
+  SHA256( sctx->job.coinbase, (int)sctx->job.coinbase_size, merkle_root );
+  for ( int i = 0; i < sctx->job.merkle_count; i++ )
+  {
+     memcpy( merkle_root + 32, sctx->job.merkle[i], 32 );
+     sha256d( merkle_root, merkle_root, 64 );
+  }
+}
+
+void std_set_target( struct work* work, double job_diff )
+{
+   work_set_target( work, job_diff / opt_diff_factor );
+}
+// most scrypt based algos
+void scrypt_set_target( struct work* work, double job_diff )
+{
+   work_set_target( work, job_diff / (65536.0 * opt_diff_factor) );
+}
+
+// set_work_data_endian target, default is do_nothing
+void swab_work_data( struct work *work )
+{
+   int nonce_index = algo_gate.nonce_index;
+   for ( int i = 0; i < nonce_index; i++ )
+      work->data[i] = swab32( work->data[i] );
+}
+
+double std_calc_network_diff( struct work* work )
+{
+   // sample for diff 43.281 : 1c05ea29
+   // todo: endian reversed on longpoll could be zr5 specific...
+   int nbits_index = algo_gate.nbits_index;
+   uint32_t nbits = have_longpoll ? work->data[ nbits_index]
+                                  : swab32( work->data[ nbits_index ] );
+   uint32_t bits  = ( nbits & 0xffffff );
+   int16_t  shift = ( swab32(nbits) & 0xff ); // 0x1c = 28
+   int m;
+   double d = (double)0x0000ffff / (double)bits;
+   for ( m = shift; m < 29; m++ )
+       d *= 256.0;
+   for ( m = 29; m < shift; m++ )
+       d /= 256.0;
+   if ( opt_debug_diff )
+      applog(LOG_DEBUG, "net diff: %f -> shift %u, bits %08x", d, shift, bits);
+   return d;
+}
+
+uint32_t* std_get_nonceptr( uint32_t *work_data )
+{
+   return work_data + algo_gate.nonce_index;
+}
+
+uint32_t* jr2_get_nonceptr( uint32_t *work_data )
+{
+   // nonce is misaligned, use byte offset
+   return (uint32_t*) ( ((uint8_t*) work_data) + algo_gate.nonce_index );
+}
+
+// BIP320, the next version bits under the mask for another pass over the
+// thread's nonces, all threads roll the same way over their own nonces.
+// False once the bits wrap around to the job's own.
+static bool roll_version( struct work *work, const struct work *g_work )
+{
+   const uint32_t mask = work->version_mask;
+   const uint32_t job = swab32( g_work->data[0] );
+   uint32_t bits = ( ( swab32( work->data[0] ) | ~mask ) + 1 ) & mask;
+
+   if ( bits == ( job & mask ) )
+      return false;
+   work->data[0] = swab32( ( job & ~mask ) | bits );
+   return true;
+}
+
+void std_get_new_work( struct work* work, struct work* g_work, int thr_id,
+                     uint32_t *end_nonce_ptr, bool clean_job )
+{
+   uint32_t *nonceptr = algo_gate.get_nonceptr( work->data );
+   uint32_t version = work->data[0];
+
+   // a rolled version is still the job of g_work
+   if ( work->version_mask )
+      work->data[0] = g_work->data[0];
+   if ( memcmp( work->data, g_work->data, algo_gate.work_cmp_size )
+      && ( clean_job || ( *nonceptr >= *end_nonce_ptr )
+         || *g_work->job_id ) )  // stratum work always switches
+   {
+     work_free( work );
+     work_copy( work, g_work );
+     *nonceptr = 0xffffffffU / opt_n_threads * thr_id;
+     if ( opt_randomize )
+       *nonceptr += ( (rand() *4 ) & UINT32_MAX ) / opt_n_threads;
+     *end_nonce_ptr = ( 0xffffffffU / opt_n_threads ) * (thr_id+1) - 0x20; 
+   }
+   else
+   {
+      work->data[0] = version;
+      // nonces used up, roll the version instead of waiting for a job
+      if ( *nonceptr >= *end_nonce_ptr && work->version_mask
+           && roll_version( work, g_work ) )
+         *nonceptr = 0xffffffffU / opt_n_threads * thr_id;
+      else
+         ++(*nonceptr);
+   }
+}
+
+void jr2_get_new_work( struct work* work, struct work* g_work, int thr_id,
+                     uint32_t *end_nonce_ptr )
+{
+   uint32_t *nonceptr = algo_gate.get_nonceptr( work->data );
+
+   // byte data[ 0..38, 43..75 ], skip over misaligned nonce [39..42]
+   if ( memcmp( work->data, g_work->data, algo_gate.nonce_index )
+     || memcmp( ((uint8_t*) work->data)   + JR2_WORK_CMP_INDEX_2,
+                ((uint8_t*) g_work->data) + JR2_WORK_CMP_INDEX_2,
+                                                    JR2_WORK_CMP_SIZE_2 ) )
+   {
+      work_free( work );
+      work_copy( work, g_work );
+      *nonceptr = ( 0xffffffU / opt_n_threads ) * thr_id
+                   + ( *nonceptr & 0xff000000U );
+      *end_nonce_ptr = ( 0xffffffU / opt_n_threads ) * (thr_id+1)
+                        + ( *nonceptr & 0xff000000U ) - 0x20;
+   }
+   else
+       ++(*nonceptr);
+}
+
+bool std_ready_to_mine( struct work* work, struct stratum_ctx* stratum,
+                           int thr_id )
+{
+   if ( have_stratum && !work->data[0] && !opt_benchmark )
+   {
+      sleep(1);
+      return false;
+   }
+   return true;
+}
+
+// Hot algo switch.
+// algo_switch_request only records the new algo and aborts the scans. Each
+// miner thread tears down its algo state and parks at the top of its loop,
+// the last one to park replaces the gate while nobody is hashing, then all
+// threads init the new algo and resume.
+
+pthread_mutex_t algo_switch_lock = PTHREAD_MUTEX_INITIALIZER;
+volatile int    algo_switch_to = ALGO_NULL;
+int             algo_switch_scrypt_n = 0;
+
+struct timeval  algo_switch_start;
+
+bool algo_switch_request( char *name )
+{
+   int scrypt_n = opt_scrypt_n;
+   int algo = algo_from_name( name, &scrypt_n );
+   bool ok = true;
+
+   if ( algo == ALGO_NULL )
+   {
+      applog( LOG_ERR, "Algo switch: unknown algo %s", name );
+      return false;
+   }
+   pthread_mutex_lock( &algo_switch_lock );
+   if ( !algo_gate.hot_switch )
+   {
+      applog( LOG_ERR, "Algo switch: %s requires a restart",
+                       algo_names[opt_algo] );
+      ok = false;
+   }
+   else if ( algo != opt_algo || scrypt_n != opt_scrypt_n
+             || algo_switch_to != ALGO_NULL )
+   {
+      algo_switch_to = algo;
+      algo_switch_scrypt_n = scrypt_n;
+      gettimeofday( &algo_switch_start, NULL );
+   }
+   pthread_mutex_unlock( &algo_switch_lock );
+   if ( ok )
+      restart_threads();
+   return ok;
+}
+
+// called by the last thread to park with algo_gate_lock held for writing
+// and algo_switch_lock
+
+
+void restart_threads(void)
+{
+	for ( int i = 0; i < opt_n_threads; i++)
+		work_restart[i].restart = 1;
+}
+
+
+json_t *std_longpoll_rpc_call( CURL *curl, int *err, char* lp_url )
+{
+   json_t *val;
+   char *req = NULL;
+   if (have_gbt && lp_id)
+   {
+       req = (char*) malloc( strlen(gbt_lp_req) + strlen(lp_id) + 1 );
+       sprintf( req, gbt_lp_req, lp_id );
+   }
+   val = json_rpc_call( curl, rpc_url, rpc_userpass, getwork_req, err,
+                        JSON_RPC_LONGPOLL );
+   val = json_rpc_call( curl, lp_url, rpc_userpass, req ? req : getwork_req,
+                        err, JSON_RPC_LONGPOLL);
+   free(req);
+   return val;
+}
+
+json_t *jr2_longpoll_rpc_call( CURL *curl, int *err )
+{
+   json_t *val;
+   char req[128];
+
+   pthread_mutex_lock( &rpc2_login_lock );
+   if ( !strlen(rpc2_id) )
+   {
+     pthread_mutex_unlock( &rpc2_login_lock );
+     sleep(1);
+     return NULL;
+   }
+   snprintf( req, 128, "{\"method\": \"getjob\", \"params\": {\"id\": \"%s\"}, \"id\":1}\r\n", rpc2_id );
+   pthread_mutex_unlock( &rpc2_login_lock );
+   val = json_rpc2_call( curl, rpc_url, rpc_userpass, req, err,
+                         JSON_RPC_LONGPOLL );
+   return val;
+}
+
+
+bool std_stratum_handle_response( json_t *val )
+{
+    bool valid = false;
+    json_t *err_val, *res_val, *id_val;
+    res_val = json_object_get( val, "result" );
+    err_val = json_object_get( val, "error" );
+    id_val  = json_object_get( val, "id" );
+
+    if ( !res_val || json_integer_value(id_val) < 4 )
+         return false;
+    valid = json_is_true( res_val );
+    share_result( valid, NULL, err_val ?
+                  json_string_value( json_array_get(err_val, 1) ) : NULL );
+    return true;
+}
+
+bool jr2_stratum_handle_response( json_t *val )
+{
+    bool valid = false;
+    json_t *err_val, *res_val;
+    res_val = json_object_get( val, "result" );
+    err_val = json_object_get( val, "error" );
+
+    if ( !res_val && !err_val )
+        return false;
+    json_t *status = json_object_get( res_val, "status" );
+    if ( status ) 
+    {
+        const char *s = json_string_value( status );
+        valid = !strcmp( s, "OK" ) && json_is_null( err_val );
+    }
+    else
+        valid = json_is_null( err_val );
+    share_result( valid, NULL, err_val ? json_string_value(err_val) : NULL );
+    return true;
+}
+
+
+void std_build_extraheader( struct work* g_work, struct stratum_ctx* sctx )
+{
+   uchar merkle_root[64] = { 0 };
+   size_t t;
+   int i;
+
+   algo_gate.gen_merkle_root( merkle_root, sctx );
+   // Increment extranonce2
+   for ( t = 0; t < sctx->xnonce2_size && !( ++sctx->job.xnonce2[t] ); t++ );
+   // Assemble block header
+   memset( g_work->data, 0, sizeof(g_work->data) );
+   g_work->data[0] = le32dec( sctx->job.version );
+   for ( i = 0; i < 8; i++ )
+      g_work->data[1 + i] = le32dec( (uint32_t *) sctx->job.prevhash + i );
+   for ( i = 0; i < 8; i++ )
+      g_work->data[9 + i] = be32dec( (uint32_t *) merkle_root + i );
+
+   g_work->data[ algo_gate.ntime_index ] = le32dec(sctx->job.ntime);
+   g_work->data[ algo_gate.nbits_index ] = le32dec(sctx->job.nbits);
+   g_work->data[20] = 0x80000000;
+   g_work->data[31] = 0x00000280;
+}
+
+void std_stratum_gen_work( struct stratum_ctx *sctx, struct work *g_work )
+{
+   pthread_mutex_lock( &sctx->work_lock );
+   strcpy( g_work->job_id, sctx->job.job_id );
+   // the session keeps its mask across an algo switch
+   g_work->version_mask = algo_gate.roll_version ? sctx->version_mask : 0;
+   g_work->xnonce2_len = sctx->xnonce2_size;
+   memcpy( g_work->xnonce2, sctx->job.xnonce2, sctx->xnonce2_size );
+
+   algo_gate.build_extraheader( g_work, sctx );
+
+   net_diff = algo_gate.calc_network_diff( g_work );
+   algo_gate.set_work_data_endian( g_work );
+   pthread_mutex_unlock( &sctx->work_lock );
+
+   if ( opt_debug )
+   {
+     unsigned char *xnonce2str = abin2hex( g_work->xnonce2,
+                                           g_work->xnonce2_len );
+     applog( LOG_DEBUG, "DEBUG: job_id='%s' extranonce2=%s ntime=%08x",
+                    g_work->job_id, xnonce2str, swab32( g_work->data[17] ) );
+       free( xnonce2str );
+   }
+
+   algo_gate.set_target( g_work, sctx->job.diff );
+
+   if ( stratum_diff != sctx->job.diff )
+   {
+     char sdiff[32] = { 0 };
+     // store for api stats
+     stratum_diff = sctx->job.diff;
+     if ( opt_showdiff && g_work->targetdiff != stratum_diff )
+     {
+        snprintf( sdiff, 32, " (%.5f)", g_work->targetdiff );
+        applog( LOG_WARNING, "Stratum difficulty set to %g%s", stratum_diff,
+                        sdiff );
+     }
+   }
+}
+
+void jr2_stratum_gen_work( struct stratum_ctx *sctx, struct work *g_work )
+{
+   pthread_mutex_lock( &sctx->work_lock );
+   work_free( g_work );
+   work_copy( g_work, &sctx->work );
+   pthread_mutex_unlock( &sctx->work_lock );
+}
+
+
+void show_version_and_exit(void)
+{
+        printf("\n built on " __DATE__
+#ifdef _MSC_VER
+         " with VC++ 2013\n");
+#elif defined(__GNUC__)
+         " with GCC");
+        printf(" %d.%d.%d\n", __GNUC__, __GNUC_MINOR__, __GNUC_PATCHLEVEL__);
+#endif
+
+        printf(" features:"
+#if defined(USE_ASM) && defined(__i386__)
+                " i386"
+#endif
+#if defined(USE_ASM) && defined(__x86_64__)
+                " x86_64"
+#endif
+#if defined(USE_ASM) && (defined(__i386__) || defined(__x86_64__))
+                " SSE2"
+#endif
+#if defined(__x86_64__) && defined(USE_AVX)
+                " AVX"
+#endif
+#if defined(__x86_64__) && defined(USE_AVX2)
+                " AVX2"
+#endif
+#if defined(__x86_64__) && defined(USE_XOP)
+                " XOP"
+#endif
+#if defined(USE_ASM) && defined(__arm__) && defined(__APCS_32__)
+                " ARM"
+#if defined(__ARM_ARCH_5E__) || defined(__ARM_ARCH_5TE__) || \
+        defined(__ARM_ARCH_5TEJ__) || defined(__ARM_ARCH_6__) || \
+        defined(__ARM_ARCH_6J__) || defined(__ARM_ARCH_6K__) || \
+        defined(__ARM_ARCH_6M__) || defined(__ARM_ARCH_6T2__) || \
+        defined(__ARM_ARCH_6Z__) || defined(__ARM_ARCH_6ZK__) || \
+        defined(__ARM_ARCH_7__) || \
+        defined(__ARM_ARCH_7A__) || defined(__ARM_ARCH_7R__) || \
+        defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+                " ARMv5E"
+#endif
+#if defined(__ARM_NEON__)
+                " NEON"
+#endif
+#endif
+                "\n\n");
+
+        /* dependencies versions */
+        printf("%s\n", curl_version());
+#ifdef JANSSON_VERSION
+        printf("jansson/%s ", JANSSON_VERSION);
+#endif
+#ifdef PTW32_VERSION
+        printf("pthreads/%d.%d.%d.%d ", PTW32_VERSION);
+#endif
+        printf("\n");
+        exit(0);
+}
+
+
+void show_usage_and_exit(int status)
+{
+	if (status)
+		fprintf(stderr, "Try `" PACKAGE_NAME " --help' for more information.\n");
+	else
+		fputs(usage, stdout);
+	exit(status);
+}
+
+void strhide(char *s)
+{
+	if (*s) *s++ = 'x';
+	while (*s) *s++ = '\0';
+}
+
+// Accepts algo names, aliases and scrypt:N, returns ALGO_NULL if unknown.
+int algo_from_name( char *arg, int *scrypt_n )
+{
+   int i, v;
+   get_algo_alias( &arg );
+   for ( i = 1; i < ALGO_COUNT; i++ )
+   {
+      v = (int) strlen( algo_names[i] );
+      if ( v && !strncasecmp( arg, algo_names[i], v ) )
+      {
+         if ( arg[v] == '\0' )
+            return i;
+         if ( arg[v] == ':' )
+         {
+            char *ep;
+            v = strtol( arg+v+1, &ep, 10 );
+            if ( *ep || v < 2 )
+               continue;
+            *scrypt_n = v;
+            return i;
+         }
+      }
+   }
+   return ALGO_NULL;
+}
+
+void parse_arg(int key, char *arg )
+{
+	char *p;
+	int v, i;
+	uint64_t ul;
+	double d;
+
+	switch(key)
+        {
+	   case 'a':
+              i = algo_from_name( arg, &opt_scrypt_n );
+              if ( i == ALGO_NULL )
+              {
+                 applog(LOG_ERR,"Unknown algo: %s",arg);
+                 show_usage_and_exit(1);
+              }
+              opt_algo = (enum algos) i;
+           break;
+
+	case 'b':
+		p = strstr(arg, ":");
+		if (p) {
+			/* ip:port */
+			if (p - arg > 0) {
+				free(opt_api_allow);
+				opt_api_allow = strdup(arg);
+				opt_api_allow[p - arg] = '\0';
+			}
+			opt_api_listen = atoi(p + 1);
+		}
+		else if (arg && strstr(arg, ".")) {
+			/* ip only */
+			free(opt_api_allow);
+			opt_api_allow = strdup(arg);
+		}
+		else if (arg) {
+			/* port or 0 to disable */
+			opt_api_listen = atoi(arg);
+		}
+		break;
+	case 1030: /* --api-remote */
+		opt_api_remote = 1;
+		break;
+	case 1031: /* --api-push */
+		v = atoi(arg);
+		if (v < 100 || v > 3600000) /* sanity check */
+			show_usage_and_exit(1);
+		opt_api_push_ms = v;
+		break;
+	case 1032: /* --perf-counters */
+		opt_perf_counters = true;
+		break;
+	case 'B':
+		opt_background = true;
+		use_colors = false;
+		break;
+	case 'c': {
+		json_error_t err;
+		json_t *config;
+                
+		if (arg && strstr(arg, "://"))
+			config = json_load_url(arg, &err);
+                else
+			config = JSON_LOADF(arg, &err);
+		if (!json_is_object(config))
+                {
+			if (err.line < 0)
+				fprintf(stderr, "%s\n", err.text);
+			else
+				fprintf(stderr, "%s:%d: %s\n",
+					arg, err.line, err.text);
+		}
+                else
+                {
+			parse_config(config, arg);
+			json_decref(config);
+		}
+		break;
+	}
+	case 'q':
+		opt_quiet = true;
+		break;
+	case 'D':
+		opt_debug = true;
+		break;
+	case 'p':
+		free(rpc_pass);
+		rpc_pass = strdup(arg);
+		strhide(arg);
+		break;
+	case 'P':
+		opt_protocol = true;
+		break;
+	case 'r':
+		v = atoi(arg);
+		if (v < -1 || v > 9999) /* sanity check */
+			show_usage_and_exit(1);
+		opt_retries = v;
+		break;
+	case 'R':
+		v = atoi(arg);
+		if (v < 1 || v > 9999) /* sanity check */
+			show_usage_and_exit(1);
+		opt_fail_pause = v;
+		break;
+	case 's':
+		v = atoi(arg);
+		if (v < 1 || v > 9999) /* sanity check */
+			show_usage_and_exit(1);
+		opt_scantime = v;
+		break;
+	case 'T':
+		v = atoi(arg);
+		if (v < 1 || v > 99999) /* sanity check */
+			show_usage_and_exit(1);
+		opt_timeout = v;
+		break;
+	case 't':
+		v = atoi(arg);
+		if (v < 0 || v > 9999) /* sanity check */
+			show_usage_and_exit(1);
+		opt_n_threads = v;
+		break;
+	case 'u':
+		free(rpc_user);
+		rpc_user = strdup(arg);
+		break;
+	case 'o': {			/* --url */
+		char *ap, *hp;
+		ap = strstr(arg, "://");
+		ap = ap ? ap + 3 : arg;
+		hp = strrchr(arg, '@');
+		if (hp) {
+			*hp = '\0';
+			p = strchr(ap, ':');
+			if (p) {
+				free(rpc_userpass);
+				rpc_userpass = strdup(ap);
+				free(rpc_user);
+				rpc_user = (char*) calloc(p - ap + 1, 1);
+				strncpy(rpc_user, ap, p - ap);
+				free(rpc_pass);
+				rpc_pass = strdup(++p);
+				if (*p) *p++ = 'x';
+				v = (int) strlen(hp + 1) + 1;
+				memmove(p + 1, hp + 1, v);
+				memset(p + v, 0, hp - p);
+				hp = p;
+			} else {
+				free(rpc_user);
+				rpc_user = strdup(ap);
+			}
+			*hp++ = '@';
+		} else
+			hp = ap;
+		if (ap != arg) {
+			if (strncasecmp(arg, "http://", 7) &&
+			    strncasecmp(arg, "https://", 8) &&
+			    strncasecmp(arg, "stratum+tcp://", 14)) {
+				fprintf(stderr, "unknown protocol -- '%s'\n", arg);
+				show_usage_and_exit(1);
+			}
+			free(rpc_url);
+			rpc_url = strdup(arg);
+			strcpy(rpc_url + (ap - arg), hp);
+			short_url = &rpc_url[ap - arg];
+		} else {
+			if (*hp == '\0' || *hp == '/') {
+				fprintf(stderr, "invalid URL -- '%s'\n",
+					arg);
+				show_usage_and_exit(1);
+			}
+			free(rpc_url);
+			rpc_url = (char*) malloc( strlen(hp) + 15 );
+			sprintf( rpc_url, "stratum+tcp://%s", hp );
+			short_url = &rpc_url[ sizeof("stratum+tcp://") - 1 ];
+		}
+		have_stratum = !opt_benchmark && !strncasecmp(rpc_url, "stratum", 7);
+		break;
+	}
+	case 'O':			/* --userpass */
+		p = strchr(arg, ':');
+		if (!p) {
+			fprintf(stderr, "invalid username:password pair -- '%s'\n", arg);
+			show_usage_and_exit(1);
+		}
+		free(rpc_userpass);
+		rpc_userpass = strdup(arg);
+		free(rpc_user);
+		rpc_user = (char*) calloc(p - arg + 1, 1);
+		strncpy(rpc_user, arg, p - arg);
+		free(rpc_pass);
+		rpc_pass = strdup(++p);
+		strhide(p);
+		break;
+	case 'x':			/* --proxy */
+		if (!strncasecmp(arg, "socks4://", 9))
+			opt_proxy_type = CURLPROXY_SOCKS4;
+		else if (!strncasecmp(arg, "socks5://", 9))
+			opt_proxy_type = CURLPROXY_SOCKS5;
+#if LIBCURL_VERSION_NUM >= 0x071200
+		else if (!strncasecmp(arg, "socks4a://", 10))
+			opt_proxy_type = CURLPROXY_SOCKS4A;
+		else if (!strncasecmp(arg, "socks5h://", 10))
+			opt_proxy_type = CURLPROXY_SOCKS5_HOSTNAME;
+#endif
+		else
+			opt_proxy_type = CURLPROXY_HTTP;
+		free(opt_proxy);
+		opt_proxy = strdup(arg);
+		break;
+	case 1001:
+		free(opt_cert);
+		opt_cert = strdup(arg);
+		break;
+	case 1002:
+		use_colors = false;
+		break;
+	case 1003:
+		want_longpoll = false;
+		break;
+	case 1040: /* --bench-reps */
+		v = atoi(arg);
+		if (v < 1 || v > 10000)
+			show_usage_and_exit(1);
+		opt_bench_reps = v;
+		opt_bench = true;
+		goto benchmark;
+	case 1041: /* --bench-hashes */
+		opt_bench_hashes = strtoull(arg, NULL, 10);
+		opt_bench = true;
+		goto benchmark;
+	case 1042: /* --bench-warmup */
+		opt_bench_warmup = strtoll(arg, NULL, 10);
+		opt_bench = true;
+		goto benchmark;
+	case 1043: /* --bench-sweep */
+		opt_bench_sweep = true;
+		opt_bench = true;
+		goto benchmark;
+	case 1045: /* --bench-memory */
+		opt_bench_memory = true;
+		opt_bench = true;
+		goto benchmark;
+	case 1044: /* --bench-json */
+		free(opt_bench_json);
+		opt_bench_json = strdup(arg);
+		opt_bench = true;
+		/* fall through */
+	case 1005:
+	benchmark:
+		opt_benchmark = true;
+		want_longpoll = false;
+		want_stratum = false;
+		have_stratum = false;
+		break;
+	case 1006:
+		opt_cputest = true;
+		break;
+	case 1073: /* --verify */
+		free(opt_verify_file);
+		opt_verify_file = arg ? strdup(arg) : NULL;
+		opt_verify = true;
+		break;
+	case 1007:
+		want_stratum = false;
+		opt_extranonce = false;
+		break;
+	case 1008:
+		opt_time_limit = atoi(arg);
+		break;
+	case 1009:
+		opt_redirect = false;
+		break;
+	case 1010:
+		allow_getwork = false;
+		break;
+	case 1011:
+		have_gbt = false;
+		break;
+	case 1012:
+		opt_extranonce = false;
+		break;
+	case 1074: /* --no-version-rolling */
+		opt_version_rolling = false;
+		break;
+	case 1013:
+		opt_showdiff = false;
+		break;
+	case 1016:			/* --coinbase-addr */
+		pk_script_size = address_to_script(pk_script, sizeof(pk_script), arg);
+		if (!pk_script_size) {
+			fprintf(stderr, "invalid address -- '%s'\n", arg);
+			show_usage_and_exit(1);
+		}
+		break;
+	case 1015:			/* --coinbase-sig */
+		if (strlen(arg) + 1 > sizeof(coinbase_sig)) {
+			fprintf(stderr, "coinbase signature too long\n");
+			show_usage_and_exit(1);
+		}
+		strcpy(coinbase_sig, arg);
+		break;
+	case 'f':
+		d = atof(arg);
+		if (d == 0.)	/* --diff-factor */
+			show_usage_and_exit(1);
+		opt_diff_factor = d;
+		break;
+	case 'm':
+		d = atof(arg);
+		if (d == 0.)	/* --diff-multiplier */
+			show_usage_and_exit(1);
+		opt_diff_factor = 1.0/d;
+		break;
+	case 'S':
+		use_syslog = true;
+		use_colors = false;
+		break;
+	case 1020:
+		p = strstr(arg, "0x");
+		if (p)
+			ul = strtoul(p, NULL, 16);
+		else
+			ul = atol(arg);
+		if (ul > (1UL<<num_cpus)-1)
+			ul = -1;
+		opt_affinity = ul;
+		break;
+	case 1072: /* --interleave */
+		v = atoi(arg);
+		if (v < 0 || v > IL_MAX_WAYS)
+			show_usage_and_exit(1);
+		opt_interleave = v;
+		break;
+	case 1070: /* --split */
+		free(opt_split);
+		opt_split = strdup(arg);
+		break;
+	case 1071: /* --split-cpus */
+		p = strstr(arg, "0x");
+		if (p)
+			ul = strtoul(p, NULL, 16);
+		else
+			ul = atol(arg);
+		opt_split_cpus = ul;
+		break;
+	case 1021:
+		v = atoi(arg);
+		if (v < 0 || v > 5)	/* sanity check */
+			show_usage_and_exit(1);
+		opt_priority = v;
+		break;
+	case 1060: // max-temp
+		d = atof(arg);
+		opt_max_temp = d;
+		break;
+	case 1061: // max-diff
+		d = atof(arg);
+		opt_max_diff = d;
+		break;
+	case 1065: // share-rate
+		d = atof(arg);
+		if (d <= 0.)
+			show_usage_and_exit(1);
+		opt_share_rate = d;
+		break;
+	case 1063: // max-power
+		d = atof(arg);
+		opt_max_power = d;
+		break;
+	case 1064: // max-memory, MiB without a unit
+		d = strtod(arg, &p);
+		if (*p == 'K' || *p == 'k')
+			d *= 1024.;
+		else if (*p == 'G' || *p == 'g')
+			d *= 1024. * 1024. * 1024.;
+		else
+			d *= 1024. * 1024.;
+		if (d < 1.)
+			show_usage_and_exit(1);
+		opt_max_memory = (uint64_t) d;
+		break;
+	case 1062: // max-rate
+		d = atof(arg);
+		p = strstr(arg, "K");
+		if (p) d *= 1e3;
+		p = strstr(arg, "M");
+		if (p) d *= 1e6;
+		p = strstr(arg, "G");
+		if (p) d *= 1e9;
+		opt_max_rate = d;
+		break;
+	case 1024:
+		opt_randomize = true;
+		break;
+	case 'V':
+		show_version_and_exit();
+	case 'h':
+		show_usage_and_exit(0);
+	default:
+		show_usage_and_exit(1);
+	}
+}
+
+void parse_config(json_t *config, char *ref)
+{
+	int i;
+	json_t *val;
+
+	for (i = 0; i < ARRAY_SIZE(options); i++) {
+		if (!options[i].name)
+			break;
+
+		val = json_object_get(config, options[i].name);
+		if (!val)
+			continue;
+		if (options[i].has_arg && json_is_string(val)) {
+			char *s = strdup(json_string_value(val));
+			if (!s)
+				break;
+			parse_arg(options[i].val, s);
+			free(s);
+		}
+		else if (options[i].has_arg && json_is_integer(val)) {
+			char buf[16];
+			sprintf(buf, "%d", (int)json_integer_value(val));
+			parse_arg(options[i].val, buf);
+		}
+		else if (options[i].has_arg && json_is_real(val)) {
+			char buf[16];
+			sprintf(buf, "%f", json_real_value(val));
+			parse_arg(options[i].val, buf);
+		}
+		else if (!options[i].has_arg) {
+			if (json_is_true(val))
+				parse_arg(options[i].val, "");
+		}
+		else
+			applog(LOG_ERR, "JSON option %s invalid",
+			options[i].name);
+	}
+}
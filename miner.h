@@ -245,6 +245,14 @@ void work_copy(struct work *dest, const struct work *src);
 /* api related */
 void *api_thread(void *userdata);
 
+// push subscription event types
+#define API_EVENT_HASHRATE 1
+#define API_EVENT_SHARE    2
+#define API_EVENT_JOB      4
+#define API_EVENT_ALL      ( API_EVENT_HASHRATE | API_EVENT_SHARE | API_EVENT_JOB )
+
+void api_push_event( int type, const char *fmt, ... );
+
 struct cpu_info {
 	int thr_id;
 	int accepted;
@@ -303,6 +311,8 @@ struct thr_api {
 
 void   applog(int prio, const char *fmt, ...);
 void   restart_threads(void);
+int    algo_from_name( char *arg, int *scrypt_n );
+bool   algo_switch_request( char *name );
 extern json_t *json_rpc_call( CURL *curl, const char *url, const char *userpass,
                 	const char *rpc_req, int *curl_err, int flags );
 void   bin2hex( char *s, const unsigned char *p, size_t len );
@@ -337,6 +347,117 @@ void   cpu_getmodelid(char *outbuf, size_t maxsz);
 void   cpu_brand_string( char* s );
 
 float cpu_temp( int core );
+uint32_t cpu_clock( int core );
+int   cpu_package( int core );
+int   cpu_core( int core );
+float cpu_power( int package );
+
+/* cputime.c */
+bool   cputime_init( int n_threads );
+void   cputime_start( int thr_id );
+void   cputime_sample( int thr_id, uint64_t hashes_done );
+double cputime_rate( int thr_id );
+void   cputime_format( int thr_id, char *out, size_t sz );
+int    cputime_format_api( char *buf, size_t sz );
+
+/* thermal.c */
+extern double opt_max_temp;
+extern double opt_max_power;
+
+bool   governor_init();
+void  *governor_thread( void *userdata );
+double governor_duty( int thr_id );
+double governor_throttle( int thr_id, double busy );
+int    governor_format_api( char *buf, size_t sz );
+
+/* cgroup.c */
+extern unsigned long cgroup_cpus;
+extern double        cgroup_cpu_quota;
+extern uint64_t      cgroup_mem_limit;
+
+bool   cgroup_init();
+int    cgroup_threads();
+
+/* memory.c */
+extern uint64_t opt_max_memory;
+extern int      memory_threads;
+
+uint64_t memory_budget();
+bool     memory_init( bool threads_given );
+int      memory_format_api( char *buf, size_t sz );
+
+/* diffctl.c */
+#define DIFFCTL_RPC_ID  5   /* id of mining.suggest_difficulty */
+
+extern double opt_share_rate;
+
+struct stratum_ctx;
+void diffctl_connect();
+void diffctl_update( struct stratum_ctx *sctx, const uint32_t *target );
+void diffctl_response( json_t *val );
+int  diffctl_format_api( char *buf, size_t sz );
+
+/* verify.c */
+extern bool  opt_verify;
+extern char *opt_verify_file;
+
+int cpu_verify();
+
+/* split.c */
+extern char       *opt_split;
+extern int64_t     opt_split_cpus;
+extern const char *log_tag;
+
+bool   split_init();
+bool   split_start();
+bool   split_pinned();
+int    split_format_api( char *buf, size_t sz );
+int    thread_cpu( int thr_id );
+bool   thread_pinned();
+
+/* bench.c */
+extern bool     opt_bench;
+extern int      opt_bench_reps;
+extern uint64_t opt_bench_hashes;
+extern int64_t  opt_bench_warmup;
+extern bool     opt_bench_sweep;
+extern char    *opt_bench_json;
+extern bool     opt_bench_memory;
+
+int  cpu_bench();
+void affine_to_cpu_mask( int id, unsigned long mask );
+
+/* perfmon.c, per thread hardware counters */
+enum {
+	PERF_CTR_CYCLES = 0,
+	PERF_CTR_INSTRUCTIONS,
+	PERF_CTR_L1D_MISS,
+	PERF_CTR_LLC_MISS,
+	PERF_CTR_DTLB_MISS,
+	PERF_CTR_STALLED,
+	PERF_CTR_COUNT
+};
+
+struct perf_stats {
+	uint64_t ctr[PERF_CTR_COUNT];
+	uint64_t hashes;
+	int valid;   // bitmask of counters that could be read
+};
+
+extern bool opt_perf_counters;
+
+bool   perf_init( int n_threads );
+void   perf_thread_init( int thr_id );
+void   perf_thread_start( int thr_id );
+void   perf_thread_sample( int thr_id, uint64_t hashes_done );
+bool   perf_get_stats( int thr_id, bool total, struct perf_stats *st );
+bool   perf_get_total( struct perf_stats *st );
+double perf_ipc( const struct perf_stats *st );
+void   perf_format( const struct perf_stats *st, char *out, size_t sz );
+int    perf_format_api( const struct perf_stats *st, char *out, size_t sz );
+
+#define WORK_JOB_ID_MAX   128
+#define WORK_XNONCE2_MAX  16
 
 struct work {
 	uint32_t data[48];
@@ -350,9 +471,13 @@ struct work {
 	char *txs;
 	char *workid;
 
-	char *job_id;
+	// inline so a job switch copies the work without allocating,
+	// stratum limits the extranonce2 size to 16 bytes
+	char job_id[WORK_JOB_ID_MAX];
 	size_t xnonce2_len;
-	unsigned char *xnonce2;
+	unsigned char xnonce2[WORK_XNONCE2_MAX];
+
+	uint32_t version_mask;  // version bits the miner may roll, BIP320
 };
 
 struct stratum_job {
@@ -394,13 +519,20 @@ struct stratum_ctx {
 	pthread_mutex_t work_lock;
 
 	int bloc_height;
+	uint32_t version_mask;  // negotiated with mining.configure, 0 for none
 };
 
+/* BIP320 version rolling, the mask is its general purpose bits */
+#define STRATUM_CONFIGURE_ID   6
+#define VERSION_ROLL_MASK      0x1fffe000
+#define VERSION_ROLL_MIN_BITS  2
+
 bool stratum_socket_full(struct stratum_ctx *sctx, int timeout);
 bool stratum_send_line(struct stratum_ctx *sctx, char *s);
 char *stratum_recv_line(struct stratum_ctx *sctx);
 bool stratum_connect(struct stratum_ctx *sctx, const char *url);
 void stratum_disconnect(struct stratum_ctx *sctx);
+bool stratum_configure(struct stratum_ctx *sctx);
 bool stratum_subscribe(struct stratum_ctx *sctx);
 bool stratum_authorize(struct stratum_ctx *sctx, const char *user, const char *pass);
 bool stratum_handle_method(struct stratum_ctx *sctx, const char *s);
@@ -441,6 +573,7 @@ void proper_exit(int reason);
 void applog_hash(void *hash);
 void format_hashrate(double hashrate, char *output);
 void print_hash_tests(void);
+int  cpu_selftest(int algo);
 
 
 
@@ -465,6 +598,7 @@ enum workio_commands {
 struct workio_cmd {
         enum workio_commands cmd;
         struct thr_info *thr;
+        int gate_gen;   /* algo generation of a submission */
         union {
                 struct work *work;
         } u;
@@ -604,6 +738,7 @@ extern bool opt_benchmark;
 extern bool opt_protocol;
 extern bool opt_showdiff;
 extern bool opt_extranonce;
+extern bool opt_version_rolling;
 extern bool opt_quiet;
 extern bool opt_redirect;
 extern int opt_timeout;
@@ -640,12 +775,52 @@ extern time_t g_work_time;
 extern bool opt_stratum_stats;
 extern int num_cpus;
 extern int opt_priority;
+extern int64_t opt_affinity;
 
 extern pthread_mutex_t rpc2_job_lock;
 extern pthread_mutex_t rpc2_login_lock;
 extern pthread_mutex_t applog_lock;
 extern pthread_mutex_t stats_lock;
 
+// set by parse_arg in miner-common.c for the threads of cpu-miner.c
+extern bool opt_cputest;
+extern bool opt_background;
+extern int opt_retries;
+extern int opt_fail_pause;
+extern int opt_time_limit;
+extern int opt_scantime;
+extern double opt_max_diff;
+extern double opt_max_rate;
+extern char *opt_api_allow;
+extern int opt_api_listen;
+extern unsigned char pk_script[25];
+extern size_t pk_script_size;
+extern char coinbase_sig[101];
+extern char *rpc_url;
+extern char *rpc_userpass;
+extern char *rpc_pass;
+extern char *short_url;
+extern struct stratum_ctx stratum;
+extern bool stratum_need_reset;
+extern struct work g_work;
+extern char *lp_id;
+extern double *thr_hashcount;
+extern double global_hashcount;
+extern const char *getwork_req;
+extern const char *gbt_req;
+extern const char *gbt_lp_req;
+
+// a hot algo switch requested by algo_switch_request
+extern pthread_mutex_t algo_switch_lock;
+extern volatile int    algo_switch_to;
+extern int             algo_switch_scrypt_n;
+extern struct timeval  algo_switch_start;
+
+void drop_policy(void);
+int  share_result( int result, struct work *work, const char *reason );
+void scale_hash_for_display( double* hashrate, char* units );
+void show_usage_and_exit( int status );
+
 
 static char const usage[] = "\
 Usage: " PACKAGE_NAME " [OPTIONS]\n\
@@ -733,6 +908,7 @@ Options:\n\
       --no-gbt          disable getblocktemplate support\n\
       --no-stratum      disable X-Stratum support\n\
       --no-extranonce   disable Stratum extranonce support\n\
+      --no-version-rolling disable Stratum version rolling (sha256d, BIP320)\n\
       --no-redirect     ignore requests to change the URL of the mining server\n\
   -q, --quiet           disable per-thread hashmeter output\n\
       --no-color        disable colored output\n\
@@ -745,14 +921,36 @@ Options:\n\
 "\
   -B, --background      run the miner in the background\n\
       --benchmark       run in offline benchmark mode\n\
-      --cputest         debug hashes from cpu algorithms\n\
+      --bench-reps=N    benchmark N repetitions of fixed work, report mean,\n\
+                          stddev, min and max (default: 5)\n\
+      --bench-hashes=N  hashes per thread in each repetition (default: 2s)\n\
+      --bench-warmup=N  hashes per thread before measuring (default: 10%)\n\
+      --bench-sweep     benchmark 1 to -t threads to show the scaling\n\
+      --bench-json=FILE write the benchmark results as JSON, - for stdout\n\
+      --bench-memory    benchmark the thread scaling for each placement, huge\n\
+                          pages on and off and scrypt width, with bandwidth\n\
+      --interleave=N    hash N nonces at once per thread in axiom and pluck to\n\
+                          overlap their memory loads (default: by cache size)\n\
+      --cputest         check the hash functions of all algos, or of -a\n\
+      --verify[=FILE]   hash the headers of FILE or stdin, one per line in hex\n\
+                          with an optional target, and report pass or fail\n\
       --cpu-affinity    set process affinity to cpu core(s), mask 0x3 for cores 0 and 1\n\
+      --split=OPTIONS   mine a second algo with these options on the SMT siblings,\n\
+                          e.g. --split=\"-a x11 -o URL -u USER -p PASS\" (linux)\n\
+      --split-cpus=MASK cpus of the --split algo instead of the siblings\n\
       --cpu-priority    set process priority (default: 0 idle, 2 normal to 5 highest)\n\
+      --perf-counters   report IPC and cache misses per hash (linux perf_event)\n\
   -b, --api-bind        IP/Port for the miner API (default: 127.0.0.1:4048)\n\
       --api-remote      Allow remote control\n\
-      --max-temp=N      Only mine if cpu temp is less than specified value (linux)\n\
+      --api-push=N      Default interval of API hashrate pushes in ms (default: 1000)\n\
+      --max-temp=N      Throttle threads to hold cpu temp at N C (linux)\n\
+      --max-power=N     Throttle threads to hold package power at N watts (linux, RAPL)\n\
+      --max-memory=N[KMG] Fit the threads and their scratchpads in N MiB, also\n\
+                          follows the cgroup memory limit\n\
       --max-rate=N[KMG] Only mine if net hashrate is less than specified value\n\
       --max-diff=N      Only mine if net difficulty is less than specified value\n\
+      --share-rate=N    Suggest the stratum difficulty for N shares per minute\n\
+                          at the measured hashrate\n\
   -c, --config=FILE     load a JSON-format configuration file\n\
   -V, --version         display version information and exit\n\
   -h, --help            display this help text and exit\n\
@@ -774,15 +972,25 @@ static struct option const options[] = {
         { "algo", 1, NULL, 'a' },
         { "api-bind", 1, NULL, 'b' },
         { "api-remote", 0, NULL, 1030 },
+        { "api-push", 1, NULL, 1031 },
         { "background", 0, NULL, 'B' },
         { "benchmark", 0, NULL, 1005 },
+        { "bench-reps", 1, NULL, 1040 },
+        { "bench-hashes", 1, NULL, 1041 },
+        { "bench-warmup", 1, NULL, 1042 },
+        { "bench-sweep", 0, NULL, 1043 },
+        { "bench-json", 1, NULL, 1044 },
+        { "bench-memory", 0, NULL, 1045 },
         { "cputest", 0, NULL, 1006 },
+        { "verify", 2, NULL, 1073 },
+        { "interleave", 1, NULL, 1072 },
         { "cert", 1, NULL, 1001 },
         { "coinbase-addr", 1, NULL, 1016 },
         { "coinbase-sig", 1, NULL, 1015 },
         { "config", 1, NULL, 'c' },
         { "cpu-affinity", 1, NULL, 1020 },
         { "cpu-priority", 1, NULL, 1021 },
+        { "perf-counters", 0, NULL, 1032 },
         { "no-color", 0, NULL, 1002 },
         { "debug", 0, NULL, 'D' },
         { "diff-factor", 1, NULL, 'f' },
@@ -796,9 +1004,13 @@ static struct option const options[] = {
         { "no-redirect", 0, NULL, 1009 },
         { "no-stratum", 0, NULL, 1007 },
         { "no-extranonce", 0, NULL, 1012 },
+        { "no-version-rolling", 0, NULL, 1074 },
         { "max-temp", 1, NULL, 1060 },
         { "max-diff", 1, NULL, 1061 },
+        { "share-rate", 1, NULL, 1065 },
         { "max-rate", 1, NULL, 1062 },
+        { "max-power", 1, NULL, 1063 },
+        { "max-memory", 1, NULL, 1064 },
         { "pass", 1, NULL, 'p' },
         { "protocol", 0, NULL, 'P' },
         { "protocol-dump", 0, NULL, 'P' },
@@ -808,6 +1020,8 @@ static struct option const options[] = {
         { "retry-pause", 1, NULL, 'R' },
         { "randomize", 0, NULL, 1024 },
         { "scantime", 1, NULL, 's' },
+        { "split", 1, NULL, 1070 },
+        { "split-cpus", 1, NULL, 1071 },
 #ifdef HAVE_SYSLOG_H
         { "syslog", 0, NULL, 'S' },
 #endif
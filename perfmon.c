@@ -0,0 +1,271 @@
+/**
+ * Per thread hardware performance counters (linux perf_event)
+ *
+ * Each miner thread opens its own counters and samples them around
+ * every scanhash call, so rates are per hash of the current algo.
+ * Counters the kernel or the cpu refuse are simply left out, if none
+ * can be opened (perf_event_paranoid, containers, VMs) sampling is
+ * disabled with a single warning.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "miner.h"
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+bool opt_perf_counters = false;
+
+static const char* const perf_ctr_names[PERF_CTR_COUNT] =
+{
+	"cycles",
+	"instructions",
+	"L1D misses",
+	"LLC misses",
+	"dTLB misses",
+	"stalled cycles"
+};
+
+struct perf_thread {
+	int fd[PERF_CTR_COUNT];
+	uint64_t last[PERF_CTR_COUNT];
+	struct perf_stats interval;
+	struct perf_stats total;
+};
+
+static struct perf_thread *perf_thr = NULL;
+static int perf_n_threads = 0;
+static bool perf_warned = false;
+
+#ifdef __linux__
+
+static int perf_paranoid()
+{
+	int level = -9;
+	FILE *fd = fopen("/proc/sys/kernel/perf_event_paranoid", "r");
+	if (fd) {
+		if (fscanf(fd, "%d", &level) != 1)
+			level = -9;
+		fclose(fd);
+	}
+	return level;
+}
+
+static int perf_open(uint32_t type, uint64_t config)
+{
+	struct perf_event_attr pe;
+
+	memset(&pe, 0, sizeof(pe));
+	pe.size = sizeof(pe);
+	pe.type = type;
+	pe.config = config;
+	pe.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+	               | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	pe.exclude_kernel = 1;
+	pe.exclude_hv = 1;
+
+	// this thread, any cpu
+	return (int) syscall(__NR_perf_event_open, &pe, 0, -1, -1, 0);
+}
+
+#define HW_CACHE(cache, op, result) \
+	((cache) | ((op) << 8) | ((result) << 16))
+
+/* read one counter scaled for multiplexing */
+static bool perf_read(int fd, uint64_t *val)
+{
+	uint64_t buf[3];
+
+	if (read(fd, buf, sizeof(buf)) != sizeof(buf))
+		return false;
+	if (buf[2] && buf[2] < buf[1])
+		buf[0] = (uint64_t) ((double) buf[0] * buf[1] / buf[2]);
+	*val = buf[0];
+	return true;
+}
+
+#endif /* __linux__ */
+
+bool perf_init(int n_threads)
+{
+	if (!opt_perf_counters)
+		return true;
+	perf_thr = (struct perf_thread*) calloc(n_threads, sizeof(*perf_thr));
+	if (!perf_thr)
+		return false;
+	perf_n_threads = n_threads;
+	for (int i = 0; i < n_threads; i++)
+		for (int c = 0; c < PERF_CTR_COUNT; c++)
+			perf_thr[i].fd[c] = -1;
+#ifndef __linux__
+	applog(LOG_WARNING, "Performance counters are only supported on Linux");
+	opt_perf_counters = false;
+#endif
+	return true;
+}
+
+/* called by each miner thread before it starts hashing */
+void perf_thread_init(int thr_id)
+{
+#ifdef __linux__
+	static const struct { uint32_t type; uint64_t config; } ctrs[PERF_CTR_COUNT] =
+	{
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		{ PERF_TYPE_HW_CACHE, HW_CACHE(PERF_COUNT_HW_CACHE_L1D,
+		                               PERF_COUNT_HW_CACHE_OP_READ,
+		                               PERF_COUNT_HW_CACHE_RESULT_MISS) },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+		{ PERF_TYPE_HW_CACHE, HW_CACHE(PERF_COUNT_HW_CACHE_DTLB,
+		                               PERF_COUNT_HW_CACHE_OP_READ,
+		                               PERF_COUNT_HW_CACHE_RESULT_MISS) },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND }
+	};
+	struct perf_thread *pt;
+	int opened = 0, err = 0;
+
+	if (!opt_perf_counters || thr_id >= perf_n_threads)
+		return;
+	pt = &perf_thr[thr_id];
+
+	for (int c = 0; c < PERF_CTR_COUNT; c++) {
+		pt->fd[c] = perf_open(ctrs[c].type, ctrs[c].config);
+		if (pt->fd[c] < 0) {
+			err = errno;
+			if (opt_debug)
+				applog(LOG_DEBUG, "Thread %d: no %s counter (%s)",
+					thr_id, perf_ctr_names[c], strerror(err));
+			continue;
+		}
+		opened++;
+	}
+
+	if (!opened && !perf_warned) {
+		perf_warned = true;
+		if (err == EACCES || err == EPERM)
+			applog(LOG_WARNING, "Performance counters not permitted, "
+				"perf_event_paranoid is %d", perf_paranoid());
+		else
+			applog(LOG_WARNING, "Performance counters unavailable (%s)",
+				strerror(err));
+	}
+#endif
+}
+
+/* counter baseline, just before scanhash */
+void perf_thread_start(int thr_id)
+{
+#ifdef __linux__
+	struct perf_thread *pt;
+
+	if (!opt_perf_counters || thr_id >= perf_n_threads)
+		return;
+	pt = &perf_thr[thr_id];
+	for (int c = 0; c < PERF_CTR_COUNT; c++)
+		if (pt->fd[c] >= 0)
+			perf_read(pt->fd[c], &pt->last[c]);
+#endif
+}
+
+/* sample the counters after a scanhash of hashes_done */
+void perf_thread_sample(int thr_id, uint64_t hashes_done)
+{
+#ifdef __linux__
+	struct perf_thread *pt;
+
+	if (!opt_perf_counters || thr_id >= perf_n_threads)
+		return;
+	pt = &perf_thr[thr_id];
+
+	pt->interval.hashes = hashes_done;
+	pt->total.hashes += hashes_done;
+	for (int c = 0; c < PERF_CTR_COUNT; c++) {
+		uint64_t now;
+		if (pt->fd[c] < 0 || !perf_read(pt->fd[c], &now))
+			continue;
+		pt->interval.ctr[c] = now - pt->last[c];
+		pt->total.ctr[c] += now - pt->last[c];
+		pt->interval.valid |= 1 << c;
+		pt->total.valid |= 1 << c;
+		pt->last[c] = now;
+	}
+#endif
+}
+
+/* copy of a thread's last interval, or its totals */
+bool perf_get_stats(int thr_id, bool total, struct perf_stats *st)
+{
+	if (!opt_perf_counters || thr_id < 0 || thr_id >= perf_n_threads)
+		return false;
+	*st = total ? perf_thr[thr_id].total : perf_thr[thr_id].interval;
+	return st->valid != 0;
+}
+
+/* sum of all threads */
+bool perf_get_total(struct perf_stats *st)
+{
+	memset(st, 0, sizeof(*st));
+	if (!opt_perf_counters)
+		return false;
+	for (int i = 0; i < perf_n_threads; i++) {
+		struct perf_stats *t = &perf_thr[i].total;
+		st->hashes += t->hashes;
+		st->valid |= t->valid;
+		for (int c = 0; c < PERF_CTR_COUNT; c++)
+			st->ctr[c] += t->ctr[c];
+	}
+	return st->valid != 0;
+}
+
+static double per_hash(const struct perf_stats *st, int c)
+{
+	if (!(st->valid & (1 << c)) || !st->hashes)
+		return -1.;
+	return (double) st->ctr[c] / (double) st->hashes;
+}
+
+double perf_ipc(const struct perf_stats *st)
+{
+	int need = (1 << PERF_CTR_CYCLES) | (1 << PERF_CTR_INSTRUCTIONS);
+	if ((st->valid & need) != need || !st->ctr[PERF_CTR_CYCLES])
+		return -1.;
+	return (double) st->ctr[PERF_CTR_INSTRUCTIONS]
+	     / (double) st->ctr[PERF_CTR_CYCLES];
+}
+
+/* "IPC 2.10, 1840 cycles/H, L1D 12.1/H..." for the log, n/a omitted */
+void perf_format(const struct perf_stats *st, char *out, size_t sz)
+{
+	static const char* const short_names[PERF_CTR_COUNT] =
+		{ "cycles", "instr", "L1D", "LLC", "dTLB", "stall" };
+	double ipc = perf_ipc(st);
+	size_t len = 0;
+
+	*out = '\0';
+	if (ipc >= 0.)
+		len += snprintf(out + len, sz - len, "IPC %.2f", ipc);
+	for (int c = 0; c < PERF_CTR_COUNT && len < sz; c++) {
+		double v = per_hash(st, c);
+		if (c == PERF_CTR_INSTRUCTIONS || v < 0.)
+			continue;
+		len += snprintf(out + len, sz - len, "%s%s %.*f/H",
+			len ? ", " : "", short_names[c], v < 100. ? 2 : 0, v);
+	}
+}
+
+/* api format, unavailable counters are reported as -1 */
+int perf_format_api(const struct perf_stats *st, char *out, size_t sz)
+{
+	return snprintf(out, sz,
+		"IPC=%.3f;CPH=%.1f;L1DPH=%.3f;LLCPH=%.3f;DTLBPH=%.3f;STALLPH=%.1f",
+		perf_ipc(st), per_hash(st, PERF_CTR_CYCLES),
+		per_hash(st, PERF_CTR_L1D_MISS), per_hash(st, PERF_CTR_LLC_MISS),
+		per_hash(st, PERF_CTR_DTLB_MISS), per_hash(st, PERF_CTR_STALLED));
+}
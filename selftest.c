@@ -0,0 +1,1081 @@
+/**
+ * Hash self test, --cputest
+ *
+ * Checks, for each algo or only the one given with -a:
+ *  - the hash of a public block header against its published hash, for
+ *    sha256d and scrypt,
+ *  - the hash of a fixed header against a regression answer,
+ *  - gate.hash against gate.hash_alt on random headers and nonces,
+ *  - the scanhash path (midstates, multi-way and asm kernels) against
+ *    gate.hash on the same headers, by scanning one nonce with a target
+ *    just above and just below the expected hash,
+ *  - the hash library (hashlib.c) against gate.hash on a threaded batch,
+ *  - a scanhash_nway range that ends at the last nonce,
+ * and the sph reference code of blake, groestl, keccak and skein against
+ * the published vectors of their submissions, then the sse2, aes_ni and
+ * vperm primitives, the 4 lane kernels and the 80 byte header precompute
+ * against the sph code on random messages. Runs offline, exits non zero
+ * on any mismatch.
+ *
+ * Algos whose gate.hash is not a plain hash of the header (scrypt, pluck,
+ * yescrypt, drop) or that have none (hodl, m7m) only get the primitive
+ * tests of the kernels they use. scrypt, pluck and yescrypt also get a
+ * regression answer of their scanhash, the first nonce it finds under a
+ * fixed target, and the interleaved lanes of pluck are checked against its
+ * serial hash. Algos whose scanhash only looks at
+ * hashes under a fixed share difficulty (keccak, quark, zr5) skip
+ * the scanhash check.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "miner.h"
+#include "algo-gate-api.h"
+#include "cpuminer-hash.h"
+
+#include "algo/blake/sph_blake.h"
+#include "algo/bmw/sph_bmw.h"
+#include "algo/keccak/sph_keccak.h"
+#include "algo/skein/sph_skein.h"
+#include "algo/groestl/sph_groestl.h"
+#include "algo/echo/sph_echo.h"
+#include "algo/luffa/sph_luffa.h"
+#include "algo/cubehash/sph_cubehash.h"
+#include "algo/simd/sph_simd.h"
+#include "algo/jh/sph_jh.h"
+#include "algo/shavite/sph_shavite.h"
+#include "algo/hamsi/sph_hamsi.h"
+#include "algo/fugue/sph_fugue.h"
+#include "algo/shabal/sph_shabal.h"
+#include "algo/whirlpool/sph_whirlpool.h"
+#include "algo/sha3/sph_sha2.h"
+#include "algo/haval/sph-haval.h"
+#include "algo/gost/sph_gost.h"
+#include "algo/hash64.h"
+#include "algo/luffa/sse2/luffa_for_sse2.h"
+#include "algo/cubehash/sse2/cubehash_sse2.h"
+#include "algo/simd/sse2/nist.h"
+#ifndef NO_AES_NI
+#include "algo/groestl/aes_ni/hash-groestl.h"
+#endif
+#include "algo/echo/aes_ni/hash_api.h"
+#include "algo/aes-vperm.h"
+#include "algo/interleave.h"
+
+#if defined(USE_ASM) && defined(__x86_64__)
+int scrypt_best_throughput();
+void scrypt_core(uint32_t *X, uint32_t *V, int N);
+void scrypt_core_3way(uint32_t *X, uint32_t *V, int N);
+#if defined(USE_AVX2)
+#define HAVE_SCRYPT_6WAY 1
+void scrypt_core_6way(uint32_t *X, uint32_t *V, int N);
+#endif
+#endif
+
+void pluck_hash(uint32_t *hash, const uint32_t *data, uchar *hashbuffer,
+	const int N);
+void pluck_hash_ways(uint32_t hash[][8], uint32_t data[][20], uchar *buf,
+	int k, const int N);
+
+#define ST_ROUNDS      16     /* random headers per algo */
+#define ST_LIB_HEADERS 32     /* headers per hash library batch */
+#define ST_LIB_NONCES  8      /* of them in a row with the same prefix */
+#define ST_MAX_TIME    0.5    /* but no more than this many seconds */
+
+#define ST_NO_HASH     1      /* gate.hash is not hash(header) */
+#define ST_NO_SWAB     2      /* hash input is work data as is */
+#define ST_NO_SCAN     4      /* scanhash prefilters on a fixed share diff */
+#define ST_NTIME       8      /* hash depends on a real ntime */
+
+#define ST_NTIME_VAL   0x58000000   /* Oct 2016 */
+#define ST_SKAT_TARGET 0x00ffffff   /* top word of the scan regression */
+#define ST_SKAT_END    0x10000      /* nonces it scans at most */
+#define ST_SJ_NFACTOR  4            /* scryptjane without algo:nf */
+
+/* algos that differ from an 80 byte big endian header */
+static const struct {
+	int algo;
+	int len;
+	int flags;
+} st_algos[] =
+{
+	{ ALGO_CRYPTOLIGHT, 76,  ST_NO_SWAB },
+	{ ALGO_CRYPTONIGHT, 76,  ST_NO_SWAB },
+	{ ALGO_DECRED,      180, ST_NO_SWAB },
+	{ ALGO_DROP,        80,  ST_NO_HASH },
+	{ ALGO_HEAVY,       80,  ST_NO_SWAB },
+	{ ALGO_KECCAK,      80,  ST_NO_SCAN },
+	{ ALGO_LBRY,        112, 0 },
+	{ ALGO_NEOSCRYPT,   80,  ST_NO_SWAB },
+	{ ALGO_PLUCK,       80,  ST_NO_HASH },
+	{ ALGO_QUARK,       80,  ST_NO_SCAN },
+	{ ALGO_SCRYPT,      80,  ST_NO_HASH },
+	{ ALGO_X11EVO,      80,  ST_NTIME },
+	{ ALGO_YESCRYPT,    80,  ST_NO_HASH },
+	{ ALGO_ZR5,         80,  ST_NO_SCAN },
+};
+
+/*
+ * Public vectors: genesis block headers as serialized and the proof of
+ * work hash of each, most significant byte first as block explorers show
+ * it. The Litecoin one is scrypt at N 1024, the header hashes with sha256d
+ * to the published block hash 12a765e3...
+ */
+static const struct {
+	int algo;
+	const char *header;
+	const char *hash;
+} st_blocks[] =
+{
+	/* Bitcoin block 0 */
+	{ ALGO_SHA256D,
+	  "0100000000000000000000000000000000000000000000000000000000000000"
+	  "000000003ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa"
+	  "4b1e5e4a29ab5f49ffff001d1dac2b7c",
+	  "000000000019d6689c085ae165831e934ff763ae46a2a6c172b3f1b60a8ce26f" },
+	/* Litecoin block 0 */
+	{ ALGO_SCRYPT,
+	  "0100000000000000000000000000000000000000000000000000000000000000"
+	  "00000000d9ced4ed1130f7b7faad9be25323ffafa33232a17c3edf6cfd97bee6"
+	  "bafbdd97b9aa8e4ef0ff0f1ecd513f7c",
+	  "0000050c34a64b415b6b15b37f2216634b5b1669cb9a2e38d76f7213b0671e00" },
+};
+
+/*
+ * Regression answers only, no public vectors: the first 8 bytes in hex of
+ * the hash of the header whose byte i is i, finished by st_header().
+ * Recorded from this tree once hash, hash_alt and scanhash agreed, they
+ * catch a change of the output, not a hash that was wrong from the start.
+ * scryptjane is at N factor ST_SJ_NFACTOR.
+ */
+static const struct {
+	int algo;
+	const char *hash;
+} st_regress[] =
+{
+	{ ALGO_ARGON2,      "f2d06dc1cc9a0bfc" },
+	{ ALGO_AXIOM,       "d7d262b4da4f40f2" },
+	{ ALGO_BASTION,     "626a4d038d5b3f1e" },
+	{ ALGO_BLAKE,       "0e0825862e20f042" },
+	{ ALGO_BLAKECOIN,   "9fec6acc5a18cff7" },
+	{ ALGO_BLAKE2S,     "aff3b75f3f581264" },
+	{ ALGO_C11,         "1d779b963a8ad08b" },
+	{ ALGO_CRYPTOLIGHT, "16d766dd8f17dbd3" },
+	{ ALGO_CRYPTONIGHT, "f6cb9c11f00543ba" },
+	{ ALGO_DECRED,      "084765f66f70fb32" },
+	{ ALGO_DEEP,        "6a4bece1c2fdd83c" },
+	{ ALGO_FRESH,       "72d9c7a5706c1665" },
+	{ ALGO_GROESTL,     "e273974c11312120" },
+	{ ALGO_HEAVY,       "c065c5c7f20551e6" },
+	{ ALGO_HMQ1725,     "8ac907d3b6ad9ede" },
+	{ ALGO_KECCAK,      "f0fe5c66fa31e608" },
+	{ ALGO_LBRY,        "5896632aee5dc847" },
+	{ ALGO_LUFFA,       "5224f8bc8335d5ea" },
+	{ ALGO_LYRA2RE,     "dda1487831430df5" },
+	{ ALGO_LYRA2REV2,   "2246faafca15a01a" },
+	{ ALGO_LYRA2Z,      "6b0ded5afb3b27cf" },
+	{ ALGO_LYRA2Z330,   "bbc07308856eef23" },
+	{ ALGO_MYR_GR,      "f28596c452bcec23" },
+	{ ALGO_NEOSCRYPT,   "7258961afb33fd12" },
+	{ ALGO_NIST5,       "613f61e8346b89ae" },
+	{ ALGO_PENTABLAKE,  "e5e50ee555902ac9" },
+	{ ALGO_QUARK,       "ae69759081f8ffa2" },
+	{ ALGO_QUBIT,       "5f445fc9277a5af9" },
+	{ ALGO_SCRYPTJANE,  "228eae917d32e235" },
+	{ ALGO_SHA256D,     "852c98044fb00507" },
+	{ ALGO_SHA256T,     "aa473d6cefe87076" },
+	{ ALGO_SKEIN,       "4de841423eddf5bd" },
+	{ ALGO_SKEIN2,      "6b0d9d3bf2558dbd" },
+	{ ALGO_S3,          "ff596655d3c67070" },
+	{ ALGO_TIMETRAVEL,  "c9277894f36a33d3" },
+	{ ALGO_VANILLA,     "9fec6acc5a18cff7" },
+	{ ALGO_VELTOR,      "db782cc9523b5453" },
+	{ ALGO_WHIRLPOOL,   "21ef109a07e28676" },
+	{ ALGO_WHIRLPOOLX,  "fefb823ce0336b66" },
+	{ ALGO_X11,         "412e767aa9a39ee2" },
+	{ ALGO_X11EVO,      "dfa32b935b803a45" },
+	{ ALGO_X11GOST,     "efa038c3416e1db6" },
+	{ ALGO_X13,         "44e39c878aa74bad" },
+	{ ALGO_X14,         "e499406b72e51e4f" },
+	{ ALGO_X15,         "3f6a85ad072244e1" },
+	{ ALGO_X17,         "356809810d629727" },
+	{ ALGO_XEVAN,       "ed78c0fd583a6296" },
+	{ ALGO_ZR5,         "ceb75dde033cecf0" },
+};
+
+/*
+ * Regression answers only of the algos without a plain hash: the first
+ * work nonce scanhash finds under ST_SKAT_TARGET, scanning from nonce 0 of
+ * the regression header. scrypt is at the default N, pluck at --pluck-n
+ * 128.
+ */
+static const struct {
+	int algo;
+	uint32_t nonce;
+} st_scan_regress[] =
+{
+	{ ALGO_PLUCK,       0x07020000 },
+	{ ALGO_SCRYPT,      0x00000042 },
+	{ ALGO_YESCRYPT,    0x000000b8 },
+};
+
+static uint64_t st_seed = 0x2545f4914f6cdd1dULL;
+
+static uint32_t st_rand()
+{
+	/* xorshift64*, same sequence on every run */
+	st_seed ^= st_seed >> 12;
+	st_seed ^= st_seed << 25;
+	st_seed ^= st_seed >> 27;
+	return (uint32_t) ((st_seed * 0x2545f4914f6cdd1dULL) >> 32);
+}
+
+static double st_now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void st_fail(const char *name, const char *what, const void *a,
+	const void *b, int len)
+{
+	char *ha = abin2hex((const uchar*) a, len);
+	char *hb = abin2hex((const uchar*) b, len);
+	applog(LOG_ERR, "%s: %s mismatch", name, what);
+	applog(LOG_ERR, "  got    %s", ha);
+	applog(LOG_ERR, "  expect %s", hb);
+	free(ha);
+	free(hb);
+}
+
+/*
+ * Scan work data from its nonce up to end, true if scanhash found a nonce.
+ * The first one found is in the solutions or in the nonce of work.
+ */
+static bool st_scan_to(struct work *work, const uint32_t *data,
+	const uint32_t *target, uint32_t end)
+{
+	uint64_t hashes = 0;
+
+	memset(work, 0, sizeof(*work));
+	memcpy(work->data, data, sizeof(work->data));
+	memcpy(work->target, target, sizeof(work->target));
+	work_restart[0].restart = 0;
+	scan_solutions.count = 0;
+	return algo_gate.scanhash(0, work, end, &hashes) > 0;
+}
+
+/* scan the one nonce of work data, true if scanhash found it */
+static bool st_scan(const uint32_t *data, const uint32_t *target)
+{
+	struct work work;
+	uint32_t nonce = *algo_gate.get_nonceptr((uint32_t*) data);
+
+	return st_scan_to(&work, data, target, nonce + 1)
+		&& scan_found_nonce(&work, nonce);
+}
+
+static void st_input(uint32_t *in, const uint32_t *data, int len, int flags)
+{
+	for (int i = 0; i < len / 4; i++)
+		in[i] = flags & ST_NO_SWAB ? data[i] : swab32(data[i]);
+}
+
+/* finish a header the way stratum work is built */
+static void st_header(uint32_t *data, int len, int flags)
+{
+	/* work data holds ntime byte swapped, as it comes from stratum */
+	if (flags & ST_NTIME)
+		data[17] = swab32(ST_NTIME_VAL);
+	if (len == 80) {
+		data[20] = 0x80000000;
+		data[31] = 0x00000280;
+	}
+}
+
+/* hash a header the way scanhash would and compare with hash_alt */
+static int st_hash(const char *name, const uint32_t *data, int len, int flags,
+	uint32_t *hash)
+{
+	uint32_t _ALIGN(64) in[48];
+	uint32_t _ALIGN(64) alt[16];
+	uint32_t target[8];
+
+	memset(in, 0, sizeof(in));
+	st_input(in, data, len, flags);
+
+	/* prime any midstate kept by the algo for this header */
+	memset(target, 0, sizeof(target));
+	st_scan(data, target);
+
+	memset(hash, 0, 64);
+	algo_gate.hash(hash, in, len);
+
+	if (algo_gate.hash_alt != (void*) &null_hash_alt
+	    && algo_gate.hash_alt != algo_gate.hash) {
+		memset(alt, 0, sizeof(alt));
+		algo_gate.hash_alt(alt, in, len);
+		if (memcmp(hash, alt, 32)) {
+			st_fail(name, "hash_alt", alt, hash, 32);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * scanhash must find the nonce for a target just above the hash and not
+ * for one just below. Only the top word is compared, all algos check it
+ * first and some check nothing else. Several algos don't scan at all
+ * with a target over ST_SCAN_MAX, no pool sends one.
+ */
+#define ST_SCAN_MAX 0x0fffffff
+
+static int st_scanhash(const char *name, const uint32_t *data,
+	const uint32_t *hash)
+{
+	uint32_t target[8];
+	uint32_t nonce = *algo_gate.get_nonceptr((uint32_t*) data);
+	int errors = 0;
+
+	memset(target, 0xff, sizeof(target));
+	target[7] = hash[7] + 1;
+	if (!st_scan(data, target)) {
+		applog(LOG_ERR, "%s: scanhash missed nonce %08x", name, nonce);
+		errors++;
+	}
+	if (hash[7] != 0) {
+		target[7] = hash[7] - 1;
+		if (st_scan(data, target)) {
+			applog(LOG_ERR, "%s: scanhash found nonce %08x above target",
+				name, nonce);
+			errors++;
+		}
+	}
+	return errors;
+}
+
+/*
+ * A scanhash_nway range that ends at the last nonce stops there, with a
+ * tail shorter than the lanes, instead of wrapping to nonce 0.
+ */
+static int st_scan_end(const char *name, const uint32_t *data)
+{
+	struct work work;
+	uint64_t hashes = 0;
+
+	memset(&work, 0, sizeof(work));
+	memcpy(work.data, data, sizeof(work.data));
+	memset(work.target, 0, sizeof(work.target));
+	work.data[19] = 0xfffffffd;
+	work_restart[0].restart = 0;
+	scan_solutions.count = 0;
+	scanhash_nway(0, &work, 0xffffffff, &hashes);
+	if (hashes != 3 || work.data[19] != 0xffffffff) {
+		applog(LOG_ERR, "%s: scan to the last nonce did %llu hashes, "
+			"ended at %08x", name, (unsigned long long) hashes,
+			work.data[19]);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * The hash library against st_hash on a batch run by two threads, then the
+ * verify of each hash as its own target and just under it. The prefix
+ * changes every ST_LIB_NONCES headers, for the lane batches and the primed
+ * midstates. Called with the gate registered, unregisters it.
+ */
+static int st_lib(const char *name, int len, int flags)
+{
+	uint32_t _ALIGN(64) data[48];
+	uint32_t _ALIGN(64) ref[ST_LIB_HEADERS][16];
+	uchar headers[ST_LIB_HEADERS * 180];
+	uint32_t hashes[ST_LIB_HEADERS][8];
+	uint32_t targets[ST_LIB_HEADERS][8];
+	uint8_t pass[ST_LIB_HEADERS];
+	char arg[64];
+	cmh_ctx *ctx;
+	int scrypt_n = opt_scrypt_n, errors = 0;
+
+	memset(data, 0, sizeof(data));
+	for (int i = 0; i < ST_LIB_HEADERS && !errors; i++) {
+		uint32_t *np = algo_gate.get_nonceptr(data);
+		if (i % ST_LIB_NONCES == 0) {
+			for (int w = 0; w < len / 4; w++)
+				data[w] = st_rand();
+			st_header(data, len, flags);
+		}
+		else
+			(*np)++;
+		errors += st_hash(name, data, len, flags, ref[i]);
+		st_input((uint32_t*) (headers + i * len), data, len, flags);
+	}
+	algo_gate.miner_thread_free(0);
+	unregister_algo_gate(&algo_gate);
+	if (errors)
+		return errors;
+
+	if (opt_algo == ALGO_SCRYPTJANE)
+		snprintf(arg, sizeof(arg), "%s:%d", name,
+			scrypt_n ? scrypt_n : ST_SJ_NFACTOR);
+	else
+		snprintf(arg, sizeof(arg), "%s", name);
+	ctx = cmh_init(arg, 2);
+	opt_scrypt_n = scrypt_n;
+	if (!ctx) {
+		applog(LOG_ERR, "%s: hash library init failed", name);
+		return 1;
+	}
+	if (cmh_header_len(ctx) != len) {
+		applog(LOG_ERR, "%s: hash library header is %d bytes, expect %d",
+			name, cmh_header_len(ctx), len);
+		errors++;
+	}
+	else if (cmh_hash_batch(ctx, hashes, headers, ST_LIB_HEADERS))
+		errors++;
+	for (int i = 0; i < ST_LIB_HEADERS && !errors; i++)
+		if (memcmp(hashes[i], ref[i], 32)) {
+			st_fail(name, "hash library", hashes[i], ref[i], 32);
+			errors++;
+		}
+
+	for (int i = 0; i < ST_LIB_HEADERS && !errors; i++) {
+		memcpy(targets[i], ref[i], 32);
+		/* odd headers just under their hash */
+		if (i & 1)
+			for (int w = 0; w < 8 && targets[i][w]-- == 0; w++);
+	}
+	if (!errors
+	    && cmh_verify_batch(ctx, pass, NULL, headers, targets, 32,
+	                        ST_LIB_HEADERS))
+		errors++;
+	for (int i = 0; i < ST_LIB_HEADERS && !errors; i++)
+		if (pass[i] != !(i & 1)) {
+			applog(LOG_ERR, "%s: hash library verify %s header %d", name,
+				pass[i] ? "passed" : "failed", i);
+			errors++;
+		}
+
+	/*
+	 * A header that differs from the one before only past the first 64
+	 * bytes but inside a primed midstate, against a fresh context.
+	 */
+	if (!errors && cmh_can_hash(ctx)) {
+		uchar h[180];
+		uint32_t a[8], b[8];
+
+		memcpy(h, headers, len);
+		h[64 + (len - 64) / 2] ^= 1;
+		cmh_hash(ctx, a, headers);
+		cmh_hash(ctx, a, h);
+		cmh_free(ctx);
+		ctx = cmh_init(arg, 2);
+		opt_scrypt_n = scrypt_n;
+		if (!ctx)
+			return 1;
+		cmh_hash(ctx, b, h);
+		if (memcmp(a, b, 32)) {
+			st_fail(name, "hash library prefix", a, b, 32);
+			errors++;
+		}
+	}
+	cmh_free(ctx);
+	return errors;
+}
+
+/* pluck_hash_ways against pluck_hash, each lane on its own header */
+static int st_pluck_lanes(const char *name)
+{
+	const int N = opt_pluck_n;
+	uint32_t _ALIGN(64) data[IL_MAX_WAYS][20];
+	uint32_t _ALIGN(64) hash[IL_MAX_WAYS][8];
+	uint32_t _ALIGN(64) ref[8];
+	uchar *buf = (uchar*) malloc((size_t) IL_MAX_WAYS * (N * 1024 + 64));
+	int errors = 0;
+
+	if (!buf) {
+		applog(LOG_ERR, "%s: no memory for the lanes", name);
+		return 1;
+	}
+	for (int k = 2; k <= IL_MAX_WAYS && !errors; k *= 2) {
+		for (int l = 0; l < k; l++)
+			for (int i = 0; i < 20; i++)
+				data[l][i] = st_rand();
+		pluck_hash_ways(hash, data, buf, k, N);
+		for (int l = 0; l < k && !errors; l++) {
+			pluck_hash(ref, data[l], buf, N);
+			if (memcmp(hash[l], ref, 32)) {
+				st_fail(name, "interleaved lane", hash[l], ref, 32);
+				errors++;
+			}
+		}
+	}
+	free(buf);
+	return errors;
+}
+
+/*
+ * The public block headers of the algo: gate.hash against the published
+ * hash if the algo has a plain one, and scanhash with the published hash
+ * as the target must find the nonce, and not one below it.
+ */
+static int st_block(const char *name, int algo, int flags)
+{
+	uint32_t _ALIGN(64) data[48];
+	uint32_t _ALIGN(64) hash[16];
+	uint32_t header[20], expect[8], target[8];
+	uchar be[32];
+	int errors = 0;
+
+	for (int b = 0; b < (int) ARRAY_SIZE(st_blocks); b++) {
+		if (st_blocks[b].algo != algo)
+			continue;
+		if (algo == ALGO_SCRYPT && opt_scrypt_n && opt_scrypt_n != 1024)
+			continue;
+		hex2bin((uchar*) header, st_blocks[b].header, 80);
+		hex2bin(be, st_blocks[b].hash, 32);
+		for (int i = 0; i < 32; i++)
+			((uchar*) expect)[i] = be[31 - i];
+
+		memset(data, 0, sizeof(data));
+		st_input(data, header, 80, flags);
+		st_header(data, 80, flags);
+		if (!(flags & ST_NO_HASH)) {
+			errors += st_hash(name, data, 80, flags, hash);
+			if (!errors && memcmp(hash, expect, 32)) {
+				st_fail(name, "public block", hash, expect, 32);
+				errors++;
+			}
+		}
+
+		memcpy(target, expect, sizeof(target));
+		if (!st_scan(data, target)) {
+			applog(LOG_ERR, "%s: scanhash missed the public block", name);
+			errors++;
+		}
+		for (int i = 0; i < 8 && target[i]-- == 0; i++);
+		if (st_scan(data, target)) {
+			applog(LOG_ERR, "%s: scanhash found the public block under "
+				"its hash", name);
+			errors++;
+		}
+	}
+	return errors;
+}
+
+/*
+ * The algos without a plain hash: the scan regression, the lanes of pluck
+ * and the public block of scrypt. Called with the gate registered.
+ */
+static int st_no_hash(const char *name, int algo, int len, int flags)
+{
+	uint32_t _ALIGN(64) data[48];
+	uint32_t _ALIGN(64) kat[48];
+	uint32_t target[8];
+	struct work work;
+	uint32_t nonce;
+	int k, errors = 0;
+
+	for (k = 0; k < (int) ARRAY_SIZE(st_scan_regress); k++)
+		if (st_scan_regress[k].algo == algo)
+			break;
+	if (k == (int) ARRAY_SIZE(st_scan_regress)) {
+		applog(LOG_INFO, "%s: skipped, no plain hash function", name);
+		return 0;
+	}
+	if (!algo_gate.miner_thread_init(0)) {
+		applog(LOG_ERR, "%s: thread init failed", name);
+		return 1;
+	}
+
+	/* the regression header, scanned from nonce 0 */
+	for (int i = 0; i < len; i++)
+		((uchar*) kat)[i] = (uchar) i;
+	memset(data, 0, sizeof(data));
+	st_input(data, kat, len, flags);
+	st_header(data, len, flags);
+	*algo_gate.get_nonceptr(data) = 0;
+	memset(target, 0xff, sizeof(target));
+	target[7] = ST_SKAT_TARGET;
+	if (!st_scan_to(&work, data, target, ST_SKAT_END)) {
+		applog(LOG_ERR, "%s: scanhash found no nonce for the regression "
+			"header", name);
+		errors++;
+	}
+	else {
+		nonce = scan_solutions.count ? scan_solutions.nonce[0]
+			: *algo_gate.get_nonceptr(work.data);
+		if (nonce != st_scan_regress[k].nonce) {
+			applog(LOG_ERR, "%s: scan regression mismatch, got %08x "
+				"expect %08x", name, nonce, st_scan_regress[k].nonce);
+			errors++;
+		}
+	}
+	if (!errors && algo == ALGO_PLUCK)
+		errors += st_pluck_lanes(name);
+	if (!errors)
+		errors += st_block(name, algo, flags);
+	if (!errors)
+		applog(LOG_INFO, "%s: ok, scan regression", name);
+	algo_gate.miner_thread_free(0);
+	return errors;
+}
+
+static int st_algo(int algo)
+{
+	const char *name = algo_names[algo];
+	uint32_t _ALIGN(64) data[48];
+	uint32_t _ALIGN(64) hash[16];
+	uint32_t _ALIGN(64) kat[48];
+	int len = 80, flags = 0, errors = 0, rounds;
+	bool ok, sj_n = false;
+	double t0;
+	char *hex;
+
+	for (int i = 0; i < (int) ARRAY_SIZE(st_algos); i++)
+		if (st_algos[i].algo == algo) {
+			len = st_algos[i].len;
+			flags = st_algos[i].flags;
+		}
+
+	opt_algo = (enum algos) algo;
+	if (algo == ALGO_SCRYPTJANE && !opt_scrypt_n) {
+		opt_scrypt_n = ST_SJ_NFACTOR;
+		sj_n = true;
+	}
+	ok = register_algo_gate(algo, &algo_gate);
+	if (sj_n)
+		opt_scrypt_n = 0;
+	if (!ok) {
+		applog(LOG_INFO, "%s: skipped, not implemented", name);
+		return 0;
+	}
+	if (algo_gate.hash == (void*) &null_hash)
+		flags |= ST_NO_HASH;
+	if (flags & ST_NO_HASH) {
+		errors = st_no_hash(name, algo, len, flags);
+		unregister_algo_gate(&algo_gate);
+		return errors;
+	}
+	if (!algo_gate.miner_thread_init(0)) {
+		applog(LOG_ERR, "%s: thread init failed", name);
+		unregister_algo_gate(&algo_gate);
+		return 1;
+	}
+
+	errors += st_block(name, algo, flags);
+
+	/* regression answer, input bytes are 0, 1, 2... */
+	for (int i = 0; i < len; i++)
+		((uchar*) kat)[i] = (uchar) i;
+	memset(data, 0, sizeof(data));
+	st_input(data, kat, len, flags);
+	st_header(data, len, flags);
+	errors += st_hash(name, data, len, flags, hash);
+	hex = abin2hex((uchar*) hash, 8);
+	for (int i = 0; i < (int) ARRAY_SIZE(st_regress); i++) {
+		if (st_regress[i].algo != algo)
+			continue;
+		if (strcmp(hex, st_regress[i].hash)) {
+			applog(LOG_ERR, "%s: regression mismatch, got %s expect %s",
+				name, hex, st_regress[i].hash);
+			errors++;
+		}
+		free(hex);
+		hex = NULL;
+		break;
+	}
+	if (hex) {
+		applog(LOG_WARNING, "%s: no regression answer, hash is %s", name,
+			hex);
+		free(hex);
+	}
+
+	/* random headers and nonces */
+	t0 = st_now();
+	for (rounds = 0; rounds < ST_ROUNDS && !errors; rounds++) {
+		if (rounds > 1 && st_now() - t0 > ST_MAX_TIME)
+			break;
+		uint32_t *np = algo_gate.get_nonceptr(data);
+
+		memset(data, 0, sizeof(data));
+		for (int i = 0; i < len / 4; i++)
+			data[i] = st_rand();
+		st_header(data, len, flags);
+		/* leave room for the multi-way scans above the nonce */
+		*np &= 0x7fffffff;
+
+		/* next nonce until the hash is under a target scanhash takes */
+		for (int tries = 0; tries < 64 && !errors; tries++, (*np)++) {
+			errors += st_hash(name, data, len, flags, hash);
+			if (hash[7] <= ST_SCAN_MAX)
+				break;
+		}
+		if (!errors && hash[7] <= ST_SCAN_MAX && !(flags & ST_NO_SCAN))
+			errors += st_scanhash(name, data, hash);
+	}
+
+	if (!errors && algo_gate.scanhash == (void*) &scanhash_nway)
+		errors += st_scan_end(name, data);
+
+	if (!errors)
+		applog(LOG_INFO, "%s: ok, %d headers", name, rounds + 1);
+	if (!errors)
+		errors += st_lib(name, len, flags);
+	else {
+		algo_gate.miner_thread_free(0);
+		unregister_algo_gate(&algo_gate);
+	}
+	return errors;
+}
+
+/*
+ * The sph code the kernels are checked against, on the published vectors:
+ * the empty and the one byte 0x00 message of the BLAKE submission, the
+ * empty and the 0xff message of Skein 1.3, and the empty message of
+ * Groestl and of Keccak, as submitted before the SHA-3 padding.
+ */
+
+#define ST_SPH(fn) \
+static void st_sph_##fn(void *out, const void *in, size_t len) \
+{ \
+	sph_##fn##_context ctx; \
+	sph_##fn##_init(&ctx); \
+	sph_##fn(&ctx, in, len); \
+	sph_##fn##_close(&ctx, out); \
+}
+
+ST_SPH(blake256)
+ST_SPH(blake512)
+ST_SPH(groestl512)
+ST_SPH(keccak256)
+ST_SPH(keccak512)
+ST_SPH(skein512)
+
+static const struct {
+	const char *name;
+	void (*hash)(void*, const void*, size_t);
+	int len;
+	uchar msg;
+	const char *digest;
+} st_published[] =
+{
+	{ "blake256", st_sph_blake256, 1, 0x00,
+	  "0ce8d4ef4dd7cd8d62dfded9d4edb0a774ae6a41929a74da23109e8f11139c87" },
+	{ "blake256", st_sph_blake256, 0, 0x00,
+	  "716f6e863f744b9ac22c97ec7b76ea5f5908bc5b2f67c61510bfc4751384ea7a" },
+	{ "blake512", st_sph_blake512, 1, 0x00,
+	  "97961587f6d970faba6d2478045de6d1fabd09b61ae50932054d52bc29d31be4"
+	  "ff9102b9f69e2bbdb83be13d4b9c06091e5fa0b48bd081b634058be0ec49beb3" },
+	{ "blake512", st_sph_blake512, 0, 0x00,
+	  "a8cfbbd73726062df0c6864dda65defe58ef0cc52a5625090fa17601e1eecd1b"
+	  "628e94f396ae402a00acc9eab77b4d4c2e852aaaa25a636d80af3fc7913ef5b8" },
+	{ "groestl512", st_sph_groestl512, 0, 0x00,
+	  "6d3ad29d279110eef3adbd66de2a0345a77baede1557f5d099fce0c03d6dc2ba"
+	  "8e6d4a6633dfbd66053c20faa87d1a11f39a7fbe4a6c2f009801370308fc4ad8" },
+	{ "keccak256", st_sph_keccak256, 0, 0x00,
+	  "c5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470" },
+	{ "keccak512", st_sph_keccak512, 0, 0x00,
+	  "0eab42de4c3ceb9235fc91acffe746b29c29a8c366b7c60e4e67c466f36a4304"
+	  "c00fa9caf9d87976ba469bcbe06713b435f091ef2769fb160cdab33d3670680e" },
+	{ "skein512", st_sph_skein512, 0, 0x00,
+	  "bc5b4c50925519c290cc634277ae3d6257212395cba733bbad37a4af0fa06af4"
+	  "1fca7903d06564fea7a2d3730dbdb80c1f85562dfcc070334ea4d1d9e72cba7a" },
+	{ "skein512", st_sph_skein512, 1, 0xff,
+	  "71b7bce6fe6452227b9ced6014249e5bf9a9754c3ad618ccc4e0aae16b316cc8"
+	  "ca698d864307ed3e80b6ef1570812ac5272dc409b5a012df2a579102f340617a" },
+};
+
+static int st_sph_published()
+{
+	uchar out[64];
+	int errors = 0;
+
+	for (int i = 0; i < (int) ARRAY_SIZE(st_published); i++) {
+		int len = (int) strlen(st_published[i].digest) / 2;
+		char *hex;
+
+		st_published[i].hash(out, &st_published[i].msg,
+			st_published[i].len);
+		hex = abin2hex(out, len);
+		if (strcmp(hex, st_published[i].digest)) {
+			applog(LOG_ERR, "%s: published vector mismatch, %d byte "
+				"message", st_published[i].name, st_published[i].len);
+			applog(LOG_ERR, "  got    %s", hex);
+			applog(LOG_ERR, "  expect %s", st_published[i].digest);
+			errors++;
+		}
+		free(hex);
+	}
+	if (!errors)
+		applog(LOG_INFO, "sph published vectors: ok");
+	return errors;
+}
+
+/* sse2 and aes_ni primitives against sph on random messages */
+
+static int st_compare(const char *name, int len, const void *a, const void *b)
+{
+	if (!memcmp(a, b, 64))
+		return 0;
+	char what[32];
+	snprintf(what, sizeof(what), "%d byte", len);
+	st_fail(name, what, a, b, 64);
+	return 1;
+}
+
+static int st_primitives()
+{
+	static const int lens[] = { 32, 64, 80, 128 };
+	uchar _ALIGN(64) msg[128];
+	uchar _ALIGN(64) ref[64], out[64];
+	int errors = 0;
+
+	for (int r = 0; r < ST_ROUNDS; r++)
+	for (int l = 0; l < (int) ARRAY_SIZE(lens); l++) {
+		int len = lens[l];
+
+		for (int i = 0; i < len / 4; i++)
+			((uint32_t*) msg)[i] = st_rand();
+
+		{
+			sph_luffa512_context sc;
+			hashState_luffa st;
+			sph_luffa512_init(&sc);
+			sph_luffa512(&sc, msg, len);
+			sph_luffa512_close(&sc, ref);
+			init_luffa(&st, 512);
+			update_and_final_luffa(&st, (BitSequence*) out,
+				(const BitSequence*) msg, len);
+			errors += st_compare("luffa sse2", len, out, ref);
+		}
+		{
+			sph_cubehash512_context sc;
+			cubehashParam st;
+			sph_cubehash512_init(&sc);
+			sph_cubehash512(&sc, msg, len);
+			sph_cubehash512_close(&sc, ref);
+			cubehashInit(&st, 512, 16, 32);
+			cubehashUpdateDigest(&st, (byte*) out, (const byte*) msg, len);
+			errors += st_compare("cubehash sse2", len, out, ref);
+		}
+		{
+			sph_simd512_context sc;
+			hashState_sd st;
+			sph_simd512_init(&sc);
+			sph_simd512(&sc, msg, len);
+			sph_simd512_close(&sc, ref);
+			init_sd(&st, 512);
+			update_final_sd(&st, (BitSequence*) out,
+				(const BitSequence*) msg, len * 8);
+			errors += st_compare("simd sse2", len, out, ref);
+		}
+#ifndef NO_AES_NI
+		{
+			sph_groestl512_context sc;
+			hashState_groestl st;
+			sph_groestl512_init(&sc);
+			sph_groestl512(&sc, msg, len);
+			sph_groestl512_close(&sc, ref);
+			init_groestl(&st, 64);
+			update_and_final_groestl(&st, (char*) out, (const char*) msg,
+				len * 8);
+			errors += st_compare("groestl aes_ni", len, out, ref);
+		}
+#endif
+		{
+			sph_echo512_context sc;
+			hashState_echo st;
+			sph_echo512_init(&sc);
+			sph_echo512(&sc, msg, len);
+			sph_echo512_close(&sc, ref);
+			init_echo(&st, 512);
+			update_final_echo(&st, (BitSequence*) out,
+				(const BitSequence*) msg, len * 8);
+			errors += st_compare(HASH_IMPL_STR, len, out, ref);
+		}
+		if (errors)
+			return errors;
+	}
+
+#if defined(__AES__) && defined(__SSSE3__)
+	/* vperm AES rounds against AES-NI */
+	for (int r = 0; r < ST_ROUNDS * 16; r++) {
+		__m128i x = _mm_set_epi32(st_rand(), st_rand(), st_rand(), st_rand());
+		__m128i k = _mm_set_epi32(st_rand(), st_rand(), st_rand(), st_rand());
+		__m128i _ALIGN(16) a[4], b[4];
+
+		a[0] = _mm_aesenc_si128(x, k);
+		a[1] = _mm_aesenclast_si128(x, k);
+		a[2] = _mm_aeskeygenassist_si128(x, 0x1b);
+		a[3] = _mm_aesenc_si128(a[0], k);
+		b[0] = vperm_aesenc(x, k);
+		b[1] = vperm_aesenclast(x, k);
+		b[2] = vperm_aeskeygenassist(x, 0x1b);
+		/* two rounds without leaving the basis */
+		b[3] = vperm_basis_out(vperm_aesenc_basis(vperm_aesenc_basis(
+			vperm_basis_in(x), vperm_basis_in(k)), vperm_basis_in(k)));
+		if (memcmp(a, b, sizeof(a))) {
+			st_fail("aes vperm", "round", b, a, sizeof(a));
+			return errors + 1;
+		}
+	}
+#endif
+
+	/* 80 byte header precompute, a few nonces per header */
+	for (int r = 0; r < ST_ROUNDS; r++) {
+		for (int i = 0; i < 20; i++)
+			((uint32_t*) msg)[i] = st_rand();
+		for (int n = 0; n < 4; n++) {
+			((uint32_t*) msg)[19] = st_rand();
+#define ST_HEADER80(name) do { \
+			sph_ ## name ## _context sc; \
+			sph_ ## name ## _init(&sc); \
+			sph_ ## name(&sc, msg, 80); \
+			sph_ ## name ## _close(&sc, ref); \
+			sph_ ## name ## _80(out, msg); \
+			errors += st_compare(#name "_80", 80, out, ref); \
+		} while (0)
+			ST_HEADER80(blake512);
+			ST_HEADER80(bmw512);
+			ST_HEADER80(keccak512);
+			ST_HEADER80(skein512);
+#undef ST_HEADER80
+		}
+		if (errors)
+			return errors;
+	}
+
+	/* 64 byte one shot chain stages, hashed in place as the chains do */
+	for (int r = 0; r < ST_ROUNDS; r++) {
+		for (int i = 0; i < 16; i++)
+			((uint32_t*) msg)[i] = st_rand();
+#define ST_HASH64(name, len) do { \
+			sph_ ## name ## _context sc; \
+			memset(ref, 0, 64); \
+			sph_ ## name ## _init(&sc); \
+			sph_ ## name(&sc, msg, 64); \
+			sph_ ## name ## _close(&sc, ref); \
+			memcpy(out, msg, 64); \
+			name ## _hash64(out, out); \
+			memset(out + len, 0, 64 - len); \
+			errors += st_compare(#name "_hash64", 64, out, ref); \
+		} while (0)
+		ST_HASH64(blake512, 64);
+		ST_HASH64(bmw512, 64);
+		ST_HASH64(groestl512, 64);
+		ST_HASH64(skein512, 64);
+		ST_HASH64(jh512, 64);
+		ST_HASH64(keccak512, 64);
+		ST_HASH64(luffa512, 64);
+		ST_HASH64(cubehash512, 64);
+		ST_HASH64(shavite512, 64);
+		ST_HASH64(simd512, 64);
+		ST_HASH64(echo512, 64);
+		ST_HASH64(hamsi512, 64);
+		ST_HASH64(fugue512, 64);
+		ST_HASH64(shabal512, 64);
+		ST_HASH64(whirlpool, 64);
+		ST_HASH64(sha512, 64);
+		ST_HASH64(haval256_5, 32);
+		ST_HASH64(gost512, 64);
+#undef ST_HASH64
+		if (errors)
+			return errors;
+	}
+
+#ifdef HAVE_HASH64_4WAY
+	/* 4 lane one shot stages against each lane on its own */
+	for (int r = 0; r < ST_ROUNDS; r++) {
+		uchar _ALIGN(64) m4[256], o4[256], r4[256];
+
+		for (int i = 0; i < 64; i++)
+			((uint32_t*) m4)[i] = st_rand();
+#define ST_HASH64_4WAY(name) do { \
+			for (int l = 0; l < 4; l++) \
+				name ## _hash64(r4 + 64 * l, m4 + 64 * l); \
+			memcpy(o4, m4, 256); \
+			name ## _4way_hash64(o4, o4); \
+			for (int l = 0; l < 4; l++) \
+				errors += st_compare(#name "_4way_hash64", 64, \
+					o4 + 64 * l, r4 + 64 * l); \
+		} while (0)
+		ST_HASH64_4WAY(keccak512);
+		ST_HASH64_4WAY(skein512);
+#undef ST_HASH64_4WAY
+		if (errors)
+			return errors;
+	}
+#endif
+
+#if defined(USE_ASM) && defined(__x86_64__)
+	/* multi-way scrypt cores against the single one, N = 1024 */
+	{
+		const int N = 1024, ways = scrypt_best_throughput() >= 24 ? 6 : 3;
+		uint32_t _ALIGN(64) X[6 * 32], Y[6 * 32];
+		uint32_t *V = (uint32_t*) _mm_malloc(6 * 128 * N, 64);
+
+		if (!V)
+			return errors + 1;
+		for (int i = 0; i < 6 * 32; i++)
+			X[i] = Y[i] = st_rand();
+		for (int l = 0; l < 6; l++)
+			scrypt_core(X + 32 * l, V, N);
+		scrypt_core_3way(Y, V, N);
+		scrypt_core_3way(Y + 96, V, N);
+		errors += st_compare("scrypt_core_3way", 128, Y, X);
+#ifdef HAVE_SCRYPT_6WAY
+		if (ways == 6) {
+			for (int i = 0; i < 6 * 32; i++)
+				X[i] = Y[i] = st_rand();
+			for (int l = 0; l < 6; l++)
+				scrypt_core(X + 32 * l, V, N);
+			scrypt_core_6way(Y, V, N);
+			errors += st_compare("scrypt_core_6way", 128, Y, X);
+		}
+#endif
+		(void) ways;
+		_mm_free(V);
+	}
+#endif
+
+	if (!errors)
+		applog(LOG_INFO, "sse2/aes_ni primitives: ok");
+	return errors;
+}
+
+/* ALGO_NULL tests every algo, returns the number of failures */
+int cpu_selftest(int algo)
+{
+	int failed = 0;
+
+	if (!work_restart)
+		work_restart = (struct work_restart*) calloc(1, sizeof(*work_restart));
+	if (!work_restart)
+		return 1;
+	/* everything runs on thread 0 */
+	if (!opt_n_threads)
+		opt_n_threads = 1;
+
+	applog(LOG_INFO, "Testing %s", algo == ALGO_NULL ? "all algos"
+		: algo_names[algo]);
+	failed += st_sph_published() ? 1 : 0;
+	failed += st_primitives() ? 1 : 0;
+
+	for (int a = ALGO_NULL + 1; a < ALGO_COUNT; a++) {
+		if (algo != ALGO_NULL && a != algo)
+			continue;
+		failed += st_algo(a) ? 1 : 0;
+	}
+
+	if (failed)
+		applog(LOG_ERR, "Self test: %d failed", failed);
+	else
+		applog(LOG_NOTICE, "Self test: all passed");
+	return failed;
+}
@@ -0,0 +1,301 @@
+/**
+ * Split mining
+ *
+ * --split="-a x11 -o URL -u USER -p PASS" mines a second algo on part of
+ * the cpus. A memory hard algo like cryptonight fills the L3 and the
+ * memory bandwidth with one thread per core and gains nothing from the
+ * SMT siblings, a compute bound algo like x11 or sha256d leaves the
+ * memory idle, so the host earns more running both: the algo of the
+ * command line on the first logical cpu of each core and the --split
+ * algo on the siblings. Without SMT the cores are halved, --split-cpus
+ * gives the second group explicitly.
+ *
+ * The gate, the pool connection and the current work are process wide,
+ * so the second group is a child process of the miner with its own
+ * options, started on its cpus and killed with the parent. Each side
+ * pins one thread per cpu of its own mask, they never share a cpu.
+ * Log lines are tagged with the algo of each group. The child writes its
+ * hashrate and shares to a pipe every SPLIT_REPORT seconds, the API
+ * summary of the parent adds them as a record of the split group.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#ifdef __linux
+#include <sys/prctl.h>
+#endif
+
+#include "miner.h"
+
+extern char *opt_api_allow;
+extern int opt_api_listen; /* port */
+extern uint32_t accepted_count;
+extern uint32_t rejected_count;
+
+#define SPLIT_ENV       "CPUMINER_SPLIT_CHILD"
+#define SPLIT_MAX_ARGS  64
+#define SPLIT_REPORT    5      /* s between the stats of the child */
+
+char   *opt_split = NULL;
+int64_t opt_split_cpus = -1L;
+const char *log_tag = NULL;
+
+static unsigned long split_mask = 0;   /* cpus of the --split group */
+static bool split_child = false;
+
+/* the child writes its stats to it, the parent reads them */
+static int split_fd = -1;
+static pthread_mutex_t split_lock = PTHREAD_MUTEX_INITIALIZER;
+static char split_stats[256];          /* last line of the child */
+
+static unsigned long all_cpus()
+{
+	if (opt_affinity != -1L)
+		return (unsigned long) opt_affinity;
+	if (num_cpus >= (int) (8 * sizeof(unsigned long)))
+		return ~0UL;
+	return (1UL << num_cpus) - 1;
+}
+
+/*
+ * SMT siblings: every cpu of the mask but the first of its core, or the
+ * upper half of the mask when each core has one cpu.
+ */
+static unsigned long split_siblings(unsigned long all)
+{
+	unsigned long mask = 0;
+	int c, k, n = 0;
+
+	for (c = 0; c < num_cpus && c < (int) (8 * sizeof(long)); c++) {
+		if (!(all & (1UL << c)))
+			continue;
+		n++;
+		for (k = 0; k < c; k++)
+			if ((all & (1UL << k)) && cpu_package(k) == cpu_package(c)
+			    && cpu_core(k) == cpu_core(c))
+				break;
+		if (k < c)
+			mask |= 1UL << c;
+	}
+	if (mask)
+		return mask;
+
+	for (c = 0, k = 0; c < (int) (8 * sizeof(long)); c++) {
+		if (!(all & (1UL << c)))
+			continue;
+		if (k++ >= n / 2)
+			mask |= 1UL << c;
+	}
+	return mask;
+}
+
+/* split on white space, single or double quotes group */
+static int split_args(char *s, char **argv, int max)
+{
+	int n = 0;
+
+	while (*s && n < max) {
+		char q = 0, *d;
+
+		while (*s == ' ' || *s == '\t')
+			s++;
+		if (!*s)
+			break;
+		argv[n++] = d = s;
+		while (*s && (q || (*s != ' ' && *s != '\t'))) {
+			if (*s == '"' || *s == '\'') {
+				if (!q)
+					q = *s++;
+				else if (q == *s) {
+					q = 0;
+					s++;
+				}
+				else
+					*d++ = *s++;
+			}
+			else
+				*d++ = *s++;
+		}
+		if (*s)
+			s++;
+		*d = '\0';
+	}
+	return n;
+}
+
+/*
+ * Takes the cpus of the second group off this process, before the thread
+ * count defaults to the number of cpus.
+ */
+bool split_init()
+{
+	unsigned long all;
+
+	if (getenv(SPLIT_ENV)) {
+		/* the --split group of a parent miner */
+		split_child = true;
+		split_fd = atoi(getenv(SPLIT_ENV));
+		log_tag = algo_names[opt_algo];
+		return true;
+	}
+	if (!opt_split)
+		return true;
+#ifndef __linux
+	applog(LOG_ERR, "--split is only supported on Linux");
+	return false;
+#else
+	all = all_cpus();
+	if (opt_split_cpus != -1L)
+		split_mask = all & (unsigned long) opt_split_cpus;
+	else
+		split_mask = split_siblings(all);
+	if (!split_mask || !(all & ~split_mask)) {
+		applog(LOG_ERR, "--split: no cpus left for one of the algos");
+		return false;
+	}
+	opt_affinity = all & ~split_mask;
+	if (!opt_n_threads)
+		opt_n_threads = __builtin_popcountl(opt_affinity);
+	log_tag = algo_names[opt_algo];
+	return true;
+#endif
+}
+
+/* true if each miner thread is bound to one cpu of its group */
+bool split_pinned()
+{
+	return split_mask || split_child;
+}
+
+/* child, the stats line of its group */
+static void *split_report(void *arg)
+{
+	char line[256];
+	int len;
+
+	signal(SIGPIPE, SIG_IGN);
+	for (;;) {
+		len = snprintf(line, sizeof(line),
+			"ALGO=%s;CPUS=%d;KHS=%.2f;ACC=%u;REJ=%u\n",
+			algo_names[opt_algo], opt_n_threads,
+			global_hashrate / 1000., accepted_count, rejected_count);
+		if (write(split_fd, line, len) != len)
+			break;
+		sleep(SPLIT_REPORT);
+	}
+	return NULL;
+}
+
+/* parent, keeps the last stats line until the child exits */
+static void *split_collect(void *arg)
+{
+	FILE *in = fdopen(split_fd, "r");
+	char line[256];
+
+	while (in && fgets(line, sizeof(line), in)) {
+		line[strcspn(line, "|\n")] = '\0';
+		pthread_mutex_lock(&split_lock);
+		snprintf(split_stats, sizeof(split_stats), "%s", line);
+		pthread_mutex_unlock(&split_lock);
+	}
+	pthread_mutex_lock(&split_lock);
+	*split_stats = '\0';
+	pthread_mutex_unlock(&split_lock);
+	applog(LOG_WARNING, "Split: the second group exited");
+	if (in)
+		fclose(in);
+	return NULL;
+}
+
+/* api summary record of the split group, empty without one */
+int split_format_api(char *buf, size_t sz)
+{
+	int len = 0;
+
+	*buf = '\0';
+	pthread_mutex_lock(&split_lock);
+	if (*split_stats)
+		len = snprintf(buf, sz, "GROUP=split;%s|", split_stats);
+	pthread_mutex_unlock(&split_lock);
+	return len;
+}
+
+/*
+ * Starts the second group, after the fork of --background so it stays the
+ * child of the miner process.
+ */
+bool split_start()
+{
+#ifdef __linux
+	char *argv[SPLIT_MAX_ARGS + 8];
+	char threads[16], mask[32], api[64], fd[16];
+	char *args;
+	pid_t parent = getpid(), pid;
+	pthread_t thr;
+	int n = 0, fds[2];
+
+	if (split_child && split_fd >= 0)
+		return !pthread_create(&thr, NULL, split_report, NULL);
+	if (!split_mask)
+		return true;
+
+	args = strdup(opt_split);
+	if (!args)
+		return false;
+	sprintf(threads, "%d", __builtin_popcountl(split_mask));
+	sprintf(mask, "0x%lx", split_mask);
+	argv[n++] = "cpuminer";
+	argv[n++] = "-t";
+	argv[n++] = threads;
+	argv[n++] = "--cpu-affinity";
+	argv[n++] = mask;
+	if (opt_api_listen) {
+		/* next port, the --split options can still override it */
+		snprintf(api, sizeof(api), "%s:%d", opt_api_allow,
+			opt_api_listen + 1);
+		argv[n++] = "-b";
+		argv[n++] = api;
+	}
+	n += split_args(args, argv + n, SPLIT_MAX_ARGS);
+	argv[n] = NULL;
+
+	if (pipe(fds)) {
+		applog(LOG_ERR, "--split: pipe failed");
+		free(args);
+		return false;
+	}
+	fflush(stdout);
+	pid = fork();
+	if (pid < 0) {
+		applog(LOG_ERR, "--split: fork failed");
+		free(args);
+		close(fds[0]);
+		close(fds[1]);
+		return false;
+	}
+	if (pid == 0) {
+		prctl(PR_SET_PDEATHSIG, SIGTERM);
+		if (getppid() != parent)
+			_exit(0);
+		close(fds[0]);
+		sprintf(fd, "%d", fds[1]);
+		setenv(SPLIT_ENV, fd, 1);
+		execv("/proc/self/exe", argv);
+		applog(LOG_ERR, "--split: exec failed");
+		_exit(1);
+	}
+	free(args);
+	close(fds[1]);
+	split_fd = fds[0];
+	if (pthread_create(&thr, NULL, split_collect, NULL))
+		applog(LOG_WARNING, "Split: no stats of the second group");
+	applog(LOG_BLUE, "Split: %s on cpus 0x%lx, second group on 0x%lx (pid %d)",
+		algo_names[opt_algo], (unsigned long) opt_affinity, split_mask,
+		(int) pid);
+#endif
+	return true;
+}
@@ -0,0 +1,123 @@
+#include "cpuminer-config.h"
+
+#ifdef STAGE_PROFILE
+
+#include <string.h>
+#include <pthread.h>
+#include "miner.h"
+#include "stage-profile.h"
+
+#define PROF_MAX_THREADS 1024
+
+__thread struct prof_table prof_thr;
+
+static struct prof_table *prof_tables[PROF_MAX_THREADS];
+static int prof_ntables = 0;
+static pthread_mutex_t prof_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// counts of the threads that have exited, bench sweep and hash library
+// threads come and go
+static struct prof_table prof_exited;
+
+static pthread_key_t prof_key;
+static pthread_once_t prof_key_once = PTHREAD_ONCE_INIT;
+
+static void prof_thread_exit( void *pt )
+{
+   prof_unregister();
+}
+
+static void prof_key_init()
+{
+   pthread_key_create( &prof_key, prof_thread_exit );
+}
+
+static void prof_add( struct prof_table *sum, const struct prof_table *pt )
+{
+   sum->hashes += pt->hashes;
+   if ( pt->nstages > sum->nstages )
+      sum->nstages = pt->nstages;
+   for ( int i = 0; i < pt->nstages; i++ )
+   {
+      sum->cycles[i] += pt->cycles[i];
+      if ( pt->names[i] )
+         sum->names[i] = pt->names[i];
+   }
+}
+
+void prof_register()
+{
+   pthread_once( &prof_key_once, prof_key_init );
+   pthread_mutex_lock( &prof_lock );
+   if ( prof_ntables < PROF_MAX_THREADS )
+      prof_tables[ prof_ntables++ ] = &prof_thr;
+   prof_thr.registered = true;
+   pthread_mutex_unlock( &prof_lock );
+   // non NULL for the destructor to run at thread exit
+   pthread_setspecific( prof_key, &prof_thr );
+}
+
+// Called at thread exit, the table of the thread goes away with it. Its
+// counts are kept in prof_exited.
+void prof_unregister()
+{
+   if ( !prof_thr.registered )
+      return;
+   pthread_mutex_lock( &prof_lock );
+   prof_add( &prof_exited, &prof_thr );
+   for ( int t = 0; t < prof_ntables; t++ )
+      if ( prof_tables[t] == &prof_thr )
+      {
+         prof_tables[t] = prof_tables[ --prof_ntables ];
+         break;
+      }
+   prof_thr.registered = false;
+   pthread_mutex_unlock( &prof_lock );
+}
+
+// Sums are read while the threads keep counting, good enough for a report.
+void prof_report()
+{
+   struct prof_table sum;
+   uint64_t hashes, total = 0;
+   int nstages;
+
+   pthread_mutex_lock( &prof_lock );
+   sum = prof_exited;
+   for ( int t = 0; t < prof_ntables; t++ )
+      prof_add( &sum, prof_tables[t] );
+   pthread_mutex_unlock( &prof_lock );
+
+   hashes = sum.hashes;
+   nstages = sum.nstages;
+   if ( !hashes )
+      return;
+   for ( int i = 0; i < nstages; i++ )
+      total += sum.cycles[i];
+
+   applog( LOG_NOTICE, "Stage profile %s, %.0f cycles per hash:",
+           algo_names[opt_algo], (double)total / hashes );
+   for ( int i = 0; i < nstages; i++ )
+      if ( sum.names[i] )
+         applog( LOG_NOTICE, "  %-10s %8.0f cycles %5.1f%%", sum.names[i],
+                 (double)sum.cycles[i] / hashes,
+                 total ? 100. * sum.cycles[i] / total : 0. );
+}
+
+// Not synchronised with the counting threads, a few samples may be lost.
+void prof_reset()
+{
+   pthread_mutex_lock( &prof_lock );
+   memset( &prof_exited, 0, sizeof prof_exited );
+   for ( int t = 0; t < prof_ntables; t++ )
+   {
+      struct prof_table *pt = prof_tables[t];
+      memset( pt->cycles, 0, sizeof pt->cycles );
+      memset( pt->names, 0, sizeof pt->names );
+      pt->hashes = 0;
+      pt->nstages = 0;
+   }
+   pthread_mutex_unlock( &prof_lock );
+}
+
+#endif
@@ -0,0 +1,93 @@
+// Per stage cycle profiler for chained hash functions.
+//
+// Build with ./configure --enable-stage-profile to enable. Otherwise every
+// macro expands to nothing and the hash functions are unchanged.
+//
+// Usage in a hash function, stage indexes are fixed per function so
+// algos that permute their chain still account each primitive to the
+// same stage:
+//
+//   PROF_BEGIN;
+//   sph_blake512_80( hash, input );
+//   PROF_STAGE( 1, "blake" );
+//   bmw512_hash64( hash, hash );
+//   PROF_STAGE( 2, "bmw" );
+//   ...
+//   PROF_END;
+//
+// Each thread accumulates its own counters, prof_report() sums all threads
+// and logs cycles per hash and share of total for each stage. A thread's
+// counters are folded into a total of the exited threads when it exits.
+
+#ifndef STAGE_PROFILE_H__
+#define STAGE_PROFILE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#ifdef STAGE_PROFILE
+
+#define PROF_MAX_STAGES 24
+
+struct prof_table
+{
+   uint64_t    cycles[PROF_MAX_STAGES];
+   const char *names[PROF_MAX_STAGES];
+   uint64_t    hashes;
+   int         nstages;
+   bool        registered;
+};
+
+extern __thread struct prof_table prof_thr;
+
+void prof_register();
+void prof_unregister();
+void prof_report();
+void prof_reset();
+
+static inline uint64_t prof_ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+   uint32_t lo, hi;
+   __asm__ __volatile__ ( "rdtsc" : "=a"(lo), "=d"(hi) );
+   return ( (uint64_t)hi << 32 ) | lo;
+#else
+   struct timespec ts;
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+#define PROF_BEGIN \
+   uint64_t prof_t0, prof_t1; \
+   if ( !prof_thr.registered ) prof_register(); \
+   prof_t0 = prof_ticks()
+
+#define PROF_STAGE( i, name ) \
+do { \
+   prof_t1 = prof_ticks(); \
+   prof_thr.cycles[i] += prof_t1 - prof_t0; \
+   prof_thr.names[i] = name; \
+   if ( (i) >= prof_thr.nstages ) prof_thr.nstages = (i) + 1; \
+   prof_t0 = prof_t1; \
+} while(0)
+
+#define PROF_END  prof_thr.hashes++
+
+// end of a batch of n hashes profiled together
+#define PROF_END_N( n )  prof_thr.hashes += (n)
+
+#else
+
+#define PROF_BEGIN            do {} while(0)
+#define PROF_STAGE( i, name ) do {} while(0)
+#define PROF_END              do {} while(0)
+#define PROF_END_N( n )       do {} while(0)
+
+#define prof_report()         do {} while(0)
+#define prof_reset()          do {} while(0)
+
+#endif  // STAGE_PROFILE
+
+#endif  // STAGE_PROFILE_H__
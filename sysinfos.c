@@ -8,6 +8,9 @@
 #include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/time.h>
 
 #include "miner.h"
 
@@ -20,43 +23,215 @@
 #define HWMON_ALT2 \
  "/sys/class/hwmon/hwmon0/temp1_input"
 
+#define HWMON_MAX   32  /* hwmon devices scanned */
+#define HWMON_TEMPS 64  /* temp inputs scanned per device */
+#define HWMON_CPUS  256 /* cpus with a cached sensor path */
+
+static int linux_topology(int core, const char *item)
+{
+	char path[128];
+	int val = -1;
+	FILE *fd;
+
+	snprintf(path, sizeof(path),
+		"/sys/devices/system/cpu/cpu%d/topology/%s", core, item);
+	fd = fopen(path, "r");
+	if (!fd)
+		return -1;
+	if (fscanf(fd, "%d", &val) != 1)
+		val = -1;
+	fclose(fd);
+	return val;
+}
+
+static bool read_line(const char *path, char *buf, int sz)
+{
+	FILE *fd = fopen(path, "r");
+	bool ret;
+
+	if (!fd)
+		return false;
+	ret = fgets(buf, sz, fd) != NULL;
+	fclose(fd);
+	if (ret)
+		buf[strcspn(buf, "\n")] = '\0';
+	return ret;
+}
+
+/*
+ * coretemp has one hwmon per package, labelled "Package id P" and
+ * "Core C", take the core sensor, else the package, else the first
+ * cpu sensor (k10temp has no per core values), else the old paths.
+ */
+static void hwmon_resolve(int core, char *out, size_t sz)
+{
+	int pkg = linux_topology(core, "physical_package_id");
+	int cid = linux_topology(core, "core_id");
+	char path[128], buf[64];
+	char pkg_input[128] = { 0 }, any_input[128] = { 0 };
+
+	for (int h = 0; h < HWMON_MAX; h++) {
+		char core_input[128] = { 0 };
+		bool this_pkg = false;
+
+		snprintf(path, sizeof(path), "/sys/class/hwmon/hwmon%d/name", h);
+		if (!read_line(path, buf, sizeof(buf)))
+			continue;
+		if (strcmp(buf, "coretemp") && strcmp(buf, "k10temp")
+		    && strcmp(buf, "zenpower"))
+			continue;
+		if (!any_input[0])
+			snprintf(any_input, sizeof(any_input),
+				"/sys/class/hwmon/hwmon%d/temp1_input", h);
+
+		for (int t = 1; t <= HWMON_TEMPS; t++) {
+			int id;
+			snprintf(path, sizeof(path),
+				"/sys/class/hwmon/hwmon%d/temp%d_label", h, t);
+			if (!read_line(path, buf, sizeof(buf)))
+				continue;
+			snprintf(path, sizeof(path),
+				"/sys/class/hwmon/hwmon%d/temp%d_input", h, t);
+			if (sscanf(buf, "Package id %d", &id) == 1 && id == pkg) {
+				this_pkg = true;
+				snprintf(pkg_input, sizeof(pkg_input), "%s", path);
+			}
+			else if (sscanf(buf, "Core %d", &id) == 1 && id == cid)
+				snprintf(core_input, sizeof(core_input), "%s", path);
+		}
+		if (this_pkg && core_input[0]) {
+			snprintf(out, sz, "%s", core_input);
+			return;
+		}
+	}
+
+	if (pkg_input[0])
+		snprintf(out, sz, "%s", pkg_input);
+	else if (any_input[0])
+		snprintf(out, sz, "%s", any_input);
+	else {
+		static const char* const legacy[] = { HWMON_PATH, HWMON_ALT, HWMON_ALT2 };
+		*out = '\0';
+		for (int i = 0; i < 3; i++)
+			if (access(legacy[i], R_OK) == 0) {
+				snprintf(out, sz, "%s", legacy[i]);
+				break;
+			}
+	}
+}
+
 static float linux_cputemp(int core)
 {
+	static char *paths[HWMON_CPUS];
+	static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
 	float tc = 0.0;
-	FILE *fd = fopen(HWMON_PATH, "r");
 	uint32_t val = 0;
+	const char *path;
+	FILE *fd;
 
-	if (!fd)
-		fd = fopen(HWMON_ALT, "r");
+	if (core < 0 || core >= HWMON_CPUS)
+		core = 0;
 
-	if (!fd)
-		fd = fopen(HWMON_ALT2, "r");
+	pthread_mutex_lock(&lock);
+	if (!paths[core]) {
+		char buf[128];
+		hwmon_resolve(core, buf, sizeof(buf));
+		paths[core] = strdup(buf);
+	}
+	path = paths[core];
+	pthread_mutex_unlock(&lock);
+
+	if (!path || !*path)
+		return tc;
 
+	fd = fopen(path, "r");
 	if (!fd)
 		return tc;
 
-	if (fscanf(fd, "%d", &val))
+	if (fscanf(fd, "%u", &val) == 1)
 		tc = val / 1000.0;
 	fclose(fd);
 	return tc;
 }
 
 #define CPUFREQ_PATH \
- "/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_cur_freq"
+ "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_cur_freq"
+#define CPUFREQ_ALT \
+ "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq"
+
 static uint32_t linux_cpufreq(int core)
 {
-	FILE *fd = fopen(CPUFREQ_PATH, "r");
+	char path[128];
 	uint32_t freq = 0;
-
+	FILE *fd;
+
+	snprintf(path, sizeof(path), CPUFREQ_PATH, core);
+	fd = fopen(path, "r");
+	if (!fd) {
+		/* cpuinfo_cur_freq is often root only */
+		snprintf(path, sizeof(path), CPUFREQ_ALT, core);
+		fd = fopen(path, "r");
+	}
 	if (!fd)
 		return freq;
 
-	if (!fscanf(fd, "%d", &freq))
-		return freq;
-
+	if (fscanf(fd, "%u", &freq) != 1)
+		freq = 0;
+	fclose(fd);
 	return freq;
 }
 
+#define RAPL_PATH "/sys/class/powercap/intel-rapl:%d/%s"
+
+/* package power in watts since the previous call, -1 if unavailable */
+static float linux_cpupower(int package)
+{
+	static uint64_t last_uj[HWMON_MAX];
+	static struct timeval last_tv[HWMON_MAX];
+	uint64_t uj = 0, range = 0;
+	struct timeval now, diff;
+	char path[128];
+	float watts = -1.;
+	double secs;
+	FILE *fd;
+
+	if (package < 0 || package >= HWMON_MAX)
+		return watts;
+
+	snprintf(path, sizeof(path), RAPL_PATH, package, "energy_uj");
+	fd = fopen(path, "r");
+	if (!fd)
+		return watts;
+	if (fscanf(fd, "%" SCNu64, &uj) != 1) {
+		fclose(fd);
+		return watts;
+	}
+	fclose(fd);
+	gettimeofday(&now, NULL);
+
+	if (last_tv[package].tv_sec) {
+		timeval_subtract(&diff, &now, &last_tv[package]);
+		secs = diff.tv_sec + diff.tv_usec * 1e-6;
+		if (uj < last_uj[package]) {
+			/* counter wrapped */
+			snprintf(path, sizeof(path), RAPL_PATH, package,
+				"max_energy_range_uj");
+			fd = fopen(path, "r");
+			if (fd) {
+				if (fscanf(fd, "%" SCNu64, &range) != 1)
+					range = 0;
+				fclose(fd);
+			}
+			uj += range;
+		}
+		if (secs > 0.)
+			watts = (float) ((uj - last_uj[package]) * 1e-6 / secs);
+	}
+	last_uj[package] = uj - range;
+	last_tv[package] = now;
+	return watts;
+}
+
 #else /* WIN32 */
 
 static float win32_cputemp(int core)
@@ -89,6 +264,38 @@ uint32_t cpu_clock(int core)
 #endif
 }
 
+/* physical package of a logical cpu */
+int cpu_package(int core)
+{
+#ifdef WIN32
+	return 0;
+#else
+	int pkg = linux_topology(core, "physical_package_id");
+	return pkg < 0 ? 0 : pkg;
+#endif
+}
+
+/* physical core of a logical cpu, unique within its package */
+int cpu_core(int core)
+{
+#ifdef WIN32
+	return core;
+#else
+	int cid = linux_topology(core, "core_id");
+	return cid < 0 ? core : cid;
+#endif
+}
+
+/* RAPL package power, only meant to be polled by one thread */
+float cpu_power(int package)
+{
+#ifdef WIN32
+	return -1.;
+#else
+	return linux_cpupower(package);
+#endif
+}
+
 int cpu_fanpercent()
 {
 	return 0;
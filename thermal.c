@@ -0,0 +1,215 @@
+/**
+ * Thermal governor
+ *
+ * Holds each cpu package at --max-temp, and at --max-power when the
+ * RAPL energy counter is readable, by setting the duty cycle of the
+ * miner threads running on it. One PID controller per package is
+ * updated every second from the hottest core, threads then sleep for
+ * the off part of each scan. Running a little slower all the time
+ * gives more hashes than stopping and restarting on a hard limit.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+
+#include "miner.h"
+
+#define GOV_PERIOD    1.0    /* seconds between controller updates */
+#define GOV_KP        0.04   /* duty per degree C */
+#define GOV_KI        0.008  /* duty per degree C and second */
+#define GOV_KD        0.02   /* duty per degree C per second */
+#define GOV_MIN_DUTY  0.05
+#define GOV_PANIC     10.0   /* degrees over target where threads stop */
+#define GOV_POWER_K   50.0   /* degrees equivalent of 100% over power */
+#define GOV_MAX_OFF   2.0    /* longest sleep of a thread in seconds */
+
+double opt_max_power = 0.0;
+
+struct gov_pkg {
+	int id;
+	int cpus;
+	float temp;        /* hottest core */
+	float power;       /* watts, -1 if unknown */
+	uint32_t freq;     /* average kHz */
+	double err;
+	double integ;
+	double p, i, d;
+	volatile double duty;
+};
+
+static struct gov_pkg *gov_pkgs = NULL;
+static int gov_npkgs = 0;
+static int *gov_cpu_pkg = NULL;   /* package index of each cpu */
+static bool gov_active = false;
+
+static struct gov_pkg *thread_pkg(int thr_id)
+{
+	if (!gov_active)
+		return NULL;
+	return &gov_pkgs[gov_cpu_pkg[thread_cpu(thr_id)]];
+}
+
+bool governor_init()
+{
+	if (opt_max_temp <= 0. && opt_max_power <= 0.)
+		return true;
+#ifdef WIN32
+	applog(LOG_WARNING, "--max-temp and --max-power are only supported on Linux");
+	return true;
+#else
+	gov_cpu_pkg = (int*) calloc(num_cpus, sizeof(int));
+	gov_pkgs = (struct gov_pkg*) calloc(num_cpus, sizeof(struct gov_pkg));
+	if (!gov_cpu_pkg || !gov_pkgs)
+		return false;
+
+	for (int c = 0; c < num_cpus; c++) {
+		int id = cpu_package(c), k;
+		for (k = 0; k < gov_npkgs; k++)
+			if (gov_pkgs[k].id == id)
+				break;
+		if (k == gov_npkgs) {
+			gov_pkgs[k].id = id;
+			gov_pkgs[k].duty = 1.0;
+			gov_npkgs++;
+		}
+		gov_pkgs[k].cpus++;
+		gov_cpu_pkg[c] = k;
+	}
+
+	if (opt_max_temp > 0. && cpu_temp(0) <= 0.)
+		applog(LOG_WARNING, "No cpu temperature sensor found, --max-temp ignored");
+
+	gov_active = true;
+	return true;
+#endif
+}
+
+/* one PID step, e is how far over target the package is */
+static void gov_update(struct gov_pkg *pk, double e, double dt)
+{
+	double integ = pk->integ + e * dt;
+	double deriv = (e - pk->err) / dt;
+	double duty;
+
+	pk->p = GOV_KP * e;
+	pk->d = GOV_KD * deriv;
+	duty = 1.0 - (pk->p + GOV_KI * integ + pk->d);
+
+	/* don't wind up the integral while the output is saturated */
+	if (duty > GOV_MIN_DUTY && duty < 1.0)
+		pk->integ = integ;
+	pk->i = GOV_KI * pk->integ;
+	pk->err = e;
+
+	if (duty > 1.0)
+		duty = 1.0;
+	if (duty < GOV_MIN_DUTY)
+		duty = GOV_MIN_DUTY;
+	if (e > GOV_PANIC)
+		duty = 0.;
+	pk->duty = duty;
+}
+
+void *governor_thread(void *userdata)
+{
+	struct thr_info *mythr = (struct thr_info *) userdata;
+	bool throttled = false;
+	int loops = 0;
+
+	if (!gov_active)
+		goto out;
+
+	while (1) {
+		for (int k = 0; k < gov_npkgs; k++) {
+			struct gov_pkg *pk = &gov_pkgs[k];
+			double e = -1e9;
+			uint64_t freq = 0;
+
+			pk->temp = 0.;
+			for (int c = 0; c < num_cpus; c++) {
+				float t;
+				if (gov_cpu_pkg[c] != k)
+					continue;
+				t = cpu_temp(c);
+				if (t > pk->temp)
+					pk->temp = t;
+				freq += cpu_clock(c);
+			}
+			pk->freq = (uint32_t) (freq / pk->cpus);
+			pk->power = cpu_power(pk->id);
+			/* the first power sample only primes the counter */
+			if (loops == 1 && k == 0 && opt_max_power > 0. && pk->power < 0.)
+				applog(LOG_WARNING, "RAPL energy counter not readable, "
+					"--max-power ignored");
+
+			if (opt_max_temp > 0. && pk->temp > 0.)
+				e = pk->temp - opt_max_temp;
+			if (opt_max_power > 0. && pk->power >= 0.)
+				e = fmax(e, (pk->power - opt_max_power) / opt_max_power
+				            * GOV_POWER_K);
+			if (e > -1e9)
+				gov_update(pk, e, GOV_PERIOD);
+
+			if (!opt_quiet && k == 0 && (pk->duty < 1.0) != throttled) {
+				throttled = pk->duty < 1.0;
+				if (throttled)
+					applog(LOG_INFO, "CPU %d at %.0fC, throttling", pk->id,
+						pk->temp);
+				else
+					applog(LOG_INFO, "CPU %d at %.0fC, full speed", pk->id,
+						pk->temp);
+			}
+			if (opt_debug)
+				applog(LOG_DEBUG, "CPU %d: %.1fC %.0fW %u MHz duty %.3f"
+					" (P %.3f I %.3f D %.3f)", pk->id, pk->temp, pk->power,
+					pk->freq / 1000, pk->duty, pk->p, pk->i, pk->d);
+		}
+		loops++;
+		usleep((useconds_t) (GOV_PERIOD * 1e6));
+	}
+out:
+	tq_freeze(mythr->q);
+	return NULL;
+}
+
+/* 1.0 unless the package of the thread is throttled */
+double governor_duty(int thr_id)
+{
+	struct gov_pkg *pk = thread_pkg(thr_id);
+	return pk ? pk->duty : 1.0;
+}
+
+/* sleep the off part of a duty cycle, returns the seconds slept */
+double governor_throttle(int thr_id, double busy)
+{
+	double duty = governor_duty(thr_id);
+	double off;
+
+	if (duty >= 1.0)
+		return 0.;
+	off = duty > 0. ? busy * (1.0 - duty) / duty : GOV_MAX_OFF;
+	if (off > GOV_MAX_OFF)
+		off = GOV_MAX_OFF;
+	usleep((useconds_t) (off * 1e6));
+	return off;
+}
+
+/* api "thermal" command, one record per package */
+int governor_format_api(char *buf, size_t sz)
+{
+	size_t len = 0;
+
+	*buf = '\0';
+	for (int k = 0; k < gov_npkgs && len < sz; k++) {
+		struct gov_pkg *pk = &gov_pkgs[k];
+		len += snprintf(buf + len, sz - len,
+			"PKG=%d;CPUS=%d;TEMP=%.1f;FREQ=%u;POWER=%.1f;MAXTEMP=%.1f;"
+			"MAXPOWER=%.1f;DUTY=%.3f;P=%.4f;I=%.4f;D=%.4f|",
+			pk->id, pk->cpus, pk->temp, pk->freq, pk->power,
+			opt_max_temp, opt_max_power, pk->duty, pk->p, pk->i, pk->d);
+	}
+	return (int) len;
+}
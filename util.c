@@ -133,14 +133,18 @@ void applog(int prio, const char *fmt, ...)
 			color = "";
 
 		len = 64 + (int) strlen(fmt) + 2;
+		if (log_tag)
+			len += (int) strlen(log_tag) + 3;
 		f = (char*) malloc(len);
-		sprintf(f, "[%d-%02d-%02d %02d:%02d:%02d]%s %s%s\n",
+		sprintf(f, "[%d-%02d-%02d %02d:%02d:%02d]%s%s%s %s%s\n",
 			tm.tm_year + 1900,
 			tm.tm_mon + 1,
 			tm.tm_mday,
 			tm.tm_hour,
 			tm.tm_min,
 			tm.tm_sec,
+			log_tag ? " " : "",
+			log_tag ? log_tag : "",
 			color,
 			fmt,
 			use_colors ? CL_N : ""
@@ -506,13 +510,16 @@ json_t *json_rpc_call(CURL *curl, const char *url,
 	upload_data.pos = 0;
 	sprintf(len_hdr, "Content-Length: %lu",
 		(unsigned long) upload_data.len);
+	/* known size, else newer curl sends it chunked */
+	curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long) upload_data.len);
 
 	headers = curl_slist_append(headers, "Content-Type: application/json");
 	headers = curl_slist_append(headers, len_hdr);
 	headers = curl_slist_append(headers, "User-Agent: " USER_AGENT);
 	headers = curl_slist_append(headers, "X-Mining-Extensions: longpoll reject-reason");
 	//headers = curl_slist_append(headers, "Accept:"); /* disable Accept hdr*/
-	//headers = curl_slist_append(headers, "Expect:"); /* disable Expect hdr*/
+	/* no round trip for 100-continue before a block */
+	headers = curl_slist_append(headers, "Expect:"); /* disable Expect hdr*/
 
 	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
 
@@ -1243,7 +1250,7 @@ static bool stratum_parse_extranonce(struct stratum_ctx *sctx, json_t *params, i
 		applog(LOG_ERR, "Failed to get extranonce2_size");
 		goto out;
 	}
-	if (xn2_size < 2 || xn2_size > 16) {
+	if (xn2_size < 2 || xn2_size > WORK_XNONCE2_MAX) {
 		applog(LOG_INFO, "Failed to get valid n2size in parse_extranonce");
 		goto out;
 	}
@@ -1271,6 +1278,64 @@ out:
 	return false;
 }
 
+/*
+ * mining.configure, sent first on a connection to ask for BIP320 version
+ * rolling when the algo can roll the version bits. A pool that doesn't
+ * know the method answers with an error or not at all, both leave
+ * version_mask 0.
+ */
+bool stratum_configure(struct stratum_ctx *sctx)
+{
+	char s[256], *sret;
+	json_t *val, *res_val;
+	json_error_t err;
+	const char *mask;
+
+	sctx->version_mask = 0;
+	if (jsonrpc_2 || !opt_version_rolling || !algo_gate.roll_version)
+		return true;
+
+	snprintf(s, sizeof(s), "{\"id\": %d, \"method\": \"mining.configure\", "
+		"\"params\": [[\"version-rolling\"], {\"version-rolling.mask\": "
+		"\"%08x\", \"version-rolling.min-bit-count\": %d}]}",
+		STRATUM_CONFIGURE_ID, VERSION_ROLL_MASK, VERSION_ROLL_MIN_BITS);
+	if (!stratum_send_line(sctx, s))
+		return false;
+
+	while (stratum_socket_full(sctx, 3)) {
+		if (!(sret = stratum_recv_line(sctx)))
+			return false;
+		if (stratum_handle_method(sctx, sret)) {
+			free(sret);
+			continue;
+		}
+		val = JSON_LOADS(sret, &err);
+		free(sret);
+		if (!val)
+			break;
+		if (json_integer_value(json_object_get(val, "id"))
+		    != STRATUM_CONFIGURE_ID) {
+			json_decref(val);
+			continue;
+		}
+		res_val = json_object_get(val, "result");
+		mask = json_string_value(json_object_get(res_val,
+			"version-rolling.mask"));
+		if (json_is_true(json_object_get(res_val, "version-rolling"))
+		    && mask)
+			sctx->version_mask = strtoul(mask, NULL, 16)
+				& VERSION_ROLL_MASK;
+		json_decref(val);
+		break;
+	}
+	if (sctx->version_mask)
+		applog(LOG_INFO, "Stratum version rolling, mask %08x",
+			sctx->version_mask);
+	else if (opt_debug)
+		applog(LOG_DEBUG, "Stratum version rolling not supported");
+	return true;
+}
+
 bool stratum_subscribe(struct stratum_ctx *sctx)
 {
 	char *s, *sret = NULL;
@@ -1591,6 +1656,10 @@ bool rpc2_job_decode(const json_t *job, struct work *work)
 		goto err_out;
 	}
 	const char *job_id = json_string_value(tmp);
+	if (!job_id || strlen(job_id) >= WORK_JOB_ID_MAX) {
+		applog(LOG_ERR, "JSON invalid job id");
+		goto err_out;
+	}
 	tmp = json_object_get(job, "blob");
 	if (!tmp) {
 		applog(LOG_ERR, "JSON invalid blob");
@@ -1649,8 +1718,7 @@ bool rpc2_job_decode(const json_t *job, struct work *work)
 		memcpy(work->data, rpc2_blob, rpc2_bloblen);
 		memset(work->target, 0xff, sizeof(work->target));
 		work->target[7] = rpc2_target;
-		if (work->job_id) free(work->job_id);
-		work->job_id = strdup(rpc2_job_id);
+		strcpy(work->job_id, rpc2_job_id);
 	}
 	return true;
 
@@ -1723,7 +1791,7 @@ static bool stratum_notify(struct stratum_ctx *sctx, json_t *params)
 	clean = json_is_true(json_array_get(params, p)); p++;
 
 	if (!job_id || !prevhash || !coinb1 || !coinb2 || !version || !nbits || !stime ||
-	    strlen(prevhash) != 64 || strlen(version) != 8 ||
+	    strlen(job_id) >= WORK_JOB_ID_MAX || strlen(prevhash) != 64 || strlen(version) != 8 ||
 	    strlen(nbits) != 8 || strlen(stime) != 8) {
 		applog(LOG_ERR, "Stratum notify: invalid parameters");
 		goto out;
@@ -1805,6 +1873,22 @@ static bool stratum_set_difficulty(struct stratum_ctx *sctx, json_t *params)
 	return true;
 }
 
+/* BIP320, the pool changes the version bits it allows */
+static bool stratum_set_version_mask(struct stratum_ctx *sctx, json_t *params)
+{
+	const char *mask = json_string_value(json_array_get(params, 0));
+
+	if (!mask)
+		return false;
+	pthread_mutex_lock(&sctx->work_lock);
+	sctx->version_mask = opt_version_rolling && algo_gate.roll_version
+		? strtoul(mask, NULL, 16) & VERSION_ROLL_MASK : 0;
+	pthread_mutex_unlock(&sctx->work_lock);
+	if (opt_debug)
+		applog(LOG_DEBUG, "Stratum version mask %08x", sctx->version_mask);
+	return true;
+}
+
 static bool stratum_reconnect(struct stratum_ctx *sctx, json_t *params)
 {
 	json_t *port_val;
@@ -2074,6 +2158,36 @@ static bool stratum_show_message(struct stratum_ctx *sctx, json_t *id, json_t *p
 	return ret;
 }
 
+static bool stratum_set_algo(struct stratum_ctx *sctx, json_t *id, json_t *params)
+{
+	char algo[64] = { 0 };
+	const char *name;
+	char *s;
+	json_t *val;
+	bool ret, ok = false;
+
+	name = json_string_value(json_array_get(params, 0));
+	if (name) {
+		snprintf(algo, sizeof(algo), "%s", name);
+		applog(LOG_NOTICE, "Pool asked to switch algo to %s", algo);
+		ok = algo_switch_request(algo);
+	}
+
+	if (!id || json_is_null(id))
+		return true;
+
+	val = json_object();
+	json_object_set(val, "id", id);
+	json_object_set_new(val, "error", json_null());
+	json_object_set_new(val, "result", json_boolean(ok));
+	s = json_dumps(val, 0);
+	ret = stratum_send_line(sctx, s);
+	json_decref(val);
+	free(s);
+
+	return ret;
+}
+
 bool stratum_handle_method(struct stratum_ctx *sctx, const char *s)
 {
 	json_t *val, *id, *params;
@@ -2115,6 +2229,10 @@ bool stratum_handle_method(struct stratum_ctx *sctx, const char *s)
 		ret = stratum_set_difficulty(sctx, params);
 		goto out;
 	}
+	if (!strcasecmp(method, "mining.set_version_mask")) {
+		ret = stratum_set_version_mask(sctx, params);
+		goto out;
+	}
 	if (!strcasecmp(method, "mining.set_extranonce")) {
 		ret = stratum_parse_extranonce(sctx, params, 0);
 		goto out;
@@ -2129,6 +2247,10 @@ bool stratum_handle_method(struct stratum_ctx *sctx, const char *s)
 		ret = stratum_get_algo(sctx, id, params);
 		goto out;
 	}
+	if (!strcasecmp(method, "client.set_algo")) {
+		ret = stratum_set_algo(sctx, id, params);
+		goto out;
+	}
 	if (!strcasecmp(method, "client.get_stats")) {
 		// optional to fill device benchmarks
 		ret = stratum_get_stats(sctx, id, params);
@@ -0,0 +1,271 @@
+/**
+ * Share verification, --verify[=FILE]
+ *
+ * Hashes one header per line of FILE, or of stdin, with the hash library
+ * on -t threads and writes one line per header. An input line is the
+ * header in hex as it goes on the wire, optionally followed by a target
+ * as a 64 digit big endian hex number, the way pools show them. The
+ * output is the hash as the same kind of number, followed by pass or fail
+ * for a line with a target. The verify only algos need the target and
+ * write "-" for the hash. Lines are read and hashed VF_CHUNK at a time.
+ *
+ * Lines that don't parse, or that the algo can't hash, are written as
+ * "error" without hashing them.
+ *
+ * With --benchmark, VF_BENCH_HEADERS random headers with the current
+ * ntime, or --bench-hashes of them, are hashed in one batch: headers that all differ, headers of one
+ * job that differ in the nonce, then verified against a share target.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "miner.h"
+#include "cpuminer-hash.h"
+
+#define VF_CHUNK          4096
+#define VF_LINE           1024
+#define VF_BENCH_HEADERS  (1 << 20)
+#define VF_BENCH_TARGET   0x0000ffff   /* top word of the share target */
+
+bool  opt_verify = false;
+char *opt_verify_file = NULL;   /* NULL for stdin */
+
+/* a chunk of lines */
+static uchar    vf_headers[VF_CHUNK * 180];
+static uint32_t vf_targets[VF_CHUNK][8];
+static uint32_t vf_hashes[VF_CHUNK][8];
+static uint8_t  vf_pass[VF_CHUNK];
+static bool     vf_has_target[VF_CHUNK];
+static bool     vf_bad[VF_CHUNK];
+
+static double vf_now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* 32 bytes in memory order to and from a big endian hex number */
+static void vf_hex(char *s, const uint32_t *v)
+{
+	uint32_t be[8];
+
+	for (int i = 0; i < 8; i++)
+		be32enc(be + i, v[7 - i]);
+	bin2hex(s, (const uchar*) be, 32);
+}
+
+static bool vf_unhex(uint32_t *v, const char *s)
+{
+	uint32_t be[8];
+
+	if (strlen(s) != 64 || !hex2bin((uchar*) be, s, 32))
+		return false;
+	for (int i = 0; i < 8; i++)
+		v[7 - i] = be32dec(be + i);
+	return true;
+}
+
+static cmh_ctx *vf_open()
+{
+	char arg[64];
+	cmh_ctx *ctx;
+
+	if (opt_scrypt_n)
+		snprintf(arg, sizeof(arg), "%s:%d", algo_names[opt_algo],
+			opt_scrypt_n);
+	else
+		snprintf(arg, sizeof(arg), "%s", algo_names[opt_algo]);
+	if (!(ctx = cmh_init(arg, opt_n_threads)))
+		applog(LOG_ERR, "verify: %s is not supported by the hash library",
+			algo_names[opt_algo]);
+	return ctx;
+}
+
+static double vf_rate(size_t n, double t)
+{
+	return t > 0. ? n / t : 0.;
+}
+
+/* random headers, an 80 byte header gets a current ntime */
+static void vf_random(uchar *headers, size_t n, int len)
+{
+	const uint32_t ntime = (uint32_t) time(NULL);
+
+	for (size_t i = 0; i < n * len; i++)
+		headers[i] = (uchar) rand();
+	if (len == 80)
+		for (size_t i = 0; i < n; i++)
+			le32enc(headers + i * len + 68, ntime);
+}
+
+static int vf_bench(cmh_ctx *ctx)
+{
+	const size_t n = opt_bench_hashes ? opt_bench_hashes : VF_BENCH_HEADERS;
+	const int len = cmh_header_len(ctx);
+	uchar *headers = (uchar*) malloc(n * len);
+	uint32_t *hashes = (uint32_t*) malloc(n * 32);
+	uint8_t *pass = (uint8_t*) malloc(n);
+	uint32_t target[8];
+	double t, hash_t = 0., job_t = 0., verify_t;
+	size_t passed = 0;
+	int rc = 0;
+
+	if (!headers || !hashes || !pass) {
+		applog(LOG_ERR, "verify: no memory for %zu headers", n);
+		rc = 1;
+		goto out;
+	}
+	srand(time(NULL));
+	vf_random(headers, n, len);
+
+	applog(LOG_INFO, "Verify benchmark: %zu %s headers on %d threads", n,
+		algo_names[opt_algo], opt_n_threads);
+	if (cmh_can_hash(ctx)) {
+		t = vf_now();
+		rc |= cmh_hash_batch(ctx, hashes, headers, n);
+		hash_t = vf_now() - t;
+
+		/* one job, the nonce is the last word of an 80 byte header */
+		for (size_t i = 1; i < n; i++) {
+			memcpy(headers + i * len, headers, len);
+			if (len == 80)
+				be32enc(headers + i * len + 76, (uint32_t) i);
+		}
+		t = vf_now();
+		rc |= cmh_hash_batch(ctx, hashes, headers, n);
+		job_t = vf_now() - t;
+		vf_random(headers, n, len);
+	}
+
+	memset(target, 0xff, sizeof(target));
+	target[7] = VF_BENCH_TARGET;
+	t = vf_now();
+	rc |= cmh_verify_batch(ctx, pass, NULL, headers, target, 0, n);
+	verify_t = vf_now() - t;
+	for (size_t i = 0; i < n; i++)
+		passed += pass[i];
+
+	if (rc)
+		applog(LOG_ERR, "verify: hash library failed");
+	else if (cmh_can_hash(ctx))
+		applog(LOG_NOTICE, "Verify benchmark: hash %.0f H/s, one job "
+			"%.0f H/s, verify %.0f H/s, %zu shares", vf_rate(n, hash_t),
+			vf_rate(n, job_t), vf_rate(n, verify_t), passed);
+	else
+		applog(LOG_NOTICE, "Verify benchmark: verify %.0f H/s, %zu shares",
+			vf_rate(n, verify_t), passed);
+out:
+	free(headers);
+	free(hashes);
+	free(pass);
+	return rc;
+}
+
+/*
+ * Hashes a chunk of lines and writes them, bad lines as "error". The good
+ * lines are moved to the front of the chunk first, the bad ones aren't
+ * hashed.
+ */
+static void vf_flush(cmh_ctx *ctx, int n, int len, int *errors)
+{
+	char hex[65];
+	bool verify = !cmh_can_hash(ctx);
+	int good = 0, rc = 0;
+
+	for (int i = 0; i < n; i++) {
+		if (vf_bad[i])
+			continue;
+		verify |= vf_has_target[i];
+		if (good != i) {
+			memcpy(vf_headers + good * len, vf_headers + i * len, len);
+			memcpy(vf_targets[good], vf_targets[i], 32);
+		}
+		good++;
+	}
+	if (good)
+		rc = verify ? cmh_verify_batch(ctx, vf_pass, vf_hashes, vf_headers,
+				vf_targets, 32, good)
+			: cmh_hash_batch(ctx, vf_hashes, vf_headers, good);
+
+	for (int i = 0, k = 0; i < n; i++) {
+		if (vf_bad[i] || rc) {
+			puts("error");
+			(*errors)++;
+			k += !vf_bad[i];
+			continue;
+		}
+		if (cmh_can_hash(ctx))
+			vf_hex(hex, vf_hashes[k]);
+		else
+			strcpy(hex, "-");
+		if (vf_has_target[i])
+			printf("%s %s\n", hex, vf_pass[k] ? "pass" : "fail");
+		else
+			puts(hex);
+		k++;
+	}
+	fflush(stdout);
+}
+
+/* 0 if every line could be hashed */
+int cpu_verify()
+{
+	char line[VF_LINE];
+	FILE *in = stdin;
+	cmh_ctx *ctx;
+	size_t lines = 0;
+	int len, n = 0, errors = 0;
+	double t0;
+
+	if (!(ctx = vf_open()))
+		return 1;
+	if (opt_benchmark) {
+		errors = vf_bench(ctx);
+		cmh_free(ctx);
+		return errors;
+	}
+	if (opt_verify_file && strcmp(opt_verify_file, "-")
+	    && !(in = fopen(opt_verify_file, "r"))) {
+		applog(LOG_ERR, "verify: can't open %s", opt_verify_file);
+		cmh_free(ctx);
+		return 1;
+	}
+
+	len = cmh_header_len(ctx);
+	t0 = vf_now();
+	while (fgets(line, sizeof(line), in)) {
+		char *hdr = strtok(line, " \t\r\n"), *tgt = strtok(NULL, " \t\r\n");
+		uchar *h = vf_headers + n * len;
+
+		if (!hdr)
+			continue;
+		vf_has_target[n] = tgt != NULL;
+		vf_bad[n] = strlen(hdr) != (size_t) len * 2 || !hex2bin(h, hdr, len);
+		if (tgt)
+			vf_bad[n] |= !vf_unhex(vf_targets[n], tgt);
+		else {
+			memset(vf_targets[n], 0xff, 32);
+			vf_bad[n] |= !cmh_can_hash(ctx);
+		}
+		if (!vf_bad[n])
+			vf_bad[n] = !cmh_header_ok(ctx, h);
+		lines++;
+		if (++n == VF_CHUNK) {
+			vf_flush(ctx, n, len, &errors);
+			n = 0;
+		}
+	}
+	if (n)
+		vf_flush(ctx, n, len, &errors);
+	if (in != stdin)
+		fclose(in);
+
+	applog(LOG_INFO, "Verified %zu headers in %.2fs, %d errors", lines,
+		vf_now() - t0, errors);
+	cmh_free(ctx);
+	return errors ? 1 : 0;
+}